@@ -49,6 +49,8 @@
 #ifndef _CALLBACK_H_
 #define _CALLBACK_H_
 
+#include <string>
+
 // CARLsim user interface classes
 class CARLsim; // forward-declaration
 
@@ -97,6 +99,15 @@ public:
 	 * \attention The virtual method should never be called directly */
 	virtual void connect(CARLsim* s, int srcGrpId, int i, int destGrpId, int j, float& weight, float& maxWt,
 							float& delay, bool& connected) = 0;
+
+	/*!
+	 * \brief identifies the connections made by the generator for the network cache
+	 *
+	 * The network cache (see CARLsim::setNetworkCache) cannot inspect the connections a generator would make, so it
+	 * relies on this identity instead. Two generators with the same identity must make the same connections.
+	 * Networks with a generator that returns an empty identity (the default) are not cached.
+	 * \since v4.0 */
+	virtual std::string getIdentity() { return ""; }
 };
 
 
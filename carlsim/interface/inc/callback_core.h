@@ -49,6 +49,8 @@
 #ifndef _CALLBACK_CORE_H_
 #define _CALLBACK_CORE_H_
 
+#include <string>
+
 class CARLsim;
 class SNN;
 
@@ -94,6 +96,9 @@ public:
 	virtual void connect(SNN* s, int srcGrpId, int i, int destGrpId, int j, float& weight, float& maxWt,
 		float& delay, bool& connected);
 
+	//! returns the identity of the user-defined ConnectionGenerator, empty if there is none
+	std::string getIdentity();
+
 private:
 	CARLsim* carlsim;
 	ConnectionGenerator* cGen;
@@ -478,6 +478,243 @@ public:
 	*/
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	/*!
+	* \brief Sets whether a single CPU runtime is executed inline
+	*
+	* All CPU runtimes (partitions) are executed by a pool of persistent worker threads, which is created once in
+	* setupNetwork and reused by every phase of runNetwork. Each worker thread is pinned to a CPU core.
+	*
+	* If the network has only one CPU runtime, there is nothing to run in parallel. In this case, the runtime is by
+	* default executed inline on the thread that called runNetwork, which avoids the synchronization overhead.
+	* Setting <tt>runInline</tt> to false forces the single CPU runtime onto a pinned worker thread.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] runInline whether a single CPU runtime is executed inline on the calling thread (default: true)
+	* \since v4.0
+	*/
+	void setCPURunInline(bool runInline);
+
+	/*!
+	* \brief Sets the number of threads that share the neurons of each CPU runtime
+	*
+	* By default, each CPU runtime (partition) is simulated by a single thread, so that a network with only one big
+	* partition can use only one CPU core. With <tt>numThreads</tt> > 1, the local neurons of each CPU runtime are split
+	* into <tt>numThreads</tt> contiguous ranges, and the neuron state update, the decay of conductances and STP
+	* variables, and the spike detection of each range are executed by a separate worker thread.
+	*
+	* The firing tables are filled in neuron order (the slots of each neuron range are assigned by a parallel prefix
+	* sum), such that the simulation produces exactly the same spikes as with a single thread per CPU runtime.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] numThreads the number of threads per CPU runtime, must be in [1, 16] (default: 1)
+	* \note Neuron groups with compartments depend on the voltage of their neighbors, so the neuron state update of
+	* networks with compartments is not split.
+	* \since v4.0
+	*/
+	void setCPUThreadsPerRuntime(int numThreads);
+
+	/*!
+	* \brief Sets whether the spike delivery of a CPU runtime is split among its threads
+	*
+	* Spike delivery (doCurrentUpdate) walks the firing tables and scatters each spike into the conductances (or
+	* currents) and the STDP state of the post-synaptic neurons. If enabled, the threads of a CPU runtime (see
+	* setCPUThreadsPerRuntime) each walk all spikes, but only update the post-synaptic neurons in their own neuron
+	* range. Since no two threads write to the same neuron, no atomic operations are needed, and every neuron receives
+	* its spikes in the same order as with a single thread. The result is therefore identical to the serial delivery.
+	*
+	* This pays off in networks with many synapses per spike (dense recurrent networks), where the scattering dominates
+	* the cost of walking the firing tables.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to split the spike delivery among the threads of a CPU runtime (default: false)
+	* \since v4.0
+	*/
+	void setCPUParallelSpikeDelivery(bool enable);
+
+	/*!
+	* \brief Sets whether the CPU runtimes update each neuron in a single fused pass
+	*
+	* By default, a simulated millisecond makes several full passes over the neuron state of a CPU runtime: one per
+	* integration step (see setIntegrationMethod) to integrate v and u, and a copy of the new membrane potentials after
+	* each integration step. For networks that do not fit into the cache, every pass streams the whole state from
+	* memory again.
+	*
+	* If enabled, each neuron instead runs all integration steps on registers and writes back its state once. The
+	* simulation results, including the conductances read between two calls to runNetwork (e.g., via
+	* getConductanceAMPA), are bit-exact with the default update.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to use the fused neuron update (default: false)
+	* \note Not supported for networks with compartments, which fall back to the default update.
+	* \since v4.0
+	*/
+	void setCPUFusedNeuronUpdate(bool enable);
+
+	/*!
+	* \brief Sets whether the CPU runtimes integrate the neurons with SIMD instructions
+	*
+	* By default, the CPU runtimes integrate one neuron at a time, and decide per neuron which Izhikevich model and
+	* integration method to use. If enabled, the neurons of a group are integrated by a vectorized kernel instead, which
+	* is specialized for the model (4- or 9-parameter), the integration method (Forward-Euler or Runge-Kutta 4), and the
+	* synapse model (CUBA or COBA) of the group, and processes 16 (AVX-512) or 8 (AVX2) neurons at a time. The
+	* instruction set is chosen at setupNetwork according to the processor, with a scalar kernel as fallback.
+	*
+	* The kernels perform the same floating-point operations as the default update, so that the simulation results
+	* are bit-exact. Can be combined with setCPUFusedNeuronUpdate.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to use the vectorized neuron update (default: false)
+	* \note Groups with compartments are always integrated by the default update.
+	* \note AVX2 and AVX-512 kernels are only available on x86 processors with GCC or Clang.
+	* \since v4.0
+	*/
+	void setCPUVectorizedNeuronUpdate(bool enable);
+
+	/*!
+	* \brief Distributes the groups without a preferred partition among multiple CPU runtimes
+	*
+	* By default, all groups that were created with <tt>preferredPartition</tt> ANY are assigned to the first CPU
+	* runtime, so that a network uses multiple CPU cores only if the user assigns the partitions by hand. With
+	* <tt>numPartitions</tt> > 1, these groups are instead distributed among <tt>numPartitions</tt> CPU runtimes
+	* during setupNetwork.
+	*
+	* The partitioner estimates the cost of each group from its number of neurons and its expected number of incoming
+	* synapses (based on group sizes, connection types, and connection probabilities), and the spike traffic between
+	* two groups from the size of the pre-synaptic group. It then places the groups such that the estimated load of
+	* the runtimes is balanced and as few spikes as possible have to be routed between runtimes. Groups with a
+	* user-specified partition stay where they are, but count towards the load of their runtime.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] numPartitions the number of CPU runtimes to use (default: 1)
+	* \note Only applies to CPU_MODE and HYBRID_MODE. The estimated load and the groups of each runtime are reported at
+	* setupNetwork.
+	* \since v4.0
+	*/
+	void setCPUAutoPartition(int numPartitions);
+
+	/*!
+	* \brief Sets whether multiple CPU runtimes synchronize only once per lookahead window
+	*
+	* By default, all CPU runtimes wait for each other after every phase of every simulated millisecond. However, a
+	* spike that is sent from one runtime to another cannot affect its target earlier than the minimum axonal delay of
+	* the connections between runtimes (the lookahead). If enabled, each CPU runtime simulates up to lookahead
+	* milliseconds on its own, and the runtimes only exchange their spikes at the end of such a window (as in
+	* conservative parallel discrete-event simulation). The simulation results are the same as without lookahead.
+	*
+	* The lookahead is the smallest <tt>minDelay</tt> of all connections between groups on different runtimes, as
+	* specified by the RangeDelay of CARLsim::connect (connections with a ConnectionGenerator have a minimum delay of
+	* 1 ms). Windows never cross a second boundary or a weight update.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to use lookahead synchronization (default: false)
+	* \note Only supported if all groups run on CPU runtimes, no group uses a user-defined spike generator, and the
+	* lookahead is at least 2 ms. Otherwise, the runtimes synchronize every millisecond (a warning is issued at
+	* setupNetwork).
+	* \note In lookahead mode, each CPU runtime is executed by a single thread (see setCPUThreadsPerRuntime).
+	* \since v4.0
+	*/
+	void setCPULookahead(bool enable);
+
+	/*!
+	* \brief Sets whether the CPU runtimes store the synapses of a fixed network in a compact layout
+	*
+	* By default, the CPU runtimes store about 26 bytes per synapse: the ids of the pre- and the post-synaptic neuron
+	* (8 bytes each), the weight, the time of the last spike, and the connection id. If enabled, and if the network has
+	* no plastic synapses and no STDP, each synapse instead takes 7 to 10 bytes: the id of the post-synaptic neuron is
+	* packed into 32 bits together with the synapse id, the pre-synaptic ids and the spike times are not stored, and the
+	* weights are stored in <tt>weightFormat</tt>. Besides the memory, this reduces the memory bandwidth of the spike
+	* delivery.
+	*
+	* With SYN_WEIGHT_FLOAT, the simulation results are the same as with the default layout. With SYN_WEIGHT_HALF and
+	* SYN_WEIGHT_INT8, the weights are rounded when the network is set up, and whenever they are changed (e.g., via
+	* setWeight). Weights read back (e.g., via a ConnectionMonitor) are the rounded weights.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to use the compact synapse storage (default: false)
+	* \param[in] weightFormat the storage format of the weights (default: SYN_WEIGHT_FLOAT)
+	* \note With SYN_WEIGHT_INT8, weights larger than the maxWt of their connection at setupNetwork are clipped (e.g.,
+	* after biasWeights with <tt>updateWeightRange</tt>).
+	* \note If the network has plastic synapses or STDP, the default layout is used (a warning is issued at
+	* setupNetwork). If the ids of a CPU runtime do not fit into 32 bits, it keeps the default ids.
+	* \since v4.0
+	*/
+	void setCPUCompactSynapses(bool enable, SynWeightFormat weightFormat = SYN_WEIGHT_FLOAT);
+
+	/*!
+	* \brief Sets whether the CPU runtimes apply LTP event-driven
+	*
+	* By default, whenever a neuron of a group with STDP fires, the LTP of all its plastic synapses is updated from the
+	* time of their last pre-synaptic spike, which costs time proportional to the number of synapses per post-synaptic
+	* spike. If enabled, the spike is only recorded in a short history of the neuron. Each synapse applies the LTP of
+	* the recorded spikes when it is next used: when the next pre-synaptic spike arrives, or when the weights are
+	* updated (see setWeightAndWeightChangeUpdate). All synapses of a neuron are updated at once only if its history is
+	* full.
+	*
+	* The pairing of pre- and post-synaptic spikes, and thus the results for all E-STDP and I-STDP curves, are the same
+	* as without event-driven STDP, up to rounding.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to use event-driven STDP (default: false)
+	* \since v4.0
+	*/
+	void setCPUEventDrivenSTDP(bool enable);
+
+	/*!
+	* \brief Sets whether the CPU runtimes skip the conductance decay of silent neurons
+	*
+	* By default, the conductances of every regular neuron are decayed every millisecond, even though most neurons of a
+	* sparse network do not receive any input for a long time. If enabled, the conductances of a neuron are set to zero
+	* as soon as all of them have decayed below snapThreshold. Such a silent neuron costs nothing in the conductance
+	* decay until it receives its next spike.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to skip the conductance decay of silent neurons (default: false)
+	* \param[in] snapThreshold the conductance below which the conductances of a neuron are set to zero
+	* \note Only applies to COBA mode. The simulation results differ from the default update by the conductances that are
+	* set to zero, which are bounded by snapThreshold.
+	* \since v4.0
+	*/
+	void setCPULazyConductanceDecay(bool enable, float snapThreshold = 1e-6f);
+
+	/*!
+	* \brief Sets whether the CPU runtimes store the neurons of a group in a locality-improving order
+	*
+	* By default, the neurons of a group are stored in the order of their Grid3D coordinates (x first, then y, then z),
+	* so that the targets of a Gaussian or random connection between two 2D or 3D grids scatter across the whole state
+	* arrays of the group. If enabled, the CPU runtimes store the neurons of every regular group whose grid extends in
+	* at least two dimensions in the order of a Hilbert curve through the grid, which keeps neighboring neurons close
+	* in memory and makes the spike delivery more cache-friendly. The public (group-relative) neuron ids, and thus all
+	* monitors and the get/set functions, are not affected by the reordering.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] enable whether to reorder the neurons of the CPU runtimes (default: false)
+	* \note Networks with multi-compartment neurons are not reordered. Since spikes are delivered in a different order,
+	* the simulation results may differ from those without reordering by rounding.
+	* \since v4.0
+	*/
+	void setCPUNeuronReordering(bool enable);
+
+	/*!
+	* \brief Sets the spike delivery engine of the CPU runtimes
+	*
+	* By default, the CPU runtimes deliver every spike through the post-synaptic list of the firing neuron, which
+	* scatters the synaptic input across the state arrays of the post-synaptic neurons (SPIKE_DELIVERY_PUSH). With
+	* SPIKE_DELIVERY_PULL, every post-synaptic neuron instead walks its pre-synaptic list each millisecond and collects
+	* the spikes that arrive through its synapses from a bitmap of the recent spikes. This costs a fixed amount of work
+	* per synapse, but reads the synapses sequentially and writes each neuron only once, which pays off for dense
+	* networks with high firing rates. With SPIKE_DELIVERY_AUTO, each CPU runtime measures the fraction of its synapses
+	* that receive a spike per millisecond, and uses the pull engine during the next second if it exceeds
+	* CPU_PULL_DELIVERY_MIN_DENSITY.
+	*
+	* \STATE ::CONFIG_STATE
+	* \param[in] mode the spike delivery engine (default: SPIKE_DELIVERY_PUSH)
+	* \note The pull engine stores the pre-synaptic neuron id and the delay of each synapse (5 bytes per synapse). The
+	* synaptic input of a neuron is summed up in a different order, so the results may differ from the push engine by
+	* rounding.
+	* \since v4.0
+	*/
+	void setCPUSpikeDelivery(SpikeDeliveryMode mode);
+
 	/*!
 	 * \brief Sets Izhikevich params a, b, c, and d with as mean +- standard deviation
 	 *
@@ -797,6 +1034,13 @@ public:
 	 * default which causes the synaptic weight values to be output by default along with the rest of the
 	 * network information.
 	 *
+	 * The synapses are written as flat arrays in the order in which CARLsim lays them out, so that
+	 * CARLsim::loadSimulation restores them without generating the connections again. The runtime state of the
+	 * CPU partitions is stored as well: the state of the neurons (membrane potential, recovery variable, current,
+	 * conductances, homeostatic firing rates), the STP variables, the STDP traces and weight changes, the spikes in
+	 * transit, and the simulation time. Spike generators, external currents, and the random number generator of
+	 * Poisson groups are not part of the state.
+	 *
 	 * \STATE ::SETUP_STATE, ::RUN_STATE
 	 * \param[in] fileName          string of filename of saved simulation data.
 	 * \param[in] saveSynapseInfo   boolean value that determines if the weight values are written to
@@ -876,13 +1120,17 @@ public:
 	 *
 	 * Past CARLsim networks can be loaded from file by setting up the same number of groups, connections, and neurons
 	 * as was used to store the network via CARLsim::saveSimulation, and then calling CARLsim::loadSimulation to
-	 * overwrite all corresponding synaptic weight and delay values from file.
+	 * overwrite all corresponding synaptic weight and delay values from file. The connections are not generated
+	 * again, so the loaded network does not depend on the random seed. The runtime state stored with the file is
+	 * restored as well, and the loaded simulation continues at the time at which it was saved, so that a network
+	 * without spike generators, Poisson groups, or GPU partitions continues bit-identically. External currents have
+	 * to be set again after CARLsim::setupNetwork.
 	 *
 	 * \STATE ::CONFIG_STATE
 	 * \param[in] fid       file pointer to a save file created with CARLsim::saveSimulation
 	 *
 	 *\note In order for CARLsim::loadSimulation to work, the configured network must have the identical number of
-	 * groups, connections, and neurons as the one stored with CARLsim::saveSimulation.
+	 * groups, connections, and neurons, partitioned the same way, as the one stored with CARLsim::saveSimulation.
 	 * \note In addition, CARLsim::saveSimulation must have been called with flag <tt>saveSynapseInfo</tt> set to
 	 * <tt>true</tt>.
 	 * \attention Wait with calling fclose on the file pointer until ::SETUP_STATE!
@@ -891,6 +1139,32 @@ public:
 	 */
 	void loadSimulation(FILE* fid);
 
+	/*!
+	 * \brief Caches the generated synapses of the network in a directory
+	 *
+	 * Generating the synapses of a large network can take much longer than the rest of CARLsim::setupNetwork. With a
+	 * network cache, setupNetwork hashes the configuration the synapses are generated from (groups, partitioning,
+	 * connections, and the random seed) and looks for a file named after the hash in the given directory. If the file
+	 * exists, the synapses are loaded from it as by CARLsim::loadSimulation. Otherwise, they are generated and stored
+	 * in a new file at the end of setupNetwork. Repeated runs of the same network, e.g., in a parameter sweep that
+	 * varies neuron or plasticity parameters, thus generate the synapses only once.
+	 *
+	 * \STATE ::CONFIG_STATE
+	 * \param[in] dirName     an existing directory in which the cache files are stored (empty: no cache)
+	 *
+	 * \note Networks with user-defined connections are only cached if each ConnectionGenerator declares an identity
+	 * (see ConnectionGenerator::getIdentity).
+	 * \note On CPU runtimes (except on Windows), the connectivity of a cached network, and its weights if it has no
+	 * plastic synapses, are mapped read-only from an image of the runtime in the cache directory instead of being
+	 * allocated. Simulations of the same network on one machine thus share the memory of these arrays. Weights changed
+	 * with CARLsim::setWeight, CARLsim::biasWeights, or CARLsim::scaleWeights are copied first.
+	 * \note The cache only contains the synapses as they were generated; neuron state is not cached. The network
+	 * cache is not used if a simulation is loaded with CARLsim::loadSimulation.
+	 * \see CARLsim::loadSimulation
+	 * \since v4.0
+	 */
+	void setNetworkCache(const std::string& dirName);
+
 	/*!
 	 * \brief reset Spike Counter to zero
 	 *
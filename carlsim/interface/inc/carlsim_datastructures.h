@@ -243,6 +243,40 @@ static const char* updateInterval_string[] = {
 	"10 ms interval", "100 ms interval", "1000 ms interval"
 };
 
+/*!
+ * \brief Storage format of synaptic weights
+ *
+ * The compact synapse storage of the CPU runtimes (CARLsim::setCPUCompactSynapses) can store the weights of fixed
+ * synapses with reduced precision.
+ * SYN_WEIGHT_FLOAT: 32-bit floating point, the weights are exact
+ * SYN_WEIGHT_HALF: 16-bit floating point (IEEE 754 half precision), with a relative error of at most 2^-11
+ * SYN_WEIGHT_INT8: 8-bit integer in multiples of maxWt/127 of the connection, with an error of at most maxWt/254
+ */
+enum SynWeightFormat {
+	SYN_WEIGHT_FLOAT,	//!< 32-bit floating point
+	SYN_WEIGHT_HALF,	//!< 16-bit floating point
+	SYN_WEIGHT_INT8		//!< 8-bit integer with a scale per connection
+};
+static const char* synWeightFormat_string[] = {
+	"32-bit float", "16-bit float", "8-bit integer"
+};
+
+/*!
+ * \brief Spike delivery engine of the CPU runtimes
+ *
+ * SPIKE_DELIVERY_PUSH: every spike is delivered to the post-synaptic neurons of the firing neuron (scatter)
+ * SPIKE_DELIVERY_PULL: every post-synaptic neuron collects the recent spikes of its pre-synaptic neurons (gather)
+ * SPIKE_DELIVERY_AUTO: each CPU runtime chooses the engine once per second from the measured synaptic activity
+ */
+enum SpikeDeliveryMode {
+	SPIKE_DELIVERY_PUSH,	//!< scatter the spikes through the post-synaptic lists
+	SPIKE_DELIVERY_PULL,	//!< gather the spikes through the pre-synaptic lists
+	SPIKE_DELIVERY_AUTO		//!< choose push or pull from the measured synaptic activity
+};
+static const char* spikeDeliveryMode_string[] = {
+	"push", "pull", "auto"
+};
+
 /*!
  * \brief CARLsim states
  *
@@ -75,3 +75,7 @@ void ConnectionGeneratorCore::connect(SNN* s, int srcGrpId, int i, int destGrpId
 	if (cGen != NULL)
 		cGen->connect(carlsim, srcGrpId, i, destGrpId, j, weight, maxWt, delay, connected);
 }
+
+std::string ConnectionGeneratorCore::getIdentity() {
+	return (cGen != NULL) ? cGen->getIdentity() : "";
+}
@@ -514,6 +514,109 @@ public:
 		//std::cout << "numStepsPerMs is (in interface): " + numStepsPerMs << std::endl;
 	}
 
+	// set whether a single CPU runtime is executed inline
+	void setCPURunInline(bool runInline) {
+		std::string funcName = "setCPURunInline()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPURunInline(runInline);
+	}
+
+	void setCPUThreadsPerRuntime(int numThreads) {
+		std::string funcName = "setCPUThreadsPerRuntime()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		std::stringstream range;	range << "[1," << MAX_CPU_THREADS_PER_RUNTIME << "]";
+		UserErrors::assertTrue(numThreads >= 1 && numThreads <= MAX_CPU_THREADS_PER_RUNTIME, UserErrors::MUST_BE_IN_RANGE,
+			funcName, "numThreads", range.str());
+
+		snn_->setCPUThreadsPerRuntime(numThreads);
+	}
+
+	void setCPUParallelSpikeDelivery(bool enable) {
+		std::string funcName = "setCPUParallelSpikeDelivery()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUParallelSpikeDelivery(enable);
+	}
+
+	void setCPUFusedNeuronUpdate(bool enable) {
+		std::string funcName = "setCPUFusedNeuronUpdate()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUFusedNeuronUpdate(enable);
+	}
+
+	void setCPUVectorizedNeuronUpdate(bool enable) {
+		std::string funcName = "setCPUVectorizedNeuronUpdate()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUVectorizedNeuronUpdate(enable);
+	}
+
+	void setCPUAutoPartition(int numPartitions) {
+		std::string funcName = "setCPUAutoPartition()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(numPartitions >= 1 && numPartitions <= MAX_NET_PER_SNN - CPU_RUNTIME_BASE,
+			UserErrors::MUST_BE_IN_RANGE, funcName, "numPartitions", "[1, number of CPU runtimes]");
+
+		snn_->setCPUAutoPartition(numPartitions);
+	}
+
+	void setCPULookahead(bool enable) {
+		std::string funcName = "setCPULookahead()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPULookahead(enable);
+	}
+
+	void setCPUCompactSynapses(bool enable, SynWeightFormat weightFormat) {
+		std::string funcName = "setCPUCompactSynapses()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUCompactSynapses(enable, weightFormat);
+	}
+
+	void setCPUEventDrivenSTDP(bool enable) {
+		std::string funcName = "setCPUEventDrivenSTDP()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUEventDrivenSTDP(enable);
+	}
+
+	void setCPULazyConductanceDecay(bool enable, float snapThreshold) {
+		std::string funcName = "setCPULazyConductanceDecay()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+		UserErrors::assertTrue(snapThreshold >= 0.0f, UserErrors::CANNOT_BE_NEGATIVE, funcName, "snapThreshold");
+
+		snn_->setCPULazyConductanceDecay(enable, snapThreshold);
+	}
+
+	void setCPUNeuronReordering(bool enable) {
+		std::string funcName = "setCPUNeuronReordering()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUNeuronReordering(enable);
+	}
+
+	void setCPUSpikeDelivery(SpikeDeliveryMode mode) {
+		std::string funcName = "setCPUSpikeDelivery()";
+		UserErrors::assertTrue(carlsimState_ == CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName, funcName,
+			"CONFIG.");
+
+		snn_->setCPUSpikeDelivery(mode);
+	}
+
 	// set neuron parameters for Izhikevich neuron, with standard deviations
 	void setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 		float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -898,6 +1001,15 @@ public:
 		snn_->loadSimulation(fid);
 	}
 
+	// caches the generated synapses of the network in a directory
+	void setNetworkCache(const std::string& dirName) {
+		std::string funcName = "setNetworkCache()";
+		UserErrors::assertTrue(carlsimState_==CONFIG_STATE, UserErrors::CAN_ONLY_BE_CALLED_IN_STATE, funcName,
+			funcName, "CONFIG.");
+
+		snn_->setNetworkCache(dirName);
+	}
+
 	// scales the weight of every synapse in the connection with a scaling factor
 	void scaleWeights(short int connId, float scale, bool updateWeightRange) {
 		std::stringstream funcName;	funcName << "scaleWeights(" << connId << "," << scale << "," << updateWeightRange
@@ -1702,6 +1814,66 @@ void CARLsim::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs
 	_impl->setIntegrationMethod(method, numStepsPerMs);
 }
 
+void CARLsim::setCPURunInline(bool runInline)
+{
+	_impl->setCPURunInline(runInline);
+}
+
+void CARLsim::setCPUThreadsPerRuntime(int numThreads)
+{
+	_impl->setCPUThreadsPerRuntime(numThreads);
+}
+
+void CARLsim::setCPUParallelSpikeDelivery(bool enable)
+{
+	_impl->setCPUParallelSpikeDelivery(enable);
+}
+
+void CARLsim::setCPUFusedNeuronUpdate(bool enable)
+{
+	_impl->setCPUFusedNeuronUpdate(enable);
+}
+
+void CARLsim::setCPUVectorizedNeuronUpdate(bool enable)
+{
+	_impl->setCPUVectorizedNeuronUpdate(enable);
+}
+
+void CARLsim::setCPUAutoPartition(int numPartitions)
+{
+	_impl->setCPUAutoPartition(numPartitions);
+}
+
+void CARLsim::setCPULookahead(bool enable)
+{
+	_impl->setCPULookahead(enable);
+}
+
+void CARLsim::setCPUCompactSynapses(bool enable, SynWeightFormat weightFormat)
+{
+	_impl->setCPUCompactSynapses(enable, weightFormat);
+}
+
+void CARLsim::setCPUEventDrivenSTDP(bool enable)
+{
+	_impl->setCPUEventDrivenSTDP(enable);
+}
+
+void CARLsim::setCPULazyConductanceDecay(bool enable, float snapThreshold)
+{
+	_impl->setCPULazyConductanceDecay(enable, snapThreshold);
+}
+
+void CARLsim::setCPUNeuronReordering(bool enable)
+{
+	_impl->setCPUNeuronReordering(enable);
+}
+
+void CARLsim::setCPUSpikeDelivery(SpikeDeliveryMode mode)
+{
+	_impl->setCPUSpikeDelivery(mode);
+}
+
 // set neuron params
 void CARLsim::setNeuronParameters(int grpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd, float izh_c, 
 	float izh_c_sd, float izh_d, float izh_d_sd)
@@ -1826,6 +1998,9 @@ void CARLsim::biasWeights(short int connId, float bias, bool updateWeightRange)
 // Loads a simulation (and network state) from file. The file pointer fid must point to a
 void CARLsim::loadSimulation(FILE* fid) { _impl->loadSimulation(fid); }
 
+// Caches the generated synapses of the network in a directory
+void CARLsim::setNetworkCache(const std::string& dirName) { _impl->setNetworkCache(dirName); }
+
 // Multiplies the weight of every synapse in the connection with a scaling factor
 void CARLsim::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 	_impl->scaleWeights(connId, scale, updateWeightRange);
@@ -0,0 +1,125 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _CPU_WORKER_POOL_H_
+#define _CPU_WORKER_POOL_H_
+
+
+// forward declaration of the per-task argument struct (see snn_datastructures.h)
+typedef struct ThreadStruct_s ThreadStruct;
+
+
+/*!
+ * \brief Persistent pool of worker threads for the CPU runtimes
+ *
+ * Each phase of SNN::advSimStep() runs one task per CPU runtime (local network). Instead of creating, pinning, and
+ * joining a fresh pthread for every task in every simulated millisecond, a CpuWorkerPool spawns its workers once
+ * during SNN::setupNetwork and pins worker i to core (i % NUM_CPU_CORES). A phase hands its tasks to the pool with
+ * CpuWorkerPool::run, which returns only after all tasks are done, and thus acts as a barrier between phases.
+ *
+ * Task i is always executed by worker (i % numWorkers), so that a CPU runtime stays on the same core for the whole
+ * simulation. A pool with zero workers executes all tasks inline on the calling thread (this is always the case on
+ * Windows).
+ *
+ * \since v4.0
+ */
+class CpuWorkerPool {
+public:
+	//! signature of a task routine, identical to the start routine expected by pthread_create
+	typedef void* (*TaskRoutine)(void*);
+
+	/*!
+	 * \brief CpuWorkerPool Constructor
+	 *
+	 * Spawns and pins the worker threads, which then sleep until tasks are dispatched to them.
+	 * \param[in] numWorkers number of worker threads to spawn. If 0, all tasks are executed inline.
+	 */
+	CpuWorkerPool(int numWorkers);
+
+	/*!
+	 * \brief CpuWorkerPool Destructor
+	 *
+	 * The destructor wakes up all workers, tells them to exit, and joins them.
+	 */
+	~CpuWorkerPool();
+
+	//! returns the number of worker threads (0 if tasks are executed inline)
+	int getNumWorkers();
+
+	/*!
+	 * \brief Runs a batch of tasks and waits for their completion
+	 *
+	 * Calls routine(&args[i]) for all i in [0, numTasks). Task i is executed by worker (i % numWorkers), or inline
+	 * if the pool has no workers. The method returns after all tasks have been completed.
+	 * \param[in] routine task routine (e.g., SNN::helperFindFiring_CPU)
+	 * \param[in] args array of numTasks task arguments
+	 * \param[in] numTasks number of tasks in the batch
+	 */
+	void run(TaskRoutine routine, ThreadStruct* args, int numTasks);
+
+	/*!
+	 * \brief Runs a single task on a specific worker and waits for its completion
+	 *
+	 * Calls routine(arg) on worker (workerId % numWorkers), or inline if the pool has no workers. This is used to
+	 * allocate the memory of a CPU runtime on the worker that will later execute it, so that the pages are first
+	 * touched (and thus placed by the OS) on the NUMA node of that worker's core.
+	 * \param[in] workerId id of the worker that should execute the task
+	 * \param[in] routine task routine (e.g., SNN::helperAllocateSNN_CPU)
+	 * \param[in] arg task argument
+	 */
+	void runOnWorker(int workerId, TaskRoutine routine, ThreadStruct* arg);
+
+private:
+	// This class provides a pImpl, which keeps pthread types out of the public header.
+	// \see https://marcmutz.wordpress.com/translated-articles/pimp-my-pimpl/
+	class Impl;
+	Impl* _impl;
+};
+
+
+#endif
@@ -0,0 +1,131 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+#ifndef _IZHIKEVICH_SIMD_H_
+#define _IZHIKEVICH_SIMD_H_
+
+#include <carlsim_datastructures.h> // integrationMethod_t
+
+
+/*!
+ * \brief Instruction sets of the vectorized neuron update of the CPU runtimes
+ */
+enum SimdInstructionSet {
+	SIMD_SCALAR, //!< portable scalar code, one neuron at a time
+	SIMD_AVX2,   //!< x86 AVX2, 8 neurons at a time
+	SIMD_AVX512  //!< x86 AVX-512F, 16 neurons at a time
+};
+
+/*!
+ * \brief A contiguous range of regular neurons of a group, whose membrane potentials are integrated over one or more
+ * integration steps by integrateIzhikevich()
+ *
+ * All arrays point to the state of the first neuron of the range, i.e., they are the structure-of-arrays of RuntimeData
+ * offset by the first local neuron id. The model (4- or 9-parameter Izhikevich), the integration method, and the
+ * synapse model are the same for all neurons of a group, so that the kernels do not branch per neuron.
+ */
+typedef struct IzhikevichRange_s {
+	int numN;       //!< number of neurons in the range
+	int numSteps;   //!< number of integration steps of timeStep ms
+
+	const float* voltage; //!< membrane potential before the first integration step
+	float* nextVoltage;   //!< membrane potential after the last integration step (may be the same as voltage)
+	float* recovery;      //!< recovery variable, updated in place
+	unsigned int* curSpikeBits; //!< bit-packed, the bits of the neurons that fired are set (never reset)
+	int curSpikeBitOffset;      //!< bit of the first neuron of the range in curSpikeBits
+	float* current;       //!< CUBA: synaptic input current, COBA: receives the synaptic current of the last step
+	const float* extCurrent;
+
+	const float* Izh_a;
+	const float* Izh_b;
+	const float* Izh_c;
+	const float* Izh_d;
+	const float* Izh_C;     //!< 9-parameter model only
+	const float* Izh_k;     //!< 9-parameter model only
+	const float* Izh_vr;    //!< 9-parameter model only
+	const float* Izh_vt;    //!< 9-parameter model only
+	const float* Izh_vpeak; //!< 9-parameter model only
+
+	const float* gAMPA;     //!< COBA only
+	const float* gNMDA;     //!< COBA without NMDA rise time only
+	const float* gNMDA_r;   //!< COBA with NMDA rise time only
+	const float* gNMDA_d;   //!< COBA with NMDA rise time only
+	const float* gGABAa;    //!< COBA only
+	const float* gGABAb;    //!< COBA without GABAb rise time only
+	const float* gGABAb_r;  //!< COBA with GABAb rise time only
+	const float* gGABAb_d;  //!< COBA with GABAb rise time only
+
+	bool withParamModel_9;
+	bool withConductances;
+	bool withNMDARise;
+	bool withGABAbRise;
+	integrationMethod_t integrationMethod;
+	float timeStep;
+} IzhikevichRange;
+
+//! returns the widest instruction set that is supported by the processor (and the operating system)
+SimdInstructionSet detectSimdInstructionSet();
+
+//! returns the name of an instruction set, e.g. for logging
+const char* getSimdInstructionSetName(SimdInstructionSet isa);
+
+/*!
+ * \brief Integrates the Izhikevich neurons of a range with the given instruction set
+ *
+ * The kernels perform the same floating-point operations in the same order as SNN::integrateNeuron_CPU (without
+ * contracting them into fused multiply-adds), so that the results are bit-exact with the scalar update. The neurons
+ * that do not fill a whole vector are integrated by the scalar kernel.
+ */
+void integrateIzhikevich(const IzhikevichRange& range, SimdInstructionSet isa);
+
+// the kernels of each instruction set, isa must be supported by the processor
+void integrateIzhikevichScalar(const IzhikevichRange& range);
+void integrateIzhikevichAVX2(const IzhikevichRange& range);
+void integrateIzhikevichAVX512(const IzhikevichRange& range);
+
+#endif
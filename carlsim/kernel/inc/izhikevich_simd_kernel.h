@@ -0,0 +1,288 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+
+// Generic Izhikevich integration kernel of the vectorized neuron update (see izhikevich_simd.h). The kernel is written
+// once against a small set of vector operations (Ops) and instantiated for each instruction set by
+// izhikevich_simd*.cpp, each of which is compiled for its own target. Everything is in an unnamed namespace, so that
+// the instantiations of different targets are never merged by the linker.
+//
+// Only to be included by izhikevich_simd*.cpp.
+
+#ifndef _IZHIKEVICH_SIMD_KERNEL_H_
+#define _IZHIKEVICH_SIMD_KERNEL_H_
+
+#include <izhikevich_simd.h>
+
+namespace {
+
+// vector operations of the scalar kernel, one neuron at a time
+struct ScalarOps {
+	typedef float V;
+	typedef bool M;
+	static const int width = 1;
+
+	static V load(const float* p) { return *p; }
+	static void store(float* p, V x) { *p = x; }
+	static V set1(float x) { return x; }
+	static V add(V x, V y) { return x + y; }
+	static V sub(V x, V y) { return x - y; }
+	static V mul(V x, V y) { return x * y; }
+	static V div(V x, V y) { return x / y; }
+	static M greater(V x, V y) { return x > y; }
+	static V select(M m, V x, V y) { return m ? x : y; }
+	static M maskOr(M m1, M m2) { return m1 || m2; }
+	static M maskNone() { return false; }
+	static int maskBits(M m) { return m ? 1 : 0; }
+};
+
+// single integration step for voltage equation of 4-param Izhikevich, see dvdtIzhikevich4
+template<class Ops>
+inline typename Ops::V dvdtIzhikevich4(typename Ops::V volt, typename Ops::V recov, typename Ops::V totalCurrent,
+	typename Ops::V timeStep)
+{
+	return Ops::mul(Ops::add(Ops::sub(Ops::add(Ops::mul(Ops::add(Ops::mul(Ops::set1(0.04f), volt), Ops::set1(5.0f)), volt),
+		Ops::set1(140.0f)), recov), totalCurrent), timeStep);
+}
+
+// single integration step for recovery equation of 4-param Izhikevich, see dudtIzhikevich4
+template<class Ops>
+inline typename Ops::V dudtIzhikevich4(typename Ops::V volt, typename Ops::V recov, typename Ops::V izhA,
+	typename Ops::V izhB, typename Ops::V timeStep)
+{
+	return Ops::mul(Ops::mul(izhA, Ops::sub(Ops::mul(izhB, volt), recov)), timeStep);
+}
+
+// single integration step for voltage equation of 9-param Izhikevich, see dvdtIzhikevich9
+template<class Ops>
+inline typename Ops::V dvdtIzhikevich9(typename Ops::V volt, typename Ops::V recov, typename Ops::V invCapac,
+	typename Ops::V izhK, typename Ops::V voltRest, typename Ops::V voltInst, typename Ops::V totalCurrent,
+	typename Ops::V timeStep)
+{
+	return Ops::mul(Ops::mul(Ops::add(Ops::sub(Ops::mul(Ops::mul(izhK, Ops::sub(volt, voltRest)), Ops::sub(volt, voltInst)),
+		recov), totalCurrent), invCapac), timeStep);
+}
+
+// single integration step for recovery equation of 9-param Izhikevich, see dudtIzhikevich9
+template<class Ops>
+inline typename Ops::V dudtIzhikevich9(typename Ops::V volt, typename Ops::V recov, typename Ops::V voltRest,
+	typename Ops::V izhA, typename Ops::V izhB, typename Ops::V timeStep)
+{
+	return Ops::mul(Ops::mul(izhA, Ops::sub(Ops::mul(izhB, Ops::sub(volt, voltRest)), recov)), timeStep);
+}
+
+template<class Ops, bool withParamModel_9>
+inline typename Ops::V dvdt(const typename Ops::V& v, const typename Ops::V& u, const typename Ops::V& totalCurrent,
+	const typename Ops::V& invC, const typename Ops::V& k, const typename Ops::V& vr, const typename Ops::V& vt,
+	const typename Ops::V& timeStep)
+{
+	if (withParamModel_9)
+		return dvdtIzhikevich9<Ops>(v, u, invC, k, vr, vt, totalCurrent, timeStep);
+	else
+		return dvdtIzhikevich4<Ops>(v, u, totalCurrent, timeStep);
+}
+
+template<class Ops, bool withParamModel_9>
+inline typename Ops::V dudt(const typename Ops::V& v, const typename Ops::V& u, const typename Ops::V& a,
+	const typename Ops::V& b, const typename Ops::V& vr, const typename Ops::V& timeStep)
+{
+	if (withParamModel_9)
+		return dudtIzhikevich9<Ops>(v, u, vr, a, b, timeStep);
+	else
+		return dudtIzhikevich4<Ops>(v, u, a, b, timeStep);
+}
+
+// integrates the neurons [i, i + Ops::width) of a range, mirrors SNN::integrateNeuron_CPU
+template<class Ops, bool withParamModel_9, bool withRungeKutta4, bool withConductances>
+inline void integrateIzhikevichLanes(const IzhikevichRange& r, int i) {
+	typedef typename Ops::V V;
+	typedef typename Ops::M M;
+
+	const V zero = Ops::set1(0.0f);
+	const V two = Ops::set1(2.0f);
+	const V sixth = Ops::set1(1.0f / 6.0f);
+	const V vMin = Ops::set1(-90.0f);
+	const V timeStep = Ops::set1(r.timeStep);
+
+	V v = Ops::load(r.voltage + i);
+	V u = Ops::load(r.recovery + i);
+	V a = Ops::load(r.Izh_a + i);
+	V b = Ops::load(r.Izh_b + i);
+	V c = Ops::load(r.Izh_c + i);
+	V d = Ops::load(r.Izh_d + i);
+	V invC = zero, k = zero, vr = zero, vt = zero, vpeak = Ops::set1(30.0f);
+	if (withParamModel_9) {
+		invC = Ops::div(Ops::set1(1.0f), Ops::load(r.Izh_C + i));
+		k = Ops::load(r.Izh_k + i);
+		vr = Ops::load(r.Izh_vr + i);
+		vt = Ops::load(r.Izh_vt + i);
+		vpeak = Ops::load(r.Izh_vpeak + i);
+	}
+
+	// the conductances (COBA) or the synaptic current (CUBA) do not change during the integration steps
+	V extCurrent = Ops::load(r.extCurrent + i);
+	V current = zero, gAMPA = zero, gNMDA = zero, gGABAa = zero, gGABAb = zero;
+	if (withConductances) {
+		gAMPA = Ops::load(r.gAMPA + i);
+		gNMDA = r.withNMDARise ? Ops::sub(Ops::load(r.gNMDA_d + i), Ops::load(r.gNMDA_r + i)) : Ops::load(r.gNMDA + i);
+		gGABAa = Ops::load(r.gGABAa + i);
+		gGABAb = r.withGABAbRise ? Ops::sub(Ops::load(r.gGABAb_d + i), Ops::load(r.gGABAb_r + i)) : Ops::load(r.gGABAb + i);
+	} else {
+		current = Ops::load(r.current + i);
+	}
+
+	V I_sum = zero;
+	M spiked = Ops::maskNone();
+	for (int step = 0; step < r.numSteps; step++) {
+		V totalCurrent = extCurrent;
+		if (withConductances) {
+			V vPlus80 = Ops::add(v, Ops::set1(80.0f));
+			V NMDAtmp = Ops::div(Ops::div(Ops::mul(vPlus80, vPlus80), Ops::set1(60.0f)), Ops::set1(60.0f));
+			V sum = Ops::mul(gAMPA, Ops::sub(v, zero));
+			sum = Ops::add(sum, Ops::mul(Ops::div(Ops::mul(gNMDA, NMDAtmp), Ops::add(Ops::set1(1.0f), NMDAtmp)), Ops::sub(v, zero)));
+			sum = Ops::add(sum, Ops::mul(gGABAa, Ops::add(v, Ops::set1(70.0f))));
+			sum = Ops::add(sum, Ops::mul(gGABAb, Ops::add(v, Ops::set1(90.0f))));
+			I_sum = Ops::mul(sum, Ops::set1(-1.0f)); // exact negation
+			totalCurrent = Ops::add(totalCurrent, I_sum);
+		} else {
+			totalCurrent = Ops::add(totalCurrent, current);
+		}
+
+		V vNext, du;
+		if (!withRungeKutta4) {
+			vNext = Ops::add(v, dvdt<Ops, withParamModel_9>(v, u, totalCurrent, invC, k, vr, vt, timeStep));
+		} else {
+			V k1 = dvdt<Ops, withParamModel_9>(v, u, totalCurrent, invC, k, vr, vt, timeStep);
+			V l1 = dudt<Ops, withParamModel_9>(v, u, a, b, vr, timeStep);
+
+			V v2 = Ops::add(v, Ops::div(k1, two));
+			V u2 = Ops::add(u, Ops::div(l1, two));
+			V k2 = dvdt<Ops, withParamModel_9>(v2, u2, totalCurrent, invC, k, vr, vt, timeStep);
+			V l2 = dudt<Ops, withParamModel_9>(v2, u2, a, b, vr, timeStep);
+
+			V v3 = Ops::add(v, Ops::div(k2, two));
+			V u3 = Ops::add(u, Ops::div(l2, two));
+			V k3 = dvdt<Ops, withParamModel_9>(v3, u3, totalCurrent, invC, k, vr, vt, timeStep);
+			V l3 = dudt<Ops, withParamModel_9>(v3, u3, a, b, vr, timeStep);
+
+			V v4 = Ops::add(v, k3);
+			V u4 = Ops::add(u, l3);
+			V k4 = dvdt<Ops, withParamModel_9>(v4, u4, totalCurrent, invC, k, vr, vt, timeStep);
+			V l4 = dudt<Ops, withParamModel_9>(v4, u4, a, b, vr, timeStep);
+
+			vNext = Ops::add(v, Ops::mul(sixth, Ops::add(Ops::add(Ops::add(k1, Ops::mul(two, k2)), Ops::mul(two, k3)), k4)));
+			du = Ops::mul(sixth, Ops::add(Ops::add(Ops::add(l1, Ops::mul(two, l2)), Ops::mul(two, l3)), l4));
+		}
+
+		// masked spike reset
+		M spike = Ops::greater(vNext, vpeak);
+		vNext = Ops::select(spike, c, vNext);
+		u = Ops::select(spike, Ops::add(u, d), u);
+		spiked = Ops::maskOr(spiked, spike);
+
+		vNext = Ops::select(Ops::greater(vMin, vNext), vMin, vNext);
+
+		if (!withRungeKutta4)
+			du = dudt<Ops, withParamModel_9>(vNext, u, a, b, vr, timeStep);
+		u = Ops::add(u, du);
+
+		v = vNext;
+	}
+
+	Ops::store(r.nextVoltage + i, v);
+	Ops::store(r.recovery + i, u);
+	if (withConductances)
+		Ops::store(r.current + i, I_sum);
+
+	// a vector has at most 16 lanes, its bits span at most two words of the bitset
+	unsigned int bits = Ops::maskBits(spiked);
+	if (bits != 0) {
+		int bitPos = r.curSpikeBitOffset + i;
+		unsigned long long mask = (unsigned long long)bits << (bitPos % 32);
+		r.curSpikeBits[bitPos / 32] |= (unsigned int)mask;
+		if (mask >> 32)
+			r.curSpikeBits[bitPos / 32 + 1] |= (unsigned int)(mask >> 32);
+	}
+}
+
+template<class Ops, bool withParamModel_9, bool withRungeKutta4, bool withConductances>
+inline int integrateIzhikevichLoop(const IzhikevichRange& r, int startIdx) {
+	int i = startIdx;
+	for (; i + Ops::width <= r.numN; i += Ops::width)
+		integrateIzhikevichLanes<Ops, withParamModel_9, withRungeKutta4, withConductances>(r, i);
+	return i;
+}
+
+template<class Ops, bool withParamModel_9, bool withRungeKutta4>
+inline int selectSynapseModel(const IzhikevichRange& r, int startIdx) {
+	if (r.withConductances)
+		return integrateIzhikevichLoop<Ops, withParamModel_9, withRungeKutta4, true>(r, startIdx);
+	else
+		return integrateIzhikevichLoop<Ops, withParamModel_9, withRungeKutta4, false>(r, startIdx);
+}
+
+template<class Ops, bool withParamModel_9>
+inline int selectIntegrationMethod(const IzhikevichRange& r, int startIdx) {
+	if (r.integrationMethod == RUNGE_KUTTA4)
+		return selectSynapseModel<Ops, withParamModel_9, true>(r, startIdx);
+	else
+		return selectSynapseModel<Ops, withParamModel_9, false>(r, startIdx);
+}
+
+// integrates the neurons [startIdx, startIdx + n * Ops::width) of a range and returns the first neuron that does not
+// fill a whole vector. The per-group branches are resolved here instead of per neuron.
+template<class Ops>
+inline int integrateIzhikevichVectors(const IzhikevichRange& r, int startIdx) {
+	if (r.withParamModel_9)
+		return selectIntegrationMethod<Ops, true>(r, startIdx);
+	else
+		return selectIntegrationMethod<Ops, false>(r, startIdx);
+}
+
+} // namespace
+
+#endif
@@ -88,6 +88,7 @@
 
 #include <snn_definitions.h>
 #include <snn_datastructures.h>
+#include <izhikevich_simd.h>
 
 // #include <spike_buffer.h>
 #include <poisson_rate.h>
@@ -98,6 +99,7 @@ class ConnectionMonitorCore;
 class ConnectionMonitor;
 
 class SpikeBuffer;
+class CpuWorkerPool;
 
 
 /// **************************************************************************************************************** ///
@@ -232,6 +234,42 @@ public:
 	//! Sets the integration method and the number of integration steps per 1ms simulation time step
 	void setIntegrationMethod(integrationMethod_t method, int numStepsPerMs);
 
+	//! Sets whether a single CPU runtime is executed inline on the calling thread instead of a pinned worker thread
+	void setCPURunInline(bool runInline);
+
+	//! Sets the number of threads that share the neurons of each CPU runtime
+	void setCPUThreadsPerRuntime(int numThreads);
+
+	//! Sets whether the spike delivery of each CPU runtime is split among its threads by post-synaptic neuron range
+	void setCPUParallelSpikeDelivery(bool enable);
+
+	//! Sets whether the CPU runtimes integrate and commit the state of each neuron in a single fused pass
+	void setCPUFusedNeuronUpdate(bool enable);
+
+	//! Sets whether the CPU runtimes integrate the neurons of a group with SIMD instructions (AVX2 / AVX-512)
+	void setCPUVectorizedNeuronUpdate(bool enable);
+
+	//! Sets the number of CPU runtimes among which groups with preferredNetId ANY are distributed
+	void setCPUAutoPartition(int numPartitions);
+
+	//! Sets whether the CPU runtimes synchronize only once per lookahead window (minimum delay between runtimes)
+	void setCPULookahead(bool enable);
+
+	//! Sets whether the CPU runtimes store the synapses of a fixed network in a compact layout
+	void setCPUCompactSynapses(bool enable, SynWeightFormat weightFormat);
+
+	//! Sets whether the CPU runtimes apply LTP when a synapse is next used instead of at every post-synaptic spike
+	void setCPUEventDrivenSTDP(bool enable);
+
+	//! Sets whether the CPU runtimes set vanishing conductances to zero and stop decaying them until the next spike
+	void setCPULazyConductanceDecay(bool enable, float snapThreshold);
+
+	//! Sets whether the CPU runtimes store the neurons of 2D and 3D groups in the order of a Hilbert curve
+	void setCPUNeuronReordering(bool enable);
+
+	//! Sets whether the CPU runtimes push spikes to their targets, pull them from their sources, or choose at runtime
+	void setCPUSpikeDelivery(SpikeDeliveryMode mode);
+
 	//! Sets the Izhikevich parameters a, b, c, and d of a neuron group.
 	/*!
 	 * \brief Parameter values for each neuron are given by a normal distribution with mean _a, _b, _c, _d and standard deviation _a_sd, _b_sd, _c_sd, and _d_sd, respectively
@@ -376,14 +414,18 @@ public:
 	void exitSimulation(int val = 1);
 
 	//! reads the network state from file
-	//! Reads a CARLsim network file. Such a file can be created using SNN:writeNetwork.
+	//! Reads a CARLsim network file. Such a file can be created using SNN::saveSimulation.
 	/*
-	 * \brief After calling SNN::loadSimulation, you should run SNN::runNetwork before calling fclose(fp).
+	 * \brief The file is read by setupNetwork, which takes the synapses from the file instead of generating them.
+	 * Do not call fclose(fp) before setupNetwork.
 	 * \param fid: file pointer
 	 * \sa SNN::saveSimulation()
 	 */
 	void loadSimulation(FILE* fid);
 
+	//! Sets the directory in which setupNetwork caches the generated synapses of the network
+	void setNetworkCache(const std::string& dirName);
+
 	// multiplies every weight with a scaling factor
 	void scaleWeights(short int connId, float scale, bool updateWeightRange = false);
 
@@ -453,9 +495,13 @@ public:
 
 	//! stores the pre and post synaptic neuron ids with the weight and delay
 	/*
+	 * The synapse arrays of each local network are written as they are laid out at runtime (one block per array), so
+	 * that loadSimulation restores them without building them again. Unless saveNeuronInfo is false, the runtime state
+	 * of the CPU runtimes (neuron, STP, and STDP state, and the spikes in transit) and the simulation time are stored
+	 * as well, from which a loaded simulation continues bit by bit.
 	 * \param fid file pointer
 	 */
-	void saveSimulation(FILE* fid, bool saveSynapseInfo = false);
+	void saveSimulation(FILE* fid, bool saveSynapseInfo = false, bool saveNeuronInfo = true);
 
 	//! function writes population weights from gIDpre to gIDpost to file fname in binary.
 	//void writePopWeights(std::string fname, int gIDpre, int gIDpost);
@@ -575,6 +621,8 @@ public:
 	//! checks whether a point pre lies in the receptive field for point post
 	double getRFDist3D(const RadiusRF& radius, const Point3D& pre, const Point3D& post);
 	bool isPoint3DinRF(const RadiusRF& radius, const Point3D& pre, const Point3D& post);
+	//! collects the neurons of group gGrpId (relative ids, increasing) whose locations lie in the receptive field of pre
+	void findNeuronsInRF3D(int gGrpId, const RadiusRF& radius, const Point3D& pre, std::vector<int>& relNIds);
 
 	bool isSimulationWithCompartments() { return sim_with_compartments; }
 	bool isSimulationWithCOBA() { return sim_with_conductances; }
@@ -597,6 +645,10 @@ private:
 
 	//! advance time step in a simulation
 	void advSimStep();
+	//! advance numSteps time steps in lookahead mode, where the CPU runtimes only synchronize once
+	void advSimStepsLookahead(int numSteps);
+	//! sets the clocks of the CPU runtimes to the clock of the manager
+	void syncCPURuntimeClocks();
 
 	//! allocates and initializes all core datastructures
 	void allocateManagerRuntimeData();
@@ -628,13 +680,17 @@ private:
 	 * \brief generate connections among groups according to connect configuration
 	 */
 	void connectNetwork();
-	inline void connectNeurons(int netId, int srcGrp, int destGrp, int srcN, int destN, short int connId, int externalNetId);
-	inline void connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId);
-	void connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectOneToOne(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectRandom(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
-	void connectUserDefined(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	void runConnectBlocks(CpuWorkerPool* pool, std::vector<ThreadStruct>& args);
+	void connectBlock(int blockId);
+	static void* helperConnectBlock(void*);
+	void addGroupSynapses(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal);
+	inline void connectNeurons(ConnectionBlock& block, int _nSrc, int _nDest);
+	inline void connectNeurons(ConnectionBlock& block, int _nSrc, int _nDest, float initWt, float maxWt, uint8_t delay);
+	void connectFull(ConnectionBlock& block);
+	void connectOneToOne(ConnectionBlock& block);
+	void connectRandom(ConnectionBlock& block);
+	void connectGaussian(ConnectionBlock& block);
+	void connectUserDefined(ConnectionBlock& block);
 
 	void deleteObjects();			//!< deallocates all used data structures in snn_cpu.cpp
 
@@ -647,6 +703,8 @@ private:
 		int& _numNPois, int& _numNExcPois, int& _numNInhPois);
 	void findNumNSpikeGenAndOffset(int _netId);
 
+	template<bool withConductances, bool withNMDARise, bool withGABAbRise, bool withSTP, bool withSTDP, bool withLazyDecay,
+		int weightFormat>
 	void generatePostSynapticSpike(int preNId, int postNId, int synId, int tD, int netId);
 	void fillSpikeGenBits(int netId);
 	void userDefinedSpikeGenerator(int gGrpId);
@@ -672,6 +730,10 @@ private:
 
 	void partitionSNN();
 
+	//! assigns the groups whose preferredNetId is ANY to CPU runtimes, balancing the estimated load and minimizing
+	//! the spike traffic between runtimes, returns the assigned netId of each group (ANY if not auto-partitioned)
+	std::vector<int> partitionGroupsCPU(int numPartitions);
+
 	void generateRuntimeSNN();
 
 	/*!
@@ -704,7 +766,20 @@ private:
 	void printStatusSpikeMonitor(int gGrpId = ALL);
 	void printSikeRoutingInfo();
 
-	int loadSimulation_internal(bool onlyPlastic);
+	void loadSimulation_internal(); //!< reads the configuration of the network from loadSimFID, instead of connectNetwork
+	bool saveSynapseArrays(FILE* fid, int netId);
+	bool loadSynapseArrays(FILE* fid, int netId); //!< reads the synapse arrays of a local network, instead of generateConnectionRuntime
+	bool saveRuntimeState(FILE* fid, int netId);
+	bool loadRuntimeState(FILE* fid, int netId);
+	bool saveSpikeTables(FILE* fid, int netId);
+	bool loadSpikeTables(FILE* fid, int netId);
+	int getRuntimeStateFlags(); //!< the optional parts of the runtime state, see saveRuntimeState
+
+	bool hashNetworkConfig(unsigned long long& hash); //!< hashes the configuration from which connectNetwork generates the synapses
+	void openNetworkCache();   //!< sets loadSimFID to the cache file of the network if it exists
+	void updateNetworkCache(); //!< writes the cache file of the network if it did not exist, or closes it
+	void saveNetworkCacheFile(const std::string& fileName, int netId); //!< writes the synapses (ALL) or a synapse image
+	std::string getSynapseImageFileName(int netId); //!< the cache file with the synapse image of a CPU runtime
 
 	void resetConductances(int netId);
 	void resetCurrent(int netId);
@@ -753,10 +828,16 @@ private:
 	void resetSpikeCnt(int gGrpId);
 	void shiftSpikeTables();
 	void spikeGeneratorUpdate();
+	void assignPoissonFiringRate();
 	void updateTimingTable();
 	void updateWeights();
 	void updateNetworkConfig(int netId);
 
+	//! dispatches a batch of CPU runtime tasks to the worker pool and waits for their completion
+	void runCPUTasks(void* (*routine)(void*), ThreadStruct* args, int numTasks);
+	//! splits the neurons of a CPU runtime into numThreads ranges and appends one task per range, returns the new number of tasks
+	int addNeuronRangeTasks(int netId, int numThreads, ThreadStruct* args, int numTasks);
+
 	// Abstract layer for trasferring data (local-to-global copy)
 	void fetchConductanceAMPA(int gGrpId);
 	void fetchConductanceNMDA(int gGrpId);
@@ -903,44 +984,53 @@ private:
 
 	//allocates runtime data on CPU memory
 	void allocateSNN_CPU(int netId); 
+	//! returns the id of the worker thread that executes the first neuron range of a CPU runtime
+	int getCPURuntimeWorkerId(int netId);
+	//! returns the NUMA node of the calling thread, or -1 if unknown
+	static int getCurrentNumaNode();
 
-	// runNetwork functions - multithreaded in POSIX using pthreads
-#if defined(WIN32) || defined(WIN64)
+	// runNetwork functions - multithreaded using the persistent CpuWorkerPool (one task per CPU runtime)
 	void assignPoissonFiringRate_CPU(int netId);
 	void clearExtFiringTable_CPU(int netId);
 	void convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
 	void convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
-	void doCurrentUpdateD2_CPU(int netId);
-	void doCurrentUpdateD1_CPU(int netId);
-	void doSTPUpdateAndDecayCond_CPU(int netId);
+	void doCurrentUpdateD2_CPU(int netId, int startIdx, int endIdx);
+	void doCurrentUpdateD1_CPU(int netId, int startIdx, int endIdx);
+	void deliverSpikeSlot_CPU(int netId, const int* firingTable, int kStart, int kEnd, int tD, int startIdx, int endIdx);
+	void prepareSpikeBits_CPU(int netId);
+	void pullCurrentUpdate_CPU(int netId, int startIdx, int endIdx);
+	void selectSpikeDelivery_CPU(int netId);
+	void doSTPUpdateAndDecayCond_CPU(int netId, int startIdx, int endIdx);
+	void decayConductanceRange_CPU(int netId, int startIdx, int endIdx);
 	void deleteRuntimeData_CPU(int netId);
-	void findFiring_CPU(int netId);
-	void globalStateUpdate_CPU(int netId);
+	void countFiring_CPU(int netId, int startIdx, int endIdx, int& numSpikesD1, int& numSpikesD2);
+	void assignFiringTableSlots_CPU(ThreadStruct* args, int numTasks);
+	void findFiring_CPU(int netId, int startIdx, int endIdx, int fireIdD1, int fireIdD2, int& numSpikesD1, int& numSpikesD2);
+	void receiveExtSpikes_CPU(int netId);
+	void runLookaheadWindow_CPU(int netId);
+	void finishLookaheadWindow_CPU(int netId);
+	void commitFiringTables_CPU(ThreadStruct* args, int numTasks);
+	void growFiringTables_CPU(int netId, unsigned int minSpikesD1, unsigned int minSpikesD2);
+	void computeNeuronOrder_CPU(int netId);
+	void allocatePullDelivery_CPU(int netId);
+	void getCachedSynapseArrays_CPU(int netId, std::vector<std::pair<void**, size_t> >& arrays, int* imageInfo = NULL);
+	bool saveSynapseImage_CPU(int netId, FILE* fid);
+	bool mapSynapseImage_CPU(int netId, const std::string& fileName);
+	void unmapSynapseImage_CPU(int netId);
+	bool isMappedArray_CPU(int netId, const void* array);
+	void globalStateUpdate_CPU(int netId, int startIdx, int endIdx);
+	void globalStateUpdateFused_CPU(int netId, int startIdx, int endIdx);
 	void resetSpikeCnt_CPU(int netId, int lGrpId); //!< Resets the spike count for a particular group.
 	void shiftSpikeTables_CPU(int netId);
 	void spikeGeneratorUpdate_CPU(int netId);
 	void updateTimingTable_CPU(int netId);
 	void updateWeights_CPU(int netId);
-#else // for POSIX systems - returns a void* to pthread_create - only differ in the return type compared to the counterparts above
-	void* assignPoissonFiringRate_CPU(int netId);
-	void* clearExtFiringTable_CPU(int netId);
-	void* convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
-	void* convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset);
-	void* doCurrentUpdateD2_CPU(int netId);
-	void* doCurrentUpdateD1_CPU(int netId);
-	void* doSTPUpdateAndDecayCond_CPU(int netId);
-	void* deleteRuntimeData_CPU(int netId);
-	void* findFiring_CPU(int netId);
-	void* globalStateUpdate_CPU(int netId);
-	void* resetSpikeCnt_CPU(int netId, int lGrpId); //!< Resets the spike count for a particular group.
-	void* shiftSpikeTables_CPU(int netId);
-	void* spikeGeneratorUpdate_CPU(int netId);
-	void* updateTimingTable_CPU(int netId);
-	void* updateWeights_CPU(int netId);
-
-	// static multithreading helper methods for the above CPU runNetwork() methods
+
+	// static multithreading helper methods for the above CPU runNetwork() methods, executed by CpuWorkerPool
+	static void* helperAllocateSNN_CPU(void*);
 	static void* helperAssignPoissonFiringRate_CPU(void*);
 	static void* helperClearExtFiringTable_CPU(void*);
+	static void* helperCountFiring_CPU(void*);
 	static void* helperConvertExtSpikesD2_CPU(void*);
 	static void* helperConvertExtSpikesD1_CPU(void*);
 	static void* helperDoCurrentUpdateD2_CPU(void*);
@@ -948,13 +1038,16 @@ private:
 	static void* helperDoSTPUpdateAndDecayCond_CPU(void*);
 	static void* helperDeleteRuntimeData_CPU(void*);
 	static void* helperFindFiring_CPU(void*);
+	static void* helperPrepareSpikeBits_CPU(void*);
 	static void* helperGlobalStateUpdate_CPU(void*);
+	static void* helperReceiveExtSpikes_CPU(void*);
+	static void* helperRunLookaheadWindow_CPU(void*);
+	static void* helperFinishLookaheadWindow_CPU(void*);
 	static void* helperResetSpikeCnt_CPU(void*);
 	static void* helperShiftSpikeTables_CPU(void*);
 	static void* helperSpikeGeneratorUpdate_CPU(void*);
 	static void* helperUpdateTimingTable_CPU(void*);
 	static void* helperUpdateWeights_CPU(void*);
-#endif
 
 	// CPU computing backend: data transfer function
 	void copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool allocateMem);
@@ -970,29 +1063,66 @@ private:
 	void copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocateMem);	
 	void copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem, int destOffset);	
 	void copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, bool allocateMem);	
+	void copySynapseWeights(int netId, RuntimeData* dest, RuntimeData* src, int posSyn, int lengthSyn);
+	void copyMaxSynapseWeights(int netId, int lNId);
+	void updateWeightScale_CPU(int netId, short int connId, float maxWt);
 	void copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem);	
 	void copyWeightState(int netId, int lGrpId);
 	void copyNetworkConfig(int netId);
 	void copyGrpIdsLookupArray(int netId);
 	void copyConnIdsLookupArray(int netId);
 	void copyLastSpikeTime(int netId);
+	void copyRuntimeStateToManager(int netId);
+	void copyPostSpikeHistory(int netId, int* history, unsigned short* historyLength, bool toRuntime);
+	void copySpikeBits(int netId, std::vector<int>& firedNIds, bool toRuntime);
 	void copyNetworkSpikeCount(int netId,
 	unsigned int* spikeCountD1, unsigned int* spikeCountD2,
 	unsigned int* spikeCountExtD1, unsigned int* spikeCountExtD2);
-	void copySpikeTables(int netId);
+	void copySpikeTables(int netId, bool toManager);
 	void copyTimeTable(int netId, bool toManager);
 	void copyExtFiringTable(int netId);
 	
 	// CPU backend: utility function
 	void firingUpdateSTP(int lNId, int lGrpId, int netId);
+	void updateDopamine(int preNId, int postNId, int netId);
+	void decayConductances(int lNId, int netId);
+	bool snapConductances(int lNId, int netId);
+	template<bool withParamModel_9, bool withRungeKutta4, bool withConductances, bool withNMDARise, bool withGABAbRise,
+		bool withCompartments>
+	float integrateNeuron_CPU(int netId, int lGrpId, int lNId, float v, float& u, float& I_sum);
+	template<bool withParamModel_9, bool withRungeKutta4, bool withConductances, bool withNMDARise, bool withGABAbRise,
+		bool withCompartments>
+	void integrateNeuronRangeScalar_CPU(int netId, int lGrpId, int lStartN, int lEndN, int numSteps, float* nextVoltage);
+	void integrateNeuronRange_CPU(int netId, int lGrpId, int lStartN, int lEndN, int numSteps, float* nextVoltage);
+	void updateNeuronCurrentAndHomeostasis(int lNId, int lGrpId, int netId, float I_sum);
+	void updateGroupDopamine(int lGrpId, int netId);
 	void updateLTP(int lNId, int lGrpId, int netId);
+	void updateLTPSynapse(int netId, int lGrpId, unsigned int pos_ij, int stdp_tDiff);
+	void recordPostSpikeLTP(int netId, int lNId, int lGrpId);
+	void settleLTP(int netId, int lNId, int lGrpId, unsigned int pos_ij);
+	void settleNeuronLTP(int netId, int lNId, int lGrpId);
 	void resetFiredNeuron(int lNId, short int lGrpId, int netId);
+	bool getNeuronSpike(int lNId, int lGrpId, int netId);
+	int findNextSpike_CPU(int netId, int lGrpId, int lNId, int lEndN);
 	bool getPoissonSpike(int lNId, int netId);
 	bool getSpikeGenBit(unsigned int nIdPos, int netId);
 
+	// CPU backend: kernels specialized at compile time for the features of a group, selected in setupNetwork()
+	//! integrates the regular neurons [lStartN, lEndN] of a group over numSteps integration steps
+	typedef void (SNN::*NeuronRangeKernel)(int netId, int lGrpId, int lStartN, int lEndN, int numSteps, float* nextVoltage);
+	//! delivers a spike of a pre-synaptic neuron to one of its synapses
+	typedef void (SNN::*PostSynapticSpikeKernel)(int preNId, int postNId, int synId, int tD, int netId);
+	void selectCPUKernels(int netId);
+	template<int flags> NeuronRangeKernel getNeuronRangeKernel(int selectedFlags);
+	template<int flags> PostSynapticSpikeKernel getPostSynapticSpikeKernel(int selectedFlags);
+
 	// +++++ PRIVATE PROPERTIES +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 	SNNState snnState; //!< state of the network
 	FILE* loadSimFID;
+	bool loadSimWithState_; //!< true if the file of loadSimulation holds the runtime state, see saveSimulation
+	std::string networkCacheDir_;  //!< directory of the network cache, empty if the network is not cached
+	std::string networkCacheFile_; //!< cache file of the network, empty if the network cannot be cached
+	FILE* networkCacheFID_;        //!< the cache file from which setupNetwork loads the synapses, NULL if not found
 
 	const std::string networkName_;	//!< network name
 	const LoggerMode loggerMode_;	//!< current logger mode (USER, DEVELOPER, SILENT, CUSTOM)
@@ -1002,6 +1132,33 @@ private:
 	int numGPUs;    //!< number of GPU(s) is used in the simulation
 	int numCores;   //!< number of CPU Core(s) is used in the simulation
 
+	CpuWorkerPool* cpuWorkerPool; //!< persistent worker threads executing the CPU runtimes, spawned in setupNetwork()
+	bool cpuRunInline_;           //!< if true, a single CPU runtime is executed inline on the calling thread
+	int numCPUThreadsPerRuntime_; //!< number of threads sharing the neurons of each CPU runtime
+	bool cpuParallelSpikeDelivery_; //!< if true, the threads of a CPU runtime deliver spikes to their own post-synaptic neurons
+	bool cpuFusedNeuronUpdate_;   //!< if true, globalStateUpdate_CPU also decays the conductances in a single pass per neuron
+	bool cpuVectorizedNeuronUpdate_; //!< if true, globalStateUpdate_CPU integrates the neurons of a group with SIMD kernels
+	SimdInstructionSet cpuSimdInstructionSet_; //!< instruction set of the SIMD kernels, detected in setupNetwork()
+	NeuronRangeKernel cpuNeuronKernels_[MAX_NET_PER_SNN][MAX_GRP_PER_SNN]; //!< neuron update kernel of each local group
+	PostSynapticSpikeKernel cpuSynapseKernels_[MAX_NET_PER_SNN][MAX_GRP_PER_SNN]; //!< spike delivery kernel of each pre-synaptic group
+	int numCPUAutoPartitions_;    //!< number of CPU runtimes for groups with preferredNetId ANY (1: all on CPU_RUNTIME_BASE)
+	int cpuRuntimeNumaNode[MAX_NET_PER_SNN]; //!< NUMA node on which the data of each CPU runtime was allocated (-1: unknown)
+	bool cpuLookahead_;           //!< if true, the CPU runtimes synchronize once per lookahead window (if supported)
+	int cpuLookaheadMs_;          //!< the lookahead (minimum delay between CPU runtimes) in ms, 0 if lookahead is not used
+	int cpuLookaheadWindowMs_;    //!< the number of time steps of the current lookahead window
+	bool cpuCompactSynapses_;     //!< if true, the CPU runtimes of a fixed network use the compact synapse storage
+	SynWeightFormat cpuSynWeightFormat_; //!< the weight format of the compact synapse storage
+	bool cpuEventDrivenSTDP_;     //!< if true, the CPU runtimes defer the LTP of a synapse until it is next used
+	bool cpuLazyConductanceDecay_; //!< if true, the CPU runtimes do not decay the conductances of silent neurons
+	float cpuCondSnapThreshold_;  //!< the conductance below which the lazy conductance decay sets a conductance to zero
+	bool cpuNeuronReordering_;    //!< if true, the CPU runtimes store the neurons of 2D and 3D groups in Hilbert order
+	SpikeDeliveryMode cpuSpikeDeliveryMode_; //!< the spike delivery engine of the CPU runtimes
+
+	//! the external spikes of each CPU runtime in the current lookahead window, step by step and group by group
+	std::vector<int> lookaheadSendSpikes[MAX_NET_PER_SNN];
+	//! the offset of each (step, local group) into lookaheadSendSpikes, plus the total number of spikes
+	std::vector<int> lookaheadSendOffsets[MAX_NET_PER_SNN];
+
 	int numAvailableGPUs; //!< number of available GPU(s) in the machine
 
 	bool simulatorDeleted;
@@ -1025,9 +1182,29 @@ private:
 	std::list<ConnectConfig> externalConnectLists[MAX_NET_PER_SNN];
 	std::list<compConnectConfig> localCompConnectLists[MAX_NET_PER_SNN];
 
-	std::list<ConnectionInfo> connectionLists[MAX_NET_PER_SNN];
+	std::vector<ConnectionInfo> connectionLists[MAX_NET_PER_SNN]; //!< synapses of each local network, until generateConnectionRuntime
+	std::vector<ConnectionBlock> connectionBlocks; //!< blocks of the connections that are being generated by connectNetwork
+	std::vector<Point3D> neuronLocations; //!< 3D coordinates of the neurons (global ids) while connectNetwork runs
 
 	std::list<RoutingTableEntry> spikeRoutingTable;
+	//! true for CPU runtimes that only receive spikes from other CPU runtimes, which they collect directly (see receiveExtSpikes_CPU)
+	bool cpuDirectSpikeExchange[MAX_NET_PER_SNN];
+	//! the maximum number of spikes a CPU runtime can add to its firing tables in one time step, the tables grow on demand
+	unsigned int maxSpikesPerStepD1[MAX_NET_PER_SNN];
+	unsigned int maxSpikesPerStepD2[MAX_NET_PER_SNN];
+	//! the largest number of entries ever used in the firing tables of a CPU runtime (high-water marks)
+	unsigned int firingTableHighWaterD1[MAX_NET_PER_SNN];
+	unsigned int firingTableHighWaterD2[MAX_NET_PER_SNN];
+	//! the storage position of each regular neuron of a CPU runtime with neuron reordering, indexed by the local neuron
+	//! id of the manager, and the inverse mapping. Both are empty if the neurons of the runtime are not reordered.
+	std::vector<int> cpuRuntimeNId[MAX_NET_PER_SNN];
+	std::vector<int> cpuManagerNId[MAX_NET_PER_SNN];
+	//! true for CPU runtimes that currently use the pull-based spike delivery (see setCPUSpikeDelivery)
+	bool cpuPullDelivery[MAX_NET_PER_SNN];
+	//! the read-only mapping of the synapse image of each CPU runtime from the network cache (see setNetworkCache), NULL
+	//! if its synapse arrays are allocated instead
+	char* cpuSynapseImage[MAX_NET_PER_SNN];
+	size_t cpuSynapseImageSize[MAX_NET_PER_SNN];
 
 	float 		*mulSynFast;	//!< scaling factor for fast synaptic currents, per connection
 	float 		*mulSynSlow;	//!< scaling factor for slow synaptic currents, per connection
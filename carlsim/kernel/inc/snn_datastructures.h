@@ -136,6 +136,64 @@ typedef struct ConnectConfig_s {
 	int                      numberOfConnections; // ToDo: move to ConnectConfigMD
 } ConnectConfig;
 
+/*!
+ * \brief a counter-based random number generator
+ *
+ * The i-th number of a stream is a hash (SplitMix64) of the key of the stream and i. Streams with different keys are
+ * independent, so that each block of a connection can draw its own numbers, regardless of which thread generates it
+ * and in which order.
+ */
+typedef struct CounterRNG_s {
+	CounterRNG_s() : key(0), counter(0) {}
+	CounterRNG_s(int seed, int connId, int blockId) : counter(0) {
+		key = mix(mix(mix((unsigned int)seed) + (unsigned int)connId) + (unsigned int)blockId);
+	}
+
+	static unsigned long long mix(unsigned long long z) {
+		z += 0x9e3779b97f4a7c15ULL;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		return z ^ (z >> 31);
+	}
+
+	//! returns the next number of the stream, uniformly distributed in [0, 2^64)
+	unsigned long long next() { return mix(key + 0x9e3779b97f4a7c15ULL * counter++); }
+	//! returns the next number of the stream, uniformly distributed in [0, 1)
+	double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+	//! returns the next number of the stream, uniformly distributed in [0, n)
+	int nextInt(int n) { return (int)(next() % (unsigned long long)n); }
+
+	unsigned long long key;     //!< key of the stream
+	unsigned long long counter; //!< index of the next number of the stream
+} CounterRNG;
+
+/*!
+ * \brief a block of pre-synaptic neurons of a connection, whose synapses are generated by one task
+ *
+ * \see SNN::connectNetwork
+ */
+typedef struct ConnectionBlock_s {
+	int netId;
+	std::list<ConnectConfig>::iterator connIt;
+	bool isExternal;
+	int gStartN; //!< first pre-synaptic neuron of the block
+	int gEndN;   //!< last pre-synaptic neuron of the block
+	// properties of the groups, looked up before the blocks are generated in parallel
+	bool isExcitatorySrc; //!< whether the pre-synaptic group is excitatory (sign of the weights)
+	int gSrcStartN;  //!< first neuron of the pre-synaptic group
+	int gDestStartN; //!< first neuron of the post-synaptic group
+	int numNDest;    //!< number of neurons of the post-synaptic group
+	CounterRNG rng; //!< random stream of the block, keyed by the random seed, the connection id, and the block id
+	int externalNetId; //!< the network of the post-synaptic group of an external connection, -1 otherwise
+
+	bool isCounting;     //!< if true, the block only counts its synapses (first pass)
+	size_t numSynapses;  //!< number of synapses of the block, counted by the first pass
+	size_t numWritten;   //!< number of synapses written by the second pass
+	ConnectionInfo* synapses;         //!< slice of the connection list of the network, written by the second pass
+	ConnectionInfo* externalSynapses; //!< slice of the connection list of the external network, NULL if not external
+	std::vector<ConnectionInfo> userSynapses; //!< synapses of a user-defined connection, which is only generated once
+} ConnectionBlock;
+
 /*!
  * \brief the intermediate data of connect config
  *
@@ -451,6 +509,9 @@ typedef struct RuntimeData_s {
 	unsigned int spikeCountExtRxD2; //!< the number of external spikes with axonal delay > 1 in a simulation, used in CPU_MODE currently
 	unsigned int spikeCountExtRxD1; //!< the number of external spikes with axonal delay == 1 in a simulation, used in CPU_MODE currently
 
+	int simTime;    //!< the absolute simulation time (ms) of a CPU runtime, which may run ahead of SNN::simTime in lookahead mode
+	int simTimeMs;  //!< the milliseconds within the current second of a CPU runtime, see simTime
+
 	float* voltage; //!< membrane potential for each regular neuron
 	float* nextVoltage; //!< membrane potential buffer (next/future time step) for each regular neuron
 	float* recovery;
@@ -470,6 +531,8 @@ typedef struct RuntimeData_s {
 	//! Because integration step can be < 1ms we might want to keep integrating but remember that the neuron fired,
 	//! so that we don't produce more than 1 spike per ms.
 	bool* curSpike;
+	//! CPU runtimes store curSpike bit-packed instead: bit lNId % 32 of word lNId / 32 is set if neuron lNId fired
+	unsigned int* curSpikeBits;
 
 	// conductances and stp values
 	float* gNMDA;   //!< conductance of gNMDA
@@ -480,6 +543,7 @@ typedef struct RuntimeData_s {
 	float* gGABAb;  //!< conductance of gGABAb
 	float* gGABAb_r;
 	float* gGABAb_d;
+	unsigned int* condActiveBits; //!< bit lNId is cleared while all conductances of neuron lNId are zero (lazy conductance decay of CPU runtimes)
 
 	int* I_set; //!< an array of bits indicating which synapse got a spike
 
@@ -499,6 +563,8 @@ typedef struct RuntimeData_s {
 
 	int* lastSpikeTime; //!< stores the last spike time of a neuron
 	int* synSpikeTime;  //!< stores the last spike time of a synapse
+	int* postSpikeHistory;  //!< CPU only: spikes of a neuron whose LTP has not been applied to all synapses yet (event-driven STDP)
+	unsigned short* postSpikeHistoryLength; //!< CPU only: the number of spikes in postSpikeHistory of a neuron
 
 	float* wtChange; //!< stores the weight change of a synaptic connection
 	float* wt;       //!< stores the weight change of a synaptic connection
@@ -506,6 +572,7 @@ typedef struct RuntimeData_s {
 	
 	unsigned int* cumulativePost;
 	unsigned int* cumulativePre;
+	unsigned int* cumulativePrePlastic; //!< CPU only: start of the plastic synapses of a neuron in wtChange, maxSynWt and synSpikeTime
 
 	short int* connIdsPreIdx; //!< connectId, per synapse, presynaptic cumulative indexing
 	short int* grpIds;
@@ -519,6 +586,17 @@ typedef struct RuntimeData_s {
 	SynInfo* postSynapticIds;
 	SynInfo* preSynapticIds;
 
+	// compact synapse storage of the CPU runtimes (see SNN::setCPUCompactSynapses)
+	unsigned int* postSynapticIdsPacked; //!< post-synaptic neuron id (low bits) and synapse id (high bits) in 32 bits
+	unsigned short* wtHalf; //!< synaptic weights in IEEE 754 half precision (SYN_WEIGHT_HALF)
+	signed char* wtInt8;    //!< synaptic weights in multiples of the wtScale of their connection (SYN_WEIGHT_INT8)
+	float* wtScale;         //!< the weight of one int8 step of each connection (SYN_WEIGHT_INT8)
+
+	// pull-based spike delivery of the CPU runtimes (see SNN::setCPUSpikeDelivery)
+	int* preSynapticNIds;             //!< pre-synaptic neuron id of each synapse, in the order of cumulativePre
+	unsigned char* preSynapticDelays; //!< delay - 1 of each synapse, in the order of cumulativePre
+	unsigned int* recentSpikeBits;    //!< one bit per neuron and delay slot: the neuron fired tD ms ago
+
 	DelayInfo* postDelayInfo;  	//!< delay information
 	unsigned int* timeTableD1; //!< firing table, only used in CPU_MODE currently
 	unsigned int* timeTableD2; //!< firing table, only used in CPU_MODE currently
@@ -619,8 +697,12 @@ typedef struct NetworkConfigRT_s  {
 	size_t       STP_Pitch;   //!< numN rounded upwards to the nearest 256 boundary, used for GPU only
 	int numPostSynNet;        //!< the total number of post-connections in a network
 	int numPreSynNet;         //!< the total number of pre-connections in a network
+	int numPreSynPlasticNet;  //!< CPU only: the total number of plastic pre-connections in a network
 	int maxNumPostSynN;       //!< the maximum number of post-synaptic connections among neurons
 	int maxNumPreSynN;        //!< the maximum number of pre-syanptic connections among neurons 
+	bool withPackedSynapseIds; //!< CPU only: post-synaptic ids are packed in 32 bits, pre-synaptic ids are not stored
+	int packedNeuronIdBits;    //!< CPU only: the number of bits of the neuron id in a packed post-synaptic id
+	SynWeightFormat synWeightFormat; //!< CPU only: the format in which the synaptic weights are stored
 	unsigned int maxSpikesD2; //!< the estimated maximum number of spikes with delay >= 2 in a network
 	unsigned int maxSpikesD1; //!< the estimated maximum number of spikes with delay == 1 in a network
 
@@ -686,7 +768,8 @@ typedef struct RoutingTableEntry_s {
 *	This sturcture contains the snn object (because the 
 *	multithreading routing is a static method and does not recognize this object), 
 *	netID runtime used by the CPU runtime methods, local group ID, startIdx, 
-*	endIdx, GtoLOffset
+*	endIdx, GtoLOffset. The firing table slots are used by findFiring_CPU when
+*	the neurons of a CPU runtime are split among multiple threads.
 */
 typedef struct ThreadStruct_s {
 	void* snn_pointer;
@@ -695,6 +778,10 @@ typedef struct ThreadStruct_s {
 	int startIdx;
 	int endIdx;
 	int GtoLOffset;
+	int fireIdD1;    //!< first slot of the neuron range [startIdx, endIdx) in firingTableD1
+	int fireIdD2;    //!< first slot of the neuron range [startIdx, endIdx) in firingTableD2
+	int numSpikesD1; //!< number of D1 spikes of the neuron range
+	int numSpikesD2; //!< number of D2 spikes of the neuron range
 } ThreadStruct;
 
 #endif
@@ -131,6 +131,14 @@
 #define MAX_CONN_PER_SNN 256	// hard limit: 2^16
 #define MAX_GRP_PER_SNN 128		// hard limit: 2^16
 #define MAX_NET_PER_SNN 32		// the maximum number of local networks in a simulation
+#define MAX_CPU_THREADS_PER_RUNTIME 16	// the maximum number of threads sharing the neurons of a CPU runtime
+#define CONN_BLOCK_SIZE 256	// pre-synaptic neurons per block (and random stream) of a generated connection
+#define LAZY_DECAY_SNAP_INTERVAL 8	// ms between two checks of the lazy conductance decay for vanished conductances
+
+// file format of SNN::saveSimulation and SNN::loadSimulation
+#define SIM_FILE_SIGNATURE 294338571	// identifies a simulation file
+#define SIM_FILE_VERSION 0.4f		// loadSimulation only reads files of this version
+#define SYNAPSE_IMAGE_INFO_SIZE 10	// number of ints in the header of a synapse image in the network cache
 
 #ifdef __NO_CUDA__
 	#define CPU_RUNTIME_BASE 0
@@ -145,8 +153,11 @@
 #define COND_INTEGRATION_SCALE	2
 
 #define NEURON_MAX_FIRING_RATE 500
+#define FIRING_TABLE_INIT_FIRING_RATE 10 // initial capacity of the growable firing tables of CPU runtimes, in spikes per neuron
 
 #define STDP(t,a,b)       ((a)*exp(-(t)*(b))) // consider to use __expf(), which is accelerated by GPU hardware
+#define STDP_POST_HISTORY_LENGTH 16 // post-synaptic spikes kept per neuron by the event-driven STDP of CPU runtimes
+#define CPU_PULL_DELIVERY_MIN_DENSITY 0.05f // fraction of synapses hit per ms above which SPIKE_DELIVERY_AUTO pulls
 
 #define MAX_TIME_SLICE 1000
 #define MAX_SIMULATION_TIME     INT_MAX
@@ -186,6 +197,11 @@
 #define GET_CONN_SYN_ID(val) (val.gsId & SYNAPSE_ID_MASK)
 #define GET_CONN_GRP_ID(val) ((val.gsId >> NUM_SYNAPSE_BITS) & GROUP_ID_MASK)
 
+// packed post-synaptic ids of the compact synapse storage (CPU only): [synapse id | neuron id (nBits)]
+#define GET_PACKED_CONN_NEURON_ID(val, nBits) ((int)((val) & ((1u << (nBits)) - 1)))
+#define GET_PACKED_CONN_SYN_ID(val, nBits) ((int)((val) >> (nBits)))
+#define SET_PACKED_CONN_ID(nId, sId, nBits) (((unsigned int)(sId) << (nBits)) | (unsigned int)(nId))
+
 #define CONNECTION_INITWTS_RANDOM    	0
 #define CONNECTION_CONN_PRESENT  		1
 #define CONNECTION_FIXED_PLASTIC		2
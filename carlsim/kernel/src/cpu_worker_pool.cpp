@@ -0,0 +1,259 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <snn.h>
+
+#include <cpu_worker_pool.h>
+
+
+class CpuWorkerPool::Impl {
+public:
+	// +++++ PUBLIC METHODS: SETUP / TEAR-DOWN ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	Impl(int numWorkers) : _numWorkers(0), _routine(NULL), _args(NULL), _numTasks(0), _targetWorker(-1), _numPending(0),
+		_generation(0), _shutdown(false)
+	{
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		_numWorkers = (numWorkers > 0) ? numWorkers : 0;
+
+		pthread_mutex_init(&_mutex, NULL);
+		pthread_cond_init(&_startCond, NULL);
+		pthread_cond_init(&_doneCond, NULL);
+
+		_threads = new pthread_t[_numWorkers + 1]; // +1 array size if _numWorkers == 0
+		_workers = new WorkerInfo[_numWorkers + 1];
+		for (int i = 0; i < _numWorkers; i++) {
+			pthread_attr_t attr;
+			pthread_attr_init(&attr);
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(i % NUM_CPU_CORES, &cpus);
+			pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+
+			_workers[i].pool = this;
+			_workers[i].workerId = i;
+
+			pthread_create(&_threads[i], &attr, &Impl::workerLoop, (void*)&_workers[i]);
+			pthread_attr_destroy(&attr);
+		}
+#endif
+	}
+
+	~Impl() {
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_lock(&_mutex);
+		_shutdown = true;
+		pthread_cond_broadcast(&_startCond);
+		pthread_mutex_unlock(&_mutex);
+
+		for (int i = 0; i < _numWorkers; i++)
+			pthread_join(_threads[i], NULL);
+
+		pthread_cond_destroy(&_doneCond);
+		pthread_cond_destroy(&_startCond);
+		pthread_mutex_destroy(&_mutex);
+
+		delete[] _workers;
+		delete[] _threads;
+#endif
+	}
+
+
+	// +++++ PUBLIC METHODS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	int getNumWorkers() { return _numWorkers; }
+
+	void run(TaskRoutine routine, ThreadStruct* args, int numTasks) {
+		if (numTasks <= 0)
+			return;
+
+		// no workers: execute all tasks on the calling thread
+		if (_numWorkers == 0) {
+			for (int i = 0; i < numTasks; i++)
+				routine((void*)&args[i]);
+			return;
+		}
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_lock(&_mutex);
+		_routine = routine;
+		_args = args;
+		_numTasks = numTasks;
+		_targetWorker = -1;
+		_numPending = (numTasks < _numWorkers) ? numTasks : _numWorkers; // idle workers do not report back
+		dispatchAndWait();
+#endif
+	}
+
+	void runOnWorker(int workerId, TaskRoutine routine, ThreadStruct* arg) {
+		assert(workerId >= 0);
+
+		// no workers: execute the task on the calling thread
+		if (_numWorkers == 0) {
+			routine((void*)arg);
+			return;
+		}
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+		pthread_mutex_lock(&_mutex);
+		_routine = routine;
+		_args = arg;
+		_numTasks = 1;
+		_targetWorker = workerId % _numWorkers;
+		_numPending = 1;
+		dispatchAndWait();
+#endif
+	}
+
+private:
+	// +++++ PRIVATE METHODS ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	// wakes up the workers for the batch described by _routine, _args, _numTasks, and _targetWorker, and waits for the
+	// busy workers to finish; must be called with _mutex locked, which is released on return
+	void dispatchAndWait() {
+		_generation++;
+		pthread_cond_broadcast(&_startCond);
+
+		// barrier: wait until all busy workers have finished their share of the batch
+		while (_numPending > 0)
+			pthread_cond_wait(&_doneCond, &_mutex);
+
+		_routine = NULL;
+		_args = NULL;
+		_numTasks = 0;
+		_targetWorker = -1;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	struct WorkerInfo {
+		Impl* pool;
+		int workerId;
+	};
+
+	// main loop of a worker thread: sleep until a new batch is dispatched, execute own share, report back
+	static void* workerLoop(void* arguments) {
+		WorkerInfo* info = (WorkerInfo*) arguments;
+		Impl* pool = info->pool;
+		unsigned int lastGeneration = 0;
+
+		pthread_mutex_lock(&pool->_mutex);
+		while (true) {
+			while (!pool->_shutdown && pool->_generation == lastGeneration)
+				pthread_cond_wait(&pool->_startCond, &pool->_mutex);
+
+			if (pool->_shutdown)
+				break;
+
+			lastGeneration = pool->_generation;
+			TaskRoutine routine = pool->_routine;
+			ThreadStruct* args = pool->_args;
+			int numTasks = pool->_numTasks;
+			int numWorkers = pool->_numWorkers;
+			int targetWorker = pool->_targetWorker;
+
+			if (targetWorker >= 0 ? (info->workerId != targetWorker) : (info->workerId >= numTasks))
+				continue; // nothing to do for this worker in the current batch
+
+			pthread_mutex_unlock(&pool->_mutex);
+			if (targetWorker >= 0) {
+				routine((void*)&args[0]);
+			} else {
+				for (int i = info->workerId; i < numTasks; i += numWorkers)
+					routine((void*)&args[i]);
+			}
+			pthread_mutex_lock(&pool->_mutex);
+
+			if (--pool->_numPending == 0)
+				pthread_cond_signal(&pool->_doneCond);
+		}
+		pthread_mutex_unlock(&pool->_mutex);
+
+		return NULL;
+	}
+#endif
+
+
+	// +++++ PRIVATE PROPERTY MEMBERS +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+
+	int _numWorkers;            //!< number of worker threads, 0 means all tasks are executed inline
+
+	TaskRoutine _routine;       //!< task routine of the current batch
+	ThreadStruct* _args;        //!< task arguments of the current batch
+	int _numTasks;              //!< number of tasks in the current batch
+	int _targetWorker;          //!< worker that executes a single-task batch (see runOnWorker), -1 otherwise
+	int _numPending;            //!< number of workers that have not yet finished the current batch
+	unsigned int _generation;   //!< incremented whenever a new batch is dispatched
+	bool _shutdown;             //!< tells the workers to exit
+
+#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
+	pthread_t* _threads;
+	WorkerInfo* _workers;
+	pthread_mutex_t _mutex;
+	pthread_cond_t _startCond;  //!< signaled when a new batch is dispatched (or on shutdown)
+	pthread_cond_t _doneCond;   //!< signaled when the last busy worker has finished the current batch
+#endif
+};
+
+
+// ****************************************************************************************************************** //
+// CPUWORKERPOOL API IMPLEMENTATION
+// ****************************************************************************************************************** //
+
+// constructor / destructor
+CpuWorkerPool::CpuWorkerPool(int numWorkers) : _impl( new Impl(numWorkers) ) {}
+CpuWorkerPool::~CpuWorkerPool() { delete _impl; }
+
+int CpuWorkerPool::getNumWorkers() { return _impl->getNumWorkers(); }
+
+void CpuWorkerPool::run(TaskRoutine routine, ThreadStruct* args, int numTasks) {
+	_impl->run(routine, args, numTasks);
+}
+
+void CpuWorkerPool::runOnWorker(int workerId, TaskRoutine routine, ThreadStruct* arg) {
+	_impl->runOnWorker(workerId, routine, arg);
+}
@@ -0,0 +1,105 @@
+/* * Copyright (c) 2016 Regents of the University of California. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+*
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+*
+* 3. The names of its contributors may not be used to endorse or promote
+*    products derived from this software without specific prior written
+*    permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+* CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+* EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+* PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+* LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+* SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* *********************************************************************************************** *
+* CARLsim
+* created by: (MDR) Micah Richert, (JN) Jayram M. Nageswaran
+* maintained by:
+* (MA) Mike Avery <averym@uci.edu>
+* (MB) Michael Beyeler <mbeyeler@uci.edu>,
+* (KDC) Kristofor Carlson <kdcarlso@uci.edu>
+* (TSC) Ting-Shuo Chou <tingshuc@uci.edu>
+* (HK) Hirak J Kashyap <kashyaph@uci.edu>
+*
+* CARLsim v1.0: JM, MDR
+* CARLsim v2.0/v2.1/v2.2: JM, MDR, MA, MB, KDC
+* CARLsim3: MB, KDC, TSC
+* CARLsim4: TSC, HK
+*
+* CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
+* Ver 12/31/2016
+*/
+#include <izhikevich_simd.h>
+
+// AVX-512 kernel: this translation unit is compiled for AVX-512F, and must only be called if the processor
+// supports it (see detectSimdInstructionSet)
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#pragma clang fp contract(off)
+#else
+#pragma GCC target("avx512f")
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include <izhikevich_simd_kernel.h>
+
+namespace {
+
+// vector operations of the AVX-512 kernel, 16 neurons at a time
+struct Avx512Ops {
+	typedef __m512 V;
+	typedef __mmask16 M;
+	static const int width = 16;
+
+	static V load(const float* p) { return _mm512_loadu_ps(p); }
+	static void store(float* p, V x) { _mm512_storeu_ps(p, x); }
+	static V set1(float x) { return _mm512_set1_ps(x); }
+	static V add(V x, V y) { return _mm512_add_ps(x, y); }
+	static V sub(V x, V y) { return _mm512_sub_ps(x, y); }
+	static V mul(V x, V y) { return _mm512_mul_ps(x, y); }
+	static V div(V x, V y) { return _mm512_div_ps(x, y); }
+	static M greater(V x, V y) { return _mm512_cmp_ps_mask(x, y, _CMP_GT_OQ); }
+	static V select(M m, V x, V y) { return _mm512_mask_blend_ps(m, y, x); }
+	static M maskOr(M m1, M m2) { return (M)(m1 | m2); }
+	static M maskNone() { return 0; }
+	static int maskBits(M m) { return (int)m; }
+};
+
+} // namespace
+
+void integrateIzhikevichAVX512(const IzhikevichRange& range) {
+	int i = integrateIzhikevichVectors<Avx512Ops>(range, 0);
+	integrateIzhikevichVectors<ScalarOps>(range, i); // remaining neurons
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#else // no x86 processor
+
+void integrateIzhikevichAVX512(const IzhikevichRange& range) {
+	integrateIzhikevichScalar(range);
+}
+
+#endif
@@ -47,15 +47,211 @@
 */
 
 #include <snn.h>
+#include <algorithm>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+#if !defined(WIN32) && !defined(WIN64)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #include <spike_buffer.h>
 
-// spikeGeneratorUpdate_CPU on CPUs
-#if defined(WIN32) || defined(WIN64)
-	void SNN::spikeGeneratorUpdate_CPU(int netId) {
-#else // POSIX
-	void* SNN::spikeGeneratorUpdate_CPU(int netId) {
+// conversion between float and IEEE 754 half precision (SYN_WEIGHT_HALF), rounds to nearest even
+static inline unsigned short floatToHalf(float value) {
+	unsigned int f;
+	memcpy(&f, &value, sizeof(float));
+	unsigned int sign = (f >> 16) & 0x8000u;
+	f &= 0x7fffffffu;
+
+	unsigned short h;
+	if (f >= 0x47800000u) { // too large for half precision: infinity (or NaN)
+		h = (f > 0x7f800000u) ? 0x7e00u : 0x7c00u;
+	} else if (f < 0x38800000u) { // subnormal half: let the FPU round the mantissa
+		float tmp;
+		memcpy(&tmp, &f, sizeof(float));
+		tmp += 0.5f;
+		memcpy(&f, &tmp, sizeof(float));
+		h = (unsigned short)(f - 0x3f000000u);
+	} else {
+		unsigned int mantOdd = (f >> 13) & 1u;
+		f += 0xc8000fffu + mantOdd; // rebias the exponent from 127 to 15, and round to nearest even
+		h = (unsigned short)(f >> 13);
+	}
+	return (unsigned short)(h | sign);
+}
+
+static inline float halfToFloat(unsigned short value) {
+	unsigned int f = ((unsigned int)value & 0x7fffu) << 13;
+	unsigned int exponent = f & 0x0f800000u;
+	f += 0x38000000u; // rebias the exponent from 15 to 127
+	if (exponent == 0x0f800000u) { // infinity or NaN
+		f += 0x38000000u;
+	} else if (exponent == 0) { // zero or subnormal: renormalize
+		f += 0x00800000u;
+		float tmp;
+		memcpy(&tmp, &f, sizeof(float));
+		tmp -= 6.103515625e-05f; // 2^-14
+		memcpy(&f, &tmp, sizeof(float));
+	}
+	f |= ((unsigned int)value & 0x8000u) << 16;
+
+	float result;
+	memcpy(&result, &f, sizeof(float));
+	return result;
+}
+
+// The manager stores per-synapse data of a neuron at cumulativePre[lNId], with the plastic synapses first. CPU runtimes
+// store wtChange, maxSynWt and synSpikeTime for the plastic synapses only, at cumulativePrePlastic[lNId]. This copies
+// the values of the plastic synapses of the neurons [lStartN, lEndN] between the two layouts.
+template<typename T>
+static void copyPlasticSynapses(T* dest, const T* src, const RuntimeData* rt, int lStartN, int lEndN, bool toRuntime) {
+	for (int lNId = lStartN; lNId <= lEndN; lNId++) {
+		unsigned int posFull = rt->cumulativePre[lNId];
+		unsigned int posPlastic = rt->cumulativePrePlastic[lNId];
+		if (toRuntime)
+			memcpy(&dest[posPlastic], &src[posFull], sizeof(T) * rt->Npre_plastic[lNId]);
+		else
+			memcpy(&dest[posFull], &src[posPlastic], sizeof(T) * rt->Npre_plastic[lNId]);
+	}
+}
+
+// CPU runtimes with neuron reordering store the regular neurons of a group in a different order than the manager (see
+// computeNeuronOrder_CPU). nIdMap maps a local neuron id to the other order, neurons beyond its end keep their ids.
+static inline int mapNeuronId(const std::vector<int>& nIdMap, int lNId) {
+	return (lNId < (int)nIdMap.size()) ? nIdMap[lNId] : lNId;
+}
+
+// returns the number of set bits of the bitset bits in [first, last]
+static inline int countBits(const unsigned int* bits, int first, int last) {
+	int count = 0;
+	for (int w = first / 32; w <= last / 32 && first <= last; w++) {
+		unsigned int word = bits[w];
+		if (w == first / 32)
+			word &= ~0u << (first % 32);
+		if (w == last / 32)
+			word &= ~0u >> (31 - last % 32);
+#if defined(__GNUC__)
+		count += __builtin_popcount(word);
+#else
+		for (; word != 0; word &= word - 1)
+			count++;
 #endif
+	}
+	return count;
+}
+
+// returns the first set bit of the bitset bits in [first, last], or last + 1 if there is none
+static inline int findNextBit(const unsigned int* bits, int first, int last) {
+	for (int w = first / 32; w <= last / 32 && first <= last; w++) {
+		unsigned int word = bits[w];
+		if (w == first / 32)
+			word &= ~0u << (first % 32);
+		if (word != 0) {
+#if defined(__GNUC__)
+			int bit = w * 32 + __builtin_ctz(word);
+#else
+			int bit = w * 32;
+			for (; !(word & 1u); word >>= 1)
+				bit++;
+#endif
+			return std::min(bit, last + 1);
+		}
+	}
+	return last + 1;
+}
+
+// copies the per-neuron data (stride values per neuron) of the neurons [lStartN, lStartN + numN) between the order of
+// the manager and the storage order of a CPU runtime, runtimeNId maps the former to the latter
+template<typename T>
+static void copyNeurons(T* dest, const T* src, const std::vector<int>& runtimeNId, int lStartN, int numN, int stride,
+	bool toRuntime)
+{
+	if (lStartN >= (int)runtimeNId.size()) {
+		memcpy(&dest[lStartN * stride], &src[lStartN * stride], sizeof(T) * numN * stride);
+		return;
+	}
+
+	for (int lNId = lStartN; lNId < lStartN + numN; lNId++) {
+		int rNId = mapNeuronId(runtimeNId, lNId);
+		if (toRuntime)
+			memcpy(&dest[rNId * stride], &src[lNId * stride], sizeof(T) * stride);
+		else
+			memcpy(&dest[lNId * stride], &src[rNId * stride], sizeof(T) * stride);
+	}
+}
+
+// maps the neuron ids of the synapses [posSyn, posSyn + lengthSyn) to the other neuron order
+static void mapSynapseNeuronIds(SynInfo* synIds, int posSyn, int lengthSyn, const std::vector<int>& nIdMap) {
+	if (nIdMap.empty())
+		return;
+
+	for (int i = posSyn; i < posSyn + lengthSyn; i++)
+		synIds[i].nId = mapNeuronId(nIdMap, synIds[i].nId);
+}
+
+// replaces an array mapped from the network cache by a copy that can be written
+template<typename T>
+static void copyMappedArray(T*& array, int length) {
+	T* copy = new T[length];
+	memcpy(copy, array, sizeof(T) * length);
+	array = copy;
+}
+
+// one int8 step of a connection (SYN_WEIGHT_INT8) is 1/127 of its maximum weight
+static inline float getInt8WeightScale(float maxWt) {
+	maxWt = fabs(maxWt);
+	return (maxWt > 0.0f) ? maxWt / 127.0f : 1.0f;
+}
+
+// the arrays of a synapse image start at multiples of the cache line size
+static inline size_t alignImageOffset(size_t offset) {
+	return (offset + 63) & ~(size_t)63;
+}
+
+// returns the position of a grid point on the Hilbert curve through a grid of 2^nBits points per dimension, following
+// J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004). coords is overwritten.
+static unsigned long long getHilbertIndex(unsigned int* coords, int nDims, int nBits) {
+	// inverse undo excess work
+	for (unsigned int q = 1u << (nBits - 1); q > 1; q >>= 1) {
+		unsigned int p = q - 1;
+		for (int i = 0; i < nDims; i++) {
+			if (coords[i] & q) {
+				coords[0] ^= p;
+			} else {
+				unsigned int t = (coords[0] ^ coords[i]) & p;
+				coords[0] ^= t;
+				coords[i] ^= t;
+			}
+		}
+	}
+
+	// gray encode
+	for (int i = 1; i < nDims; i++)
+		coords[i] ^= coords[i - 1];
+	unsigned int t = 0;
+	for (unsigned int q = 1u << (nBits - 1); q > 1; q >>= 1) {
+		if (coords[nDims - 1] & q)
+			t ^= q - 1;
+	}
+	for (int i = 0; i < nDims; i++)
+		coords[i] ^= t;
+
+	// interleave the transposed index
+	unsigned long long index = 0;
+	for (int bit = nBits - 1; bit >= 0; bit--) {
+		for (int i = 0; i < nDims; i++)
+			index = (index << 1) | ((coords[i] >> bit) & 1u);
+	}
+	return index;
+}
+
+// spikeGeneratorUpdate_CPU on CPUs
+void SNN::spikeGeneratorUpdate_CPU(int netId) {
 	assert(runtimeData[netId].allocated);
 	assert(runtimeData[netId].memType == CPU_MEM);
 
@@ -81,36 +277,28 @@
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperSpikeGeneratorUpdate_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> spikeGeneratorUpdate_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::updateTimingTable_CPU(int netId) {
-#else // POSIX
-	void* SNN::updateTimingTable_CPU(int netId) {
-#endif
+void SNN::updateTimingTable_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
-	runtimeData[netId].timeTableD2[simTimeMs + networkConfigs[netId].maxDelay + 1] = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
-	runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay + 1] = runtimeData[netId].spikeCountD1Sec;
+	runtimeData[netId].timeTableD2[runtimeData[netId].simTimeMs + networkConfigs[netId].maxDelay + 1] = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
+	runtimeData[netId].timeTableD1[runtimeData[netId].simTimeMs + networkConfigs[netId].maxDelay + 1] = runtimeData[netId].spikeCountD1Sec;
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperUpdateTimingTable_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> updateTimingTable_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
 //void SNN::routeSpikes_CPU() {
 //	int firingTableIdxD2, firingTableIdxD1;
@@ -227,11 +415,7 @@
 //
 //}
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#else // POSIX
-	void* SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#endif
+void SNN::convertExtSpikesD2_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
 	int spikeCountExtRx = endIdx - startIdx; // received external spike count
 
 	runtimeData[netId].spikeCountD2Sec += spikeCountExtRx;
@@ -244,21 +428,15 @@
 		runtimeData[netId].firingTableD2[extIdx] += GtoLOffset;
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperConvertExtSpikesD2_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> convertExtSpikesD2_CPU(args->netId, args->startIdx, args->endIdx, args->GtoLOffset);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#else // POSIX
-	void* SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
-#endif
+void SNN::convertExtSpikesD1_CPU(int netId, int startIdx, int endIdx, int GtoLOffset) {
 	int spikeCountExtRx = endIdx - startIdx; // received external spike count
 
 	runtimeData[netId].spikeCountD1Sec += spikeCountExtRx;
@@ -270,36 +448,274 @@
 		runtimeData[netId].firingTableD1[extIdx] += GtoLOffset;
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperConvertExtSpikesD1_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> convertExtSpikesD1_CPU(args->netId, args->startIdx, args->endIdx, args->GtoLOffset);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::clearExtFiringTable_CPU(int netId) {
-#else // POSIX
-	void* SNN::clearExtFiringTable_CPU(int netId) {
-#endif
+// collects the spikes that other CPU runtimes generated in the current time step and that target ghost groups of
+// this runtime. CPU runtimes share the address space of the manager, so the external firing tables of the source
+// runtimes are read in place instead of being staged through managerRuntimeData. The source tables are complete
+// after findFiring() and are not cleared before clearExtFiringTable(), which are both separated from this task by
+// the barrier of the worker pool. The spikes are appended in the same order as SNN::routeSpikes() would append them:
+// route by route in the order of the routing table, and source group by source group within a route.
+void SNN::receiveExtSpikes_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+
+	int firingTableIdxD2 = runtimeData[netId].timeTableD2[runtimeData[netId].simTimeMs + glbNetworkConfig.maxDelay + 1];
+	int firingTableIdxD1 = runtimeData[netId].timeTableD1[runtimeData[netId].simTimeMs + glbNetworkConfig.maxDelay + 1];
+
+	// make room for all spikes that may be received
+	unsigned int numSpikesRxD2 = 0, numSpikesRxD1 = 0;
+	for (std::list<RoutingTableEntry>::iterator rteItr = spikeRoutingTable.begin(); rteItr != spikeRoutingTable.end(); rteItr++) {
+		if (rteItr->destNetId != netId)
+			continue;
+
+		for (int lGrpId = 0; lGrpId < networkConfigs[rteItr->srcNetId].numGroups; lGrpId++) {
+			if (groupConfigs[rteItr->srcNetId][lGrpId].hasExternalConnect) {
+				numSpikesRxD2 += runtimeData[rteItr->srcNetId].extFiringTableEndIdxD2[lGrpId];
+				numSpikesRxD1 += runtimeData[rteItr->srcNetId].extFiringTableEndIdxD1[lGrpId];
+			}
+		}
+	}
+	growFiringTables_CPU(netId, firingTableIdxD1 + numSpikesRxD1, firingTableIdxD2 + numSpikesRxD2);
+
+	for (std::list<RoutingTableEntry>::iterator rteItr = spikeRoutingTable.begin(); rteItr != spikeRoutingTable.end(); rteItr++) {
+		if (rteItr->destNetId != netId)
+			continue;
+
+		int srcNetId = rteItr->srcNetId;
+		assert(srcNetId >= CPU_RUNTIME_BASE);
+
+		for (int lGrpId = 0; lGrpId < networkConfigs[srcNetId].numGroups; lGrpId++) {
+			if (!groupConfigs[srcNetId][lGrpId].hasExternalConnect)
+				continue;
+
+			int numSpikesD2 = runtimeData[srcNetId].extFiringTableEndIdxD2[lGrpId];
+			int numSpikesD1 = runtimeData[srcNetId].extFiringTableEndIdxD1[lGrpId];
+			if (numSpikesD2 == 0 && numSpikesD1 == 0)
+				continue;
+
+			// search GtoLOffset of the neural group at destination local network
+			int GtoLOffset = 0;
+			bool isFound = false;
+			for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
+				if (grpIt->gGrpId == groupConfigs[srcNetId][lGrpId].gGrpId) {
+					GtoLOffset = grpIt->GtoLOffset;
+					isFound = true;
+					break;
+				}
+			}
+
+			if (!isFound)
+				continue;
+
+			if (numSpikesD2 > 0) {
+				memcpy(runtimeData[netId].firingTableD2 + firingTableIdxD2, runtimeData[srcNetId].extFiringTableD2[lGrpId],
+					sizeof(int) * numSpikesD2);
+				convertExtSpikesD2_CPU(netId, firingTableIdxD2, firingTableIdxD2 + numSpikesD2, GtoLOffset); // [StartIdx, EndIdx)
+				firingTableIdxD2 += numSpikesD2;
+			}
+
+			if (numSpikesD1 > 0) {
+				memcpy(runtimeData[netId].firingTableD1 + firingTableIdxD1, runtimeData[srcNetId].extFiringTableD1[lGrpId],
+					sizeof(int) * numSpikesD1);
+				convertExtSpikesD1_CPU(netId, firingTableIdxD1, firingTableIdxD1 + numSpikesD1, GtoLOffset); // [StartIdx, EndIdx)
+				firingTableIdxD1 += numSpikesD1;
+			}
+		}
+	}
+
+	runtimeData[netId].timeTableD2[runtimeData[netId].simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD2;
+	runtimeData[netId].timeTableD1[runtimeData[netId].simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD1;
+}
+
+	// Static multithreading subroutine method - helper for the above method  
+	void* SNN::helperReceiveExtSpikes_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
+		((SNN *)args->snn_pointer) -> receiveExtSpikes_CPU(args->netId);
+		return NULL;
+	}
+
+// simulates a whole lookahead window of cpuLookaheadWindowMs_ time steps without synchronizing with the other CPU
+// runtimes. The spikes of groups with external connections are staged per time step and per local group in
+// lookaheadSendSpikes[netId], where lookaheadSendOffsets[netId][step * numGroups + lGrpId] marks the first spike of
+// each (time step, group) pair. Spikes from other runtimes are not due before the last time step of the window, whose
+// current update is therefore deferred to finishLookaheadWindow_CPU().
+void SNN::runLookaheadWindow_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+	assert(cpuLookaheadWindowMs_ >= 1);
+
+	int numN = networkConfigs[netId].numN;
+	int numGroups = networkConfigs[netId].numGroups;
+
+	lookaheadSendSpikes[netId].clear();
+	lookaheadSendOffsets[netId].clear();
+
+	for (int step = 0; step < cpuLookaheadWindowMs_; step++) {
+		runtimeData[netId].simTime = simTime + step;
+		runtimeData[netId].simTimeMs = simTimeMs + step;
+
+		doSTPUpdateAndDecayCond_CPU(netId, 0, numN);
+
+		spikeGeneratorUpdate_CPU(netId);
+
+		ThreadStruct firingRange;
+		firingRange.snn_pointer = this;
+		firingRange.netId = netId;
+		firingRange.lGrpId = 0;
+		firingRange.startIdx = 0;
+		firingRange.endIdx = numN;
+		firingRange.GtoLOffset = 0;
+		firingRange.numSpikesD1 = 0;
+		firingRange.numSpikesD2 = 0;
+		assignFiringTableSlots_CPU(&firingRange, 1);
+		findFiring_CPU(netId, 0, numN, firingRange.fireIdD1, firingRange.fireIdD2, firingRange.numSpikesD1,
+			firingRange.numSpikesD2);
+		commitFiringTables_CPU(&firingRange, 1);
+
+		updateTimingTable_CPU(netId);
+
+		// stage the spikes for the other runtimes, a minimum delay >= 2 implies that there are no external D1 spikes
+		for (int lGrpId = 0; lGrpId < numGroups; lGrpId++) {
+			assert(runtimeData[netId].extFiringTableEndIdxD1[lGrpId] == 0);
+			lookaheadSendOffsets[netId].push_back(lookaheadSendSpikes[netId].size());
+			lookaheadSendSpikes[netId].insert(lookaheadSendSpikes[netId].end(), runtimeData[netId].extFiringTableD2[lGrpId],
+				runtimeData[netId].extFiringTableD2[lGrpId] + runtimeData[netId].extFiringTableEndIdxD2[lGrpId]);
+		}
+
+		if (step < cpuLookaheadWindowMs_ - 1) {
+			if (cpuPullDelivery[netId])
+				prepareSpikeBits_CPU(netId);
+			doCurrentUpdateD2_CPU(netId, 0, numN);
+			doCurrentUpdateD1_CPU(netId, 0, numN);
+			globalStateUpdate_CPU(netId, 0, numN);
+		}
+
+		clearExtFiringTable_CPU(netId);
+	}
+
+	lookaheadSendOffsets[netId].push_back(lookaheadSendSpikes[netId].size());
+}
+
+	// Static multithreading subroutine method - helper for the above method  
+	void* SNN::helperRunLookaheadWindow_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		((SNN *)args->snn_pointer) -> runLookaheadWindow_CPU(args->netId);
+		return NULL;
+	}
+
+// inserts the spikes that other CPU runtimes staged during the lookahead window into the firing table slots of the
+// time steps they were fired at, and completes the last time step of the window. Within a slot, the external spikes
+// follow the local spikes in the same order as receiveExtSpikes_CPU() appends them, so the firing tables are exactly
+// the same as with lockstep synchronization.
+void SNN::finishLookaheadWindow_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+
+	int numN = networkConfigs[netId].numN;
+	int numSteps = cpuLookaheadWindowMs_;
+	int timeTableBase = simTimeMs + glbNetworkConfig.maxDelay; // slot of step s: [timeTableBase + s, timeTableBase + s + 1]
+
+	runtimeData[netId].simTime = simTime + numSteps - 1;
+	runtimeData[netId].simTimeMs = simTimeMs + numSteps - 1;
+
+	// collect the source groups in the order of the routing table, and the received spikes per time step
+	std::vector<int> rxNetIds, rxGrpIds, rxGtoLOffsets;
+	std::vector<int> numSpikesRx(numSteps, 0);
+	int numSpikesRxTotal = 0;
+	for (std::list<RoutingTableEntry>::iterator rteItr = spikeRoutingTable.begin(); rteItr != spikeRoutingTable.end(); rteItr++) {
+		if (rteItr->destNetId != netId)
+			continue;
+
+		int srcNetId = rteItr->srcNetId;
+		int srcNumGroups = networkConfigs[srcNetId].numGroups;
+		for (int lGrpId = 0; lGrpId < srcNumGroups; lGrpId++) {
+			if (!groupConfigs[srcNetId][lGrpId].hasExternalConnect)
+				continue;
+
+			// search GtoLOffset of the neural group at destination local network
+			for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
+				if (grpIt->gGrpId == groupConfigs[srcNetId][lGrpId].gGrpId) {
+					rxNetIds.push_back(srcNetId);
+					rxGrpIds.push_back(lGrpId);
+					rxGtoLOffsets.push_back(grpIt->GtoLOffset);
+					for (int step = 0; step < numSteps; step++) {
+						int offset = step * srcNumGroups + lGrpId;
+						int numSpikes = lookaheadSendOffsets[srcNetId][offset + 1] - lookaheadSendOffsets[srcNetId][offset];
+						numSpikesRx[step] += numSpikes;
+						numSpikesRxTotal += numSpikes;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	if (numSpikesRxTotal > 0) {
+		growFiringTables_CPU(netId, 0, runtimeData[netId].timeTableD2[timeTableBase + numSteps] + numSpikesRxTotal);
+
+		// move the slots from the last time step of the window to the first, so that no slot is overwritten before it
+		// has been moved
+		int shift = numSpikesRxTotal;
+		for (int step = numSteps - 1; step >= 0; step--) {
+			int slotStart = runtimeData[netId].timeTableD2[timeTableBase + step];
+			int slotEnd = runtimeData[netId].timeTableD2[timeTableBase + step + 1];
+			shift -= numSpikesRx[step];
+			if (shift > 0 && slotEnd > slotStart)
+				memmove(runtimeData[netId].firingTableD2 + slotStart + shift, runtimeData[netId].firingTableD2 + slotStart,
+					sizeof(int) * (slotEnd - slotStart));
+
+			int firingTableIdxD2 = slotEnd + shift;
+			for (int i = 0; i < (int)rxNetIds.size(); i++) {
+				int srcNetId = rxNetIds[i];
+				int offset = step * networkConfigs[srcNetId].numGroups + rxGrpIds[i];
+				int numSpikesD2 = lookaheadSendOffsets[srcNetId][offset + 1] - lookaheadSendOffsets[srcNetId][offset];
+				if (numSpikesD2 == 0)
+					continue;
+
+				memcpy(runtimeData[netId].firingTableD2 + firingTableIdxD2, &lookaheadSendSpikes[srcNetId][lookaheadSendOffsets[srcNetId][offset]],
+					sizeof(int) * numSpikesD2);
+				convertExtSpikesD2_CPU(netId, firingTableIdxD2, firingTableIdxD2 + numSpikesD2, rxGtoLOffsets[i]); // [StartIdx, EndIdx)
+				firingTableIdxD2 += numSpikesD2;
+			}
+
+			runtimeData[netId].timeTableD2[timeTableBase + step + 1] = firingTableIdxD2;
+		}
+		assert(shift == 0);
+	}
+
+	if (cpuPullDelivery[netId])
+		prepareSpikeBits_CPU(netId);
+	doCurrentUpdateD2_CPU(netId, 0, numN);
+	doCurrentUpdateD1_CPU(netId, 0, numN);
+	globalStateUpdate_CPU(netId, 0, numN);
+}
+
+	// Static multithreading subroutine method - helper for the above method  
+	void* SNN::helperFinishLookaheadWindow_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		((SNN *)args->snn_pointer) -> finishLookaheadWindow_CPU(args->netId);
+		return NULL;
+	}
+
+void SNN::clearExtFiringTable_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	memset(runtimeData[netId].extFiringTableEndIdxD1, 0, sizeof(int) * networkConfigs[netId].numGroups);
 	memset(runtimeData[netId].extFiringTableEndIdxD2, 0, sizeof(int) * networkConfigs[netId].numGroups);
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperClearExtFiringTable_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> clearExtFiringTable_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
 void SNN::copyTimeTable(int netId, bool toManager) {
 	assert(netId >= CPU_RUNTIME_BASE);
@@ -327,11 +743,7 @@ void SNN::copyExtFiringTable(int netId) {
 // used for management of manager runtime data
 // FIXME: make sure this is right when separating cpu_module to a standalone class
 // FIXME: currently this function clear nSpikeCnt of manager runtime data
-#if defined(WIN32) || defined(WIN64)
-	void SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
-#else // POSIX
-	void* SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
-#endif
+void SNN::resetSpikeCnt_CPU(int netId, int lGrpId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	if (lGrpId == ALL) {
@@ -343,335 +755,537 @@ void SNN::copyExtFiringTable(int netId) {
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperResetSpikeCnt_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> resetSpikeCnt_CPU(args->netId, args->lGrpId);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
 // This method loops through all spikes that are generated by neurons with a delay of 1ms
 // and delivers the spikes to the appropriate post-synaptic neuron
-#if defined(WIN32) || defined(WIN64)
-	void SNN::doCurrentUpdateD1_CPU(int netId) {
-#else // POSIX
-	void* SNN::doCurrentUpdateD1_CPU(int netId) {
-#endif
+// Note: only post-synaptic neurons in [startIdx, endIdx) are updated. When the spike delivery is split among threads,
+// each thread walks all spikes but owns a range of post-synaptic neurons, so that no two threads write to the same
+// neuron or synapse, and each neuron receives its spikes in the same order as with a single thread
+void SNN::doCurrentUpdateD1_CPU(int netId, int startIdx, int endIdx) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
-	int k     = runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay + 1] - 1;
-	int k_end = runtimeData[netId].timeTableD1[simTimeMs + networkConfigs[netId].maxDelay];
+	// the pull-based spike delivery handles all delays in doCurrentUpdateD2_CPU
+	if (cpuPullDelivery[netId])
+		return;
+
+	int slot = runtimeData[netId].simTimeMs + networkConfigs[netId].maxDelay;
+	deliverSpikeSlot_CPU(netId, runtimeData[netId].firingTableD1, runtimeData[netId].timeTableD1[slot],
+		runtimeData[netId].timeTableD1[slot + 1], 0, startIdx, endIdx);
+}
 
-	while((k >= k_end) && (k >= 0)) {
-		int lNId = runtimeData[netId].firingTableD1[k];
+/*!
+ * \brief delivers the spikes of one slot of a firing table through their synapses with a delay of tD + 1 ms
+ *
+ * A slot of the time table holds the spikes fired in one millisecond, so the spikes that reach their targets with
+ * a given delay are a contiguous range of the firing table. The spikes are delivered newest first.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] firingTable firingTableD1 or firingTableD2
+ * \param[in] kStart the first spike of the slot
+ * \param[in] kEnd one past the last spike of the slot
+ * \param[in] tD the number of ms since the spikes of the slot were fired
+ * \param[in] startIdx the first post-synaptic neuron to be updated
+ * \param[in] endIdx one past the last post-synaptic neuron to be updated
+ *
+ * \sa doCurrentUpdateD1_CPU doCurrentUpdateD2_CPU
+ * \since v4.0
+ */
+void SNN::deliverSpikeSlot_CPU(int netId, const int* firingTable, int kStart, int kEnd, int tD, int startIdx, int endIdx) {
+	for (int k = kEnd - 1; k >= kStart; k--) {
+		int lNId = firingTable[k];
 		//assert(lNId < networkConfigs[netId].numN);
 
-		DelayInfo dPar = runtimeData[netId].postDelayInfo[lNId * (networkConfigs[netId].maxDelay + 1)];
+		DelayInfo dPar = runtimeData[netId].postDelayInfo[lNId * (networkConfigs[netId].maxDelay + 1) + tD];
+		if (dPar.delay_length == 0)
+			continue;
 
+		PostSynapticSpikeKernel postSynapticSpike = cpuSynapseKernels_[netId][runtimeData[netId].grpIds[lNId]];
 		unsigned int offset = runtimeData[netId].cumulativePost[lNId];
 
 		for(int idx_d = dPar.delay_index_start; idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
 			// get synaptic info...
-			SynInfo postInfo = runtimeData[netId].postSynapticIds[offset + idx_d];
-
-			int postNId = GET_CONN_NEURON_ID(postInfo);
+			int postNId, synId;
+			if (networkConfigs[netId].withPackedSynapseIds) {
+				unsigned int postInfo = runtimeData[netId].postSynapticIdsPacked[offset + idx_d];
+				postNId = GET_PACKED_CONN_NEURON_ID(postInfo, networkConfigs[netId].packedNeuronIdBits);
+				synId = GET_PACKED_CONN_SYN_ID(postInfo, networkConfigs[netId].packedNeuronIdBits);
+			} else {
+				SynInfo postInfo = runtimeData[netId].postSynapticIds[offset + idx_d];
+				postNId = GET_CONN_NEURON_ID(postInfo);
+				synId = GET_CONN_SYN_ID(postInfo);
+			}
 			assert(postNId < networkConfigs[netId].numNAssigned);
-
-			int synId = GET_CONN_SYN_ID(postInfo);
 			assert(synId < (runtimeData[netId].Npre[postNId]));
 
-			if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
-				generatePostSynapticSpike(lNId /* preNId */, postNId, synId, 0, netId);
-		}
+			if (postNId >= startIdx && postNId < endIdx) // test if post-neuron is a local neuron owned by this thread
+				(this->*postSynapticSpike)(lNId /* preNId */, postNId, synId, tD, netId);
 
-		k = k - 1;
+			// P5: dopamine is a group variable, it is updated by the thread that owns the first range of neurons
+			if (startIdx == 0 && postNId < networkConfigs[netId].numN)
+				updateDopamine(lNId /* preNId */, postNId, netId);
+		}
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperDoCurrentUpdateD1_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> doCurrentUpdateD1_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> doCurrentUpdateD1_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
 	}
-#endif
 
 // This method loops through all spikes that are generated by neurons with a delay of 2+ms
-// and delivers the spikes to the appropriate post-synaptic neuron
-#if defined(WIN32) || defined(WIN64)
-	void SNN::doCurrentUpdateD2_CPU(int netId) {
-#else // POSIX
-	void* SNN::doCurrentUpdateD2_CPU(int netId) {
-#endif
+// and delivers the spikes to the appropriate post-synaptic neuron in [startIdx, endIdx)
+// Note: the spikes fired tD ms ago are the slot simTimeMs - tD of timeTableD2, so the spikes are delivered slot by
+// slot (newest first) without searching for the firing time of each spike
+void SNN::doCurrentUpdateD2_CPU(int netId, int startIdx, int endIdx) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
+	if (cpuPullDelivery[netId]) {
+		pullCurrentUpdate_CPU(netId, startIdx, endIdx);
+		return;
+	}
+
 	if (networkConfigs[netId].maxDelay > 1) {
-		int k = runtimeData[netId].timeTableD2[simTimeMs + 1 + networkConfigs[netId].maxDelay] - 1;
-		int k_end = runtimeData[netId].timeTableD2[simTimeMs + 1];
-		int t_pos = simTimeMs;
-
-		while ((k >= k_end) && (k >= 0)) {
-			// get the neuron id from the index k
-			int lNId = runtimeData[netId].firingTableD2[k];
-
-			// find the time of firing from the timeTable using index k
-			while (!((k >= runtimeData[netId].timeTableD2[t_pos + networkConfigs[netId].maxDelay]) && (k < runtimeData[netId].timeTableD2[t_pos + networkConfigs[netId].maxDelay + 1]))) {
-				t_pos = t_pos - 1;
-				assert((t_pos + networkConfigs[netId].maxDelay - 1) >= 0);
+		for (int tD = 0; tD < networkConfigs[netId].maxDelay; tD++) {
+			int slot = runtimeData[netId].simTimeMs - tD + networkConfigs[netId].maxDelay;
+			assert(slot >= 1);
+			deliverSpikeSlot_CPU(netId, runtimeData[netId].firingTableD2, runtimeData[netId].timeTableD2[slot],
+				runtimeData[netId].timeTableD2[slot + 1], tD, startIdx, endIdx);
+		}
+	}
+}
+
+	// Static multithreading subroutine method - helper for the above method  
+	void* SNN::helperDoCurrentUpdateD2_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
+		((SNN *)args->snn_pointer) -> doCurrentUpdateD2_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
+	}
+
+/*!
+ * \brief collects the spikes that arrive at their synapses in the current time step for the pull-based spike delivery
+ *
+ * Bit lNId of recentSpikeBits[tD] is set if neuron lNId fired tD ms ago, i.e., if its spike arrives through its
+ * synapses with a delay of tD + 1 ms. These are the same slots of the firing tables as those of doCurrentUpdateD1_CPU
+ * and doCurrentUpdateD2_CPU. Dopamine is a group variable, it is released here, by one thread per runtime, in the same
+ * amount as the push-based delivery releases it.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ *
+ * \sa pullCurrentUpdate_CPU setCPUSpikeDelivery
+ * \since v4.0
+ */
+void SNN::prepareSpikeBits_CPU(int netId) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+	assert(runtimeData[netId].recentSpikeBits != NULL);
+
+	int maxDelay = networkConfigs[netId].maxDelay;
+	int numWords = networkConfigs[netId].numNAssigned / 32 + 1;
+	memset(runtimeData[netId].recentSpikeBits, 0, sizeof(int) * numWords * maxDelay);
+
+	for (int tD = 0; tD < maxDelay; tD++) {
+		for (int table = 0; table < 2; table++) {
+			// firingTableD1 only holds the neurons whose synapses all have a delay of 1 ms
+			int slot;
+			const int* firingTable;
+			const unsigned int* timeTable;
+			if (table == 0) {
+				if (tD > 0)
+					continue;
+				slot = runtimeData[netId].simTimeMs + maxDelay;
+				firingTable = runtimeData[netId].firingTableD1;
+				timeTable = runtimeData[netId].timeTableD1;
+			} else {
+				if (maxDelay == 1)
+					continue;
+				slot = runtimeData[netId].simTimeMs - tD + maxDelay;
+				firingTable = runtimeData[netId].firingTableD2;
+				timeTable = runtimeData[netId].timeTableD2;
 			}
 
-			// \TODO: Instead of using the complex timeTable, can neuronFiringTime value...???
-			// Calculate the time difference between time of firing of neuron and the current time...
-			int tD = simTimeMs - t_pos;
+			unsigned int* spikeBits = runtimeData[netId].recentSpikeBits + tD * numWords;
+			for (unsigned int k = timeTable[slot]; k < timeTable[slot + 1]; k++) {
+				int lNId = firingTable[k];
+				spikeBits[lNId / 32] |= 1u << (lNId % 32);
 
-			assert((tD < networkConfigs[netId].maxDelay) && (tD >= 0));
-			//assert(lNId < networkConfigs[netId].numN);
+				if (!(groupConfigs[netId][runtimeData[netId].grpIds[lNId]].Type & TARGET_DA))
+					continue;
 
-			DelayInfo dPar = runtimeData[netId].postDelayInfo[lNId * (networkConfigs[netId].maxDelay + 1) + tD];
+				DelayInfo dPar = runtimeData[netId].postDelayInfo[lNId * (maxDelay + 1) + tD];
+				unsigned int offset = runtimeData[netId].cumulativePost[lNId];
+				for (int idx_d = dPar.delay_index_start; idx_d < dPar.delay_index_start + dPar.delay_length; idx_d++) {
+					int postNId;
+					if (networkConfigs[netId].withPackedSynapseIds)
+						postNId = GET_PACKED_CONN_NEURON_ID(runtimeData[netId].postSynapticIdsPacked[offset + idx_d],
+							networkConfigs[netId].packedNeuronIdBits);
+					else
+						postNId = GET_CONN_NEURON_ID(runtimeData[netId].postSynapticIds[offset + idx_d]);
 
-			unsigned int offset = runtimeData[netId].cumulativePost[lNId];
+					if (postNId < networkConfigs[netId].numN)
+						updateDopamine(lNId /* preNId */, postNId, netId);
+				}
+			}
+		}
+	}
+}
 
-			// for each delay variables
-			for (int idx_d = dPar.delay_index_start; idx_d < (dPar.delay_index_start + dPar.delay_length); idx_d = idx_d + 1) {
-				// get synaptic info...
-				SynInfo postInfo = runtimeData[netId].postSynapticIds[offset + idx_d];
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperPrepareSpikeBits_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		((SNN *)args->snn_pointer) -> prepareSpikeBits_CPU(args->netId);
+		return NULL;
+	}
 
-				int postNId = GET_CONN_NEURON_ID(postInfo);
-				assert(postNId < networkConfigs[netId].numNAssigned);
+/*!
+ * \brief delivers the spikes of the current time step to the post-synaptic neurons in [startIdx, endIdx) (pull)
+ *
+ * Each post-synaptic neuron walks its pre-synaptic list and looks up in recentSpikeBits whether the spike of the
+ * pre-synaptic neuron arrives through the synapse in this time step. Each synapse is then handled by the same
+ * postSynapticSpike kernel as in the push-based delivery, the order of the synapses of a neuron is that of its
+ * pre-synaptic list.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] startIdx the first post-synaptic neuron to be updated
+ * \param[in] endIdx one past the last post-synaptic neuron to be updated
+ *
+ * \sa prepareSpikeBits_CPU setCPUSpikeDelivery
+ * \since v4.0
+ */
+void SNN::pullCurrentUpdate_CPU(int netId, int startIdx, int endIdx) {
+	int numWords = networkConfigs[netId].numNAssigned / 32 + 1;
+	const unsigned int* spikeBits = runtimeData[netId].recentSpikeBits;
+	const int* preNIds = runtimeData[netId].preSynapticNIds;
+	const unsigned char* delays = runtimeData[netId].preSynapticDelays;
 
-				int synId = GET_CONN_SYN_ID(postInfo);
-				assert(synId < (runtimeData[netId].Npre[postNId]));
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if ((groupConfigs[netId][lGrpId].Type & POISSON_NEURON) || groupConfigs[netId][lGrpId].lStartN >= networkConfigs[netId].numNReg)
+			continue;
 
-				if (postNId < networkConfigs[netId].numN) // test if post-neuron is a local neuron
-					generatePostSynapticSpike(lNId /* preNId */, postNId, synId, tD, netId);
+		int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+		int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
+		for (int postNId = lStartN; postNId <= lEndN; postNId++) {
+			unsigned int pos = runtimeData[netId].cumulativePre[postNId];
+			for (int synId = 0; synId < runtimeData[netId].Npre[postNId]; synId++) {
+				int preNId = preNIds[pos + synId];
+				int tD = delays[pos + synId];
+				if ((spikeBits[tD * numWords + preNId / 32] >> (preNId % 32)) & 1u) {
+					PostSynapticSpikeKernel postSynapticSpike = cpuSynapseKernels_[netId][runtimeData[netId].grpIds[preNId]];
+					(this->*postSynapticSpike)(preNId, postNId, synId, tD, netId);
+				}
 			}
+		}
+	}
+}
+
+// decays the STP variables and conductances of the local neurons in [startIdx, endIdx)
+void SNN::doSTPUpdateAndDecayCond_CPU(int netId, int startIdx, int endIdx) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+	bool decayCond = networkConfigs[netId].sim_with_conductances;
+
+	//decay the STP variables before adding new spikes.
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		if (!groupConfigs[netId][lGrpId].WithSTP)
+			continue;
 
-			k = k - 1;
+		int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+		int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
+		for(int lNId = lStartN; lNId <= lEndN; lNId++) {
+			int ind_plus  = STP_BUF_POS(lNId, runtimeData[netId].simTime, glbNetworkConfig.maxDelay);
+			int ind_minus = STP_BUF_POS(lNId, (runtimeData[netId].simTime - 1), glbNetworkConfig.maxDelay);
+			runtimeData[netId].stpu[ind_plus] = runtimeData[netId].stpu[ind_minus] * (1.0f - groupConfigs[netId][lGrpId].STP_tau_u_inv);
+			runtimeData[netId].stpx[ind_plus] = runtimeData[netId].stpx[ind_minus] + (1.0f - runtimeData[netId].stpx[ind_minus]) * groupConfigs[netId][lGrpId].STP_tau_x_inv;
 		}
 	}
+
+	// decay conductances
+	if (decayCond)
+		decayConductanceRange_CPU(netId, startIdx, endIdx);
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
-	void* SNN::helperDoCurrentUpdateD2_CPU(void* arguments) {
+	void* SNN::helperDoSTPUpdateAndDecayCond_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> doCurrentUpdateD2_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> doSTPUpdateAndDecayCond_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
 	}
-#endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
-#else // POSIX
-	void* SNN::doSTPUpdateAndDecayCond_CPU(int netId) {
-#endif
+// counts the spikes of the local neurons in [startIdx, endIdx), so that the firing table slots of each neuron range
+// can be assigned before the ranges are processed in parallel by findFiring_CPU
+void SNN::countFiring_CPU(int netId, int startIdx, int endIdx, int& numSpikesD1, int& numSpikesD2) {
 	assert(runtimeData[netId].memType == CPU_MEM);
-	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
-	//decay the STP variables before adding new spikes.
-	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
-		for(int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
-			if (groupConfigs[netId][lGrpId].WithSTP) {
-				int ind_plus  = STP_BUF_POS(lNId, simTime, glbNetworkConfig.maxDelay);
-				int ind_minus = STP_BUF_POS(lNId, (simTime - 1), glbNetworkConfig.maxDelay);
-				runtimeData[netId].stpu[ind_plus] = runtimeData[netId].stpu[ind_minus] * (1.0f - groupConfigs[netId][lGrpId].STP_tau_u_inv);
-				runtimeData[netId].stpx[ind_plus] = runtimeData[netId].stpx[ind_minus] + (1.0f - runtimeData[netId].stpx[ind_minus]) * groupConfigs[netId][lGrpId].STP_tau_x_inv;
-			}
-
-			// decay conductances
-			if (networkConfigs[netId].sim_with_conductances && IS_REGULAR_NEURON(lNId, networkConfigs[netId].numNReg, networkConfigs[netId].numNPois)) {
-				runtimeData[netId].gAMPA[lNId]  *= dAMPA;
-				if (sim_with_NMDA_rise) {
-					runtimeData[netId].gNMDA_r[lNId] *= rNMDA;	// rise
-					runtimeData[netId].gNMDA_d[lNId] *= dNMDA;	// decay
-				} else {
-					runtimeData[netId].gNMDA[lNId]   *= dNMDA;	// instantaneous rise
-				}
-
-				runtimeData[netId].gGABAa[lNId] *= dGABAa;
-				if (sim_with_GABAb_rise) {
-					runtimeData[netId].gGABAb_r[lNId] *= rGABAb;	// rise
-					runtimeData[netId].gGABAb_d[lNId] *= dGABAb;	// decay
-				} else {
-					runtimeData[netId].gGABAb[lNId] *= dGABAb;	// instantaneous rise
-				}
+	numSpikesD1 = 0;
+	numSpikesD2 = 0;
+	for(int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+		int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
+		int numSpikes = 0;
+		if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
+			for (int lNId = lStartN; lNId <= lEndN; lNId++) {
+				if (getNeuronSpike(lNId, lGrpId, netId))
+					numSpikes++;
 			}
+		} else {
+			numSpikes = countBits(runtimeData[netId].curSpikeBits, lStartN, lEndN);
 		}
+
+		if (groupConfigs[netId][lGrpId].MaxDelay == 1)
+			numSpikesD1 += numSpikes;
+		else // MaxDelay > 1
+			numSpikesD2 += numSpikes;
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
-	void* SNN::helperDoSTPUpdateAndDecayCond_CPU(void* arguments) {
+	void* SNN::helperCountFiring_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
-		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> doSTPUpdateAndDecayCond_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> countFiring_CPU(args->netId, args->startIdx, args->endIdx, args->numSpikesD1, args->numSpikesD2);
+		return NULL;
 	}
-#endif
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::findFiring_CPU(int netId) {
-#else // POSIX
-	void* SNN::findFiring_CPU(int netId) {
-#endif
+// assigns the first firing table slots of each task (exclusive prefix sum over the spike counts of the neuron ranges)
+// Note: the tasks of a CPU runtime are consecutive and ordered by neuron range, the spike counts of a task are only
+// required if it is followed by another task of the same CPU runtime
+void SNN::assignFiringTableSlots_CPU(ThreadStruct* args, int numTasks) {
+	for (int i = 0; i < numTasks; i++) {
+		int netId = args[i].netId;
+		if (i == 0 || args[i - 1].netId != netId) { // first neuron range of a CPU runtime
+			args[i].fireIdD1 = runtimeData[netId].spikeCountD1Sec;
+			args[i].fireIdD2 = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
+
+			// make room for every neuron of the runtime to fire in this time step
+			growFiringTables_CPU(netId, args[i].fireIdD1 + maxSpikesPerStepD1[netId] + 1,
+				args[i].fireIdD2 + maxSpikesPerStepD2[netId] + 1);
+		} else {
+			args[i].fireIdD1 = args[i - 1].fireIdD1 + args[i - 1].numSpikesD1;
+			args[i].fireIdD2 = args[i - 1].fireIdD2 + args[i - 1].numSpikesD2;
+		}
+	}
+}
+
+// processes the spikes of the local neurons in [startIdx, endIdx), whose firing table slots start at fireIdD1 and
+// fireIdD2, and returns the number of spikes that were written to the firing tables
+void SNN::findFiring_CPU(int netId, int startIdx, int endIdx, int fireIdD1, int fireIdD2, int& numSpikesD1, int& numSpikesD2) {
 	assert(runtimeData[netId].memType == CPU_MEM);
-	// ToDo: This can be further optimized using multiple threads allocated on mulitple CPU cores
+	numSpikesD1 = 0;
+	numSpikesD2 = 0;
 	for(int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
-		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
-			bool needToWrite = false;
+		int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+		int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
+		// only visit the neurons that fired: the spikes of regular neurons are found word by word in curSpikeBits
+		for (int lNId = findNextSpike_CPU(netId, lGrpId, lStartN, lEndN); lNId <= lEndN;
+			lNId = findNextSpike_CPU(netId, lGrpId, lNId + 1, lEndN))
+		{
 			// given group of neurons belong to the poisson group....
 			if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
-				if(groupConfigs[netId][lGrpId].isSpikeGenFunc) {
-					unsigned int offset = lNId - groupConfigs[netId][lGrpId].lStartN + groupConfigs[netId][lGrpId].Noffset;
-					needToWrite = getSpikeGenBit(offset, netId);
-				} else { // spikes generated by poission rate
-					needToWrite = getPoissonSpike(lNId, netId);
-				}
 				// Note: valid lastSpikeTime of spike gen neurons is required by userDefinedSpikeGenerator()
-				if (needToWrite)
-					runtimeData[netId].lastSpikeTime[lNId] = simTime;
-			} else if (runtimeData[netId].curSpike[lNId]) {
-				runtimeData[netId].curSpike[lNId] = false;
-				needToWrite = true;
+				runtimeData[netId].lastSpikeTime[lNId] = runtimeData[netId].simTime;
+			} else {
+				runtimeData[netId].curSpikeBits[lNId / 32] &= ~(1u << (lNId % 32));
 			}
 
-			// his flag is set if with_stdp is set and also grpType is set to have GROUP_SYN_FIXED
-			if (needToWrite) {
-				bool hasSpace = false;
-				int fireId = -1;
-
-				// update spike count: spikeCountD2Sec(W), spikeCountD1Sec(W), spikeCountLastSecLeftD2(R)
-				if (groupConfigs[netId][lGrpId].MaxDelay == 1)
-				{
-					if (runtimeData[netId].spikeCountD1Sec + 1 < networkConfigs[netId].maxSpikesD1) {
-						fireId = runtimeData[netId].spikeCountD1Sec;
-						runtimeData[netId].spikeCountD1Sec++;
-					}
-				} else { // MaxDelay > 1
-					if (runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2 + 1 < networkConfigs[netId].maxSpikesD2) {
-						fireId = runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2;
-						runtimeData[netId].spikeCountD2Sec++;
-					}
-				}
-
-				if (fireId == -1) // no space availabe in firing table, drop the spike
-					continue;
+			int fireId = -1;
 
-				// update firing table: firingTableD1(W), firingTableD2(W)
-				if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
-					runtimeData[netId].firingTableD1[fireId] = lNId;
-				} else { // MaxDelay > 1
-					runtimeData[netId].firingTableD2[fireId] = lNId;
-				}
+			// reserve a slot in the firing table: assignFiringTableSlots_CPU has grown the tables, so that every
+			// neuron can fire
+			if (groupConfigs[netId][lGrpId].MaxDelay == 1)
+			{
+				assert(fireIdD1 + 1 < (int)networkConfigs[netId].maxSpikesD1);
+				fireId = fireIdD1++;
+				numSpikesD1++;
+			} else { // MaxDelay > 1
+				assert(fireIdD2 + 1 < (int)networkConfigs[netId].maxSpikesD2);
+				fireId = fireIdD2++;
+				numSpikesD2++;
+			}
 
-				// update external firing table: extFiringTableEndIdxD1(W), extFiringTableEndIdxD2(W), extFiringTableD1(W), extFiringTableD2(W)
-				if (groupConfigs[netId][lGrpId].hasExternalConnect)     {
-					int extFireId = -1;
-					if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
-						extFireId = runtimeData[netId].extFiringTableEndIdxD1[lGrpId]++;
-						runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
-					} else { // MaxDelay > 1
-						extFireId = runtimeData[netId].extFiringTableEndIdxD2[lGrpId]++;
-						runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = lNId + groupConfigs[netId][lGrpId].LtoGOffset;
-					}
-					assert(extFireId != -1);
-				}
+			// update firing table: firingTableD1(W), firingTableD2(W)
+			if (groupConfigs[netId][lGrpId].MaxDelay == 1) {
+				runtimeData[netId].firingTableD1[fireId] = lNId;
+			} else { // MaxDelay > 1
+				runtimeData[netId].firingTableD2[fireId] = lNId;
+			}
 
-				// update STP for neurons that fire
-				if (groupConfigs[netId][lGrpId].WithSTP) {
-					firingUpdateSTP(lNId, lGrpId, netId);
-				}
+			// update STP for neurons that fire
+			if (groupConfigs[netId][lGrpId].WithSTP) {
+				firingUpdateSTP(lNId, lGrpId, netId);
+			}
 
-				// keep track of number spikes per neuron
-				runtimeData[netId].nSpikeCnt[lNId]++;
+			// keep track of number spikes per neuron
+			runtimeData[netId].nSpikeCnt[lNId]++;
 
-				if (IS_REGULAR_NEURON(lNId, networkConfigs[netId].numNReg, networkConfigs[netId].numNPois))
-					resetFiredNeuron(lNId, lGrpId, netId);
+			if (IS_REGULAR_NEURON(lNId, networkConfigs[netId].numNReg, networkConfigs[netId].numNPois))
+				resetFiredNeuron(lNId, lGrpId, netId);
 
-				// STDP calculation: the post-synaptic neuron fires after the arrival of a pre-synaptic spike
-				if (!sim_in_testing && groupConfigs[netId][lGrpId].WithSTDP) {
+			// STDP calculation: the post-synaptic neuron fires after the arrival of a pre-synaptic spike
+			if (!sim_in_testing && groupConfigs[netId][lGrpId].WithSTDP) {
+				if (cpuEventDrivenSTDP_)
+					recordPostSpikeLTP(netId, lNId, lGrpId);
+				else
 					updateLTP(lNId, lGrpId, netId);
-				}
 			}
 		}
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperFindFiring_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> findFiring_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> findFiring_CPU(args->netId, args->startIdx, args->endIdx, args->fireIdD1, args->fireIdD2,
+			args->numSpikesD1, args->numSpikesD2);
+		return NULL;
 	}
-#endif
 
+// updates the spike counts after all neuron ranges were processed by findFiring_CPU and copies the new spikes of groups
+// with external connections to the external firing tables, in the same order as in the firing tables
+void SNN::commitFiringTables_CPU(ThreadStruct* args, int numTasks) {
+	for (int i = 0; i < numTasks; i++) {
+		int netId = args[i].netId;
+
+		// update spike count: spikeCountD2Sec(W), spikeCountD1Sec(W)
+		runtimeData[netId].spikeCountD1Sec += args[i].numSpikesD1;
+		runtimeData[netId].spikeCountD2Sec += args[i].numSpikesD2;
+
+		// update external firing table: extFiringTableEndIdxD1(W), extFiringTableEndIdxD2(W), extFiringTableD1(W), extFiringTableD2(W)
+		for (int fireId = args[i].fireIdD1; fireId < args[i].fireIdD1 + args[i].numSpikesD1; fireId++) {
+			int lNId = runtimeData[netId].firingTableD1[fireId];
+			int lGrpId = runtimeData[netId].grpIds[lNId];
+			if (groupConfigs[netId][lGrpId].hasExternalConnect) {
+				int extFireId = runtimeData[netId].extFiringTableEndIdxD1[lGrpId]++;
+				runtimeData[netId].extFiringTableD1[lGrpId][extFireId] = mapNeuronId(cpuManagerNId[netId], lNId)
+					+ groupConfigs[netId][lGrpId].LtoGOffset;
+			}
+		}
+		for (int fireId = args[i].fireIdD2; fireId < args[i].fireIdD2 + args[i].numSpikesD2; fireId++) {
+			int lNId = runtimeData[netId].firingTableD2[fireId];
+			int lGrpId = runtimeData[netId].grpIds[lNId];
+			if (groupConfigs[netId][lGrpId].hasExternalConnect) {
+				int extFireId = runtimeData[netId].extFiringTableEndIdxD2[lGrpId]++;
+				runtimeData[netId].extFiringTableD2[lGrpId][extFireId] = mapNeuronId(cpuManagerNId[netId], lNId)
+					+ groupConfigs[netId][lGrpId].LtoGOffset;
+			}
+		}
+	}
+}
 
 void SNN::updateLTP(int lNId, int lGrpId, int netId) {
-	unsigned int pos_ij = runtimeData[netId].cumulativePre[lNId]; // the index of pre-synaptic neuron
+	unsigned int pos_ij = runtimeData[netId].cumulativePrePlastic[lNId]; // the index of pre-synaptic neuron among plastic synapses
 	for(int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; pos_ij++, j++) {
-		int stdp_tDiff = (simTime - runtimeData[netId].synSpikeTime[pos_ij]);
+		int stdp_tDiff = (runtimeData[netId].simTime - runtimeData[netId].synSpikeTime[pos_ij]);
 		assert(!((stdp_tDiff < 0) && (runtimeData[netId].synSpikeTime[pos_ij] != MAX_SIMULATION_TIME)));
 
-		if (stdp_tDiff > 0) {
-			// check this is an excitatory or inhibitory synapse
-			if (groupConfigs[netId][lGrpId].WithESTDP && runtimeData[netId].maxSynWt[pos_ij] >= 0) { // excitatory synapse
-				// Handle E-STDP curve
-				switch (groupConfigs[netId][lGrpId].WithESTDPcurve) {
-				case EXP_CURVE: // exponential curve
-					if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC < 25)
-						runtimeData[netId].wtChange[pos_ij] += STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
-					break;
-				case TIMING_BASED_CURVE: // sc curve
-					if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC < 25) {
-						if (stdp_tDiff <= groupConfigs[netId][lGrpId].GAMMA)
-							runtimeData[netId].wtChange[pos_ij] += groupConfigs[netId][lGrpId].OMEGA + groupConfigs[netId][lGrpId].KAPPA * STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
-						else // stdp_tDiff > GAMMA
-							runtimeData[netId].wtChange[pos_ij] -= STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
-					}
-					break;
-				default:
-					KERNEL_ERROR("Invalid E-STDP curve!");
-					break;
+		updateLTPSynapse(netId, lGrpId, pos_ij, stdp_tDiff);
+	}
+}
+
+// LTP of the plastic synapse pos_ij for a post-synaptic spike stdp_tDiff ms after its last pre-synaptic spike
+void SNN::updateLTPSynapse(int netId, int lGrpId, unsigned int pos_ij, int stdp_tDiff) {
+	if (stdp_tDiff > 0) {
+		// check this is an excitatory or inhibitory synapse
+		if (groupConfigs[netId][lGrpId].WithESTDP && runtimeData[netId].maxSynWt[pos_ij] >= 0) { // excitatory synapse
+			// Handle E-STDP curve
+			switch (groupConfigs[netId][lGrpId].WithESTDPcurve) {
+			case EXP_CURVE: // exponential curve
+				if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC < 25)
+					runtimeData[netId].wtChange[pos_ij] += STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
+				break;
+			case TIMING_BASED_CURVE: // sc curve
+				if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC < 25) {
+					if (stdp_tDiff <= groupConfigs[netId][lGrpId].GAMMA)
+						runtimeData[netId].wtChange[pos_ij] += groupConfigs[netId][lGrpId].OMEGA + groupConfigs[netId][lGrpId].KAPPA * STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
+					else // stdp_tDiff > GAMMA
+						runtimeData[netId].wtChange[pos_ij] -= STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_EXC, groupConfigs[netId][lGrpId].TAU_PLUS_INV_EXC);
 				}
-			} else if (groupConfigs[netId][lGrpId].WithISTDP && runtimeData[netId].maxSynWt[pos_ij] < 0) { // inhibitory synapse
-				// Handle I-STDP curve																				 // Handle I-STDP curve
-				switch (groupConfigs[netId][lGrpId].WithISTDPcurve) {
-				case EXP_CURVE: // exponential curve
-					if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_INB < 25) { // LTP of inhibitory synapse, which decreases synapse weight
-						runtimeData[netId].wtChange[pos_ij] -= STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_INB, groupConfigs[netId][lGrpId].TAU_PLUS_INV_INB);
-					}
-					break;
-				case PULSE_CURVE: // pulse curve
-					if (stdp_tDiff <= groupConfigs[netId][lGrpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
-						runtimeData[netId].wtChange[pos_ij] -= groupConfigs[netId][lGrpId].BETA_LTP;
-						//printf("I-STDP LTP\n");
-					} else if (stdp_tDiff <= groupConfigs[netId][lGrpId].DELTA) { // LTD of inhibitory syanpse, which increase sysnapse weight
-						runtimeData[netId].wtChange[pos_ij] -= groupConfigs[netId][lGrpId].BETA_LTD;
-						//printf("I-STDP LTD\n");
-					} else { /*do nothing*/}
-					break;
-				default:
-					KERNEL_ERROR("Invalid I-STDP curve!");
-					break;
+				break;
+			default:
+				KERNEL_ERROR("Invalid E-STDP curve!");
+				break;
+			}
+		} else if (groupConfigs[netId][lGrpId].WithISTDP && runtimeData[netId].maxSynWt[pos_ij] < 0) { // inhibitory synapse
+			// Handle I-STDP curve																				 // Handle I-STDP curve
+			switch (groupConfigs[netId][lGrpId].WithISTDPcurve) {
+			case EXP_CURVE: // exponential curve
+				if (stdp_tDiff * groupConfigs[netId][lGrpId].TAU_PLUS_INV_INB < 25) { // LTP of inhibitory synapse, which decreases synapse weight
+					runtimeData[netId].wtChange[pos_ij] -= STDP(stdp_tDiff, groupConfigs[netId][lGrpId].ALPHA_PLUS_INB, groupConfigs[netId][lGrpId].TAU_PLUS_INV_INB);
 				}
+				break;
+			case PULSE_CURVE: // pulse curve
+				if (stdp_tDiff <= groupConfigs[netId][lGrpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
+					runtimeData[netId].wtChange[pos_ij] -= groupConfigs[netId][lGrpId].BETA_LTP;
+					//printf("I-STDP LTP\n");
+				} else if (stdp_tDiff <= groupConfigs[netId][lGrpId].DELTA) { // LTD of inhibitory syanpse, which increase sysnapse weight
+					runtimeData[netId].wtChange[pos_ij] -= groupConfigs[netId][lGrpId].BETA_LTD;
+					//printf("I-STDP LTD\n");
+				} else { /*do nothing*/}
+				break;
+			default:
+				KERNEL_ERROR("Invalid I-STDP curve!");
+				break;
 			}
 		}
 	}
 }
 
+/*!
+ * \brief event-driven STDP: records the spike of a post-synaptic neuron instead of updating LTP of all its synapses
+ *
+ * Each synapse applies the LTP of the recorded spikes in settleLTP() when it is next used, that is, when the next
+ * pre-synaptic spike arrives or before the weights are updated. Only if the history of the neuron is full, all its
+ * synapses are settled at once.
+ *
+ * \sa setCPUEventDrivenSTDP
+ * \since v4.0
+ */
+void SNN::recordPostSpikeLTP(int netId, int lNId, int lGrpId) {
+	if (runtimeData[netId].postSpikeHistoryLength[lNId] == STDP_POST_HISTORY_LENGTH)
+		settleNeuronLTP(netId, lNId, lGrpId);
+
+	int k = runtimeData[netId].postSpikeHistoryLength[lNId]++;
+	runtimeData[netId].postSpikeHistory[lNId * STDP_POST_HISTORY_LENGTH + k] = runtimeData[netId].simTime;
+}
+
+// event-driven STDP: applies the LTP of the recorded post-synaptic spikes after the last pre-synaptic spike of the
+// plastic synapse pos_ij, which pair with that pre-synaptic spike as in updateLTP()
+void SNN::settleLTP(int netId, int lNId, int lGrpId, unsigned int pos_ij) {
+	const int* history = &runtimeData[netId].postSpikeHistory[lNId * STDP_POST_HISTORY_LENGTH];
+	int preTime = runtimeData[netId].synSpikeTime[pos_ij];
+
+	// the history is ordered by time, spikes up to the last pre-synaptic spike have been applied already
+	int k = runtimeData[netId].postSpikeHistoryLength[lNId];
+	while (k > 0 && history[k - 1] > preTime)
+		k--;
+	for (; k < runtimeData[netId].postSpikeHistoryLength[lNId]; k++)
+		updateLTPSynapse(netId, lGrpId, pos_ij, history[k] - preTime);
+}
+
+// event-driven STDP: settles all plastic synapses of a neuron and clears its history
+void SNN::settleNeuronLTP(int netId, int lNId, int lGrpId) {
+	if (runtimeData[netId].postSpikeHistoryLength[lNId] == 0)
+		return;
+
+	unsigned int pos_ij = runtimeData[netId].cumulativePrePlastic[lNId];
+	for (int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; pos_ij++, j++)
+		settleLTP(netId, lNId, lGrpId, pos_ij);
+
+	runtimeData[netId].postSpikeHistoryLength[lNId] = 0;
+}
+
 void SNN::firingUpdateSTP(int lNId, int lGrpId, int netId) {
 	// update the spike-dependent part of du/dt and dx/dt
 	// we need to retrieve the STP values from the right buffer position (right before vs. right after the spike)
-	int ind_plus = STP_BUF_POS(lNId, simTime, networkConfigs[netId].maxDelay); // index of right after the spike, such as in u^+
-	int ind_minus = STP_BUF_POS(lNId, (simTime - 1), networkConfigs[netId].maxDelay); // index of right before the spike, such as in u^-
+	int ind_plus = STP_BUF_POS(lNId, runtimeData[netId].simTime, networkConfigs[netId].maxDelay); // index of right after the spike, such as in u^+
+	int ind_minus = STP_BUF_POS(lNId, (runtimeData[netId].simTime - 1), networkConfigs[netId].maxDelay); // index of right before the spike, such as in u^-
 
 	// du/dt = -u/tau_F + U * (1-u^-) * \delta(t-t_{spk})
 	runtimeData[netId].stpu[ind_plus] += groupConfigs[netId][lGrpId].STP_U * (1.0f - runtimeData[netId].stpu[ind_minus]);
@@ -682,7 +1296,7 @@ void SNN::firingUpdateSTP(int lNId, int lGrpId, int netId) {
 
 void SNN::resetFiredNeuron(int lNId, short int lGrpId, int netId) {
 	if (groupConfigs[netId][lGrpId].WithSTDP)
-		runtimeData[netId].lastSpikeTime[lNId] = simTime;
+		runtimeData[netId].lastSpikeTime[lNId] = runtimeData[netId].simTime;
 
 	if (networkConfigs[netId].sim_with_homeostasis) {
 		// with homeostasis flag can be used here.
@@ -690,6 +1304,33 @@ void SNN::resetFiredNeuron(int lNId, short int lGrpId, int netId) {
 	}
 }
 
+// returns true if the neuron fires in the current time step
+// Note: this function has no side effects, so that it can be evaluated twice by countFiring_CPU and findFiring_CPU
+bool SNN::getNeuronSpike(int lNId, int lGrpId, int netId) {
+	// given group of neurons belong to the poisson group....
+	if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
+		if(groupConfigs[netId][lGrpId].isSpikeGenFunc) {
+			unsigned int offset = lNId - groupConfigs[netId][lGrpId].lStartN + groupConfigs[netId][lGrpId].Noffset;
+			return getSpikeGenBit(offset, netId);
+		} else { // spikes generated by poission rate
+			return getPoissonSpike(lNId, netId);
+		}
+	}
+
+	return (runtimeData[netId].curSpikeBits[lNId / 32] >> (lNId % 32)) & 1u;
+}
+
+// returns the first neuron in [lNId, lEndN] of a group that fires in the current time step, or lEndN + 1 if none does
+int SNN::findNextSpike_CPU(int netId, int lGrpId, int lNId, int lEndN) {
+	if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
+		while (lNId <= lEndN && !getNeuronSpike(lNId, lGrpId, netId))
+			lNId++;
+		return lNId;
+	}
+
+	return findNextBit(runtimeData[netId].curSpikeBits, lNId, lEndN);
+}
+
 bool SNN::getPoissonSpike(int lNId, int netId) {
 	// Random number value is less than the poisson firing probability
 	// if poisson firing probability is say 1.0 then the random poisson ptr
@@ -704,19 +1345,123 @@ bool SNN::getSpikeGenBit(unsigned int nIdPos, int netId) {
 	return ((runtimeData[netId].spikeGenBits[nIdIndex] >> nIdBitPos) & 0x1);
 }
 
+// decays the conductances of a regular neuron by one time step
+void SNN::decayConductances(int lNId, int netId) {
+	runtimeData[netId].gAMPA[lNId]  *= dAMPA;
+	if (sim_with_NMDA_rise) {
+		runtimeData[netId].gNMDA_r[lNId] *= rNMDA;	// rise
+		runtimeData[netId].gNMDA_d[lNId] *= dNMDA;	// decay
+	} else {
+		runtimeData[netId].gNMDA[lNId]   *= dNMDA;	// instantaneous rise
+	}
+
+	runtimeData[netId].gGABAa[lNId] *= dGABAa;
+	if (sim_with_GABAb_rise) {
+		runtimeData[netId].gGABAb_r[lNId] *= rGABAb;	// rise
+		runtimeData[netId].gGABAb_d[lNId] *= dGABAb;	// decay
+	} else {
+		runtimeData[netId].gGABAb[lNId] *= dGABAb;	// instantaneous rise
+	}
+}
+
+// sets the conductances of a regular neuron to zero if all of them are below the snap threshold of the lazy
+// conductance decay, returns true if they were set to zero
+bool SNN::snapConductances(int lNId, int netId) {
+	float gMax = runtimeData[netId].gAMPA[lNId];
+	if (sim_with_NMDA_rise)
+		gMax = std::max(gMax, std::max(runtimeData[netId].gNMDA_r[lNId], runtimeData[netId].gNMDA_d[lNId]));
+	else
+		gMax = std::max(gMax, runtimeData[netId].gNMDA[lNId]);
+	gMax = std::max(gMax, runtimeData[netId].gGABAa[lNId]);
+	if (sim_with_GABAb_rise)
+		gMax = std::max(gMax, std::max(runtimeData[netId].gGABAb_r[lNId], runtimeData[netId].gGABAb_d[lNId]));
+	else
+		gMax = std::max(gMax, runtimeData[netId].gGABAb[lNId]);
+
+	if (gMax >= cpuCondSnapThreshold_)
+		return false;
+
+	runtimeData[netId].gAMPA[lNId] = 0.0f;
+	if (sim_with_NMDA_rise) {
+		runtimeData[netId].gNMDA_r[lNId] = 0.0f;
+		runtimeData[netId].gNMDA_d[lNId] = 0.0f;
+	} else {
+		runtimeData[netId].gNMDA[lNId] = 0.0f;
+	}
+	runtimeData[netId].gGABAa[lNId] = 0.0f;
+	if (sim_with_GABAb_rise) {
+		runtimeData[netId].gGABAb_r[lNId] = 0.0f;
+		runtimeData[netId].gGABAb_d[lNId] = 0.0f;
+	} else {
+		runtimeData[netId].gGABAb[lNId] = 0.0f;
+	}
+	return true;
+}
+
+// decays the conductances of the regular neurons in [startIdx, endIdx) by one time step
+// With the lazy conductance decay, only the neurons whose bit is set in condActiveBits are visited, so that a word of
+// 32 silent neurons costs a single load. Every LAZY_DECAY_SNAP_INTERVAL ms, the conductances of a neuron are set to zero
+// if all of them are below the snap threshold, its bit is then cleared until generatePostSynapticSpike delivers its
+// next spike. The inner boundaries of the neuron ranges are multiples of 32 (see addNeuronRangeTasks), so every word
+// is written by one thread.
+void SNN::decayConductanceRange_CPU(int netId, int startIdx, int endIdx) {
+	int lEndN = std::min(endIdx, networkConfigs[netId].numNReg) - 1;
+
+	if (!cpuLazyConductanceDecay_) {
+		for (int lNId = startIdx; lNId <= lEndN; lNId++)
+			decayConductances(lNId, netId);
+		return;
+	}
+
+	unsigned int* activeBits = runtimeData[netId].condActiveBits;
+	bool snap = runtimeData[netId].simTime % LAZY_DECAY_SNAP_INTERVAL == 0;
+	for (int w = startIdx / 32; w <= lEndN / 32; w++) {
+		unsigned int word = activeBits[w];
+		if (word == 0)
+			continue;
+
+		int lLastN = std::min(w * 32 + 31, lEndN);
+		for (int lNId = std::max(w * 32, startIdx); lNId <= lLastN; lNId++) {
+			if (!((word >> (lNId % 32)) & 1u))
+				continue;
+
+			decayConductances(lNId, netId);
+			if (snap && snapConductances(lNId, netId))
+				word &= ~(1u << (lNId % 32));
+		}
+		activeBits[w] = word;
+	}
+}
+
+// P5
+// Got one spike from dopaminergic neuron, increase dopamine concentration in the target area
+void SNN::updateDopamine(int preNId, int postNId, int netId) {
+	short int pre_grpId = runtimeData[netId].grpIds[preNId];
+	if (groupConfigs[netId][pre_grpId].Type & TARGET_DA) {
+		runtimeData[netId].grpDA[runtimeData[netId].grpIds[postNId]] += 0.04;
+	}
+}
+
 /*
 * The sequence of handling an post synaptic spike in CPU mode:
 * P1. Load wt into change (temporary variable)
 * P2. Modulate change by STP (if enabled)
 * P3-1. Modulate change by d_mulSynSlow and d_mulSynFast
 * P3-2. Accumulate g(AMPA,NMDA,GABAa,GABAb) or current
-* P4. Update synSpikeTime
+* P4. Update synSpikeTime (plastic synapses only)
 * P5. Update DA,5HT,ACh,NE accordingly
-* P6. Update STDP wtChange
+* P6. Update STDP wtChange (plastic synapses only)
 * P7. Update v(voltage), u(recovery)
 * P8. Update homeostasis
 * P9. Decay and log DA,5HT,ACh,NE
+*
+* The features of the network and of the pre-synaptic group are template parameters, so that each instantiation only
+* contains the code it needs (see selectCPUKernels). With withSTDP, the STDP of the post-synaptic group is still checked.
+* Fixed synapses return after P3: only their weight and the post-synaptic current are touched. STDP state is stored
+* for plastic synapses only, which come first in the pre-synaptic list of a neuron (see copyPlasticSynapses).
 */
+template<bool withConductances, bool withNMDARise, bool withGABAbRise, bool withSTP, bool withSTDP, bool withLazyDecay,
+	int weightFormat>
 void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD, int netId) {
 	// get the cumulative position for quick access
 	unsigned int pos = runtimeData[netId].cumulativePre[postNId] + synId;
@@ -738,18 +1483,24 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 	// P1
 	// for each presynaptic spike, postsynaptic (synaptic) current is going to increase by some amplitude (change)
 	// generally speaking, this amplitude is the weight; but it can be modulated by STP
-	float change = runtimeData[netId].wt[pos];
+	float change;
+	if (weightFormat == SYN_WEIGHT_HALF)
+		change = halfToFloat(runtimeData[netId].wtHalf[pos]);
+	else if (weightFormat == SYN_WEIGHT_INT8)
+		change = runtimeData[netId].wtInt8[pos] * runtimeData[netId].wtScale[mulIndex];
+	else
+		change = runtimeData[netId].wt[pos];
 
 	// P2
-	if (groupConfigs[netId][pre_grpId].WithSTP) {
+	if (withSTP) {
 		// if pre-group has STP enabled, we need to modulate the weight
 		// NOTE: Order is important! (Tsodyks & Markram, 1998; Mongillo, Barak, & Tsodyks, 2008)
 		// use u^+ (value right after spike-update) but x^- (value right before spike-update)
 
 		// dI/dt = -I/tau_S + A * u^+ * x^- * \delta(t-t_{spk})
 		// I noticed that for connect(.., RangeDelay(1), ..) tD will be 0
-		int ind_minus = STP_BUF_POS(preNId, (simTime-tD-1), networkConfigs[netId].maxDelay);
-		int ind_plus  = STP_BUF_POS(preNId, (simTime-tD), networkConfigs[netId].maxDelay);
+		int ind_minus = STP_BUF_POS(preNId, (runtimeData[netId].simTime-tD-1), networkConfigs[netId].maxDelay);
+		int ind_plus  = STP_BUF_POS(preNId, (runtimeData[netId].simTime-tD), networkConfigs[netId].maxDelay);
 
 		change *= groupConfigs[netId][pre_grpId].STP_A * runtimeData[netId].stpu[ind_plus] * runtimeData[netId].stpx[ind_minus];
 
@@ -764,11 +1515,13 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 	// P3-1, P3-2
 	// update currents
 	// NOTE: it's faster to += 0.0 rather than checking for zero and not updating
-	if (sim_with_conductances) {
+	if (withConductances) {
+		if (withLazyDecay) // resume the lazy conductance decay of a silent neuron
+			runtimeData[netId].condActiveBits[postNId / 32] |= 1u << (postNId % 32);
 		if (pre_type & TARGET_AMPA) // if postNId expresses AMPAR
 			runtimeData[netId].gAMPA [postNId] += change * mulSynFast[mulIndex]; // scale by some factor
 		if (pre_type & TARGET_NMDA) {
-			if (sim_with_NMDA_rise) {
+			if (withNMDARise) {
 				runtimeData[netId].gNMDA_r[postNId] += change * sNMDA * mulSynSlow[mulIndex];
 				runtimeData[netId].gNMDA_d[postNId] += change * sNMDA * mulSynSlow[mulIndex];
 			} else {
@@ -778,7 +1531,7 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 		if (pre_type & TARGET_GABAa)
 			runtimeData[netId].gGABAa[postNId] -= change * mulSynFast[mulIndex]; // wt should be negative for GABAa and GABAb
 		if (pre_type & TARGET_GABAb) {
-			if (sim_with_GABAb_rise) {
+			if (withGABAbRise) {
 				runtimeData[netId].gGABAb_r[postNId] -= change * sGABAb * mulSynSlow[mulIndex];
 				runtimeData[netId].gGABAb_d[postNId] -= change * sGABAb * mulSynSlow[mulIndex];
 			} else {
@@ -789,19 +1542,24 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 		runtimeData[netId].current[postNId] += change;
 	}
 
+	// fixed synapses are done
+	if (!withSTDP || synId >= runtimeData[netId].Npre_plastic[postNId])
+		return;
+	unsigned int posPlastic = runtimeData[netId].cumulativePrePlastic[postNId] + synId;
+
+	// event-driven STDP: the post-synaptic spikes since the last pre-synaptic spike pair with that one
+	if (cpuEventDrivenSTDP_)
+		settleLTP(netId, postNId, post_grpId, posPlastic);
+
 	// P4
-	runtimeData[netId].synSpikeTime[pos] = simTime;
+	runtimeData[netId].synSpikeTime[posPlastic] = runtimeData[netId].simTime;
 
-	// P5
-	// Got one spike from dopaminergic neuron, increase dopamine concentration in the target area
-	if (pre_type & TARGET_DA) {
-		runtimeData[netId].grpDA[post_grpId] += 0.04;
-	}
+	// P5 is handled by updateDopamine()
 
 	// P6
 	// STDP calculation: the post-synaptic neuron fires before the arrival of a pre-synaptic spike
 	if (!sim_in_testing && groupConfigs[netId][post_grpId].WithSTDP) {
-		int stdp_tDiff = (simTime - runtimeData[netId].lastSpikeTime[postNId]);
+		int stdp_tDiff = (runtimeData[netId].simTime - runtimeData[netId].lastSpikeTime[postNId]);
 
 		if (stdp_tDiff >= 0) {
 			if (groupConfigs[netId][post_grpId].WithISTDP && ((pre_type & TARGET_GABAa) || (pre_type & TARGET_GABAb))) { // inhibitory syanpse
@@ -809,14 +1567,14 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 				switch (groupConfigs[netId][post_grpId].WithISTDPcurve) {
 				case EXP_CURVE: // exponential curve
 					if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB < 25) { // LTD of inhibitory syanpse, which increase synapse weight
-						runtimeData[netId].wtChange[pos] -= STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_INB, groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB);
+						runtimeData[netId].wtChange[posPlastic] -= STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_INB, groupConfigs[netId][post_grpId].TAU_MINUS_INV_INB);
 					}
 					break;
 				case PULSE_CURVE: // pulse curve
 					if (stdp_tDiff <= groupConfigs[netId][post_grpId].LAMBDA) { // LTP of inhibitory synapse, which decreases synapse weight
-						runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTP;
+						runtimeData[netId].wtChange[posPlastic] -= groupConfigs[netId][post_grpId].BETA_LTP;
 					} else if (stdp_tDiff <= groupConfigs[netId][post_grpId].DELTA) { // LTD of inhibitory syanpse, which increase synapse weight
-						runtimeData[netId].wtChange[pos] -= groupConfigs[netId][post_grpId].BETA_LTD;
+						runtimeData[netId].wtChange[posPlastic] -= groupConfigs[netId][post_grpId].BETA_LTD;
 					} else { /*do nothing*/ }
 					break;
 				default:
@@ -829,7 +1587,7 @@ void SNN::generatePostSynapticSpike(int preNId, int postNId, int synId, int tD,
 				case EXP_CURVE: // exponential curve
 				case TIMING_BASED_CURVE: // sc curve
 					if (stdp_tDiff * groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC < 25)
-						runtimeData[netId].wtChange[pos] += STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_EXC, groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC);
+						runtimeData[netId].wtChange[posPlastic] += STDP(stdp_tDiff, groupConfigs[netId][post_grpId].ALPHA_MINUS_EXC, groupConfigs[netId][post_grpId].TAU_MINUS_INV_EXC);
 					break;
 				default:
 					KERNEL_ERROR("Invalid E-STDP curve");
@@ -881,227 +1639,410 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 	return compCurrent;
 }
 
-#if defined(WIN32) || defined(WIN64)
-	void  SNN::globalStateUpdate_CPU(int netId) {
-#else // POSIX
-	void*  SNN::globalStateUpdate_CPU(int netId) {
-#endif
+// P7: integrates the membrane potential v and the recovery variable u of a regular neuron over one integration step
+// Sets the bit of the neuron in curSpikeBits if it fired, returns the membrane potential after the step, and returns the synaptic current
+// in I_sum (COBA only). The features of the network and of the group are template parameters, so that the per-neuron
+// code has no runtime checks (see selectCPUKernels).
+template<bool withParamModel_9, bool withRungeKutta4, bool withConductances, bool withNMDARise, bool withGABAbRise,
+	bool withCompartments>
+float SNN::integrateNeuron_CPU(int netId, int lGrpId, int lNId, float v, float& u, float& I_sum) {
+	float timeStep = networkConfigs[netId].timeStep;
+
+	// P7
+	// update conductances
+	float v_next;
+	float NMDAtmp;
+	float gNMDA, gGABAb;
+
+	// pre-load izhikevich variables to avoid unnecessary memory accesses & unclutter the code.
+	float k = runtimeData[netId].Izh_k[lNId];
+	float vr = runtimeData[netId].Izh_vr[lNId];
+	float vt = runtimeData[netId].Izh_vt[lNId];
+	float inverse_C = 1.0f / runtimeData[netId].Izh_C[lNId];
+	float vpeak = runtimeData[netId].Izh_vpeak[lNId];
+	float a = runtimeData[netId].Izh_a[lNId];
+	float b = runtimeData[netId].Izh_b[lNId];
+
+	float totalCurrent = runtimeData[netId].extCurrent[lNId];
+
+	if (withConductances) {
+		NMDAtmp = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
+		gNMDA = (withNMDARise) ? (runtimeData[netId].gNMDA_d[lNId] - runtimeData[netId].gNMDA_r[lNId]) : runtimeData[netId].gNMDA[lNId];
+		gGABAb = (withGABAbRise) ? (runtimeData[netId].gGABAb_d[lNId] - runtimeData[netId].gGABAb_r[lNId]) : runtimeData[netId].gGABAb[lNId];
+
+		I_sum = -(runtimeData[netId].gAMPA[lNId] * (v - 0.0f)
+			+ gNMDA * NMDAtmp / (1.0f + NMDAtmp) * (v - 0.0f)
+			+ runtimeData[netId].gGABAa[lNId] * (v + 70.0f)
+			+ gGABAb * (v + 90.0f));
+
+		totalCurrent += I_sum;
+	}
+	else {
+		totalCurrent += runtimeData[netId].current[lNId];
+	}
+	if (withCompartments) {
+		totalCurrent += getCompCurrent(netId, lGrpId, lNId);
+	}
+
+	if (!withRungeKutta4) {
+		// forward Euler
+		if (!withParamModel_9)
+		{	// 4-param Izhikevich
+			// update vpos and upos for the current neuron
+			v_next = v + dvdtIzhikevich4(v, u, totalCurrent, timeStep);
+			if (v_next > 30.0f) {
+				v_next = 30.0f; // break the loop but evaluate u[i]
+				runtimeData[netId].curSpikeBits[lNId / 32] |= 1u << (lNId % 32);
+				v_next = runtimeData[netId].Izh_c[lNId];
+				u += runtimeData[netId].Izh_d[lNId];
+			}
+		}
+		else
+		{	// 9-param Izhikevich
+			// update vpos and upos for the current neuron
+			v_next = v + dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep);
+			if (v_next > vpeak) {
+				v_next = vpeak; // break the loop but evaluate u[i]
+				runtimeData[netId].curSpikeBits[lNId / 32] |= 1u << (lNId % 32);
+				v_next = runtimeData[netId].Izh_c[lNId];
+				u += runtimeData[netId].Izh_d[lNId];
+			}
+		}
+
+		if (v_next < -90.0f) v_next = -90.0f;
+
+		if (!withParamModel_9)
+		{
+			u += dudtIzhikevich4(v_next, u, a, b, timeStep);
+		}
+		else
+		{
+			u += dudtIzhikevich9(v_next, u, vr, a, b, timeStep);
+		}
+	} else {
+		// 4th order Runge-Kutta
+		if (!withParamModel_9) {
+			// 4-param Izhikevich
+			float k1 = dvdtIzhikevich4(v, u, totalCurrent, timeStep);
+			float l1 = dudtIzhikevich4(v, u, a, b, timeStep);
+
+			float k2 = dvdtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, totalCurrent,
+				timeStep);
+			float l2 = dudtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, a, b, timeStep);
+
+			float k3 = dvdtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, totalCurrent,
+				timeStep);
+			float l3 = dudtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, a, b, timeStep);
+
+			float k4 = dvdtIzhikevich4(v + k3, u + l3, totalCurrent, timeStep);
+			float l4 = dudtIzhikevich4(v + k3, u + l3, a, b, timeStep);
+			v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			if (v_next > 30.0f) {
+				v_next = 30.0f;
+				runtimeData[netId].curSpikeBits[lNId / 32] |= 1u << (lNId % 32);
+				v_next = runtimeData[netId].Izh_c[lNId];
+				u += runtimeData[netId].Izh_d[lNId];
+			}
+			if (v_next < -90.0f) v_next = -90.0f;
+
+			u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+		}
+		else {
+			// 9-param Izhikevich
+			float k1 = dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent,
+				timeStep);
+			float l1 = dudtIzhikevich9(v, u, vr, a, b, timeStep);
+
+			float k2 = dvdtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, inverse_C, k, vr, vt,
+				totalCurrent, timeStep);
+			float l2 = dudtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, vr, a, b, timeStep);
+
+			float k3 = dvdtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, inverse_C, k, vr, vt,
+				totalCurrent, timeStep);
+			float l3 = dudtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, vr, a, b, timeStep);
+
+			float k4 = dvdtIzhikevich9(v + k3, u + l3, inverse_C, k, vr, vt,
+				totalCurrent, timeStep);
+			float l4 = dudtIzhikevich9(v + k3, u + l3, vr, a, b, timeStep);
+
+			v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+
+			if (v_next > vpeak) {
+				v_next = vpeak; // break the loop but evaluate u[i]
+				runtimeData[netId].curSpikeBits[lNId / 32] |= 1u << (lNId % 32);
+				v_next = runtimeData[netId].Izh_c[lNId];
+				u += runtimeData[netId].Izh_d[lNId];
+			}
+
+			if (v_next < -90.0f) v_next = -90.0f;
+
+			u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+
+		}
+	}
+
+	return v_next;
+}
+
+// P7 (scalar): integrates the membrane potentials of the regular neurons [lStartN, lEndN] of a group over numSteps
+// integration steps, and writes them to nextVoltage (which may be the voltage). Same interface as the vectorized
+// kernel: in COBA mode, the synaptic current of the last step is stored in current.
+template<bool withParamModel_9, bool withRungeKutta4, bool withConductances, bool withNMDARise, bool withGABAbRise,
+	bool withCompartments>
+void SNN::integrateNeuronRangeScalar_CPU(int netId, int lGrpId, int lStartN, int lEndN, int numSteps, float* nextVoltage) {
+	for (int lNId = lStartN; lNId <= lEndN; lNId++) {
+		assert(lNId < networkConfigs[netId].numNReg);
+
+		float v = runtimeData[netId].voltage[lNId];
+		float u = runtimeData[netId].recovery[lNId];
+		float I_sum;
+		for (int j = 0; j < numSteps; j++)
+			v = integrateNeuron_CPU<withParamModel_9, withRungeKutta4, withConductances, withNMDARise, withGABAbRise,
+				withCompartments>(netId, lGrpId, lNId, v, u, I_sum);
+		nextVoltage[lNId] = v;
+		runtimeData[netId].recovery[lNId] = u;
+		if (withConductances)
+			runtimeData[netId].current[lNId] = I_sum;
+	}
+}
+
+// P7 (vectorized): integrates the membrane potentials of the regular neurons [lStartN, lEndN] of a group over numSteps
+// integration steps with the SIMD kernel of the processor, and writes them to nextVoltage (which may be the voltage).
+// Bit-exact with integrateNeuronRangeScalar_CPU. In COBA mode, the synaptic current of the last step is stored in current.
+void SNN::integrateNeuronRange_CPU(int netId, int lGrpId, int lStartN, int lEndN, int numSteps, float* nextVoltage) {
+	assert(!groupConfigs[netId][lGrpId].withCompartments);
+
+	IzhikevichRange range;
+	range.numN = lEndN - lStartN + 1;
+	range.numSteps = numSteps;
+
+	range.voltage = runtimeData[netId].voltage + lStartN;
+	range.nextVoltage = nextVoltage + lStartN;
+	range.recovery = runtimeData[netId].recovery + lStartN;
+	range.curSpikeBits = runtimeData[netId].curSpikeBits;
+	range.curSpikeBitOffset = lStartN;
+	range.current = runtimeData[netId].current + lStartN;
+	range.extCurrent = runtimeData[netId].extCurrent + lStartN;
+
+	range.Izh_a = runtimeData[netId].Izh_a + lStartN;
+	range.Izh_b = runtimeData[netId].Izh_b + lStartN;
+	range.Izh_c = runtimeData[netId].Izh_c + lStartN;
+	range.Izh_d = runtimeData[netId].Izh_d + lStartN;
+	range.Izh_C = runtimeData[netId].Izh_C + lStartN;
+	range.Izh_k = runtimeData[netId].Izh_k + lStartN;
+	range.Izh_vr = runtimeData[netId].Izh_vr + lStartN;
+	range.Izh_vt = runtimeData[netId].Izh_vt + lStartN;
+	range.Izh_vpeak = runtimeData[netId].Izh_vpeak + lStartN;
+
+	range.withConductances = networkConfigs[netId].sim_with_conductances;
+	range.withNMDARise = networkConfigs[netId].sim_with_NMDA_rise;
+	range.withGABAbRise = networkConfigs[netId].sim_with_GABAb_rise;
+	range.gAMPA = range.gNMDA = range.gNMDA_r = range.gNMDA_d = range.gGABAa = range.gGABAb = range.gGABAb_r = range.gGABAb_d = NULL;
+	if (range.withConductances) {
+		range.gAMPA = runtimeData[netId].gAMPA + lStartN;
+		range.gGABAa = runtimeData[netId].gGABAa + lStartN;
+		if (range.withNMDARise) {
+			range.gNMDA_r = runtimeData[netId].gNMDA_r + lStartN;
+			range.gNMDA_d = runtimeData[netId].gNMDA_d + lStartN;
+		} else {
+			range.gNMDA = runtimeData[netId].gNMDA + lStartN;
+		}
+		if (range.withGABAbRise) {
+			range.gGABAb_r = runtimeData[netId].gGABAb_r + lStartN;
+			range.gGABAb_d = runtimeData[netId].gGABAb_d + lStartN;
+		} else {
+			range.gGABAb = runtimeData[netId].gGABAb + lStartN;
+		}
+	}
+
+	range.withParamModel_9 = groupConfigs[netId][lGrpId].withParamModel_9;
+	range.integrationMethod = networkConfigs[netId].simIntegrationMethod;
+	range.timeStep = networkConfigs[netId].timeStep;
+	if (range.integrationMethod != FORWARD_EULER && range.integrationMethod != RUNGE_KUTTA4)
+		exitSimulation(1);
+
+	integrateIzhikevich(range, cpuSimdInstructionSet_);
+}
+
+// the kernels with the given feature flags (see selectCPUKernels), found by a compile-time search over all flags
+template<> SNN::NeuronRangeKernel SNN::getNeuronRangeKernel<-1>(int) { return NULL; }
+template<> SNN::PostSynapticSpikeKernel SNN::getPostSynapticSpikeKernel<-1>(int) { return NULL; }
+
+template<int flags>
+SNN::NeuronRangeKernel SNN::getNeuronRangeKernel(int selectedFlags) {
+	if (selectedFlags == flags)
+		return &SNN::integrateNeuronRangeScalar_CPU<(flags & 1) != 0, (flags & 2) != 0, (flags & 4) != 0, (flags & 8) != 0,
+			(flags & 16) != 0, (flags & 32) != 0>;
+	return getNeuronRangeKernel<flags - 1>(selectedFlags);
+}
+
+template<int flags>
+SNN::PostSynapticSpikeKernel SNN::getPostSynapticSpikeKernel(int selectedFlags) {
+	if (selectedFlags == flags)
+		return &SNN::generatePostSynapticSpike<(flags & 1) != 0, (flags & 2) != 0, (flags & 4) != 0, (flags & 8) != 0,
+			(flags & 16) != 0, (flags & 32) != 0, flags / 64>;
+	return getPostSynapticSpikeKernel<flags - 1>(selectedFlags);
+}
+
+// selects the neuron update and spike delivery kernels of each group of a CPU runtime once, so that the inner loops
+// do not check the features of the network and of the groups for every neuron and every synapse
+void SNN::selectCPUKernels(int netId) {
+	assert(netId >= CPU_RUNTIME_BASE);
+
+	bool withRungeKutta4 = networkConfigs[netId].simIntegrationMethod == RUNGE_KUTTA4;
+	if (!withRungeKutta4 && networkConfigs[netId].simIntegrationMethod != FORWARD_EULER) {
+		KERNEL_ERROR("Unknown integration method in runtime %d", netId);
+		exitSimulation(1);
+	}
+
+	bool withConductances = networkConfigs[netId].sim_with_conductances;
+	bool withNMDARise = withConductances && networkConfigs[netId].sim_with_NMDA_rise;
+	bool withGABAbRise = withConductances && networkConfigs[netId].sim_with_GABAb_rise;
+
+	// local groups are followed by the ghost groups, which only send spikes
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroupsAssigned; lGrpId++) {
+		// the SIMD kernels integrate groups without compartments
+		bool withCompartments = groupConfigs[netId][lGrpId].withCompartments;
+		if (lGrpId >= networkConfigs[netId].numGroups) {
+			cpuNeuronKernels_[netId][lGrpId] = NULL;
+		} else if (cpuVectorizedNeuronUpdate_ && !withCompartments) {
+			cpuNeuronKernels_[netId][lGrpId] = &SNN::integrateNeuronRange_CPU;
+		} else {
+			int neuronFlags = (groupConfigs[netId][lGrpId].withParamModel_9 ? 1 : 0) | (withRungeKutta4 ? 2 : 0)
+				| (withConductances ? 4 : 0) | (withNMDARise ? 8 : 0) | (withGABAbRise ? 16 : 0) | (withCompartments ? 32 : 0);
+			cpuNeuronKernels_[netId][lGrpId] = getNeuronRangeKernel<63>(neuronFlags);
+		}
+
+		// the spike delivery kernel depends on the pre-synaptic group, STDP is checked for the post-synaptic group
+		int synapseFlags = (withConductances ? 1 : 0) | (withNMDARise ? 2 : 0) | (withGABAbRise ? 4 : 0)
+			| (groupConfigs[netId][lGrpId].WithSTP ? 8 : 0) | (sim_with_stdp && !sim_with_fixedwts ? 16 : 0)
+			| (withConductances && cpuLazyConductanceDecay_ ? 32 : 0) | (networkConfigs[netId].synWeightFormat * 64);
+		cpuSynapseKernels_[netId][lGrpId] = getPostSynapticSpikeKernel<SYN_WEIGHT_INT8 * 64 + 63>(synapseFlags);
+	}
+}
+
+// integrates the local neurons in [startIdx, endIdx), the task of the first neuron range also updates the group states
+void SNN::globalStateUpdate_CPU(int netId, int startIdx, int endIdx) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
-	float timeStep = networkConfigs[netId].timeStep;
+	if (cpuFusedNeuronUpdate_) {
+		globalStateUpdateFused_CPU(netId, startIdx, endIdx);
+		return;
+	}
 
 	// loop that allows smaller integration time step for v's and u's
 	for (int j = 1; j <= networkConfigs[netId].simNumStepsPerMs; j++) {
 
 		bool lastIter = (j == networkConfigs[netId].simNumStepsPerMs);
 		for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+			int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+			int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
 			if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
 				if (groupConfigs[netId][lGrpId].WithHomeostasis & (lastIter)) {
-					for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++)
+					for (int lNId = lStartN; lNId <= lEndN; lNId++)
 						runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
 				}
 				continue;
 			}
 
-			for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
-				assert(lNId < networkConfigs[netId].numNReg);
-
-				// P7
-				// update conductances
-				float v = runtimeData[netId].voltage[lNId];
-				float v_next = runtimeData[netId].nextVoltage[lNId];
-				float u = runtimeData[netId].recovery[lNId];
-				float I_sum, NMDAtmp;
-				float gNMDA, gGABAb;
-
-				// pre-load izhikevich variables to avoid unnecessary memory accesses & unclutter the code.
-				float k = runtimeData[netId].Izh_k[lNId];
-				float vr = runtimeData[netId].Izh_vr[lNId];
-				float vt = runtimeData[netId].Izh_vt[lNId];
-				float inverse_C = 1.0f / runtimeData[netId].Izh_C[lNId];
-				float vpeak = runtimeData[netId].Izh_vpeak[lNId];
-				float a = runtimeData[netId].Izh_a[lNId];
-				float b = runtimeData[netId].Izh_b[lNId];
-
-				float totalCurrent = runtimeData[netId].extCurrent[lNId];
-
-				if (networkConfigs[netId].sim_with_conductances) {
-					NMDAtmp = (v + 80.0f) * (v + 80.0f) / 60.0f / 60.0f;
-					gNMDA = (networkConfigs[netId].sim_with_NMDA_rise) ? (runtimeData[netId].gNMDA_d[lNId] - runtimeData[netId].gNMDA_r[lNId]) : runtimeData[netId].gNMDA[lNId];
-					gGABAb = (networkConfigs[netId].sim_with_GABAb_rise) ? (runtimeData[netId].gGABAb_d[lNId] - runtimeData[netId].gGABAb_r[lNId]) : runtimeData[netId].gGABAb[lNId];
-
-					I_sum = -(runtimeData[netId].gAMPA[lNId] * (v - 0.0f)
-						+ gNMDA * NMDAtmp / (1.0f + NMDAtmp) * (v - 0.0f)
-						+ runtimeData[netId].gGABAa[lNId] * (v + 70.0f)
-						+ gGABAb * (v + 90.0f));
-
-					totalCurrent += I_sum;
-				}
-				else {
-					totalCurrent += runtimeData[netId].current[lNId];
-				}
-				if (groupConfigs[netId][lGrpId].withCompartments) {
-					totalCurrent += getCompCurrent(netId, lGrpId, lNId);
-				}
-
-				switch (networkConfigs[netId].simIntegrationMethod) {
-				case FORWARD_EULER:
-					if (!groupConfigs[netId][lGrpId].withParamModel_9)
-					{	// 4-param Izhikevich
-						// update vpos and upos for the current neuron
-						v_next = v + dvdtIzhikevich4(v, u, totalCurrent, timeStep);
-						if (v_next > 30.0f) {
-							v_next = 30.0f; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-					}
-					else
-					{	// 9-param Izhikevich
-						// update vpos and upos for the current neuron
-						v_next = v + dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent, timeStep);
-						if (v_next > vpeak) {
-							v_next = vpeak; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-					}
-
-					if (v_next < -90.0f) v_next = -90.0f;
-
-					if (!groupConfigs[netId][lGrpId].withParamModel_9)
-					{
-						u += dudtIzhikevich4(v_next, u, a, b, timeStep);
-					}
-					else
-					{
-						u += dudtIzhikevich9(v_next, u, vr, a, b, timeStep);
-					}
-					break;
-				case RUNGE_KUTTA4:
-					if (!groupConfigs[netId][lGrpId].withParamModel_9) {
-						// 4-param Izhikevich
-						float k1 = dvdtIzhikevich4(v, u, totalCurrent, timeStep);
-						float l1 = dudtIzhikevich4(v, u, a, b, timeStep);
-
-						float k2 = dvdtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, totalCurrent,
-							timeStep);
-						float l2 = dudtIzhikevich4(v + k1 / 2.0f, u + l1 / 2.0f, a, b, timeStep);
-
-						float k3 = dvdtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, totalCurrent,
-							timeStep);
-						float l3 = dudtIzhikevich4(v + k2 / 2.0f, u + l2 / 2.0f, a, b, timeStep);
-
-						float k4 = dvdtIzhikevich4(v + k3, u + l3, totalCurrent, timeStep);
-						float l4 = dudtIzhikevich4(v + k3, u + l3, a, b, timeStep);
-						v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
-						if (v_next > 30.0f) {
-							v_next = 30.0f;
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
-						if (v_next < -90.0f) v_next = -90.0f;
-
-						u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
-					}
-					else {
-						// 9-param Izhikevich
-						float k1 = dvdtIzhikevich9(v, u, inverse_C, k, vr, vt, totalCurrent,
-							timeStep);
-						float l1 = dudtIzhikevich9(v, u, vr, a, b, timeStep);
-
-						float k2 = dvdtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l2 = dudtIzhikevich9(v + k1 / 2.0f, u + l1 / 2.0f, vr, a, b, timeStep);
-
-						float k3 = dvdtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l3 = dudtIzhikevich9(v + k2 / 2.0f, u + l2 / 2.0f, vr, a, b, timeStep);
+			if (lStartN <= lEndN) {
+				assert(lEndN < networkConfigs[netId].numNReg);
+				(this->*cpuNeuronKernels_[netId][lGrpId])(netId, lGrpId, lStartN, lEndN, 1, runtimeData[netId].nextVoltage);
 
-						float k4 = dvdtIzhikevich9(v + k3, u + l3, inverse_C, k, vr, vt,
-							totalCurrent, timeStep);
-						float l4 = dudtIzhikevich9(v + k3, u + l3, vr, a, b, timeStep);
+				// update current & average firing rate for homeostasis once per globalStateUpdate_CPU call
+				if (lastIter) {
+					for (int lNId = lStartN; lNId <= lEndN; lNId++)
+						updateNeuronCurrentAndHomeostasis(lNId, lGrpId, netId, runtimeData[netId].current[lNId]);
+				}
+			}
 
-						v_next = v + (1.0f / 6.0f) * (k1 + 2.0f * k2 + 2.0f * k3 + k4);
+			  // decay dopamine concentration once per globalStateUpdate_CPU call
+			if (lastIter && startIdx == 0)
+				updateGroupDopamine(lGrpId, netId);
+		} // end numGroups
 
-						if (v_next > vpeak) {
-							v_next = vpeak; // break the loop but evaluate u[i]
-							runtimeData[netId].curSpike[lNId] = true;
-							v_next = runtimeData[netId].Izh_c[lNId];
-							u += runtimeData[netId].Izh_d[lNId];
-						}
+		  // Only after we are done computing nextVoltage for all neurons do we copy the new values to the voltage array.
+		  // This is crucial for GPU (asynchronous kernel launch) and in the future for a multi-threaded CARLsim version.
+		// Each thread copies its own neuron range (neurons with compartments are never split among threads).
+		int numNReg = std::min(endIdx, networkConfigs[netId].numNReg) - startIdx;
+		if (numNReg > 0)
+			memcpy(&runtimeData[netId].voltage[startIdx], &runtimeData[netId].nextVoltage[startIdx], sizeof(float) * numNReg);
 
-						if (v_next < -90.0f) v_next = -90.0f;
+	} // end simNumStepsPerMs loop
+}
 
-						u += (1.0f / 6.0f) * (l1 + 2.0f * l2 + 2.0f * l3 + l4);
+// Fused version of globalStateUpdate_CPU, which makes a single pass over the neurons in [startIdx, endIdx) instead of
+// one pass per integration step (plus a copy of nextVoltage): each neuron runs all integration steps of the current
+// ms on registers and writes back v and u once. Since every neuron only depends on its own state, the result is
+// bit-exact with the phase-by-phase update. The conductances are still decayed at the start of the next ms by
+// doSTPUpdateAndDecayCond_CPU, so that they are the same as with the phase-by-phase update between two calls to
+// runNetwork. Not used for networks with compartments, whose neurons depend on their neighbors.
+void SNN::globalStateUpdateFused_CPU(int netId, int startIdx, int endIdx) {
+	assert(!sim_with_compartments);
+	int numStepsPerMs = networkConfigs[netId].simNumStepsPerMs;
 
-					}
-					break;
-				case UNKNOWN_INTEGRATION:
-				default:
-					exitSimulation(1);
-				}
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		int lStartN = std::max(groupConfigs[netId][lGrpId].lStartN, startIdx);
+		int lEndN = std::min(groupConfigs[netId][lGrpId].lEndN, endIdx - 1);
+		if (groupConfigs[netId][lGrpId].Type & POISSON_NEURON) {
+			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
+				for (int lNId = lStartN; lNId <= lEndN; lNId++)
+					runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
+			}
+			continue;
+		}
 
-				runtimeData[netId].nextVoltage[lNId] = v_next;
-				runtimeData[netId].recovery[lNId] = u;
+		// the kernel integrates all steps of the whole range at once, the rest of the pass is per neuron
+		if (lStartN <= lEndN)
+			(this->*cpuNeuronKernels_[netId][lGrpId])(netId, lGrpId, lStartN, lEndN, numStepsPerMs, runtimeData[netId].voltage);
 
-				// update current & average firing rate for homeostasis once per globalStateUpdate_CPU call
-				if (lastIter)
-				{
-					if (networkConfigs[netId].sim_with_conductances) {
-						runtimeData[netId].current[lNId] = I_sum;
-					}
-					else {
-						// current must be reset here for CUBA and not STPUpdateAndDecayConductances
-						runtimeData[netId].current[lNId] = 0.0f;
-					}
+		for (int lNId = lStartN; lNId <= lEndN; lNId++) {
+			assert(lNId < networkConfigs[netId].numNReg);
 
-					// P8
-					// update average firing rate for homeostasis
-					if (groupConfigs[netId][lGrpId].WithHomeostasis)
-						runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
-				}
-			} // end StartN...EndN
+			updateNeuronCurrentAndHomeostasis(lNId, lGrpId, netId, runtimeData[netId].current[lNId]);
+		}
 
-			  // decay dopamine concentration once per globalStateUpdate_CPU call
-			if (lastIter)
-			{
-				// P9
-				// decay dopamine concentration
-				if ((groupConfigs[netId][lGrpId].WithESTDPtype == DA_MOD || groupConfigs[netId][lGrpId].WithISTDP == DA_MOD) && runtimeData[netId].grpDA[lGrpId] > groupConfigs[netId][lGrpId].baseDP) {
-					runtimeData[netId].grpDA[lGrpId] *= groupConfigs[netId][lGrpId].decayDP;
-				}
-				runtimeData[netId].grpDABuffer[lGrpId * 1000 + simTimeMs] = runtimeData[netId].grpDA[lGrpId];
-			}
-		} // end numGroups
+		// decay dopamine concentration once per globalStateUpdate_CPU call
+		if (startIdx == 0)
+			updateGroupDopamine(lGrpId, netId);
+	}
+}
 
-		  // Only after we are done computing nextVoltage for all neurons do we copy the new values to the voltage array.
-		  // This is crucial for GPU (asynchronous kernel launch) and in the future for a multi-threaded CARLsim version.
+// updates the current and the average firing rate (homeostasis) of a regular neuron after the last integration step
+void SNN::updateNeuronCurrentAndHomeostasis(int lNId, int lGrpId, int netId, float I_sum) {
+	if (networkConfigs[netId].sim_with_conductances) {
+		runtimeData[netId].current[lNId] = I_sum;
+	}
+	else {
+		// current must be reset here for CUBA and not STPUpdateAndDecayConductances
+		runtimeData[netId].current[lNId] = 0.0f;
+	}
 
-		memcpy(runtimeData[netId].voltage, runtimeData[netId].nextVoltage, sizeof(float)*networkConfigs[netId].numNReg);
+	// P8
+	// update average firing rate for homeostasis
+	if (groupConfigs[netId][lGrpId].WithHomeostasis)
+		runtimeData[netId].avgFiring[lNId] *= groupConfigs[netId][lGrpId].avgTimeScale_decay;
+}
 
-	} // end simNumStepsPerMs loop
+// P9
+// decays the dopamine concentration of a group once per ms and logs it
+void SNN::updateGroupDopamine(int lGrpId, int netId) {
+	if ((groupConfigs[netId][lGrpId].WithESTDPtype == DA_MOD || groupConfigs[netId][lGrpId].WithISTDP == DA_MOD) && runtimeData[netId].grpDA[lGrpId] > groupConfigs[netId][lGrpId].baseDP) {
+		runtimeData[netId].grpDA[lGrpId] *= groupConfigs[netId][lGrpId].decayDP;
+	}
+	runtimeData[netId].grpDABuffer[lGrpId * 1000 + runtimeData[netId].simTimeMs] = runtimeData[netId].grpDA[lGrpId];
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperGlobalStateUpdate_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
-		((SNN *)args->snn_pointer) -> globalStateUpdate_CPU(args->netId);
-		pthread_exit(0);
+		((SNN *)args->snn_pointer) -> globalStateUpdate_CPU(args->netId, args->startIdx, args->endIdx);
+		return NULL;
 	}
-#endif
 
 // This function updates the synaptic weights from its derivatives..
-#if defined(WIN32) || defined(WIN64)
-	void SNN::updateWeights_CPU(int netId) {
-#else // POSIX
-	void* SNN::updateWeights_CPU(int netId) {
-#endif
+void SNN::updateWeights_CPU(int netId) {
 	// at this point we have already checked for sim_in_testing and sim_with_fixedwts
 	assert(sim_in_testing==false);
 	assert(sim_with_fixedwts==false);
@@ -1116,9 +2057,13 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++) {
 			assert(lNId < networkConfigs[netId].numNReg);
 			unsigned int offset = runtimeData[netId].cumulativePre[lNId];
+			unsigned int offsetPlastic = runtimeData[netId].cumulativePrePlastic[lNId];
 			float diff_firing = 0.0;
 			float homeostasisScale = 1.0;
 
+			if (cpuEventDrivenSTDP_)
+				settleNeuronLTP(netId, lNId, lGrpId);
+
 			if (groupConfigs[netId][lGrpId].WithHomeostasis) {
 				assert(runtimeData[netId].baseFiring[lNId] > 0);
 				diff_firing = 1 - runtimeData[netId].avgFiring[lNId] / runtimeData[netId].baseFiring[lNId];
@@ -1131,7 +2076,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 			for (int j = 0; j < runtimeData[netId].Npre_plastic[lNId]; j++) {
 				//	if (i==groupConfigs[0][g].StartN)
 				//		KERNEL_DEBUG("%1.2f %1.2f \t", wt[offset+j]*10, wtChange[offset+j]*10);
-				float effectiveWtChange = stdpScaleFactor_ * runtimeData[netId].wtChange[offset + j];
+				float effectiveWtChange = stdpScaleFactor_ * runtimeData[netId].wtChange[offsetPlastic + j];
 				//				if (wtChange[offset+j])
 				//					printf("connId=%d, wtChange[%d]=%f\n",connIdsPreIdx[offset+j],offset+j,wtChange[offset+j]);
 
@@ -1140,7 +2085,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 				switch (groupConfigs[netId][lGrpId].WithESTDPtype) {
 				case STANDARD:
 					if (groupConfigs[netId][lGrpId].WithHomeostasis) {
-						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + runtimeData[netId].wtChange[offset + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
+						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + runtimeData[netId].wtChange[offsetPlastic + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
 					} else {
 						// just STDP weight update
 						runtimeData[netId].wt[offset + j] += effectiveWtChange;
@@ -1163,7 +2108,7 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 				switch (groupConfigs[netId][lGrpId].WithISTDPtype) {
 				case STANDARD:
 					if (groupConfigs[netId][lGrpId].WithHomeostasis) {
-						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + runtimeData[netId].wtChange[offset + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
+						runtimeData[netId].wt[offset + j] += (diff_firing*runtimeData[netId].wt[offset + j] * homeostasisScale + runtimeData[netId].wtChange[offsetPlastic + j])*runtimeData[netId].baseFiring[lNId] / groupConfigs[netId][lGrpId].avgTimeScale / (1 + fabs(diff_firing) * 50);
 					} else {
 						// just STDP weight update
 						runtimeData[netId].wt[offset + j] += effectiveWtChange;
@@ -1185,18 +2130,18 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 
 				// It is users' choice to decay weight change or not
 				// see setWeightAndWeightChangeUpdate()
-				runtimeData[netId].wtChange[offset + j] *= wtChangeDecay_;
+				runtimeData[netId].wtChange[offsetPlastic + j] *= wtChangeDecay_;
 
 				// if this is an excitatory or inhibitory synapse
-				if (runtimeData[netId].maxSynWt[offset + j] >= 0) {
-					if (runtimeData[netId].wt[offset + j] >= runtimeData[netId].maxSynWt[offset + j])
-						runtimeData[netId].wt[offset + j] = runtimeData[netId].maxSynWt[offset + j];
+				if (runtimeData[netId].maxSynWt[offsetPlastic + j] >= 0) {
+					if (runtimeData[netId].wt[offset + j] >= runtimeData[netId].maxSynWt[offsetPlastic + j])
+						runtimeData[netId].wt[offset + j] = runtimeData[netId].maxSynWt[offsetPlastic + j];
 					if (runtimeData[netId].wt[offset + j] < 0)
 						runtimeData[netId].wt[offset + j] = 0.0;
 				}
 				else {
-					if (runtimeData[netId].wt[offset + j] <= runtimeData[netId].maxSynWt[offset + j])
-						runtimeData[netId].wt[offset + j] = runtimeData[netId].maxSynWt[offset + j];
+					if (runtimeData[netId].wt[offset + j] <= runtimeData[netId].maxSynWt[offsetPlastic + j])
+						runtimeData[netId].wt[offset + j] = runtimeData[netId].maxSynWt[offsetPlastic + j];
 					if (runtimeData[netId].wt[offset + j] > 0)
 						runtimeData[netId].wt[offset + j] = 0.0;
 				}
@@ -1205,26 +2150,24 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperUpdateWeights_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> updateWeights_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
 /*!
  * \brief This function is called every second by SNN::runNetwork(). It updates the firingTableD1(D2) and
  * timeTableD1(D2) by removing older firing information.
  */
- #if defined(WIN32) || defined(WIN64)
-	void SNN::shiftSpikeTables_CPU(int netId) {
-#else // POSIX
-	void* SNN::shiftSpikeTables_CPU(int netId) {
-#endif
+void SNN::shiftSpikeTables_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
+
+	if (cpuSpikeDeliveryMode_ == SPIKE_DELIVERY_AUTO)
+		selectSpikeDelivery_CPU(netId);
+
 	// Read the neuron ids that fired in the last glbNetworkConfig.maxDelay seconds
 	// and put it to the beginning of the firing table...
 	for(int p = runtimeData[netId].timeTableD2[999], k = 0; p < runtimeData[netId].timeTableD2[999 + networkConfigs[netId].maxDelay + 1]; p++, k++) {
@@ -1237,6 +2180,9 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 	}
 
 	runtimeData[netId].timeTableD1[networkConfigs[netId].maxDelay] = 0;
+	firingTableHighWaterD1[netId] = std::max(firingTableHighWaterD1[netId], runtimeData[netId].spikeCountD1Sec);
+	firingTableHighWaterD2[netId] = std::max(firingTableHighWaterD2[netId],
+		runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2);
 	runtimeData[netId].spikeCountD2 += runtimeData[netId].spikeCountD2Sec;
 	runtimeData[netId].spikeCountD1 += runtimeData[netId].spikeCountD1Sec;
 
@@ -1249,15 +2195,338 @@ float SNN::getCompCurrent(int netid, int lGrpId, int lneurId, float const0, floa
 	runtimeData[netId].spikeCountLastSecLeftD2 = runtimeData[netId].timeTableD2[networkConfigs[netId].maxDelay];
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperShiftSpikeTables_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> shiftSpikeTables_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
+	}
+
+// chooses the spike delivery engine of a CPU runtime for the next second (SPIKE_DELIVERY_AUTO): the spikes of the last
+// second, which are still in the firing tables, are weighted by the number of their post-synaptic synapses. The pull
+// engine is used if the resulting fraction of synapses that receive a spike per ms exceeds CPU_PULL_DELIVERY_MIN_DENSITY.
+void SNN::selectSpikeDelivery_CPU(int netId) {
+	int maxDelay = networkConfigs[netId].maxDelay;
+	unsigned long long numSynEvents = 0;
+	for (unsigned int k = runtimeData[netId].timeTableD1[maxDelay]; k < runtimeData[netId].timeTableD1[1000 + maxDelay]; k++)
+		numSynEvents += runtimeData[netId].Npost[runtimeData[netId].firingTableD1[k]];
+	for (unsigned int k = runtimeData[netId].timeTableD2[maxDelay]; k < runtimeData[netId].timeTableD2[1000 + maxDelay]; k++)
+		numSynEvents += runtimeData[netId].Npost[runtimeData[netId].firingTableD2[k]];
+
+	double density = (networkConfigs[netId].numPreSynNet > 0) ? numSynEvents / (1000.0 * networkConfigs[netId].numPreSynNet) : 0.0;
+	bool pull = density >= CPU_PULL_DELIVERY_MIN_DENSITY;
+	if (pull != cpuPullDelivery[netId])
+		KERNEL_DEBUG("CPU %d Runtime switches to %s-based spike delivery (%.3f of the synapses receive a spike per ms)",
+			netId - CPU_RUNTIME_BASE, pull ? "pull" : "push", density);
+	cpuPullDelivery[netId] = pull;
+}
+
+// grows the firing tables of a CPU runtime geometrically, so that they hold at least minSpikesD1 (minSpikesD2) entries.
+// The tables start at a small fraction of the worst-case estimate of findMaxSpikesD1D2 and are only grown between two
+// parallel sections, so that no spike has to be dropped and memory follows the actual activity of the network.
+void SNN::growFiringTables_CPU(int netId, unsigned int minSpikesD1, unsigned int minSpikesD2) {
+	assert(runtimeData[netId].memType == CPU_MEM);
+
+	if (minSpikesD1 > networkConfigs[netId].maxSpikesD1) {
+		unsigned int maxSpikesD1 = std::max(minSpikesD1, 2 * networkConfigs[netId].maxSpikesD1);
+		int* firingTableD1 = new int[maxSpikesD1];
+		memcpy(firingTableD1, runtimeData[netId].firingTableD1, sizeof(int) * networkConfigs[netId].maxSpikesD1);
+		delete [] runtimeData[netId].firingTableD1;
+		runtimeData[netId].firingTableD1 = firingTableD1;
+		KERNEL_DEBUG("Firing table D1 of CPU %d Runtime grown from %u to %u entries", netId - CPU_RUNTIME_BASE,
+			networkConfigs[netId].maxSpikesD1, maxSpikesD1);
+		networkConfigs[netId].maxSpikesD1 = maxSpikesD1;
+	}
+
+	if (minSpikesD2 > networkConfigs[netId].maxSpikesD2) {
+		unsigned int maxSpikesD2 = std::max(minSpikesD2, 2 * networkConfigs[netId].maxSpikesD2);
+		int* firingTableD2 = new int[maxSpikesD2];
+		memcpy(firingTableD2, runtimeData[netId].firingTableD2, sizeof(int) * networkConfigs[netId].maxSpikesD2);
+		delete [] runtimeData[netId].firingTableD2;
+		runtimeData[netId].firingTableD2 = firingTableD2;
+		KERNEL_DEBUG("Firing table D2 of CPU %d Runtime grown from %u to %u entries", netId - CPU_RUNTIME_BASE,
+			networkConfigs[netId].maxSpikesD2, maxSpikesD2);
+		networkConfigs[netId].maxSpikesD2 = maxSpikesD2;
+	}
+}
+
+// computes the storage order of the regular neurons of a CPU runtime with neuron reordering (see
+// setCPUNeuronReordering). The neurons of each regular group whose grid extends in at least two dimensions are sorted
+// along a Hilbert curve through the grid, all other neurons keep their local ids. The copy functions below translate
+// between the order of the manager and the storage order, so that the manager never sees the reordered ids.
+void SNN::computeNeuronOrder_CPU(int netId) {
+	cpuRuntimeNId[netId].clear();
+	cpuManagerNId[netId].clear();
+
+	// compartments are coupled through the local ids of the neurons
+	if (!cpuNeuronReordering_ || sim_with_compartments)
+		return;
+
+	int numNReg = networkConfigs[netId].numNReg;
+	std::vector<int> runtimeNId(numNReg);
+	for (int lNId = 0; lNId < numNReg; lNId++)
+		runtimeNId[lNId] = lNId;
+
+	bool isReordered = false;
+	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
+		GroupConfigRT* grp = &groupConfigs[netId][lGrpId];
+		if ((grp->Type & POISSON_NEURON) || grp->lEndN >= numNReg)
+			continue;
+
+		Grid3D grid = groupConfigMap[grp->gGrpId].grid;
+		int dims[3] = { grid.numX, grid.numY, grid.numZ };
+		int nDims = 0, maxDim = 1;
+		for (int d = 0; d < 3; d++) {
+			if (dims[d] > 1) {
+				nDims++;
+				maxDim = std::max(maxDim, dims[d]);
+			}
+		}
+		if (nDims < 2)
+			continue;
+		assert(grid.N == grp->numN);
+
+		int nBits = 1;
+		while ((1 << nBits) < maxDim)
+			nBits++;
+
+		// (Hilbert index, group-relative id) of each neuron, the neuron ids follow the grid order x, y, z
+		std::vector<std::pair<unsigned long long, int> > order(grp->numN);
+		for (int neurId = 0; neurId < grp->numN; neurId++) {
+			int pos[3] = { neurId % grid.numX, (neurId / grid.numX) % grid.numY, neurId / (grid.numX * grid.numY) };
+			unsigned int coords[3];
+			int dim = 0;
+			for (int d = 0; d < 3; d++) {
+				if (dims[d] > 1)
+					coords[dim++] = pos[d];
+			}
+			order[neurId] = std::make_pair(getHilbertIndex(coords, nDims, nBits), neurId);
+		}
+		std::sort(order.begin(), order.end());
+
+		for (int i = 0; i < grp->numN; i++)
+			runtimeNId[grp->lStartN + order[i].second] = grp->lStartN + i;
+		isReordered = true;
+
+		KERNEL_DEBUG("Neurons of group %s reordered along a %dD Hilbert curve on CPU %d Runtime",
+			groupConfigMap[grp->gGrpId].grpName.c_str(), nDims, netId - CPU_RUNTIME_BASE);
+	}
+
+	if (!isReordered)
+		return;
+
+	cpuRuntimeNId[netId] = runtimeNId;
+	cpuManagerNId[netId].resize(numNReg);
+	for (int lNId = 0; lNId < numNReg; lNId++)
+		cpuManagerNId[netId][runtimeNId[lNId]] = lNId;
+}
+
+// lists the synapse arrays of a CPU runtime that are stored in its synapse image in the network cache, with their size
+// in bytes: the connectivity, and the weights if the network has no plastic synapses. The header of the image
+// (imageInfo, optional) holds the sizes and storage options the arrays depend on.
+void SNN::getCachedSynapseArrays_CPU(int netId, std::vector<std::pair<void**, size_t> >& arrays, int* imageInfo) {
+	RuntimeData* rt = &runtimeData[netId];
+	size_t numN = networkConfigs[netId].numNAssigned;
+	size_t numPreSyn = networkConfigs[netId].numPreSynNet;
+	size_t numPostSyn = networkConfigs[netId].numPostSynNet;
+
+	arrays.clear();
+	arrays.push_back(std::make_pair((void**)&rt->Npre, sizeof(unsigned short) * numN));
+	arrays.push_back(std::make_pair((void**)&rt->Npost, sizeof(unsigned short) * numN));
+	arrays.push_back(std::make_pair((void**)&rt->cumulativePre, sizeof(unsigned int) * numN));
+	arrays.push_back(std::make_pair((void**)&rt->cumulativePost, sizeof(unsigned int) * numN));
+	arrays.push_back(std::make_pair((void**)&rt->postDelayInfo, sizeof(DelayInfo) * numN * (glbNetworkConfig.maxDelay + 1)));
+	if (networkConfigs[netId].withPackedSynapseIds) {
+		arrays.push_back(std::make_pair((void**)&rt->postSynapticIdsPacked, sizeof(unsigned int) * numPostSyn));
+	} else {
+		arrays.push_back(std::make_pair((void**)&rt->postSynapticIds, sizeof(SynInfo) * numPostSyn));
+		arrays.push_back(std::make_pair((void**)&rt->preSynapticIds, sizeof(SynInfo) * numPreSyn));
+	}
+	arrays.push_back(std::make_pair((void**)&rt->connIdsPreIdx, sizeof(short int) * numPreSyn));
+
+	// plastic weights change during the simulation
+	if (sim_with_fixedwts) {
+		switch (networkConfigs[netId].synWeightFormat) {
+		case SYN_WEIGHT_HALF:
+			arrays.push_back(std::make_pair((void**)&rt->wtHalf, sizeof(unsigned short) * numPreSyn));
+			break;
+		case SYN_WEIGHT_INT8:
+			arrays.push_back(std::make_pair((void**)&rt->wtInt8, sizeof(signed char) * numPreSyn));
+			break;
+		default:
+			arrays.push_back(std::make_pair((void**)&rt->wt, sizeof(float) * numPreSyn));
+			break;
+		}
+	}
+
+	if (imageInfo != NULL) {
+		imageInfo[0] = SIM_FILE_SIGNATURE;
+		imageInfo[1] = networkConfigs[netId].numNAssigned;
+		imageInfo[2] = networkConfigs[netId].numPreSynNet;
+		imageInfo[3] = networkConfigs[netId].numPostSynNet;
+		imageInfo[4] = glbNetworkConfig.maxDelay;
+		imageInfo[5] = networkConfigs[netId].withPackedSynapseIds;
+		imageInfo[6] = networkConfigs[netId].packedNeuronIdBits;
+		imageInfo[7] = networkConfigs[netId].synWeightFormat;
+		imageInfo[8] = !cpuRuntimeNId[netId].empty(); // neuron reordering
+		imageInfo[9] = arrays.size();
+	}
+}
+
+/*!
+ * \brief this function writes the synapse image of a CPU runtime to the network cache
+ *
+ * The synapse image holds the arrays listed by getCachedSynapseArrays_CPU as they are stored in the runtime, i.e.,
+ * after neuron reordering and in the compact synapse storage, so that mapSynapseImage_CPU can use them in place. The
+ * header is described in getCachedSynapseArrays_CPU.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] fid the file to write
+ *
+ * \returns false on a write error
+ * \sa mapSynapseImage_CPU
+ * \since v4.0
+ */
+bool SNN::saveSynapseImage_CPU(int netId, FILE* fid) {
+	std::vector<std::pair<void**, size_t> > arrays;
+	int imageInfo[SYNAPSE_IMAGE_INFO_SIZE];
+	getCachedSynapseArrays_CPU(netId, arrays, imageInfo);
+
+	bool writeErr = (fwrite(imageInfo, sizeof(int), SYNAPSE_IMAGE_INFO_SIZE, fid) != SYNAPSE_IMAGE_INFO_SIZE);
+	size_t offset = sizeof(imageInfo);
+	const char padding[64] = { 0 };
+	for (int i = 0; i < (int)arrays.size(); i++) {
+		size_t start = alignImageOffset(offset);
+		writeErr |= (fwrite(padding, 1, start - offset, fid) != start - offset);
+		writeErr |= (fwrite(*arrays[i].first, 1, arrays[i].second, fid) != arrays[i].second);
+		offset = start + arrays[i].second;
+	}
+
+	return !writeErr;
+}
+
+/*!
+ * \brief this function maps the synapse image of a CPU runtime from the network cache
+ *
+ * The image is mapped read-only and shared, so that the synapse arrays of the runtime point into the page cache
+ * instead of being allocated and copied: simulations of the same network on one machine share the memory of their
+ * synapses. Mapped arrays are skipped by the copy functions and by deleteRuntimeData_CPU. Weights that are changed
+ * afterwards (e.g., by CARLsim::setWeight) are first copied, see copySynapseWeights.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] fileName the synapse image written by saveSynapseImage_CPU
+ *
+ * \returns false if the image does not exist or does not match the runtime, its arrays are then allocated as usual
+ * \sa saveSynapseImage_CPU, unmapSynapseImage_CPU
+ * \since v4.0
+ */
+bool SNN::mapSynapseImage_CPU(int netId, const std::string& fileName) {
+#if defined(WIN32) || defined(WIN64)
+	return false;
+#else
+	std::vector<std::pair<void**, size_t> > arrays;
+	int imageInfo[SYNAPSE_IMAGE_INFO_SIZE];
+	getCachedSynapseArrays_CPU(netId, arrays, imageInfo);
+
+	size_t imageSize = sizeof(imageInfo);
+	for (int i = 0; i < (int)arrays.size(); i++)
+		imageSize = alignImageOffset(imageSize) + arrays[i].second;
+
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || (size_t)fileStat.st_size != imageSize) {
+		close(fd);
+		return false;
+	}
+
+	// the mapping remains valid after the file is closed
+	void* image = mmap(NULL, imageSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (image == MAP_FAILED)
+		return false;
+
+	if (memcmp(image, imageInfo, sizeof(imageInfo)) != 0) {
+		munmap(image, imageSize);
+		return false;
+	}
+
+	size_t offset = sizeof(imageInfo);
+	for (int i = 0; i < (int)arrays.size(); i++) {
+		size_t start = alignImageOffset(offset);
+		*arrays[i].first = (char*)image + start;
+		offset = start + arrays[i].second;
 	}
+
+	cpuSynapseImage[netId] = (char*)image;
+	cpuSynapseImageSize[netId] = imageSize;
+	return true;
+#endif
+}
+
+// unmaps the synapse image of a CPU runtime, the arrays that point into it are reset to NULL
+void SNN::unmapSynapseImage_CPU(int netId) {
+	if (cpuSynapseImage[netId] == NULL)
+		return;
+
+	std::vector<std::pair<void**, size_t> > arrays;
+	getCachedSynapseArrays_CPU(netId, arrays);
+	for (int i = 0; i < (int)arrays.size(); i++) {
+		if (isMappedArray_CPU(netId, *arrays[i].first))
+			*arrays[i].first = NULL;
+	}
+
+#if !defined(WIN32) && !defined(WIN64)
+	munmap(cpuSynapseImage[netId], cpuSynapseImageSize[netId]);
 #endif
+	cpuSynapseImage[netId] = NULL;
+	cpuSynapseImageSize[netId] = 0;
+}
+
+// returns true if the array points into the synapse image of a CPU runtime, i.e., it is read-only and not allocated
+bool SNN::isMappedArray_CPU(int netId, const void* array) {
+	const char* image = cpuSynapseImage[netId];
+	return image != NULL && (const char*)array >= image && (const char*)array < image + cpuSynapseImageSize[netId];
+}
+
+// builds the pre-synaptic neuron id and the delay of each synapse, in the order of the pre-synaptic lists, and the
+// bitmap of the recent spikes for the pull-based spike delivery (see setCPUSpikeDelivery)
+void SNN::allocatePullDelivery_CPU(int netId) {
+	cpuPullDelivery[netId] = (cpuSpikeDeliveryMode_ == SPIKE_DELIVERY_PULL);
+	if (cpuSpikeDeliveryMode_ == SPIKE_DELIVERY_PUSH)
+		return;
+
+	int maxDelay = networkConfigs[netId].maxDelay;
+	assert(maxDelay <= 256);
+	runtimeData[netId].preSynapticNIds = new int[networkConfigs[netId].numPreSynNet];
+	runtimeData[netId].preSynapticDelays = new unsigned char[networkConfigs[netId].numPreSynNet];
+	runtimeData[netId].recentSpikeBits = new unsigned int[(networkConfigs[netId].numNAssigned / 32 + 1) * maxDelay];
+
+	for (int lNIdPre = 0; lNIdPre < networkConfigs[netId].numNAssigned; lNIdPre++) {
+		unsigned int offset = runtimeData[netId].cumulativePost[lNIdPre];
+		for (int tD = 0; tD < maxDelay; tD++) {
+			DelayInfo dPar = runtimeData[netId].postDelayInfo[lNIdPre * (maxDelay + 1) + tD];
+			for (int idx_d = dPar.delay_index_start; idx_d < dPar.delay_index_start + dPar.delay_length; idx_d++) {
+				int postNId, synId;
+				if (networkConfigs[netId].withPackedSynapseIds) {
+					unsigned int postInfo = runtimeData[netId].postSynapticIdsPacked[offset + idx_d];
+					postNId = GET_PACKED_CONN_NEURON_ID(postInfo, networkConfigs[netId].packedNeuronIdBits);
+					synId = GET_PACKED_CONN_SYN_ID(postInfo, networkConfigs[netId].packedNeuronIdBits);
+				} else {
+					postNId = GET_CONN_NEURON_ID(runtimeData[netId].postSynapticIds[offset + idx_d]);
+					synId = GET_CONN_SYN_ID(runtimeData[netId].postSynapticIds[offset + idx_d]);
+				}
+
+				unsigned int pos = runtimeData[netId].cumulativePre[postNId] + synId;
+				runtimeData[netId].preSynapticNIds[pos] = lNIdPre;
+				runtimeData[netId].preSynapticDelays[pos] = tD;
+			}
+		}
+	}
+}
 
 void SNN::allocateSNN_CPU(int netId) {
 	// setup memory type of CPU runtime data
@@ -1276,6 +2545,14 @@ void SNN::allocateSNN_CPU(int netId) {
 	//KERNEL_INFO("Random Gen:\t\t%2.3f MB\t%2.3f MB\t%2.3f MB",(float)(previous-avail)/toMB, (float)((total-avail)/toMB),(float)(avail/toMB));
 	//previous=avail;
 
+	// the storage order of the neurons, which the copy functions below follow
+	computeNeuronOrder_CPU(netId);
+
+	// the synapses of a network found in the network cache are mapped from the synapse image of the runtime, the copy
+	// functions below skip the mapped arrays
+	if (networkCacheFID_ != NULL && mapSynapseImage_CPU(netId, getSynapseImageFileName(netId)))
+		KERNEL_DEBUG("Mapped the synapses of CPU %d Runtime from the network cache", netId - CPU_RUNTIME_BASE);
+
 
 	// initialize (copy from SNN) runtimeData[0].Npre, runtimeData[0].Npre_plastic, runtimeData[0].Npre_plasticInv, runtimeData[0].cumulativePre
 	// initialize (copy from SNN) runtimeData[0].cumulativePost, runtimeData[0].Npost, runtimeData[0].postDelayInfo
@@ -1317,6 +2594,9 @@ void SNN::allocateSNN_CPU(int netId) {
 	// initialize (copy from managerRuntimeData) runtimeData[0].nSpikeCnt,
 	// initialize (copy from SNN) runtimeData[0].synSpikeTime, runtimeData[0].lastSpikeTime
 	copyAuxiliaryData(netId, ALL, &runtimeData[netId], true);
+
+	// initialize runtimeData[0].preSynapticNIds, runtimeData[0].preSynapticDelays, runtimeData[0].recentSpikeBits
+	allocatePullDelivery_CPU(netId);
 	//KERNEL_INFO("Auxiliary Data:\t\t%2.3f MB\t%2.3f MB\t%2.3f MB\n\n",(float)(previous-avail)/toMB,(float)((total-avail)/toMB), (float)(avail/toMB));
 	//previous=avail;
 
@@ -1366,6 +2646,27 @@ void SNN::allocateSNN_CPU(int netId) {
 	runtimeData[netId].allocated = true;
 }
 
+	// Static multithreading subroutine method - helper for the above method
+	// Note: this task runs on the worker thread that executes the CPU runtime, so that all runtime data is allocated
+	// and first touched (copied) on the NUMA node of that worker. The node is recorded for the setup report.
+	void* SNN::helperAllocateSNN_CPU(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		SNN* snn = (SNN *)args->snn_pointer;
+		snn->allocateSNN_CPU(args->netId);
+		snn->cpuRuntimeNumaNode[args->netId] = getCurrentNumaNode();
+		return NULL;
+	}
+
+// returns the NUMA node of the core the calling thread is running on, or -1 if it cannot be determined
+int SNN::getCurrentNumaNode() {
+#if defined(__linux__) && defined(SYS_getcpu)
+	unsigned int cpu, node;
+	if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+		return (int)node;
+#endif
+	return -1;
+}
+
 /*!
  * \brief this function allocates memory sapce and copies information of pre-connections to it
  *
@@ -1386,6 +2687,8 @@ void SNN::allocateSNN_CPU(int netId) {
 */
 void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem) {
 	int lengthN, lengthSyn, posN, posSyn;
+	bool toRuntime = (src == &managerRuntimeData);
+	const std::vector<int>& runtimeNId = cpuRuntimeNId[netId];
 
 	if (lGrpId == ALL) {
 		lengthN = networkConfigs[netId].numNAssigned;
@@ -1395,17 +2698,22 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 		posN = groupConfigs[netId][lGrpId].lStartN;
 	}
 
+	// the arrays mapped from the network cache already hold the synapses (see mapSynapseImage_CPU)
+	bool mapped = isMappedArray_CPU(netId, dest->Npre);
+
 	// connection synaptic lengths and cumulative lengths...
-	if(allocateMem) 
-		dest->Npre = new unsigned short[networkConfigs[netId].numNAssigned];
-	memcpy(&dest->Npre[posN], &src->Npre[posN], sizeof(short) * lengthN);
+	if (!mapped) {
+		if(allocateMem) 
+			dest->Npre = new unsigned short[networkConfigs[netId].numNAssigned];
+		copyNeurons(dest->Npre, src->Npre, runtimeNId, posN, lengthN, 1, toRuntime);
+	}
 
 	// we don't need these data structures if the network doesn't have any plastic synapses at all
 	if (!sim_with_fixedwts) {
 		// presyn excitatory connections
 		if(allocateMem)
 			dest->Npre_plastic = new unsigned short[networkConfigs[netId].numNAssigned];
-		memcpy(&dest->Npre_plastic[posN], &src->Npre_plastic[posN], sizeof(short) * lengthN);
+		copyNeurons(dest->Npre_plastic, src->Npre_plastic, runtimeNId, posN, lengthN, 1, toRuntime);
 
 		// Npre_plasticInv is only used on GPUs, only allocate and copy it during initialization
 		if(allocateMem) {
@@ -1415,32 +2723,74 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
 				Npre_plasticInv[i] = 1.0f / managerRuntimeData.Npre_plastic[i];
 
 			dest->Npre_plasticInv = new float[networkConfigs[netId].numNAssigned];
-			memcpy(dest->Npre_plasticInv, Npre_plasticInv, sizeof(float) * networkConfigs[netId].numNAssigned);
+			copyNeurons(dest->Npre_plasticInv, Npre_plasticInv, runtimeNId, 0, networkConfigs[netId].numNAssigned, 1, true);
 
 			delete[] Npre_plasticInv;
 		}
+
+		// plastic synapses come first in the pre-synaptic list of a neuron, CPU runtimes keep wtChange, maxSynWt and
+		// synSpikeTime for those synapses only, see copyPlasticSynapses()
+		if (allocateMem) {
+			dest->cumulativePrePlastic = new unsigned int[networkConfigs[netId].numNAssigned];
+			networkConfigs[netId].numPreSynPlasticNet = 0;
+			for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) {
+				dest->cumulativePrePlastic[lNId] = networkConfigs[netId].numPreSynPlasticNet;
+				networkConfigs[netId].numPreSynPlasticNet += dest->Npre_plastic[lNId];
+			}
+		}
 	}
 
 	// beginning position for the pre-synaptic information
-	if(allocateMem)
-		dest->cumulativePre = new unsigned int[networkConfigs[netId].numNAssigned];
-	memcpy(&dest->cumulativePre[posN], &src->cumulativePre[posN], sizeof(int) * lengthN);
+	if (!mapped) {
+		if(allocateMem)
+			dest->cumulativePre = new unsigned int[networkConfigs[netId].numNAssigned];
+		copyNeurons(dest->cumulativePre, src->cumulativePre, runtimeNId, posN, lengthN, 1, toRuntime);
+	}
 
 	// Npre, cumulativePre has been copied to destination
+	// the synapses of a group start at its first neuron in the order of the manager
+	RuntimeData* manager = toRuntime ? src : dest;
 	if (lGrpId == ALL) {
 		lengthSyn = networkConfigs[netId].numPreSynNet;
 		posSyn = 0;
 	} else {
 		lengthSyn = 0;
 		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++)
-			lengthSyn += dest->Npre[lNId];
+			lengthSyn += manager->Npre[lNId];
+
+		posSyn = manager->cumulativePre[groupConfigs[netId][lGrpId].lStartN];
+	}
 
-		posSyn = dest->cumulativePre[groupConfigs[netId][lGrpId].lStartN];
+	// with packed synapse ids, the CPU runtime does not store the pre-synaptic ids (neuron id, index of the synapse in
+	// the post-synaptic list of the neuron, group id), they are restored from the post-synaptic ids
+	if (networkConfigs[netId].withPackedSynapseIds) {
+		if (!allocateMem) {
+			assert(dest == &managerRuntimeData);
+			int nBits = networkConfigs[netId].packedNeuronIdBits;
+			const std::vector<int>& managerNId = cpuManagerNId[netId];
+			for (int lNIdPre = 0; lNIdPre < networkConfigs[netId].numNAssigned; lNIdPre++) {
+				for (int idx = 0; idx < src->Npost[lNIdPre]; idx++) {
+					unsigned int postInfo = src->postSynapticIdsPacked[src->cumulativePost[lNIdPre] + idx];
+					int lNIdPost = mapNeuronId(managerNId, GET_PACKED_CONN_NEURON_ID(postInfo, nBits));
+					if (lNIdPost < posN || lNIdPost >= posN + lengthN)
+						continue;
+
+					SynInfo* preId = &dest->preSynapticIds[dest->cumulativePre[lNIdPost] + GET_PACKED_CONN_SYN_ID(postInfo, nBits)];
+					preId->gsId = (src->grpIds[lNIdPre] << NUM_SYNAPSE_BITS) | idx;
+					preId->nId = mapNeuronId(managerNId, lNIdPre);
+				}
+			}
+		}
+		return;
 	}
 
+	if (mapped)
+		return;
+
 	if(allocateMem)
 		dest->preSynapticIds = new SynInfo[networkConfigs[netId].numPreSynNet];
 	memcpy(&dest->preSynapticIds[posSyn], &src->preSynapticIds[posSyn], sizeof(SynInfo) * lengthSyn);
+	mapSynapseNeuronIds(dest->preSynapticIds, posSyn, lengthSyn, toRuntime ? runtimeNId : cpuManagerNId[netId]);
 }
 
 /*!
@@ -1461,6 +2811,9 @@ void SNN::copyPreConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runtim
  */
 void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, RuntimeData* src, bool allocateMem) {
 	int lengthN, lengthSyn, posN, posSyn;
+	bool toRuntime = (src == &managerRuntimeData);
+	const std::vector<int>& runtimeNId = cpuRuntimeNId[netId];
+	const std::vector<int>& managerNId = cpuManagerNId[netId];
 
 	if (lGrpId == ALL) {
 		lengthN = networkConfigs[netId].numNAssigned;
@@ -1470,38 +2823,64 @@ void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runti
 		posN = groupConfigs[netId][lGrpId].lStartN;
 	}
 
+	// the arrays mapped from the network cache already hold the synapses (see mapSynapseImage_CPU)
+	if (isMappedArray_CPU(netId, dest->Npost))
+		return;
+
 	// number of postsynaptic connections
 	if(allocateMem)
 		dest->Npost = new unsigned short[networkConfigs[netId].numNAssigned];
-	memcpy(&dest->Npost[posN], &src->Npost[posN], sizeof(short) * lengthN);
+	copyNeurons(dest->Npost, src->Npost, runtimeNId, posN, lengthN, 1, toRuntime);
 
 	// beginning position for the post-synaptic information
 	if(allocateMem)
 		dest->cumulativePost = new unsigned int[networkConfigs[netId].numNAssigned];
-	memcpy(&dest->cumulativePost[posN], &src->cumulativePost[posN], sizeof(int) * lengthN);
+	copyNeurons(dest->cumulativePost, src->cumulativePost, runtimeNId, posN, lengthN, 1, toRuntime);
 
 
 	// Npost, cumulativePost has been copied to destination
+	// the synapses of a group start at its first neuron in the order of the manager
+	RuntimeData* manager = toRuntime ? src : dest;
 	if (lGrpId == ALL) {
 		lengthSyn = networkConfigs[netId].numPostSynNet;
 		posSyn = 0;
 	} else {
 		lengthSyn = 0;
 		for (int lNId = groupConfigs[netId][lGrpId].lStartN; lNId <= groupConfigs[netId][lGrpId].lEndN; lNId++)
-			lengthSyn += dest->Npost[lNId];
+			lengthSyn += manager->Npost[lNId];
 
-		posSyn = dest->cumulativePost[groupConfigs[netId][lGrpId].lStartN];
+		posSyn = manager->cumulativePost[groupConfigs[netId][lGrpId].lStartN];
 	}
 
 	// actual post synaptic connection information...
-	if(allocateMem)
-		dest->postSynapticIds = new SynInfo[networkConfigs[netId].numPostSynNet];
-	memcpy(&dest->postSynapticIds[posSyn], &src->postSynapticIds[posSyn], sizeof(SynInfo) * lengthSyn);
+	if (networkConfigs[netId].withPackedSynapseIds) {
+		// the CPU runtime packs the neuron id and the synapse id into 32 bits, the group id is that of the neuron
+		int nBits = networkConfigs[netId].packedNeuronIdBits;
+		if (allocateMem) {
+			dest->postSynapticIdsPacked = new unsigned int[networkConfigs[netId].numPostSynNet];
+			for (int i = posSyn; i < posSyn + lengthSyn; i++)
+				dest->postSynapticIdsPacked[i] = SET_PACKED_CONN_ID(mapNeuronId(runtimeNId,
+					GET_CONN_NEURON_ID(src->postSynapticIds[i])), GET_CONN_SYN_ID(src->postSynapticIds[i]), nBits);
+		} else {
+			assert(dest == &managerRuntimeData);
+			for (int i = posSyn; i < posSyn + lengthSyn; i++) {
+				int lNIdPost = GET_PACKED_CONN_NEURON_ID(src->postSynapticIdsPacked[i], nBits);
+				dest->postSynapticIds[i].gsId = (src->grpIds[lNIdPost] << NUM_SYNAPSE_BITS)
+					| GET_PACKED_CONN_SYN_ID(src->postSynapticIdsPacked[i], nBits);
+				dest->postSynapticIds[i].nId = mapNeuronId(managerNId, lNIdPost);
+			}
+		}
+	} else {
+		if(allocateMem)
+			dest->postSynapticIds = new SynInfo[networkConfigs[netId].numPostSynNet];
+		memcpy(&dest->postSynapticIds[posSyn], &src->postSynapticIds[posSyn], sizeof(SynInfo) * lengthSyn);
+		mapSynapseNeuronIds(dest->postSynapticIds, posSyn, lengthSyn, toRuntime ? runtimeNId : managerNId);
+	}
 
 	// static specific mapping and actual post-synaptic delay metric
 	if(allocateMem)
 		dest->postDelayInfo = new DelayInfo[networkConfigs[netId].numNAssigned * (glbNetworkConfig.maxDelay + 1)];
-	memcpy(&dest->postDelayInfo[posN * (glbNetworkConfig.maxDelay + 1)], &src->postDelayInfo[posN * (glbNetworkConfig.maxDelay + 1)], sizeof(DelayInfo) * lengthN * (glbNetworkConfig.maxDelay + 1));
+	copyNeurons(dest->postDelayInfo, src->postDelayInfo, runtimeNId, posN, lengthN, glbNetworkConfig.maxDelay + 1, toRuntime);
 }
 
 /*!
@@ -1522,24 +2901,156 @@ void SNN::copyPostConnectionInfo(int netId, int lGrpId, RuntimeData* dest, Runti
 void SNN::copySynapseState(int netId, RuntimeData* dest, RuntimeData* src, bool allocateMem) {
 	assert(networkConfigs[netId].numPreSynNet > 0);
 
+	// the weights mapped from the network cache already hold the synapses (see mapSynapseImage_CPU)
+	bool mappedWeights = isMappedArray_CPU(netId, dest->wt) || isMappedArray_CPU(netId, dest->wtHalf)
+		|| isMappedArray_CPU(netId, dest->wtInt8);
+
 	// synaptic information based
-	if(allocateMem)
-		dest->wt = new float[networkConfigs[netId].numPreSynNet];
-	memcpy(dest->wt, src->wt, sizeof(float) * networkConfigs[netId].numPreSynNet);
+	if (allocateMem) {
+		switch (networkConfigs[netId].synWeightFormat) {
+		case SYN_WEIGHT_HALF:
+			if (!mappedWeights)
+				dest->wtHalf = new unsigned short[networkConfigs[netId].numPreSynNet];
+			break;
+		case SYN_WEIGHT_INT8:
+			// one int8 step of a connection is 1/127 of its maximum weight
+			if (!mappedWeights)
+				dest->wtInt8 = new signed char[networkConfigs[netId].numPreSynNet];
+			dest->wtScale = new float[networkConfigs[netId].numConnections];
+			for (int connId = 0; connId < networkConfigs[netId].numConnections; connId++)
+				dest->wtScale[connId] = getInt8WeightScale(connectConfigMap[connId].maxWt);
+			break;
+		default:
+			if (!mappedWeights)
+				dest->wt = new float[networkConfigs[netId].numPreSynNet];
+			break;
+		}
+	}
+	if (!mappedWeights)
+		copySynapseWeights(netId, dest, src, 0, networkConfigs[netId].numPreSynNet);
 
 	// we don't need these data structures if the network doesn't have any plastic synapses at all
 	// they show up in updateLTP() and updateSynapticWeights(), two functions that do not get called if
 	// sim_with_fixedwts is set
 	if (!sim_with_fixedwts) {
+		// the runtime only stores them for plastic synapses
+		bool toRuntime = (src == &managerRuntimeData);
+		int lastNId = networkConfigs[netId].numNAssigned - 1;
+
 		// synaptic weight derivative
 		if(allocateMem)
-			dest->wtChange = new float[networkConfigs[netId].numPreSynNet];
-		memcpy(dest->wtChange, src->wtChange, sizeof(float) * networkConfigs[netId].numPreSynNet);
+			dest->wtChange = new float[networkConfigs[netId].numPreSynPlasticNet];
+		copyPlasticSynapses(dest->wtChange, src->wtChange, &runtimeData[netId], 0, lastNId, toRuntime);
 
 		// synaptic weight maximum value
 		if(allocateMem)
-			dest->maxSynWt = new float[networkConfigs[netId].numPreSynNet];
-		memcpy(dest->maxSynWt, src->maxSynWt, sizeof(float) * networkConfigs[netId].numPreSynNet);
+			dest->maxSynWt = new float[networkConfigs[netId].numPreSynPlasticNet];
+		copyPlasticSynapses(dest->maxSynWt, src->maxSynWt, &runtimeData[netId], 0, lastNId, toRuntime);
+	}
+}
+
+/*!
+ * \brief this function copies the maximum synaptic weights of a neuron from the manager to its CPU runtime
+ *
+ * Used after biasWeights, scaleWeights, or setWeight changed maxSynWt in the manager.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] lNId the local id of the post-synaptic neuron
+ *
+ * \sa copySynapseState
+ * \since v4.0
+ */
+void SNN::copyMaxSynapseWeights(int netId, int lNId) {
+	assert(runtimeData[netId].maxSynWt != NULL);
+	int rNId = mapNeuronId(cpuRuntimeNId[netId], lNId);
+	copyPlasticSynapses(runtimeData[netId].maxSynWt, managerRuntimeData.maxSynWt, &runtimeData[netId], rNId, rNId, true);
+}
+
+/*!
+ * \brief this function enlarges the int8 weight step of a connection to a new maximum weight
+ *
+ * With SYN_WEIGHT_INT8, the weights of a connection are stored in steps of 1/127 of its maximum weight (see
+ * copySynapseState). setWeight, biasWeights, and scaleWeights may raise the maximum weight (updateWeightRange), the
+ * step is then enlarged and the weights of the post-synaptic group are rounded again from the manager, so that the
+ * raised weights are not capped at the old maximum. The step never shrinks.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] connId the id of the connection
+ * \param[in] maxWt the maximum weight of the connection
+ *
+ * \sa copySynapseWeights
+ * \since v4.0
+ */
+void SNN::updateWeightScale_CPU(int netId, short int connId, float maxWt) {
+	if (networkConfigs[netId].synWeightFormat != SYN_WEIGHT_INT8)
+		return;
+
+	float wtScale = getInt8WeightScale(maxWt);
+	if (wtScale <= runtimeData[netId].wtScale[connId])
+		return;
+	runtimeData[netId].wtScale[connId] = wtScale;
+
+	// the synapses of the post-synaptic group are stored contiguously, in the order of the manager
+	int lGrpId = groupConfigMDMap[connectConfigMap[connId].grpDest].lGrpId;
+	int lStartN = groupConfigs[netId][lGrpId].lStartN;
+	int lEndN = groupConfigs[netId][lGrpId].lEndN;
+	int posSyn = managerRuntimeData.cumulativePre[lStartN];
+	int lengthSyn = managerRuntimeData.cumulativePre[lEndN] + managerRuntimeData.Npre[lEndN] - posSyn;
+	copySynapseWeights(netId, &runtimeData[netId], &managerRuntimeData, posSyn, lengthSyn);
+}
+
+/*!
+ * \brief this function copies synaptic weights between the manager and a CPU runtime
+ *
+ * The manager stores the weights as float, a CPU runtime in the weight format of its compact synapse storage (see
+ * setCPUCompactSynapses). Weights copied to the runtime are rounded to that format, those copied from the runtime are
+ * converted back to float.
+ *
+ * \param[in] netId the id of a local network, which is the same as the Core (CPU) id
+ * \param[in] dest pointer to runtime data desitnation
+ * \param[in] src pointer to runtime data source
+ * \param[in] posSyn the index of the first synapse to be copied
+ * \param[in] lengthSyn the number of synapses to be copied
+ *
+ * \sa copySynapseState
+ * \since v4.0
+ */
+void SNN::copySynapseWeights(int netId, RuntimeData* dest, RuntimeData* src, int posSyn, int lengthSyn) {
+	SynWeightFormat format = networkConfigs[netId].synWeightFormat;
+
+	// the weights mapped from the network cache are read-only, the runtime gets its own copy before they change
+	if (src == &managerRuntimeData) {
+		int numPreSyn = networkConfigs[netId].numPreSynNet;
+		if (isMappedArray_CPU(netId, dest->wt))
+			copyMappedArray(dest->wt, numPreSyn);
+		if (isMappedArray_CPU(netId, dest->wtHalf))
+			copyMappedArray(dest->wtHalf, numPreSyn);
+		if (isMappedArray_CPU(netId, dest->wtInt8))
+			copyMappedArray(dest->wtInt8, numPreSyn);
+	}
+
+	if (format == SYN_WEIGHT_FLOAT) {
+		memcpy(&dest->wt[posSyn], &src->wt[posSyn], sizeof(float) * lengthSyn);
+		return;
+	}
+
+	if (src == &managerRuntimeData) {
+		for (int i = posSyn; i < posSyn + lengthSyn; i++) {
+			if (format == SYN_WEIGHT_HALF) {
+				dest->wtHalf[i] = floatToHalf(src->wt[i]);
+			} else {
+				float q = src->wt[i] / dest->wtScale[src->connIdsPreIdx[i]];
+				dest->wtInt8[i] = (signed char)std::max(-127.0f, std::min(127.0f, floorf(q + 0.5f)));
+			}
+		}
+	} else {
+		assert(dest == &managerRuntimeData);
+		for (int i = posSyn; i < posSyn + lengthSyn; i++) {
+			if (format == SYN_WEIGHT_HALF)
+				dest->wt[i] = halfToFloat(src->wtHalf[i]);
+			else
+				dest->wt[i] = src->wtInt8[i] * src->wtScale[src->connIdsPreIdx[i]];
+		}
 	}
 }
 
@@ -1581,21 +3092,21 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocat
 
 	if(allocateMem)
 		dest->recovery = new float[length];
-	memcpy(&dest->recovery[ptrPos], &managerRuntimeData.recovery[ptrPos], sizeof(float) * length);
+	copyNeurons(dest->recovery, managerRuntimeData.recovery, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if(allocateMem)
 		dest->voltage = new float[length];
-	memcpy(&dest->voltage[ptrPos], &managerRuntimeData.voltage[ptrPos], sizeof(float) * length);
+	copyNeurons(dest->voltage, managerRuntimeData.voltage, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if (allocateMem)
 
 		dest->nextVoltage = new float[length];
-	memcpy(&dest->nextVoltage[ptrPos], &managerRuntimeData.nextVoltage[ptrPos], sizeof(float) * length);
+	copyNeurons(dest->nextVoltage, managerRuntimeData.nextVoltage, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	//neuron input current...
 	if(allocateMem)
 		dest->current = new float[length];
-	memcpy(&dest->current[ptrPos], &managerRuntimeData.current[ptrPos], sizeof(float) * length);
+	copyNeurons(dest->current, managerRuntimeData.current, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if (sim_with_conductances) {
 		//conductance information
@@ -1603,15 +3114,28 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocat
 		copyConductanceNMDA(netId, lGrpId, dest, &managerRuntimeData, allocateMem, 0);
 		copyConductanceGABAa(netId, lGrpId, dest, &managerRuntimeData, allocateMem, 0);
 		copyConductanceGABAb(netId, lGrpId, dest, &managerRuntimeData, allocateMem, 0);
+
+		// all neurons start active, the lazy conductance decay clears the bits of the neurons whose conductances have vanished
+		if (allocateMem) {
+			dest->condActiveBits = new unsigned int[networkConfigs[netId].numNReg / 32 + 1];
+			memset(dest->condActiveBits, 0, sizeof(int) * (networkConfigs[netId].numNReg / 32 + 1));
+		}
+		for (int lNId = ptrPos; lNId < ptrPos + length; lNId++)
+			dest->condActiveBits[lNId / 32] |= 1u << (lNId % 32);
 	}
 
 	// copying external current needs to be done separately because setExternalCurrent needs to call it, too
 	// do it only from host to device
 	copyExternalCurrent(netId, lGrpId, dest, allocateMem);
 
-	if (allocateMem)
-		dest->curSpike = new bool[length];
-	memcpy(&dest->curSpike[ptrPos], &managerRuntimeData.curSpike[ptrPos], sizeof(bool) * length);
+	// no neuron has fired yet
+	if (allocateMem) {
+		dest->curSpikeBits = new unsigned int[networkConfigs[netId].numNReg / 32 + 1];
+		memset(dest->curSpikeBits, 0, sizeof(int) * (networkConfigs[netId].numNReg / 32 + 1));
+	} else {
+		for (int lNId = ptrPos; lNId < ptrPos + length; lNId++)
+			dest->curSpikeBits[lNId / 32] &= ~(1u << (lNId % 32));
+	}
 
 	copyNeuronParameters(netId, lGrpId, dest, allocateMem);
 
@@ -1620,7 +3144,7 @@ void SNN::copyNeuronState(int netId, int lGrpId, RuntimeData* dest, bool allocat
 		// Avg. Firing...
 		if(allocateMem)
 			dest->avgFiring = new float[length];
-		memcpy(&dest->avgFiring[ptrPos], &managerRuntimeData.avgFiring[ptrPos], sizeof(float) * length);
+		copyNeurons(dest->avgFiring, managerRuntimeData.avgFiring, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 	}
 }
 
@@ -1646,6 +3170,7 @@ void SNN::copyConductanceAMPA(int netId, int lGrpId, RuntimeData* dest, RuntimeD
 	assert(isSimulationWithCOBA());
 
 	int ptrPos, length;
+	bool toRuntime = (src == &managerRuntimeData);
 
 	if(lGrpId == ALL) {
 		ptrPos = 0;
@@ -1661,7 +3186,7 @@ void SNN::copyConductanceAMPA(int netId, int lGrpId, RuntimeData* dest, RuntimeD
 	assert(src->gAMPA  != NULL);
 	if(allocateMem)
 		dest->gAMPA = new float[length];
-	memcpy(&dest->gAMPA[ptrPos + destOffset], &src->gAMPA[ptrPos], sizeof(float) * length);
+	copyNeurons(dest->gAMPA + destOffset, src->gAMPA, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 }
 
 /*!
@@ -1686,6 +3211,7 @@ void SNN::copyConductanceNMDA(int netId, int lGrpId, RuntimeData* dest, RuntimeD
 	assert(isSimulationWithCOBA());
 
 	int ptrPos, length;
+	bool toRuntime = (src == &managerRuntimeData);
 
 	if(lGrpId == ALL) {
 		ptrPos  = 0;
@@ -1701,17 +3227,17 @@ void SNN::copyConductanceNMDA(int netId, int lGrpId, RuntimeData* dest, RuntimeD
 		assert(src->gNMDA_r != NULL);
 		if(allocateMem)
 			dest->gNMDA_r = new float[length];
-		memcpy(&dest->gNMDA_r[ptrPos], &src->gNMDA_r[ptrPos], sizeof(float) * length);
+		copyNeurons(dest->gNMDA_r, src->gNMDA_r, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 
 		assert(src->gNMDA_d != NULL);
 		if(allocateMem)
 			dest->gNMDA_d = new float[length];
-		memcpy(&dest->gNMDA_d[ptrPos], &src->gNMDA_d[ptrPos], sizeof(float) * length);
+		copyNeurons(dest->gNMDA_d, src->gNMDA_d, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 	} else {
 		assert(src->gNMDA != NULL);
 		if(allocateMem)
 			dest->gNMDA = new float[length];
-		memcpy(&dest->gNMDA[ptrPos + destOffset], &src->gNMDA[ptrPos], sizeof(float) * length);
+		copyNeurons(dest->gNMDA + destOffset, src->gNMDA, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 	}
 }
 
@@ -1737,6 +3263,7 @@ void SNN::copyConductanceGABAa(int netId, int lGrpId, RuntimeData* dest, Runtime
 	assert(isSimulationWithCOBA());
 
 	int ptrPos, length;
+	bool toRuntime = (src == &managerRuntimeData);
 
 	if(lGrpId == ALL) {
 		ptrPos  = 0;
@@ -1751,7 +3278,7 @@ void SNN::copyConductanceGABAa(int netId, int lGrpId, RuntimeData* dest, Runtime
 	assert(src->gGABAa != NULL);
 	if(allocateMem)
 		dest->gGABAa = new float[length];
-	memcpy(&dest->gGABAa[ptrPos + destOffset], &src->gGABAa[ptrPos], sizeof(float) * length);
+	copyNeurons(dest->gGABAa + destOffset, src->gGABAa, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 }
 
 /*!
@@ -1776,6 +3303,7 @@ void SNN::copyConductanceGABAb(int netId, int lGrpId, RuntimeData* dest, Runtime
 	assert(isSimulationWithCOBA());
 
 	int ptrPos, length;
+	bool toRuntime = (src == &managerRuntimeData);
 
 	if (lGrpId == ALL) {
 		ptrPos  = 0;
@@ -1791,17 +3319,17 @@ void SNN::copyConductanceGABAb(int netId, int lGrpId, RuntimeData* dest, Runtime
 		assert(src->gGABAb_r != NULL);
 		if(allocateMem)
 			dest->gGABAb_r = new float[length];
-		memcpy(&dest->gGABAb_r[ptrPos], &src->gGABAb_r[ptrPos], sizeof(float) * length);
+		copyNeurons(dest->gGABAb_r, src->gGABAb_r, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 
 		assert(src->gGABAb_d != NULL);
 		if(allocateMem)
 			dest->gGABAb_d = new float[length];
-		memcpy(&dest->gGABAb_d[ptrPos], &src->gGABAb_d[ptrPos], sizeof(float) * length);
+		copyNeurons(dest->gGABAb_d, src->gGABAb_d, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 	} else {
 		assert(src->gGABAb != NULL);
 		if(allocateMem)
 			dest->gGABAb = new float[length];
-		memcpy(&dest->gGABAb[ptrPos + destOffset], &src->gGABAb[ptrPos], sizeof(float) * length);
+		copyNeurons(dest->gGABAb + destOffset, src->gGABAb, cpuRuntimeNId[netId], ptrPos, length, 1, toRuntime);
 	}
 }
 
@@ -1839,7 +3367,7 @@ void SNN::copyExternalCurrent(int netId, int lGrpId, RuntimeData* dest, bool all
 
 	if(allocateMem)
 		dest->extCurrent = new float[lengthN];
-	memcpy(&(dest->extCurrent[posN]), &(managerRuntimeData.extCurrent[posN]), sizeof(float) * lengthN);
+	copyNeurons(dest->extCurrent, managerRuntimeData.extCurrent, cpuRuntimeNId[netId], posN, lengthN, 1, true);
 }
 
 /*!
@@ -1888,57 +3416,57 @@ void SNN::copyNeuronParameters(int netId, int lGrpId, RuntimeData* dest, bool al
 
 	if(allocateMem)
 		dest->Izh_a = new float[length];
-	memcpy(&dest->Izh_a[ptrPos], &(managerRuntimeData.Izh_a[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_a, managerRuntimeData.Izh_a, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if(allocateMem)
 		dest->Izh_b = new float[length];
-	memcpy(&dest->Izh_b[ptrPos], &(managerRuntimeData.Izh_b[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_b, managerRuntimeData.Izh_b, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if(allocateMem)
 		dest->Izh_c = new float[length];
-	memcpy(&dest->Izh_c[ptrPos], &(managerRuntimeData.Izh_c[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_c, managerRuntimeData.Izh_c, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if(allocateMem)
 		dest->Izh_d = new float[length];
-	memcpy(&dest->Izh_d[ptrPos], &(managerRuntimeData.Izh_d[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_d, managerRuntimeData.Izh_d, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if (allocateMem)
 		dest->Izh_C = new float[length];
-	memcpy(&dest->Izh_C[ptrPos], &(managerRuntimeData.Izh_C[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_C, managerRuntimeData.Izh_C, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if (allocateMem)
 		dest->Izh_k = new float[length];
-	memcpy(&dest->Izh_k[ptrPos], &(managerRuntimeData.Izh_k[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_k, managerRuntimeData.Izh_k, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if (allocateMem)
 		dest->Izh_vr = new float[length];
-	memcpy(&dest->Izh_vr[ptrPos], &(managerRuntimeData.Izh_vr[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_vr, managerRuntimeData.Izh_vr, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if (allocateMem)
 		dest->Izh_vt = new float[length];
-	memcpy(&dest->Izh_vt[ptrPos], &(managerRuntimeData.Izh_vt[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_vt, managerRuntimeData.Izh_vt, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	if (allocateMem)
 		dest->Izh_vpeak = new float[length];
-	memcpy(&dest->Izh_vpeak[ptrPos], &(managerRuntimeData.Izh_vpeak[ptrPos]), sizeof(float) * length);
+	copyNeurons(dest->Izh_vpeak, managerRuntimeData.Izh_vpeak, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 	// pre-compute baseFiringInv for fast computation on CPU cores
 	if (sim_with_homeostasis) {
-		float* baseFiringInv = new float[length];
-		for(int nid = 0; nid < length; nid++) {
+		float* baseFiringInv = new float[ptrPos + length];
+		for(int nid = ptrPos; nid < ptrPos + length; nid++) {
 			if (managerRuntimeData.baseFiring[nid] != 0.0f)
-				baseFiringInv[nid] = 1.0f / managerRuntimeData.baseFiring[ptrPos + nid];
+				baseFiringInv[nid] = 1.0f / managerRuntimeData.baseFiring[nid];
 			else
 				baseFiringInv[nid] = 0.0;
 		}
 
 		if(allocateMem)
 			dest->baseFiringInv = new float[length];
-		memcpy(&dest->baseFiringInv[ptrPos], baseFiringInv, sizeof(float) * length);
+		copyNeurons(dest->baseFiringInv, baseFiringInv, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 		if(allocateMem)
 			dest->baseFiring = new float[length];
-		memcpy(&dest->baseFiring[ptrPos], managerRuntimeData.baseFiring, sizeof(float) * length);
+		copyNeurons(dest->baseFiring, managerRuntimeData.baseFiring, cpuRuntimeNId[netId], ptrPos, length, 1, true);
 
 		delete [] baseFiringInv;
 	}
@@ -1973,13 +3501,18 @@ void SNN::copySTPState(int netId, int lGrpId, RuntimeData* dest, RuntimeData* sr
 	}
 	assert(src->stpu != NULL); assert(src->stpx != NULL);
 
+	// the STP buffer holds maxDelay + 1 values per neuron, see STP_BUF_POS
+	int numN = networkConfigs[netId].numN;
+	int stride = networkConfigs[netId].maxDelay + 1;
+	bool toRuntime = (src == &managerRuntimeData);
+
 	if(allocateMem)
-		dest->stpu = new float[networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1)];
-	memcpy(dest->stpu, src->stpu, sizeof(float) * networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1));
+		dest->stpu = new float[numN * stride];
+	copyNeurons(dest->stpu, src->stpu, cpuRuntimeNId[netId], 0, numN, stride, toRuntime);
 
 	if(allocateMem)
-		dest->stpx = new float[networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1)];
-	memcpy(dest->stpx, src->stpx, sizeof(float) * networkConfigs[netId].numN * (networkConfigs[netId].maxDelay + 1));
+		dest->stpx = new float[numN * stride];
+	copyNeurons(dest->stpx, src->stpx, cpuRuntimeNId[netId], 0, numN, stride, toRuntime);
 }
 
 // ToDo: move grpDA(5HT, ACh, NE)Buffer to copyAuxiliaryData
@@ -2076,16 +3609,30 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 	memset(dest->I_set, 0, sizeof(int) * networkConfigs[netId].numNReg * networkConfigs[netId].I_setLength);
 
 	// synSpikeTime: an array indicates the last time when a synapse got a spike
-	if(allocateMem)
-		dest->synSpikeTime = new int[networkConfigs[netId].numPreSynNet];
-	memcpy(dest->synSpikeTime, managerRuntimeData.synSpikeTime, sizeof(int) * networkConfigs[netId].numPreSynNet);
+	// we don't need it without STDP, it only shows up in updateLTP() and generatePostSynapticSpike(), both of which
+	// only look at plastic synapses
+	if (sim_with_stdp && !sim_with_fixedwts) {
+		if(allocateMem)
+			dest->synSpikeTime = new int[networkConfigs[netId].numPreSynPlasticNet];
+		copyPlasticSynapses(dest->synSpikeTime, managerRuntimeData.synSpikeTime, dest, 0, networkConfigs[netId].numNAssigned - 1, true);
+
+		// event-driven STDP: post-synaptic spikes whose LTP has not been applied to all synapses yet
+		if (cpuEventDrivenSTDP_) {
+			if (allocateMem) {
+				dest->postSpikeHistory = new int[networkConfigs[netId].numNReg * STDP_POST_HISTORY_LENGTH];
+				dest->postSpikeHistoryLength = new unsigned short[networkConfigs[netId].numNReg];
+			}
+			memset(dest->postSpikeHistoryLength, 0, sizeof(short) * networkConfigs[netId].numNReg);
+		}
+	}
 
 	// neural auxiliary data
 	// lastSpikeTime: an array indicates the last time of a neuron emitting a spike
 	// neuron firing time
 	if(allocateMem)
 		dest->lastSpikeTime = new int[networkConfigs[netId].numNAssigned];
-	memcpy(dest->lastSpikeTime, managerRuntimeData.lastSpikeTime, sizeof(int) * networkConfigs[netId].numNAssigned);
+	copyNeurons(dest->lastSpikeTime, managerRuntimeData.lastSpikeTime, cpuRuntimeNId[netId], 0,
+		networkConfigs[netId].numNAssigned, 1, true);
 
 	// auxiliary data for recording spike count of each neuron
 	copyNeuronSpikeCount(netId, lGrpId, dest, &managerRuntimeData, true, 0);
@@ -2093,12 +3640,14 @@ void SNN::copyAuxiliaryData(int netId, int lGrpId, RuntimeData* dest, bool alloc
 	// quick lookup array for local group ids
 	if(allocateMem)
 		dest->grpIds = new short int[networkConfigs[netId].numNAssigned];
-	memcpy(dest->grpIds, managerRuntimeData.grpIds, sizeof(short int) * networkConfigs[netId].numNAssigned);
+	copyNeurons(dest->grpIds, managerRuntimeData.grpIds, cpuRuntimeNId[netId], 0, networkConfigs[netId].numNAssigned, 1, true);
 
-	// quick lookup array for conn ids
-	if(allocateMem)
-		dest->connIdsPreIdx = new short int[networkConfigs[netId].numPreSynNet];
-	memcpy(dest->connIdsPreIdx, managerRuntimeData.connIdsPreIdx, sizeof(short int) * networkConfigs[netId].numPreSynNet);
+	// quick lookup array for conn ids, unless it is mapped from the network cache
+	if (!isMappedArray_CPU(netId, dest->connIdsPreIdx)) {
+		if(allocateMem)
+			dest->connIdsPreIdx = new short int[networkConfigs[netId].numPreSynNet];
+		memcpy(dest->connIdsPreIdx, managerRuntimeData.connIdsPreIdx, sizeof(short int) * networkConfigs[netId].numPreSynNet);
+	}
 
 	// reset variable related to spike count
 	// Note: the GPU counterpart is not required to do this
@@ -2217,15 +3766,12 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 	// spike count information
 	if(allocateMem)
 		dest->nSpikeCnt = new int[lengthN];
-	memcpy(&dest->nSpikeCnt[posN + destOffset], &src->nSpikeCnt[posN], sizeof(int) * lengthN);
+	copyNeurons(dest->nSpikeCnt + destOffset, src->nSpikeCnt, cpuRuntimeNId[netId], posN, lengthN, 1,
+		src == &managerRuntimeData);
 }
 
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::assignPoissonFiringRate_CPU(int netId) {
-#else // POSIX
-	void* SNN::assignPoissonFiringRate_CPU(int netId) {
-#endif
+void SNN::assignPoissonFiringRate_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
 
 	for (int lGrpId = 0; lGrpId < networkConfigs[netId].numGroups; lGrpId++) {
@@ -2248,15 +3794,13 @@ void SNN::copyNeuronSpikeCount(int netId, int lGrpId, RuntimeData* dest, Runtime
 	}
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperAssignPoissonFiringRate_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> assignPoissonFiringRate_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
 /*!
 * \brief this function copy weight state in core (CPU) memory sapce to manager (CPU) memory space
@@ -2293,14 +3837,16 @@ void SNN::copyWeightState(int netId, int lGrpId) {
 	assert(posSyn < networkConfigs[netId].numPreSynNet || networkConfigs[netId].numPreSynNet == 0);
 	assert(lengthSyn <= networkConfigs[netId].numPreSynNet);
 
-	memcpy(&managerRuntimeData.wt[posSyn], &runtimeData[netId].wt[posSyn], sizeof(float) * lengthSyn);
+	copySynapseWeights(netId, &managerRuntimeData, &runtimeData[netId], posSyn, lengthSyn);
 
 	// copy firing time for individual synapses
 	//CUDA_CHECK_ERRORS(cudaMemcpy(&managerRuntimeData.synSpikeTime[cumPos_syn], &runtimeData[netId].synSpikeTime[cumPos_syn], sizeof(int) * length_wt, cudaMemcpyDeviceToHost));
 
-	if ((!sim_with_fixedwts) || sim_with_stdp) {
+	if (!sim_with_fixedwts) {
 		// copy synaptic weight derivative
-		memcpy(&managerRuntimeData.wtChange[posSyn], &runtimeData[netId].wtChange[posSyn], sizeof(float) * lengthSyn);
+		int lStartN = (lGrpId == ALL) ? 0 : groupConfigs[netId][lGrpId].lStartN;
+		int lEndN = (lGrpId == ALL) ? networkConfigs[netId].numNAssigned - 1 : groupConfigs[netId][lGrpId].lEndN;
+		copyPlasticSynapses(managerRuntimeData.wtChange, runtimeData[netId].wtChange, &runtimeData[netId], lStartN, lEndN, false);
 	}
 }
 
@@ -2309,7 +3855,8 @@ void SNN::copyNetworkConfig(int netId) {
 }
 
 void SNN::copyGrpIdsLookupArray(int netId) {
-	memcpy(managerRuntimeData.grpIds, runtimeData[netId].grpIds, sizeof(short int) *  networkConfigs[netId].numNAssigned);
+	copyNeurons(managerRuntimeData.grpIds, runtimeData[netId].grpIds, cpuRuntimeNId[netId], 0,
+		networkConfigs[netId].numNAssigned, 1, false);
 }
 
 void SNN::copyConnIdsLookupArray(int netId) {
@@ -2317,7 +3864,81 @@ void SNN::copyConnIdsLookupArray(int netId) {
 }
 
 void SNN::copyLastSpikeTime(int netId) {
-	memcpy(managerRuntimeData.lastSpikeTime, runtimeData[netId].lastSpikeTime, sizeof(int) *  networkConfigs[netId].numN);
+	copyNeurons(managerRuntimeData.lastSpikeTime, runtimeData[netId].lastSpikeTime, cpuRuntimeNId[netId], 0,
+		networkConfigs[netId].numN, 1, false);
+}
+
+// copies the runtime state of a CPU runtime back to the manager, see saveSimulation
+void SNN::copyRuntimeStateToManager(int netId) {
+	RuntimeData* rt = &runtimeData[netId];
+	int numNReg = networkConfigs[netId].numNReg;
+
+	if (numNReg > 0) {
+		copyNeurons(managerRuntimeData.voltage, rt->voltage, cpuRuntimeNId[netId], 0, numNReg, 1, false);
+		copyNeurons(managerRuntimeData.recovery, rt->recovery, cpuRuntimeNId[netId], 0, numNReg, 1, false);
+		copyNeurons(managerRuntimeData.current, rt->current, cpuRuntimeNId[netId], 0, numNReg, 1, false);
+
+		if (sim_with_conductances) {
+			copyConductanceAMPA(netId, ALL, &managerRuntimeData, rt, false, 0);
+			copyConductanceNMDA(netId, ALL, &managerRuntimeData, rt, false, 0);
+			copyConductanceGABAa(netId, ALL, &managerRuntimeData, rt, false, 0);
+			copyConductanceGABAb(netId, ALL, &managerRuntimeData, rt, false, 0);
+		}
+
+		if (sim_with_homeostasis) {
+			copyNeurons(managerRuntimeData.avgFiring, rt->avgFiring, cpuRuntimeNId[netId], 0, numNReg, 1, false);
+			copyNeurons(managerRuntimeData.baseFiring, rt->baseFiring, cpuRuntimeNId[netId], 0, numNReg, 1, false);
+		}
+	}
+
+	if (sim_with_stp)
+		copySTPState(netId, ALL, &managerRuntimeData, rt, false);
+
+	copyNeurons(managerRuntimeData.lastSpikeTime, rt->lastSpikeTime, cpuRuntimeNId[netId], 0,
+		networkConfigs[netId].numNAssigned, 1, false);
+	copyGroupState(netId, ALL, &managerRuntimeData, rt, false);
+
+	// the runtime stores them for the plastic synapses only, the manager keeps the reset values of the others
+	int lastNId = networkConfigs[netId].numNAssigned - 1;
+	if (rt->wtChange != NULL)
+		copyPlasticSynapses(managerRuntimeData.wtChange, rt->wtChange, rt, 0, lastNId, false);
+	if (rt->synSpikeTime != NULL)
+		copyPlasticSynapses(managerRuntimeData.synSpikeTime, rt->synSpikeTime, rt, 0, lastNId, false);
+}
+
+// copies the post-synaptic spikes of event-driven STDP between the order of the manager and a CPU runtime
+void SNN::copyPostSpikeHistory(int netId, int* history, unsigned short* historyLength, bool toRuntime) {
+	RuntimeData* rt = &runtimeData[netId];
+	int numNReg = networkConfigs[netId].numNReg;
+	assert(rt->postSpikeHistory != NULL);
+
+	if (toRuntime) {
+		copyNeurons(rt->postSpikeHistory, history, cpuRuntimeNId[netId], 0, numNReg, STDP_POST_HISTORY_LENGTH, true);
+		copyNeurons(rt->postSpikeHistoryLength, historyLength, cpuRuntimeNId[netId], 0, numNReg, 1, true);
+	} else {
+		copyNeurons(history, rt->postSpikeHistory, cpuRuntimeNId[netId], 0, numNReg, STDP_POST_HISTORY_LENGTH, false);
+		copyNeurons(historyLength, rt->postSpikeHistoryLength, cpuRuntimeNId[netId], 0, numNReg, 1, false);
+	}
+}
+
+// copies the regular neurons that crossed the threshold in the last time step, whose spikes findFiring_CPU() has not
+// processed yet, between the spike bits of a CPU runtime and a list of local neuron ids in the order of the manager
+void SNN::copySpikeBits(int netId, std::vector<int>& firedNIds, bool toRuntime) {
+	RuntimeData* rt = &runtimeData[netId];
+	int numNReg = networkConfigs[netId].numNReg;
+
+	if (toRuntime) {
+		memset(rt->curSpikeBits, 0, sizeof(int) * (numNReg / 32 + 1));
+		for (int i = 0; i < (int)firedNIds.size(); i++) {
+			int rNId = mapNeuronId(cpuRuntimeNId[netId], firedNIds[i]);
+			rt->curSpikeBits[rNId / 32] |= 1u << (rNId % 32);
+		}
+	} else {
+		firedNIds.clear();
+		for (int rNId = findNextBit(rt->curSpikeBits, 0, numNReg - 1); rNId < numNReg;
+			rNId = findNextBit(rt->curSpikeBits, rNId + 1, numNReg - 1))
+			firedNIds.push_back(mapNeuronId(cpuManagerNId[netId], rNId));
+	}
 }
 
 /*!
@@ -2334,43 +3955,90 @@ void SNN::copyNetworkSpikeCount(int netId,
 }
 
 /*!
-* \brief This function fetch spikeTables in the local network specified by netId
+* \brief This function copies spikeTables between the local network specified by netId and the manager
 *
-* \param[in] netId the id of local network of which timeTableD1(D2) and firingTableD1(D2) are copied to manager runtime data
+* \param[in] netId the id of local network of which timeTableD1(D2) and firingTableD1(D2) are copied
+* \param[in] toManager copies the tables of the runtime to the manager runtime data if true, and those of the manager
+* runtime data to the runtime otherwise (see loadSimulation). The spike counts of the runtime give the size of the tables.
 */
-void SNN::copySpikeTables(int netId) {
+void SNN::copySpikeTables(int netId, bool toManager) {
 	unsigned int spikeCountD1Sec, spikeCountD2Sec, spikeCountLastSecLeftD2;
 
 	spikeCountLastSecLeftD2 = runtimeData[netId].spikeCountLastSecLeftD2;
 	spikeCountD2Sec = runtimeData[netId].spikeCountD2Sec;
 	spikeCountD1Sec = runtimeData[netId].spikeCountD1Sec;
+
+	if (!toManager) {
+		growFiringTables_CPU(netId, spikeCountD1Sec, spikeCountD2Sec + spikeCountLastSecLeftD2);
+
+		memcpy(runtimeData[netId].firingTableD2, managerRuntimeData.firingTableD2, sizeof(int) * (spikeCountD2Sec + spikeCountLastSecLeftD2));
+		memcpy(runtimeData[netId].firingTableD1, managerRuntimeData.firingTableD1, sizeof(int) * spikeCountD1Sec);
+		if (!cpuRuntimeNId[netId].empty()) {
+			for (unsigned int i = 0; i < spikeCountD2Sec + spikeCountLastSecLeftD2; i++)
+				runtimeData[netId].firingTableD2[i] = mapNeuronId(cpuRuntimeNId[netId], runtimeData[netId].firingTableD2[i]);
+			for (unsigned int i = 0; i < spikeCountD1Sec; i++)
+				runtimeData[netId].firingTableD1[i] = mapNeuronId(cpuRuntimeNId[netId], runtimeData[netId].firingTableD1[i]);
+		}
+		memcpy(runtimeData[netId].timeTableD2, managerRuntimeData.timeTableD2, sizeof(int) * (1000 + networkConfigs[netId].maxDelay + 1));
+		memcpy(runtimeData[netId].timeTableD1, managerRuntimeData.timeTableD1, sizeof(int) * (1000 + networkConfigs[netId].maxDelay + 1));
+		return;
+	}
+
+	// the firing tables of the CPU runtime may have grown since the manager tables were allocated
+	if (spikeCountD2Sec + spikeCountLastSecLeftD2 > managerRTDSize.maxMaxSpikeD2) {
+		delete [] managerRuntimeData.firingTableD2;
+		managerRTDSize.maxMaxSpikeD2 = networkConfigs[netId].maxSpikesD2;
+		managerRuntimeData.firingTableD2 = new int[managerRTDSize.maxMaxSpikeD2];
+	}
+	if (spikeCountD1Sec > managerRTDSize.maxMaxSpikeD1) {
+		delete [] managerRuntimeData.firingTableD1;
+		managerRTDSize.maxMaxSpikeD1 = networkConfigs[netId].maxSpikesD1;
+		managerRuntimeData.firingTableD1 = new int[managerRTDSize.maxMaxSpikeD1];
+	}
+
 	memcpy(managerRuntimeData.firingTableD2, runtimeData[netId].firingTableD2, sizeof(int) * (spikeCountD2Sec + spikeCountLastSecLeftD2));
 	memcpy(managerRuntimeData.firingTableD1, runtimeData[netId].firingTableD1, sizeof(int) * spikeCountD1Sec);
+
+	// the firing tables of a runtime with neuron reordering hold the storage positions of the regular neurons
+	if (!cpuManagerNId[netId].empty()) {
+		for (unsigned int i = 0; i < spikeCountD2Sec + spikeCountLastSecLeftD2; i++)
+			managerRuntimeData.firingTableD2[i] = mapNeuronId(cpuManagerNId[netId], managerRuntimeData.firingTableD2[i]);
+		for (unsigned int i = 0; i < spikeCountD1Sec; i++)
+			managerRuntimeData.firingTableD1[i] = mapNeuronId(cpuManagerNId[netId], managerRuntimeData.firingTableD1[i]);
+	}
 	memcpy(managerRuntimeData.timeTableD2, runtimeData[netId].timeTableD2, sizeof(int) * (1000 + networkConfigs[netId].maxDelay + 1));
 	memcpy(managerRuntimeData.timeTableD1, runtimeData[netId].timeTableD1, sizeof(int) * (1000 + networkConfigs[netId].maxDelay + 1));
 }
 
-#if defined(WIN32) || defined(WIN64)
-	void SNN::deleteRuntimeData_CPU(int netId) {
-#else // POSIX
-	void* SNN::deleteRuntimeData_CPU(int netId) {
-#endif
+void SNN::deleteRuntimeData_CPU(int netId) {
 	assert(runtimeData[netId].memType == CPU_MEM);
+	// the arrays mapped from the network cache are not allocated, they are reset to NULL and skipped below
+	unmapSynapseImage_CPU(netId);
+
 	// free all pointers
 	delete [] runtimeData[netId].voltage;
 	delete [] runtimeData[netId].nextVoltage;
 	delete [] runtimeData[netId].recovery;
 	delete [] runtimeData[netId].current;
 	delete [] runtimeData[netId].extCurrent;
-	delete [] runtimeData[netId].curSpike;
+	delete [] runtimeData[netId].curSpikeBits;
 	delete [] runtimeData[netId].Npre;
 	delete [] runtimeData[netId].Npre_plastic;
 	delete [] runtimeData[netId].Npre_plasticInv;
 	delete [] runtimeData[netId].Npost;
 	delete [] runtimeData[netId].cumulativePost;
 	delete [] runtimeData[netId].cumulativePre;
+	delete [] runtimeData[netId].cumulativePrePlastic;
+	delete [] runtimeData[netId].postSpikeHistory;
+	delete [] runtimeData[netId].postSpikeHistoryLength;
 	delete [] runtimeData[netId].synSpikeTime;
 	delete [] runtimeData[netId].wt;
+	delete [] runtimeData[netId].wtHalf;
+	delete [] runtimeData[netId].wtInt8;
+	delete [] runtimeData[netId].wtScale;
+	delete [] runtimeData[netId].preSynapticNIds;
+	delete [] runtimeData[netId].preSynapticDelays;
+	delete [] runtimeData[netId].recentSpikeBits;
 	delete [] runtimeData[netId].wtChange;
 	delete [] runtimeData[netId].maxSynWt;
 	delete [] runtimeData[netId].nSpikeCnt;
@@ -2408,6 +4076,7 @@ void SNN::copySpikeTables(int netId) {
 		delete [] runtimeData[netId].gNMDA;
 	}
 	delete [] runtimeData[netId].gGABAa;
+	delete [] runtimeData[netId].condActiveBits;
 	if (sim_with_GABAb_rise) {
 		delete [] runtimeData[netId].gGABAb_r;
 		delete [] runtimeData[netId].gGABAb_d;
@@ -2423,6 +4092,7 @@ void SNN::copySpikeTables(int netId) {
 
 	delete [] runtimeData[netId].postDelayInfo;
 	delete [] runtimeData[netId].postSynapticIds;
+	delete [] runtimeData[netId].postSynapticIdsPacked;
 	delete [] runtimeData[netId].preSynapticIds;
 	delete [] runtimeData[netId].I_set;
 	delete [] runtimeData[netId].poissonFireRate;
@@ -2459,13 +4129,11 @@ void SNN::copySpikeTables(int netId) {
 	runtimeData[netId].randNum = NULL;
 }
 
-#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
 	// Static multithreading subroutine method - helper for the above method  
 	void* SNN::helperDeleteRuntimeData_CPU(void* arguments) {
 		ThreadStruct* args = (ThreadStruct*) arguments;
 		//printf("\nThread ID: %lu and CPU: %d\n",pthread_self(), sched_getcpu());
 		((SNN *)args->snn_pointer) -> deleteRuntimeData_CPU(args->netId);
-		pthread_exit(0);
+		return NULL;
 	}
-#endif
 
@@ -58,8 +58,15 @@
 #include <group_monitor_core.h>
 
 #include <spike_buffer.h>
+#include <cpu_worker_pool.h>
 #include <error_code.h>
 
+#if defined(WIN32) || defined(WIN64)
+	#include <process.h>
+#else
+	#include <unistd.h>
+#endif
+
 // \FIXME what are the following for? why were they all the way at the bottom of this file?
 
 #define COMPACTION_ALIGNMENT_PRE  16
@@ -449,6 +456,60 @@ void SNN::setIntegrationMethod(integrationMethod_t method, int numStepsPerMs) {
 	glbNetworkConfig.timeStep = 1.0f / numStepsPerMs;
 }
 
+// set whether a single CPU runtime is executed inline on the calling thread
+void SNN::setCPURunInline(bool runInline) {
+	cpuRunInline_ = runInline;
+}
+
+void SNN::setCPUThreadsPerRuntime(int numThreads) {
+	assert(numThreads >= 1 && numThreads <= MAX_CPU_THREADS_PER_RUNTIME);
+	numCPUThreadsPerRuntime_ = numThreads;
+}
+
+void SNN::setCPUParallelSpikeDelivery(bool enable) {
+	cpuParallelSpikeDelivery_ = enable;
+}
+
+void SNN::setCPUFusedNeuronUpdate(bool enable) {
+	cpuFusedNeuronUpdate_ = enable;
+}
+
+void SNN::setCPUVectorizedNeuronUpdate(bool enable) {
+	cpuVectorizedNeuronUpdate_ = enable;
+}
+
+void SNN::setCPUAutoPartition(int numPartitions) {
+	assert(numPartitions >= 1 && numPartitions <= MAX_NET_PER_SNN - CPU_RUNTIME_BASE);
+	numCPUAutoPartitions_ = numPartitions;
+}
+
+void SNN::setCPULookahead(bool enable) {
+	cpuLookahead_ = enable;
+}
+
+void SNN::setCPUCompactSynapses(bool enable, SynWeightFormat weightFormat) {
+	cpuCompactSynapses_ = enable;
+	cpuSynWeightFormat_ = weightFormat;
+}
+
+void SNN::setCPUEventDrivenSTDP(bool enable) {
+	cpuEventDrivenSTDP_ = enable;
+}
+
+void SNN::setCPULazyConductanceDecay(bool enable, float snapThreshold) {
+	assert(snapThreshold >= 0.0f);
+	cpuLazyConductanceDecay_ = enable;
+	cpuCondSnapThreshold_ = snapThreshold;
+}
+
+void SNN::setCPUNeuronReordering(bool enable) {
+	cpuNeuronReordering_ = enable;
+}
+
+void SNN::setCPUSpikeDelivery(SpikeDeliveryMode mode) {
+	cpuSpikeDeliveryMode_ = mode;
+}
+
 // set Izhikevich parameters for group
 void SNN::setNeuronParameters(int gGrpId, float izh_a, float izh_a_sd, float izh_b, float izh_b_sd,
 								float izh_c, float izh_c_sd, float izh_d, float izh_d_sd)
@@ -757,32 +818,44 @@ int SNN::runNetwork(int _nsec, int _nmsec, bool printRunSummary) {
 
 	// if nsec=0, simTimeMs=10, we need to run the simulator for 10 timeStep;
 	// if nsec=1, simTimeMs=10, we need to run the simulator for 1*1000+10, time Step;
-	for(int i = 0; i < runDurationMs; i++) {
-		advSimStep();
-
-		// update weight every updateInterval ms if plastic synapses present
-		if (!sim_with_fixedwts && wtANDwtChangeUpdateInterval_ == ++wtANDwtChangeUpdateIntervalCnt_) {
-			wtANDwtChangeUpdateIntervalCnt_ = 0; // reset counter
-			if (!sim_in_testing) {
-				// keep this if statement separate from the above, so that the counter is updated correctly
-				updateWeights();
-			}
+	int numSteps = 1;
+	for(int i = 0; i < runDurationMs; i += numSteps) {
+		if (cpuLookaheadMs_ > 1) {
+			// in lookahead mode, the CPU runtimes advance a window of several time steps between two synchronizations.
+			// a window must not cross a second boundary (spike tables are shifted) nor a weight update
+			numSteps = std::min(cpuLookaheadMs_, std::min(runDurationMs - i, 1000 - simTimeMs));
+			if (!sim_with_fixedwts)
+				numSteps = std::min(numSteps, wtANDwtChangeUpdateInterval_ - wtANDwtChangeUpdateIntervalCnt_);
+			advSimStepsLookahead(numSteps);
+		} else {
+			advSimStep();
 		}
 
-		// Note: updateTime() advance simTime, simTimeMs, and simTimeSec accordingly
-		if (updateTime()) {
-			// finished one sec of simulation...
-			if (numSpikeMonitor) {
-				updateSpikeMonitor();
-			}
-			if (numGroupMonitor) {
-				updateGroupMonitor();
+		for (int step = 0; step < numSteps; step++) {
+			// update weight every updateInterval ms if plastic synapses present
+			if (!sim_with_fixedwts && wtANDwtChangeUpdateInterval_ == ++wtANDwtChangeUpdateIntervalCnt_) {
+				wtANDwtChangeUpdateIntervalCnt_ = 0; // reset counter
+				if (!sim_in_testing) {
+					// keep this if statement separate from the above, so that the counter is updated correctly
+					updateWeights();
+				}
 			}
-			if (numConnectionMonitor) {
-				updateConnectionMonitor();
+
+			// Note: updateTime() advance simTime, simTimeMs, and simTimeSec accordingly
+			if (updateTime()) {
+				// finished one sec of simulation...
+				if (numSpikeMonitor) {
+					updateSpikeMonitor();
+				}
+				if (numGroupMonitor) {
+					updateGroupMonitor();
+				}
+				if (numConnectionMonitor) {
+					updateConnectionMonitor();
+				}
+
+				shiftSpikeTables();
 			}
-			
-			shiftSpikeTables();
 		}
 
 		fetchNeuronSpikeCount(ALL);
@@ -893,15 +966,19 @@ void SNN::biasWeights(short int connId, float bias, bool updateWeightRange) {
 			assert(false);
 #endif
 		} else {
-			memcpy(&runtimeData[netId].wt[cumIdx], &managerRuntimeData.wt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+			copySynapseWeights(netId, &runtimeData[netId], &managerRuntimeData, cumIdx, managerRuntimeData.Npre[lNId]);
 
 			if (runtimeData[netId].maxSynWt != NULL) {
 				// only copy maxSynWt if datastructure actually exists on the CPU runtime
 				// (that logic should be done elsewhere though)
-				memcpy(&runtimeData[netId].maxSynWt[cumIdx], &managerRuntimeData.maxSynWt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+				copyMaxSynapseWeights(netId, lNId);
 			}
 		}
 	}
+
+	// a raised maximum weight enlarges the int8 weight step of the connection
+	if (netId >= CPU_RUNTIME_BASE && updateWeightRange)
+		updateWeightScale_CPU(netId, connId, connectConfigMap[connId].maxWt);
 }
 
 // deallocates dynamical structures and exits
@@ -915,6 +992,10 @@ void SNN::loadSimulation(FILE* fid) {
 	loadSimFID = fid;
 }
 
+void SNN::setNetworkCache(const std::string& dirName) {
+	networkCacheDir_ = dirName;
+}
+
 // multiplies every weight with a scaling factor
 void SNN::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 	assert(connId>=0 && connId<numConnections);
@@ -985,15 +1066,19 @@ void SNN::scaleWeights(short int connId, float scale, bool updateWeightRange) {
 			assert(false);
 #endif
 		} else {
-			memcpy(&runtimeData[netId].wt[cumIdx], &managerRuntimeData.wt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+			copySynapseWeights(netId, &runtimeData[netId], &managerRuntimeData, cumIdx, managerRuntimeData.Npre[lNId]);
 
 			if (runtimeData[netId].maxSynWt != NULL) {
 				// only copy maxSynWt if datastructure actually exists on the CPU runtime
 				// (that logic should be done elsewhere though)
-				memcpy(&runtimeData[netId].maxSynWt[cumIdx], &managerRuntimeData.maxSynWt[cumIdx], sizeof(float) * managerRuntimeData.Npre[lNId]);
+				copyMaxSynapseWeights(netId, lNId);
 			}
 		}
 	}
+
+	// a raised maximum weight enlarges the int8 weight step of the connection
+	if (netId >= CPU_RUNTIME_BASE && updateWeightRange)
+		updateWeightScale_CPU(netId, connId, connectConfigMap[connId].maxWt);
 }
 
 // FIXME: distinguish the function call at CONFIG_STATE and SETUP_STATE, where groupConfigs[0][] might not be available
@@ -1013,6 +1098,9 @@ GroupMonitor* SNN::setGroupMonitor(int gGrpId, FILE* fid) {
 	GroupMonitorCore* grpMonCoreObj = new GroupMonitorCore(this, numGroupMonitor, gGrpId);
 	groupMonCoreList[numGroupMonitor] = grpMonCoreObj;
 
+	// a loaded simulation may not start at time zero
+	grpMonCoreObj->setLastUpdated(simTime);
+
 	// assign group status file ID if we selected to write to a file, else it's NULL
 	// if file pointer exists, it has already been fopened
 	// this will also write the header section of the group status file
@@ -1110,6 +1198,9 @@ SpikeMonitor* SNN::setSpikeMonitor(int gGrpId, FILE* fid) {
 		SpikeMonitorCore* spkMonCoreObj = new SpikeMonitorCore(this, numSpikeMonitor, gGrpId);
 		spikeMonCoreList[numSpikeMonitor] = spkMonCoreObj;
 
+		// a loaded simulation may not start at time zero
+		spkMonCoreObj->setLastUpdated(simTime);
+
 		// assign spike file ID if we selected to write to a file, else it's NULL
 		// if file pointer exists, it has already been fopened
 		// this will also write the header section of the spike file
@@ -1190,8 +1281,18 @@ void SNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float weigh
 		}
 	}
 
+	// find the local group id of the pre-synaptic group in the local network of the post-synaptic group
+	int lGrpIdPre = -1;
+	for (int lGrpIdTmp = 0; lGrpIdTmp < networkConfigs[netId].numGroupsAssigned; lGrpIdTmp++) {
+		if (groupConfigs[netId][lGrpIdTmp].gGrpId == connectConfigMap[connId].grpSrc) {
+			lGrpIdPre = lGrpIdTmp;
+			break;
+		}
+	}
+	assert(lGrpIdPre != -1);
+
 	// find real ID of pre- and post-neuron
-	int neurIdPreReal = groupConfigs[netId][lGrpId].lStartN + neurIdPre;
+	int neurIdPreReal = groupConfigs[netId][lGrpIdPre].lStartN + neurIdPre;
 	int neurIdPostReal = groupConfigs[netId][lGrpId].lStartN + neurIdPost;
 
 	// iterate over all presynaptic synapses until right one is found
@@ -1219,12 +1320,14 @@ void SNN::setWeight(short int connId, int neurIdPre, int neurIdPost, float weigh
 				assert(false);
 #endif
 			} else {
-				// need to update datastructures on CPU runtime
-				memcpy(&runtimeData[netId].wt[pos_ij], &managerRuntimeData.wt[pos_ij], sizeof(float));
+				// need to update datastructures on CPU runtime, a raised maximum weight enlarges the int8 weight step
+				if (updateWeightRange)
+					updateWeightScale_CPU(netId, connId, maxWt);
+				copySynapseWeights(netId, &runtimeData[netId], &managerRuntimeData, pos_ij, 1);
 				if (runtimeData[netId].maxSynWt != NULL) {
 					// only copy maxSynWt if datastructure actually exists on the CPU runtime
 					// (that logic should be done elsewhere though)
-					memcpy(&runtimeData[netId].maxSynWt[pos_ij], &managerRuntimeData.maxSynWt[pos_ij], sizeof(float));
+					copyMaxSynapseWeights(netId, neurIdPostReal);
 				}
 			}
 
@@ -1270,113 +1373,303 @@ void SNN::setExternalCurrent(int grpId, const std::vector<float>& current) {
 	}
 }
 
+// writes n elements of an array to file with a single fwrite, returns whether all elements were written
+template <typename T>
+static bool writeBlock(FILE* fid, const T* data, size_t n) {
+	return n == 0 || fwrite(data, sizeof(T), n, fid) == n;
+}
+
+// reads n elements of an array from file with a single fread, returns whether all elements were read
+template <typename T>
+static bool readBlock(FILE* fid, T* data, size_t n) {
+	return n == 0 || fread(data, sizeof(T), n, fid) == n;
+}
+
+// the optional parts of the runtime state of a CPU runtime, which saveRuntimeState writes if the simulation uses them
+enum RuntimeStateFlags {
+	STATE_CONDUCTANCES = 1 << 0,
+	STATE_NMDA_RISE    = 1 << 1,
+	STATE_GABAB_RISE   = 1 << 2,
+	STATE_HOMEOSTASIS  = 1 << 3,
+	STATE_STP          = 1 << 4
+};
+
 // writes network state to file
 // handling of file pointer should be handled externally: as far as this function is concerned, it is simply
 // trying to write to file
-void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo) {
-	//int tmpInt;
-	//float tmpFloat;
-
-	//// +++++ WRITE HEADER SECTION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-
-	//// write file signature
-	//tmpInt = 294338571; // some int used to identify saveSimulation files
-	//if (!fwrite(&tmpInt,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//// write version number
-	//tmpFloat = 0.2f;
-	//if (!fwrite(&tmpFloat,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//// write simulation time so far (in seconds)
-	//tmpFloat = ((float)simTimeSec) + ((float)simTimeMs)/1000.0f;
-	//if (!fwrite(&tmpFloat,sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//// write execution time so far (in seconds)
-	//if(simMode_ == GPU_MODE) {
-	//	stopGPUTiming();
-	//	tmpFloat = gpuExecutionTime/1000.0f;
-	//} else {
-	//	stopCPUTiming();
-	//	tmpFloat = cpuExecutionTime/1000.0f;
-	//}
-	//if (!fwrite(&tmpFloat,sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+void SNN::saveSimulation(FILE* fid, bool saveSynapseInfo, bool saveNeuronInfo) {
+	int tmpInt;
+	float tmpFloat;
+	bool writeErr = false; // keep track of writing errors
 
-	//// TODO: add more params of interest
+	// +++++ WRITE HEADER SECTION +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
 
-	//// write network info
-	//if (!fwrite(&numN,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//if (!fwrite(&numPreSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//if (!fwrite(&numPostSynNet,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//if (!fwrite(&numGroups,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	// write file signature
+	tmpInt = SIM_FILE_SIGNATURE;
+	writeErr |= !writeBlock(fid, &tmpInt, 1);
 
-	//// write group info
-	//char name[100];
-	//for (int g=0;g<numGroups;g++) {
-	//	if (!fwrite(&groupConfigs[0][g].StartN,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//	if (!fwrite(&groupConfigs[0][g].EndN,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	// write version number
+	tmpFloat = SIM_FILE_VERSION;
+	writeErr |= !writeBlock(fid, &tmpFloat, 1);
 
-	//	if (!fwrite(&groupConfigs[0][g].SizeX,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//	if (!fwrite(&groupConfigs[0][g].SizeY,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//	if (!fwrite(&groupConfigs[0][g].SizeZ,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
+	// write simulation time so far (in seconds)
+	tmpFloat = ((float)simTimeSec) + ((float)simTimeMs)/1000.0f;
+	writeErr |= !writeBlock(fid, &tmpFloat, 1);
 
-	//	strncpy(name,groupInfo[g].Name.c_str(),100);
-	//	if (!fwrite(name,1,100,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//}
+	// write execution time so far (in seconds)
+	tmpFloat = cumExecutionTime/1000.0f;
+	writeErr |= !writeBlock(fid, &tmpFloat, 1);
 
-	//// +++++ Fetch WEIGHT DATA (GPU Mode only) ++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-	//if (simMode_ == GPU_MODE)
-	//	copyWeightState(&managerRuntimeData, &runtimeData[0], cudaMemcpyDeviceToHost, false);
-	//// +++++ WRITE SYNAPSE INFO +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
-
-	//// \FIXME: replace with faster version
-	//if (saveSynapseInfo) {
-	//	for (int i = 0; i < numN; i++) {
-	//		unsigned int offset = managerRuntimeData.cumulativePost[i];
-
-	//		unsigned int count = 0;
-	//		for (int t=0;t<maxDelay_;t++) {
-	//			DelayInfo dPar = managerRuntimeData.postDelayInfo[i*(maxDelay_+1)+t];
-
-	//			for(int idx_d=dPar.delay_index_start; idx_d<(dPar.delay_index_start+dPar.delay_length); idx_d++)
-	//				count++;
-	//		}
-
-	//		if (!fwrite(&count,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-
-	//		for (int t=0;t<maxDelay_;t++) {
-	//			DelayInfo dPar = managerRuntimeData.postDelayInfo[i*(maxDelay_+1)+t];
-
-	//			for(int idx_d=dPar.delay_index_start; idx_d<(dPar.delay_index_start+dPar.delay_length); idx_d++) {
-	//				// get synaptic info...
-	//				SynInfo post_info = managerRuntimeData.postSynapticIds[offset + idx_d];
-
-	//				// get neuron id
-	//				//int p_i = (post_info&POST_SYN_NEURON_MASK);
-	//				unsigned int p_i = GET_CONN_NEURON_ID(post_info);
-	//				assert(p_i<numN);
-
-	//				// get syn id
-	//				unsigned int s_i = GET_CONN_SYN_ID(post_info);
-	//				//>>POST_SYN_NEURON_BITS)&POST_SYN_CONN_MASK;
-	//				assert(s_i<(managerRuntimeData.Npre[p_i]));
-
-	//				// get the cumulative position for quick access...
-	//				unsigned int pos_i = managerRuntimeData.cumulativePre[p_i] + s_i;
-
-	//				uint8_t delay = t+1;
-	//				uint8_t plastic = s_i < managerRuntimeData.Npre_plastic[p_i]; // plastic or fixed.
-
-	//				if (!fwrite(&i,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&p_i,sizeof(int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.wt[pos_i]),sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.maxSynWt[pos_i]),sizeof(float),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&delay,sizeof(uint8_t),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&plastic,sizeof(uint8_t),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//				if (!fwrite(&(managerRuntimeData.connIdsPreIdx[pos_i]),sizeof(short int),1,fid)) KERNEL_ERROR("saveSimulation fwrite error");
-	//			}
-	//		}
-	//	}
-	//}
+	// write network info
+	int networkInfo[4] = {glbNetworkConfig.numN, glbNetworkConfig.numSynNet, glbNetworkConfig.numSynNet, numGroups};
+	writeErr |= !writeBlock(fid, networkInfo, 4);
+
+	// write group info
+	char name[100];
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		int groupInfo[5] = {groupConfigMDMap[gGrpId].gStartN, groupConfigMDMap[gGrpId].gEndN,
+			groupConfigMap[gGrpId].grid.numX, groupConfigMap[gGrpId].grid.numY, groupConfigMap[gGrpId].grid.numZ};
+		writeErr |= !writeBlock(fid, groupInfo, 5);
+
+		memset(name, 0, sizeof(name));
+		strncpy(name, groupConfigMap[gGrpId].grpName.c_str(), sizeof(name) - 1);
+		writeErr |= !writeBlock(fid, name, sizeof(name));
+	}
+
+	// the header and group info above keep the layout of version 0.2, which the offline analysis toolbox reads
+	// (see SimulationReader.m), all new fields follow them
+
+	// write the exact simulation time, and the time since the last weight update, from which a loaded simulation
+	// continues
+	int simTimeInfo[3] = {simTimeSec, simTimeMs, wtANDwtChangeUpdateIntervalCnt_};
+	writeErr |= !writeBlock(fid, simTimeInfo, 3);
+
+	// +++++ WRITE SYNAPSE INFO +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++ //
+	// whether the file holds the synapses, and whether it holds the runtime state as well
+	int synapseInfo[2] = {saveSynapseInfo ? 1 : 0, (saveSynapseInfo && saveNeuronInfo) ? 1 : 0};
+	writeErr |= !writeBlock(fid, synapseInfo, 2);
+
+	if (saveSynapseInfo) {
+		// write connection info as generated by connectNetwork, which updates the connect lists (not connectConfigMap):
+		// numberOfConnections, and maxWt and maxDelay of user-defined connections
+		tmpInt = connectConfigMap.size();
+		writeErr |= !writeBlock(fid, &tmpInt, 1);
+		for (int pass = 0; pass < 2; pass++) {
+			for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+				std::list<ConnectConfig>& connectList = (pass == 1) ? externalConnectLists[netId] : localConnectLists[netId];
+				for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++) {
+					int connInfo[5] = {connIt->connId, connIt->grpSrc, connIt->grpDest, connIt->numberOfConnections,
+						connIt->maxDelay};
+					writeErr |= !writeBlock(fid, connInfo, 5);
+					writeErr |= !writeBlock(fid, &connIt->maxWt, 1);
+				}
+			}
+		}
+
+		// write the size of each local network, including the maximum numbers of synapses of a neuron, which
+		// generateRuntimeNetworkConfigs otherwise finds from the connection lists
+		tmpInt = 0;
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			if (!groupPartitionLists[netId].empty())
+				tmpInt++;
+		}
+		writeErr |= !writeBlock(fid, &tmpInt, 1);
+
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			if (!groupPartitionLists[netId].empty()) {
+				int netInfo[5] = {netId, networkConfigs[netId].numNAssigned, networkConfigs[netId].numPreSynNet,
+					networkConfigs[netId].maxNumPostSynN, networkConfigs[netId].maxNumPreSynN};
+				writeErr |= !writeBlock(fid, netInfo, 5);
+			}
+		}
+
+		// write the synapse arrays of each local network, followed by its runtime state, in the order in which
+		// generateRuntimeSNN reads them
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			if (groupPartitionLists[netId].empty())
+				continue;
+
+			writeErr |= !saveSynapseArrays(fid, netId);
+			if (synapseInfo[1] && netId >= CPU_RUNTIME_BASE) {
+				writeErr |= !saveRuntimeState(fid, netId);
+				writeErr |= !saveSpikeTables(fid, netId);
+			} else if (synapseInfo[1]) {
+				KERNEL_WARN("saveSimulation: The runtime state of GPU %d Runtime is not stored, it starts from the "
+					"initial state after loading.", netId);
+			}
+		}
+	}
+
+	if (writeErr)
+		KERNEL_ERROR("saveSimulation fwrite error");
+}
+
+// writes the synapse arrays of a local network as the manager lays them out: the numbers and positions of the
+// pre- and post-synaptic synapses of each neuron, the delays of its post-synaptic synapses, and the synapses with
+// their connection ids and weights
+bool SNN::saveSynapseArrays(FILE* fid, int netId) {
+	int numNAssigned = networkConfigs[netId].numNAssigned;
+	int numPreSyn = networkConfigs[netId].numPreSynNet;
+	int numPostSyn = networkConfigs[netId].numPostSynNet;
+	bool writeErr = false;
+
+	int netInfo[4] = {netId, numNAssigned, numPreSyn, numPostSyn};
+	writeErr |= !writeBlock(fid, netInfo, 4);
+	if (numPreSyn == 0)
+		return !writeErr;
+
+	// get the current synapses and weights from the runtime
+	fetchPreConnectionInfo(netId);
+	fetchPostConnectionInfo(netId);
+	fetchSynapseState(netId);
+	fetchConnIdsLookupArray(netId);
+
+	// the runtimes only keep Npre_plastic if the network has plastic synapses
+	if (sim_with_fixedwts)
+		memset(managerRuntimeData.Npre_plastic, 0, sizeof(short) * numNAssigned);
+
+	// the runtimes only keep the maximum weights of plastic synapses, those of fixed synapses are set as in connectNeurons
+	for (int pos = 0; pos < numPreSyn; pos++) {
+		ConnectConfig& connConfig = connectConfigMap[managerRuntimeData.connIdsPreIdx[pos]];
+		if (GET_FIXED_PLASTIC(connConfig.connProp) == SYN_PLASTIC)
+			continue;
+
+		if (connConfig.type == CONN_USER_DEFINED) {
+			managerRuntimeData.maxSynWt[pos] = managerRuntimeData.wt[pos];
+		} else {
+			int gGrpSrc = groupConfigs[netId][GET_CONN_GRP_ID(managerRuntimeData.preSynapticIds[pos])].gGrpId;
+			managerRuntimeData.maxSynWt[pos] = isExcitatoryGroup(gGrpSrc) ? fabs(connConfig.maxWt) : -1.0*fabs(connConfig.maxWt);
+		}
+	}
+
+	writeErr |= !writeBlock(fid, managerRuntimeData.Npre, numNAssigned);
+	writeErr |= !writeBlock(fid, managerRuntimeData.Npre_plastic, numNAssigned);
+	writeErr |= !writeBlock(fid, managerRuntimeData.Npost, numNAssigned);
+	writeErr |= !writeBlock(fid, managerRuntimeData.cumulativePre, numNAssigned);
+	writeErr |= !writeBlock(fid, managerRuntimeData.cumulativePost, numNAssigned);
+	writeErr |= !writeBlock(fid, managerRuntimeData.postDelayInfo, numNAssigned * (glbNetworkConfig.maxDelay + 1));
+	writeErr |= !writeBlock(fid, managerRuntimeData.preSynapticIds, numPreSyn);
+	writeErr |= !writeBlock(fid, managerRuntimeData.postSynapticIds, numPostSyn);
+	writeErr |= !writeBlock(fid, managerRuntimeData.connIdsPreIdx, numPreSyn);
+	writeErr |= !writeBlock(fid, managerRuntimeData.wt, numPreSyn);
+	writeErr |= !writeBlock(fid, managerRuntimeData.maxSynWt, numPreSyn);
+
+	return !writeErr;
+}
+
+// returns the optional parts of the runtime state that the simulation uses, see RuntimeStateFlags
+int SNN::getRuntimeStateFlags() {
+	int flags = 0;
+	if (sim_with_conductances) {
+		flags |= STATE_CONDUCTANCES;
+		if (sim_with_NMDA_rise)
+			flags |= STATE_NMDA_RISE;
+		if (sim_with_GABAb_rise)
+			flags |= STATE_GABAB_RISE;
+	}
+	if (sim_with_homeostasis)
+		flags |= STATE_HOMEOSTASIS;
+	if (sim_with_stp)
+		flags |= STATE_STP;
+
+	return flags;
+}
+
+// writes the runtime state of a CPU runtime: the state of the regular neurons (including conductances and
+// homeostasis), the STP state, the last spike times, the neuromodulator concentrations, and the weight changes and
+// last spike times of the synapses
+bool SNN::saveRuntimeState(FILE* fid, int netId) {
+	int numNReg = networkConfigs[netId].numNReg;
+	int numN = networkConfigs[netId].numN;
+	int numNAssigned = networkConfigs[netId].numNAssigned;
+	int numGroups = networkConfigs[netId].numGroups;
+	int numPreSyn = networkConfigs[netId].numPreSynNet;
+	int flags = getRuntimeStateFlags();
+	bool writeErr = false;
+
+	int stateInfo[5] = {netId, numNReg, numN, numNAssigned, flags};
+	writeErr |= !writeBlock(fid, stateInfo, 5);
+
+	// the runtime keeps wtChange and synSpikeTime of plastic synapses only, those of fixed synapses are reset
+	resetSynapse(netId, false);
+	copyRuntimeStateToManager(netId);
+
+	writeErr |= !writeBlock(fid, managerRuntimeData.voltage, numNReg);
+	writeErr |= !writeBlock(fid, managerRuntimeData.recovery, numNReg);
+	writeErr |= !writeBlock(fid, managerRuntimeData.current, numNReg);
+	if (flags & STATE_CONDUCTANCES) {
+		writeErr |= !writeBlock(fid, managerRuntimeData.gAMPA, numNReg);
+		if (flags & STATE_NMDA_RISE) {
+			writeErr |= !writeBlock(fid, managerRuntimeData.gNMDA_r, numNReg);
+			writeErr |= !writeBlock(fid, managerRuntimeData.gNMDA_d, numNReg);
+		} else {
+			writeErr |= !writeBlock(fid, managerRuntimeData.gNMDA, numNReg);
+		}
+		writeErr |= !writeBlock(fid, managerRuntimeData.gGABAa, numNReg);
+		if (flags & STATE_GABAB_RISE) {
+			writeErr |= !writeBlock(fid, managerRuntimeData.gGABAb_r, numNReg);
+			writeErr |= !writeBlock(fid, managerRuntimeData.gGABAb_d, numNReg);
+		} else {
+			writeErr |= !writeBlock(fid, managerRuntimeData.gGABAb, numNReg);
+		}
+	}
+	if (flags & STATE_HOMEOSTASIS) {
+		writeErr |= !writeBlock(fid, managerRuntimeData.avgFiring, numNReg);
+		writeErr |= !writeBlock(fid, managerRuntimeData.baseFiring, numNReg);
+	}
+	if (flags & STATE_STP) {
+		writeErr |= !writeBlock(fid, managerRuntimeData.stpu, numN * (networkConfigs[netId].maxDelay + 1));
+		writeErr |= !writeBlock(fid, managerRuntimeData.stpx, numN * (networkConfigs[netId].maxDelay + 1));
+	}
+	writeErr |= !writeBlock(fid, managerRuntimeData.lastSpikeTime, numNAssigned);
+	writeErr |= !writeBlock(fid, managerRuntimeData.grpDA, numGroups);
+	writeErr |= !writeBlock(fid, managerRuntimeData.grp5HT, numGroups);
+	writeErr |= !writeBlock(fid, managerRuntimeData.grpACh, numGroups);
+	writeErr |= !writeBlock(fid, managerRuntimeData.grpNE, numGroups);
+	writeErr |= !writeBlock(fid, managerRuntimeData.wtChange, numPreSyn);
+	writeErr |= !writeBlock(fid, managerRuntimeData.synSpikeTime, numPreSyn);
+
+	return !writeErr;
+}
+
+// writes the spikes in transit of a CPU runtime: the spike counters, time tables, and firing tables of the current
+// second, the neurons that crossed the threshold in the last time step (they enter the firing tables in the next
+// one), and the post-synaptic spikes of event-driven STDP
+bool SNN::saveSpikeTables(FILE* fid, int netId) {
+	RuntimeData* rt = &runtimeData[netId];
+	int numNReg = networkConfigs[netId].numNReg;
+	int timeTableLength = 1000 + glbNetworkConfig.maxDelay + 1;
+	bool writeErr = false;
+
+	std::vector<int> firedNIds;
+	copySpikeBits(netId, firedNIds, false);
+
+	int tableInfo[4] = {netId, cpuPullDelivery[netId] ? 1 : 0, (rt->postSpikeHistory != NULL) ? numNReg : 0,
+		(int)firedNIds.size()};
+	writeErr |= !writeBlock(fid, tableInfo, 4);
+
+	unsigned int spikeCounts[12] = {rt->spikeCountSec, rt->spikeCountD1Sec, rt->spikeCountD2Sec,
+		rt->spikeCountExtRxD1Sec, rt->spikeCountExtRxD2Sec, rt->spikeCount, rt->spikeCountD1, rt->spikeCountD2,
+		rt->nPoissonSpikes, rt->spikeCountLastSecLeftD2, rt->spikeCountExtRxD2, rt->spikeCountExtRxD1};
+	writeErr |= !writeBlock(fid, spikeCounts, 12);
+
+	fetchSpikeTables(netId);
+	writeErr |= !writeBlock(fid, managerRuntimeData.timeTableD1, timeTableLength);
+	writeErr |= !writeBlock(fid, managerRuntimeData.timeTableD2, timeTableLength);
+	writeErr |= !writeBlock(fid, managerRuntimeData.firingTableD1, rt->spikeCountD1Sec);
+	writeErr |= !writeBlock(fid, managerRuntimeData.firingTableD2, rt->spikeCountD2Sec + rt->spikeCountLastSecLeftD2);
+	if (!firedNIds.empty())
+		writeErr |= !writeBlock(fid, &firedNIds[0], firedNIds.size());
+
+	if (tableInfo[2] > 0) {
+		std::vector<int> history(numNReg * STDP_POST_HISTORY_LENGTH);
+		std::vector<unsigned short> historyLength(numNReg);
+		copyPostSpikeHistory(netId, &history[0], &historyLength[0], false);
+		writeErr |= !writeBlock(fid, &history[0], history.size());
+		writeErr |= !writeBlock(fid, &historyLength[0], historyLength.size());
+	}
+
+	return !writeErr;
 }
 
 // writes population weights from gIDpre to gIDpost to file fname in binary
@@ -1908,6 +2201,8 @@ void SNN::SNNinit() {
 	sim_in_testing = false;
 
 	loadSimFID = NULL;
+	loadSimWithState_ = false;
+	networkCacheFID_ = NULL;
 
 	// conductance info struct for simulation
 	sim_with_NMDA_rise = false;
@@ -1937,6 +2232,37 @@ void SNN::SNNinit() {
 	// initialize spike buffer
 	spikeBuf = new SpikeBuffer(0, MAX_TIME_SLICE);
 
+	// CPU worker threads are spawned in setupNetwork(), once the number of CPU runtimes is known
+	cpuWorkerPool = NULL;
+	cpuRunInline_ = true; // by default, a single CPU runtime does not need a worker thread
+	numCPUThreadsPerRuntime_ = 1;
+	cpuParallelSpikeDelivery_ = false;
+	cpuFusedNeuronUpdate_ = false;
+	cpuVectorizedNeuronUpdate_ = false;
+	cpuSimdInstructionSet_ = SIMD_SCALAR; // determined in setupNetwork()
+	numCPUAutoPartitions_ = 1;
+	cpuLookahead_ = false;
+	cpuLookaheadMs_ = 0; // determined in setupNetwork()
+	cpuLookaheadWindowMs_ = 0;
+	cpuCompactSynapses_ = false;
+	cpuSynWeightFormat_ = SYN_WEIGHT_FLOAT;
+	cpuEventDrivenSTDP_ = false;
+	cpuLazyConductanceDecay_ = false;
+	cpuCondSnapThreshold_ = 0.0f;
+	cpuNeuronReordering_ = false;
+	cpuSpikeDeliveryMode_ = SPIKE_DELIVERY_PUSH;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		cpuRuntimeNumaNode[netId] = -1;
+		cpuDirectSpikeExchange[netId] = false;
+		maxSpikesPerStepD1[netId] = 0;
+		maxSpikesPerStepD2[netId] = 0;
+		firingTableHighWaterD1[netId] = 0;
+		firingTableHighWaterD2[netId] = 0;
+		cpuPullDelivery[netId] = false;
+		cpuSynapseImage[netId] = NULL;
+		cpuSynapseImageSize[netId] = 0;
+	}
+
 	memset(networkConfigs, 0, sizeof(NetworkConfigRT) * MAX_NET_PER_SNN);
 	
 	// reset all runtime data
@@ -1963,6 +2289,8 @@ void SNN::SNNinit() {
 }
 
 void SNN::advSimStep() {
+	syncCPURuntimeClocks();
+
 	doSTPUpdateAndDecayCond();
 
 	spikeGeneratorUpdate();
@@ -1980,365 +2308,285 @@ void SNN::advSimStep() {
 	clearExtFiringTable();
 }
 
+// advances the CPU runtimes by numSteps time steps with only two synchronizations: every CPU runtime first simulates the
+// whole window on its own, then the spikes exchanged during the window are delivered to the destination runtimes.
+// numSteps must not exceed the lookahead, i.e., the minimum delay of all connections between CPU runtimes, so that no
+// spike fired in the window is due before the last time step of the window (see finishLookaheadWindow_CPU).
+void SNN::advSimStepsLookahead(int numSteps) {
+	assert(numSteps >= 1 && numSteps <= cpuLookaheadMs_);
+	assert(numGPUs == 0);
+
+	syncCPURuntimeClocks();
+
+	assignPoissonFiringRate();
+
+	generateUserDefinedSpikes();
+
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
+
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty()) {
+			argsThreadRoutine[threadCount].snn_pointer = this;
+			argsThreadRoutine[threadCount].netId = netId;
+			argsThreadRoutine[threadCount].lGrpId = 0;
+			argsThreadRoutine[threadCount].startIdx = 0;
+			argsThreadRoutine[threadCount].endIdx = 0;
+			argsThreadRoutine[threadCount].GtoLOffset = 0;
+			threadCount++;
+		}
+	}
+
+	cpuLookaheadWindowMs_ = numSteps;
+
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperRunLookaheadWindow_CPU, argsThreadRoutine, threadCount);
+	runCPUTasks(&SNN::helperFinishLookaheadWindow_CPU, argsThreadRoutine, threadCount);
+
+	// tell the spike buffer to advance to the end of the window
+	for (int step = 0; step < numSteps; step++)
+		spikeBuf->step();
+}
+
+// CPU runtimes keep their own simulation clock, which runs ahead of the global clock in lookahead mode
+void SNN::syncCPURuntimeClocks() {
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty()) {
+			runtimeData[netId].simTime = simTime;
+			runtimeData[netId].simTimeMs = simTimeMs;
+		}
+	}
+}
+
+void SNN::runCPUTasks(void* (*routine)(void*), ThreadStruct* args, int numTasks) {
+	if (numTasks == 0)
+		return;
+
+	if (cpuWorkerPool != NULL) {
+		cpuWorkerPool->run(routine, args, numTasks);
+	} else {
+		// no worker pool available (e.g., network was never set up), run the tasks inline
+		for (int i = 0; i < numTasks; i++)
+			routine((void*)&args[i]);
+	}
+}
+
+int SNN::addNeuronRangeTasks(int netId, int numThreads, ThreadStruct* args, int numTasks) {
+	assert(numThreads >= 1 && numThreads <= MAX_CPU_THREADS_PER_RUNTIME);
+	int numN = networkConfigs[netId].numN;
+
+	// split the local neurons [0, numN) into numThreads contiguous ranges [startIdx, endIdx) of (almost) equal size. The
+	// inner boundaries are multiples of 32, so that each word of the bit-packed spike state (curSpikeBits) is written by
+	// one thread only
+	for (int i = 0; i < numThreads; i++) {
+		args[numTasks].snn_pointer = this;
+		args[numTasks].netId = netId;
+		args[numTasks].lGrpId = 0;
+		args[numTasks].startIdx = (i == 0) ? 0 : (int)((long long)numN * i / numThreads) / 32 * 32;
+		args[numTasks].endIdx = (i == numThreads - 1) ? numN : (int)((long long)numN * (i + 1) / numThreads) / 32 * 32;
+		args[numTasks].GtoLOffset = 0;
+		args[numTasks].fireIdD1 = 0;
+		args[numTasks].fireIdD2 = 0;
+		args[numTasks].numSpikesD1 = 0;
+		args[numTasks].numSpikesD2 = 0;
+		numTasks++;
+	}
+
+	return numTasks;
+}
+
 void SNN::doSTPUpdateAndDecayCond() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN * MAX_CPU_THREADS_PER_RUNTIME]; // one task per neuron range
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			assert(runtimeData[netId].allocated);
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				doSTPUpdateAndDecayCond_GPU(netId);
-			else{//CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					doSTPUpdateAndDecayCond_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoSTPUpdateAndDecayCond_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
-			}
+			else // CPU runtime
+				threadCount = addNeuronRangeTasks(netId, numCPUThreadsPerRuntime_, argsThreadRoutine, threadCount);
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperDoSTPUpdateAndDecayCond_CPU, argsThreadRoutine, threadCount);
 }
 
-void SNN::spikeGeneratorUpdate() {
+void SNN::assignPoissonFiringRate() {
 	// If poisson rate has been updated, assign new poisson rate
 	if (spikeRateUpdated) {
-		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
-			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-			int threadCount = 0;
-		#endif
+		ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+		int threadCount = 0;
 
 		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 			if (!groupPartitionLists[netId].empty()) {
 				if (netId < CPU_RUNTIME_BASE) // GPU runtime
 					assignPoissonFiringRate_GPU(netId);
 				else{ // CPU runtime
-					#if defined(WIN32) || defined(WIN64)
-						assignPoissonFiringRate_CPU(netId);
-					#else // Linux or MAC
-						pthread_attr_t attr;
-						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-						argsThreadRoutine[threadCount].snn_pointer = this;
-						argsThreadRoutine[threadCount].netId = netId;
-						argsThreadRoutine[threadCount].lGrpId = 0;
-						argsThreadRoutine[threadCount].startIdx = 0;
-						argsThreadRoutine[threadCount].endIdx = 0;
-						argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-						pthread_create(&threads[threadCount], &attr, &SNN::helperAssignPoissonFiringRate_CPU, (void*)&argsThreadRoutine[threadCount]);
-						pthread_attr_destroy(&attr);
-						threadCount++;
-					#endif
+					argsThreadRoutine[threadCount].snn_pointer = this;
+					argsThreadRoutine[threadCount].netId = netId;
+					argsThreadRoutine[threadCount].lGrpId = 0;
+					argsThreadRoutine[threadCount].startIdx = 0;
+					argsThreadRoutine[threadCount].endIdx = 0;
+					argsThreadRoutine[threadCount].GtoLOffset = 0;
+					threadCount++;
 				}
 			}
 		}
 
-		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
-		#endif
+		// run the CPU runtimes on the worker pool and wait for them to finish
+		runCPUTasks(&SNN::helperAssignPoissonFiringRate_CPU, argsThreadRoutine, threadCount);
 
 		spikeRateUpdated = false;
 	}
+}
+
+void SNN::spikeGeneratorUpdate() {
+	assignPoissonFiringRate();
 
 	// If time slice has expired, check if new spikes needs to be generated by user-defined spike generators
 	generateUserDefinedSpikes();
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				spikeGeneratorUpdate_GPU(netId);
 			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					spikeGeneratorUpdate_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperSpikeGeneratorUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
+				argsThreadRoutine[threadCount].snn_pointer = this;
+				argsThreadRoutine[threadCount].netId = netId;
+				argsThreadRoutine[threadCount].lGrpId = 0;
+				argsThreadRoutine[threadCount].startIdx = 0;
+				argsThreadRoutine[threadCount].endIdx = 0;
+				argsThreadRoutine[threadCount].GtoLOffset = 0;
+				threadCount++;
 			}
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperSpikeGeneratorUpdate_CPU, argsThreadRoutine, threadCount);
 
 	// tell the spike buffer to advance to the next time step
 	spikeBuf->step();
 }
 
 void SNN::findFiring() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN * MAX_CPU_THREADS_PER_RUNTIME]; // one task per neuron range
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				findFiring_GPU(netId);
-			else {// CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					findFiring_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperFindFiring_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
-			}
+			else // CPU runtime
+				threadCount = addNeuronRangeTasks(netId, numCPUThreadsPerRuntime_, argsThreadRoutine, threadCount);
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// if the neurons of a CPU runtime are split among threads, count the spikes of each neuron range first, so that
+	// the firing table slots of each range can be assigned in neuron order (parallel prefix). This way, the firing
+	// tables are exactly the same as with a single thread per CPU runtime.
+	if (numCPUThreadsPerRuntime_ > 1)
+		runCPUTasks(&SNN::helperCountFiring_CPU, argsThreadRoutine, threadCount);
+	assignFiringTableSlots_CPU(argsThreadRoutine, threadCount);
+
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperFindFiring_CPU, argsThreadRoutine, threadCount);
+
+	commitFiringTables_CPU(argsThreadRoutine, threadCount);
 }
 
 void SNN::doCurrentUpdate() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN * MAX_CPU_THREADS_PER_RUNTIME]; // one task per neuron range
+	int threadCount = 0;
+
+	// with parallel spike delivery, each thread of a CPU runtime delivers the spikes to its own range of post-synaptic
+	// neurons (ownership partitioning), which requires neither atomics nor a reduction of partial conductances
+	int numThreads = cpuParallelSpikeDelivery_ ? numCPUThreadsPerRuntime_ : 1;
+
+	// CPU runtimes with pull-based spike delivery first collect their recent spikes in a bitmap, one task per runtime
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty() && cpuPullDelivery[netId]) {
+			argsThreadRoutine[threadCount].snn_pointer = this;
+			argsThreadRoutine[threadCount].netId = netId;
+			argsThreadRoutine[threadCount].lGrpId = 0;
+			argsThreadRoutine[threadCount].startIdx = 0;
+			argsThreadRoutine[threadCount].endIdx = 0;
+			argsThreadRoutine[threadCount].GtoLOffset = 0;
+			threadCount++;
+		}
+	}
+	runCPUTasks(&SNN::helperPrepareSpikeBits_CPU, argsThreadRoutine, threadCount);
+	threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				doCurrentUpdateD2_GPU(netId);
-			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					doCurrentUpdateD2_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoCurrentUpdateD2_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
-			}
+			else // CPU runtime
+				threadCount = addNeuronRangeTasks(netId, numThreads, argsThreadRoutine, threadCount);
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-		threadCount = 0;
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperDoCurrentUpdateD2_CPU, argsThreadRoutine, threadCount);
+	threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				doCurrentUpdateD1_GPU(netId);
-			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					doCurrentUpdateD1_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDoCurrentUpdateD1_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
-			}
+			else // CPU runtime
+				threadCount = addNeuronRangeTasks(netId, numThreads, argsThreadRoutine, threadCount);
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperDoCurrentUpdateD1_CPU, argsThreadRoutine, threadCount);
 }
 
 void SNN::updateTimingTable() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				updateTimingTable_GPU(netId);
 			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					updateTimingTable_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperUpdateTimingTable_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
+				argsThreadRoutine[threadCount].snn_pointer = this;
+				argsThreadRoutine[threadCount].netId = netId;
+				argsThreadRoutine[threadCount].lGrpId = 0;
+				argsThreadRoutine[threadCount].startIdx = 0;
+				argsThreadRoutine[threadCount].endIdx = 0;
+				argsThreadRoutine[threadCount].GtoLOffset = 0;
+				threadCount++;
 			}
 		}
 	}
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperUpdateTimingTable_CPU, argsThreadRoutine, threadCount);
 }
 
 void SNN::globalStateUpdate() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN * MAX_CPU_THREADS_PER_RUNTIME]; // one task per neuron range
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				globalStateUpdate_C_GPU(netId);
-			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					globalStateUpdate_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperGlobalStateUpdate_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
-			}
+			else // CPU runtime, neurons with compartments depend on their neighbors and are not split
+				threadCount = addNeuronRangeTasks(netId, sim_with_compartments ? 1 : numCPUThreadsPerRuntime_, argsThreadRoutine, threadCount);
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperGlobalStateUpdate_CPU, argsThreadRoutine, threadCount);
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
@@ -2356,92 +2604,50 @@ void SNN::globalStateUpdate() {
 }
 
 void SNN::clearExtFiringTable() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				clearExtFiringTable_GPU(netId);
 			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					clearExtFiringTable_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
+				argsThreadRoutine[threadCount].snn_pointer = this;
+				argsThreadRoutine[threadCount].netId = netId;
+				argsThreadRoutine[threadCount].lGrpId = 0;
+				argsThreadRoutine[threadCount].startIdx = 0;
+				argsThreadRoutine[threadCount].endIdx = 0;
+				argsThreadRoutine[threadCount].GtoLOffset = 0;
+				threadCount++;
+			}
+		}
+	}
 
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperClearExtFiringTable_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
-			}
-		}
-	}
-
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperClearExtFiringTable_CPU, argsThreadRoutine, threadCount);
 }
 
 void SNN::updateWeights() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				updateWeights_GPU(netId);
 			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					updateWeights_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperUpdateWeights_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
+				argsThreadRoutine[threadCount].snn_pointer = this;
+				argsThreadRoutine[threadCount].netId = netId;
+				argsThreadRoutine[threadCount].lGrpId = 0;
+				argsThreadRoutine[threadCount].startIdx = 0;
+				argsThreadRoutine[threadCount].endIdx = 0;
+				argsThreadRoutine[threadCount].GtoLOffset = 0;
+				threadCount++;
 			}
 		}
 	}
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperUpdateWeights_CPU, argsThreadRoutine, threadCount);
 
 }
 
@@ -2455,48 +2661,27 @@ void SNN::updateNetworkConfig(int netId) {
 }
 
 void SNN::shiftSpikeTables() {
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				shiftSpikeTables_F_GPU(netId);
 			else { // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					shiftSpikeTables_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperShiftSpikeTables_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
+				argsThreadRoutine[threadCount].snn_pointer = this;
+				argsThreadRoutine[threadCount].netId = netId;
+				argsThreadRoutine[threadCount].lGrpId = 0;
+				argsThreadRoutine[threadCount].startIdx = 0;
+				argsThreadRoutine[threadCount].endIdx = 0;
+				argsThreadRoutine[threadCount].GtoLOffset = 0;
+				threadCount++;
 			}
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperShiftSpikeTables_CPU, argsThreadRoutine, threadCount);
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
@@ -2509,10 +2694,38 @@ void SNN::shiftSpikeTables() {
 void SNN::allocateSNN(int netId) {
 	assert(netId > ANY && netId < MAX_NET_PER_SNN);
 	
-	if (netId < CPU_RUNTIME_BASE)
+	if (netId < CPU_RUNTIME_BASE) {
 		allocateSNN_GPU(netId);
-	else 
-		allocateSNN_CPU(netId);
+	} else {
+		// allocate (and first touch) the runtime data on the worker that will execute this runtime, so that the OS
+		// places the pages on the NUMA node of that worker rather than on the node of the calling thread
+		ThreadStruct args;
+		args.snn_pointer = this;
+		args.netId = netId;
+		args.lGrpId = 0;
+		args.startIdx = 0;
+		args.endIdx = 0;
+		args.GtoLOffset = 0;
+
+		if (cpuWorkerPool != NULL)
+			cpuWorkerPool->runOnWorker(getCPURuntimeWorkerId(netId), &SNN::helperAllocateSNN_CPU, &args);
+		else
+			helperAllocateSNN_CPU((void*)&args);
+	}
+}
+
+int SNN::getCPURuntimeWorkerId(int netId) {
+	assert(netId >= CPU_RUNTIME_BASE && netId < MAX_NET_PER_SNN);
+
+	// tasks are appended in the order of netId, with numCPUThreadsPerRuntime_ consecutive neuron-range tasks per CPU
+	// runtime (see addNeuronRangeTasks), and task i is executed by worker i
+	int cpuRuntimeIdx = 0;
+	for (int id = CPU_RUNTIME_BASE; id < netId; id++) {
+		if (!groupPartitionLists[id].empty())
+			cpuRuntimeIdx++;
+	}
+
+	return cpuRuntimeIdx * numCPUThreadsPerRuntime_;
 }
 
 void SNN::allocateManagerRuntimeData() {
@@ -2885,11 +3098,26 @@ void SNN::generateRuntimeNetworkConfigs() {
 
 			// find the maximum number of pre- and post-connections among neurons
 			// SNN::maxNumPreSynN and SNN::maxNumPostSynN are updated
-			findMaxNumSynapsesNeurons(netId, networkConfigs[netId].maxNumPostSynN, networkConfigs[netId].maxNumPreSynN);
+			// a loaded simulation has no connection lists, its file holds them (see loadSimulation_internal)
+			if (loadSimFID == NULL)
+				findMaxNumSynapsesNeurons(netId, networkConfigs[netId].maxNumPostSynN, networkConfigs[netId].maxNumPreSynN);
 
 			// find the maximum number of spikes in D1 (i.e., maxDelay == 1) and D2 (i.e., maxDelay >= 2) sets
 			findMaxSpikesD1D2(netId, networkConfigs[netId].maxSpikesD1, networkConfigs[netId].maxSpikesD2);
 
+			// the firing tables of CPU runtimes start small and grow on demand (see growFiringTables_CPU), whereas
+			// GPU runtimes keep the worst-case estimate
+			if (netId >= CPU_RUNTIME_BASE) {
+				// Note: findMaxSpikesD1D2 assigns the groups by their incoming delay, whereas findFiring_CPU writes a spike
+				// to the firing table of the outgoing delay, hence any neuron of the runtime may fire into either table
+				maxSpikesPerStepD1[netId] = (networkConfigs[netId].maxSpikesD1 + networkConfigs[netId].maxSpikesD2) / NEURON_MAX_FIRING_RATE;
+				maxSpikesPerStepD2[netId] = maxSpikesPerStepD1[netId];
+				networkConfigs[netId].maxSpikesD1 = std::min(networkConfigs[netId].maxSpikesD1,
+					maxSpikesPerStepD1[netId] * FIRING_TABLE_INIT_FIRING_RATE + 1);
+				networkConfigs[netId].maxSpikesD2 = std::min(networkConfigs[netId].maxSpikesD2,
+					maxSpikesPerStepD2[netId] * FIRING_TABLE_INIT_FIRING_RATE + 1);
+			}
+
 			// find the total number of synapses in the network
 			findNumSynapsesNetwork(netId, networkConfigs[netId].numPostSynNet, networkConfigs[netId].numPreSynNet);
 
@@ -2935,18 +3163,13 @@ void SNN::generateRuntimeNetworkConfigs() {
 	}
 }
 
-bool compareSrcNeuron(const ConnectionInfo& first, const ConnectionInfo& second) {
-	return (first.nSrc + first.srcGLoffset < second.nSrc + second.srcGLoffset);
-}
-
-bool compareDelay(const ConnectionInfo& first, const ConnectionInfo& second) {
-	return (first.delay < second.delay);
-}
-
 // Note: ConnectInfo stored in connectionList use global ids
+// The synapses are written to their final places in two passes over connectionLists[netId]: a counting pass, which
+// generates Npost, Npre, and the number of synapses per pre-synaptic neuron and delay, and a fill pass, which writes
+// preSynapticIds, postSynapticIds, and the synaptic weights. No intermediate lists are built.
 void SNN::generateConnectionRuntime(int netId) {
-	std::map<int, int> GLoffset; // global nId to local nId offset
-	std::map<int, int> GLgrpId; // global grpId to local grpId offset
+	std::vector<int> GLoffset(numGroups, 0); // global nId to local nId offset
+	std::vector<int> GLgrpId(numGroups, -1); // global grpId to local grpId offset
 
 	// load offset between global neuron id and local neuron id 
 	for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
@@ -2956,56 +3179,51 @@ void SNN::generateConnectionRuntime(int netId) {
 	// FIXME: connId is global connId, use connectConfigs[netId][local connId] instead,
 	// FIXME; but note connectConfigs[netId][] are NOT complete, lack of exeternal incoming connections
 	// generate mulSynFast, mulSynSlow in connection-centric array
+	std::vector<bool> connPlastic(MAX_CONN_PER_SNN, false);
 	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
 		// store scaling factors for synaptic currents in connection-centric array
 		mulSynFast[connIt->second.connId] = connIt->second.mulSynFast;
 		mulSynSlow[connIt->second.connId] = connIt->second.mulSynSlow;
+		connPlastic[connIt->second.connId] = (GET_FIXED_PLASTIC(connIt->second.connProp) == SYN_PLASTIC);
 	}
 
+	// pass 1: count the synapses
 	// parse ConnectionInfo stored in connectionLists[0]
 	// note: ConnectInfo stored in connectionList use global ids
-	// generate Npost, Npre, Npre_plastic
+	// generate Npost, Npre, Npre_plastic, and the number of post-synaptic synapses per delay (postDelayInfo)
+	int numNAssigned = networkConfigs[netId].numNAssigned;
+	int delayStride = glbNetworkConfig.maxDelay + 1;
 	int parsedConnections = 0;
-	memset(managerRuntimeData.Npost, 0, sizeof(short) * networkConfigs[netId].numNAssigned);
-	memset(managerRuntimeData.Npre, 0, sizeof(short) * networkConfigs[netId].numNAssigned);
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		connIt->srcGLoffset = GLoffset[connIt->grpSrc];
-		if (managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]] == SYNAPSE_ID_MASK) {
+	memset(managerRuntimeData.Npost, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.Npre, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.Npre_plastic, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * (numNAssigned * delayStride));
+	for (std::vector<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
+		int lNIdPre = connIt->nSrc + GLoffset[connIt->grpSrc];
+		int lNIdPost = connIt->nDest + GLoffset[connIt->grpDest];
+		if (managerRuntimeData.Npost[lNIdPre] == SYNAPSE_ID_MASK) {
 			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connIt->nSrc, connIt->grpSrc);
 			exitSimulation(ID_OVERFLOW_ERROR);
 		}
-		if (managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]] == SYNAPSE_ID_MASK) {
+		if (managerRuntimeData.Npre[lNIdPost] == SYNAPSE_ID_MASK) {
 			KERNEL_ERROR("Error: the number of synapses exceeds maximum limit (%d) for neuron %d (group %d)", SYNAPSE_ID_MASK, connIt->nDest, connIt->grpDest);
 			exitSimulation(ID_OVERFLOW_ERROR);
 		}
-		managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]]++;
-		managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]++;
+		managerRuntimeData.Npost[lNIdPre]++;
+		managerRuntimeData.Npre[lNIdPost]++;
+
+		assert(connIt->delay > 0);
+		managerRuntimeData.postDelayInfo[lNIdPre * delayStride + connIt->delay - 1].delay_length++;
 
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_PLASTIC) {
+		if (connPlastic[connIt->connId]) {
 			sim_with_fixedwts = false; // if network has any plastic synapses at all, this will be set to true
-			managerRuntimeData.Npre_plastic[connIt->nDest + GLoffset[connIt->grpDest]]++;
+			managerRuntimeData.Npre_plastic[lNIdPost]++;
 
 			// homeostasis
 			if (groupConfigMap[connIt->grpDest].homeoConfig.WithHomeostasis && groupConfigMDMap[connIt->grpDest].homeoId == -1)
-				groupConfigMDMap[connIt->grpDest].homeoId = connIt->nDest + GLoffset[connIt->grpDest]; // this neuron info will be printed
-
-			// old access to homeostasis
-			//if (groupConfigs[netId][GLgrpId[it->grpDest]].WithHomeostasis && groupConfigs[netId][GLgrpId[it->grpDest]].homeoId == -1)
-			//	groupConfigs[netId][GLgrpId[it->grpDest]].homeoId = it->nDest + GLoffset[it->grpDest]; // this neuron info will be printed
+				groupConfigMDMap[connIt->grpDest].homeoId = lNIdPost; // this neuron info will be printed
 		}
 
-		// generate the delay vaule
-		//it->delay = connectConfigMap[it->connId].minDelay + rand() % (connectConfigMap[it->connId].maxDelay - connectConfigMap[it->connId].minDelay + 1);
-		//assert((it->delay >= connectConfigMap[it->connId].minDelay) && (it->delay <= connectConfigMap[it->connId].maxDelay));
-		// generate the max weight and initial weight
-		//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
-		//float initWt = connectConfigMap[it->connId].initWt;
-		//float maxWt = connectConfigMap[it->connId].maxWt;
-		// adjust sign of weight based on pre-group (negative if pre is inhibitory)
-		// this access is fine, isExcitatoryGroup() use global grpId
-		//it->maxWt = isExcitatoryGroup(it->grpSrc) ? fabs(maxWt) : -1.0 * fabs(maxWt);
-		//it->initWt = isExcitatoryGroup(it->grpSrc) ? fabs(initWt) : -1.0 * fabs(initWt);
-
 		parsedConnections++;
 	}
 	assert(parsedConnections == networkConfigs[netId].numPostSynNet && parsedConnections == networkConfigs[netId].numPreSynNet);
@@ -3013,124 +3231,52 @@ void SNN::generateConnectionRuntime(int netId) {
 	// generate cumulativePost and cumulativePre
 	managerRuntimeData.cumulativePost[0] = 0;
 	managerRuntimeData.cumulativePre[0] = 0;
-	for (int lNId = 1; lNId < networkConfigs[netId].numNAssigned; lNId++) {
+	for (int lNId = 1; lNId < numNAssigned; lNId++) {
 		managerRuntimeData.cumulativePost[lNId] = managerRuntimeData.cumulativePost[lNId - 1] + managerRuntimeData.Npost[lNId - 1];
 		managerRuntimeData.cumulativePre[lNId] = managerRuntimeData.cumulativePre[lNId - 1] + managerRuntimeData.Npre[lNId - 1];
 	}
 
-	// generate preSynapticIds, parse plastic connections first
-	memset(managerRuntimeData.Npre, 0, sizeof(short) * networkConfigs[netId].numNAssigned); // reset managerRuntimeData.Npre to zero, so that it can be used as synId
-	parsedConnections = 0;
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_PLASTIC) {
-			int pre_pos = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]];
-			assert(pre_pos < networkConfigs[netId].numPreSynNet);
-
-			managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), 0, (GLgrpId[connIt->grpSrc])); // managerRuntimeData.Npost[it->nSrc] is not availabe at this parse
-			connIt->preSynId = managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]; // save managerRuntimeData.Npre[it->nDest] as synId
-
-			managerRuntimeData.Npre[connIt->nDest+ GLoffset[connIt->grpDest]]++;
-			parsedConnections++;
-
-			// update the maximum number of and pre-connections of a neuron in a group
-			//if (managerRuntimeData.Npre[it->nDest] > groupInfo[it->grpDest].maxPreConn)
-			//	groupInfo[it->grpDest].maxPreConn = managerRuntimeData.Npre[it->nDest];
+	// the post-synaptic synapses of a neuron are sorted by delay, those with the same delay keep the order of
+	// connectionLists[netId]
+	for (int lNId = 0; lNId < numNAssigned; lNId++) {
+		short delayIndexStart = 0;
+		for (int t = 0; t < glbNetworkConfig.maxDelay; t++) {
+			DelayInfo& dPar = managerRuntimeData.postDelayInfo[lNId * delayStride + t];
+			if (dPar.delay_length > 0)
+				dPar.delay_index_start = delayIndexStart;
+			delayIndexStart += dPar.delay_length;
 		}
 	}
-	// parse fixed connections
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
-		if (GET_FIXED_PLASTIC(connectConfigMap[connIt->connId].connProp) == SYN_FIXED) {
-			int pre_pos = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]];
-			assert(pre_pos < networkConfigs[netId].numPreSynNet);
 
-			managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), 0, (GLgrpId[connIt->grpSrc])); // managerRuntimeData.Npost[it->nSrc] is not availabe at this parse
-			connIt->preSynId = managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]; // save managerRuntimeData.Npre[it->nDest] as synId
+	// pass 2: write the synapses to their places
+	// the pre-synaptic synapses of a neuron start with the plastic ones, both in the order of connectionLists[netId]
+	std::vector<unsigned short> preSynIdPlastic(numNAssigned, 0), preSynIdFixed(numNAssigned, 0);
+	for (int lNId = 0; lNId < numNAssigned; lNId++)
+		preSynIdFixed[lNId] = managerRuntimeData.Npre_plastic[lNId];
+	std::vector<short> delayFill(numNAssigned * delayStride, 0);
+	for (std::vector<ConnectionInfo>::iterator connIt = connectionLists[netId].begin(); connIt != connectionLists[netId].end(); connIt++) {
+		int lNIdPre = connIt->nSrc + GLoffset[connIt->grpSrc];
+		int lNIdPost = connIt->nDest + GLoffset[connIt->grpDest];
 
-			managerRuntimeData.Npre[connIt->nDest + GLoffset[connIt->grpDest]]++;
-			parsedConnections++;
+		int preSynId = connPlastic[connIt->connId] ? preSynIdPlastic[lNIdPost]++ : preSynIdFixed[lNIdPost]++;
+		int delayIdx = lNIdPre * delayStride + connIt->delay - 1;
+		int postSynId = managerRuntimeData.postDelayInfo[delayIdx].delay_index_start + delayFill[delayIdx]++;
 
-			// update the maximum number of and pre-connections of a neuron in a group
-			//if (managerRuntimeData.Npre[it->nDest] > groupInfo[it->grpDest].maxPreConn)
-			//	groupInfo[it->grpDest].maxPreConn = managerRuntimeData.Npre[it->nDest];
-		}
-	}
-	assert(parsedConnections == networkConfigs[netId].numPreSynNet);
-	//printf("parsed pre connections %d\n", parsedConnections);
+		int pre_pos = managerRuntimeData.cumulativePre[lNIdPost] + preSynId;
+		int post_pos = managerRuntimeData.cumulativePost[lNIdPre] + postSynId;
+		assert(pre_pos < networkConfigs[netId].numPreSynNet);
+		assert(post_pos < networkConfigs[netId].numPostSynNet);
 
-	// generate postSynapticIds
-	connectionLists[netId].sort(compareSrcNeuron); // sort by local nSrc id
-	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * (networkConfigs[netId].numNAssigned * (glbNetworkConfig.maxDelay + 1)));
-	for (int lNId = 0; lNId < networkConfigs[netId].numNAssigned; lNId++) { // pre-neuron order, local nId
-		if (managerRuntimeData.Npost[lNId] > 0) {
-			std::list<ConnectionInfo> postConnectionList;
-			ConnectionInfo targetConn;
-			targetConn.nSrc = lNId ; // the other fields does not matter, use local nid to search
-			
-			std::list<ConnectionInfo>::iterator firstPostConn = std::find(connectionLists[netId].begin(), connectionLists[netId].end(), targetConn);
-			std::list<ConnectionInfo>::iterator lastPostConn = firstPostConn;
-			std::advance(lastPostConn, managerRuntimeData.Npost[lNId]);
-			managerRuntimeData.Npost[lNId] = 0; // reset managerRuntimeData.Npost[lNId] to zero, so that it can be used as synId
-
-			postConnectionList.splice(postConnectionList.begin(), connectionLists[netId], firstPostConn, lastPostConn);
-			postConnectionList.sort(compareDelay);
-
-			int post_pos, pre_pos, lastDelay = 0;
-			parsedConnections = 0;
-			//memset(&managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1)], 0, sizeof(DelayInfo) * (glbNetworkConfig.maxDelay + 1));
-			for (std::list<ConnectionInfo>::iterator connIt = postConnectionList.begin(); connIt != postConnectionList.end(); connIt++) {
-				assert(connIt->nSrc + GLoffset[connIt->grpSrc] == lNId);
-				post_pos = managerRuntimeData.cumulativePost[connIt->nSrc + GLoffset[connIt->grpSrc]] + managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]];
-				pre_pos  = managerRuntimeData.cumulativePre[connIt->nDest + GLoffset[connIt->grpDest]] + connIt->preSynId;
-
-				assert(post_pos < networkConfigs[netId].numPostSynNet);
-				//assert(pre_pos  < numPreSynNet);
-
-				// generate a post synaptic id for the current connection
-				managerRuntimeData.postSynapticIds[post_pos] = SET_CONN_ID((connIt->nDest + GLoffset[connIt->grpDest]), connIt->preSynId, (GLgrpId[connIt->grpDest]));// used stored managerRuntimeData.Npre[it->nDest] in it->preSynId
-				// generate a delay look up table by the way
-				assert(connIt->delay > 0);
-				if (connIt->delay > lastDelay) {
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_index_start = managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]];
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_length++;
-				} else if (connIt->delay == lastDelay) {
-					managerRuntimeData.postDelayInfo[lNId * (glbNetworkConfig.maxDelay + 1) + connIt->delay - 1].delay_length++;
-				} else {
-					KERNEL_ERROR("Post-synaptic delays not sorted correctly... pre_id=%d, delay[%d]=%d, delay[%d]=%d",
-						lNId, managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]], connIt->delay, managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]] - 1, lastDelay);
-				}
-				lastDelay = connIt->delay;
-
-				// update the corresponding pre synaptic id
-				SynInfo preId = managerRuntimeData.preSynapticIds[pre_pos];
-				assert(GET_CONN_NEURON_ID(preId) == connIt->nSrc + GLoffset[connIt->grpSrc]);
-				//assert(GET_CONN_GRP_ID(preId) == it->grpSrc);
-				managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID((connIt->nSrc + GLoffset[connIt->grpSrc]), managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]], (GLgrpId[connIt->grpSrc]));
-				managerRuntimeData.wt[pre_pos] = connIt->initWt;
-				managerRuntimeData.maxSynWt[pre_pos] = connIt->maxWt;
-				managerRuntimeData.connIdsPreIdx[pre_pos] = connIt->connId;
-
-				managerRuntimeData.Npost[connIt->nSrc + GLoffset[connIt->grpSrc]]++;
-				parsedConnections++;
-
-				// update the maximum number of and post-connections of a neuron in a group
-				//if (managerRuntimeData.Npost[it->nSrc] > groupInfo[it->grpSrc].maxPostConn)
-				//	groupInfo[it->grpSrc].maxPostConn = managerRuntimeData.Npost[it->nSrc];
-			}
-			assert(parsedConnections == managerRuntimeData.Npost[lNId]);
-			//printf("parsed post connections %d\n", parsedConnections);
-			// note: elements in postConnectionList are deallocated automatically with postConnectionList
-			/* for postDelayInfo debugging
-			printf("%d ", lNId);
-			for (int t = 0; t < maxDelay_ + 1; t ++) {
-				printf("[%d,%d]",
-					managerRuntimeData.postDelayInfo[lNId * (maxDelay_ + 1) + t].delay_index_start,
-					managerRuntimeData.postDelayInfo[lNId * (maxDelay_ + 1) + t].delay_length);
-			}
-			printf("\n");
-			*/
-		}
+		// generate a post synaptic id for the current connection
+		managerRuntimeData.postSynapticIds[post_pos] = SET_CONN_ID(lNIdPost, preSynId, GLgrpId[connIt->grpDest]);
+		managerRuntimeData.preSynapticIds[pre_pos] = SET_CONN_ID(lNIdPre, postSynId, GLgrpId[connIt->grpSrc]);
+		managerRuntimeData.wt[pre_pos] = connIt->initWt;
+		managerRuntimeData.maxSynWt[pre_pos] = connIt->maxWt;
+		managerRuntimeData.connIdsPreIdx[pre_pos] = connIt->connId;
 	}
-	assert(connectionLists[netId].empty());
+
+	// the synapses are no longer needed in the form of a list
+	std::vector<ConnectionInfo>().swap(connectionLists[netId]);
 
 	//int p = managerRuntimeData.Npost[src];
 
@@ -3350,127 +3496,181 @@ void SNN::compileGroupConfig() {
 }
 
 void SNN::connectNetwork() {
-	// this parse generates local connections
-	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
-		for (std::list<ConnectConfig>::iterator connIt = localConnectLists[netId].begin(); connIt != localConnectLists[netId].end(); connIt++) {
-			switch(connIt->type) {
-				case CONN_RANDOM:
-					connectRandom(netId, connIt, false);
-					break;
-				case CONN_FULL:
-					connectFull(netId, connIt, false);
-					break;
-				case CONN_FULL_NO_DIRECT:
-					connectFull(netId, connIt, false);
-					break;
-				case CONN_ONE_TO_ONE:
-					connectOneToOne(netId, connIt, false);
-					break;
-				case CONN_GAUSSIAN:
-					connectGaussian(netId, connIt, false);
-					break;
-				case CONN_USER_DEFINED:
-					connectUserDefined(netId, connIt, false);
-					break;
-				default:
-					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
-					exitSimulation(-1);
+	// 0. look up the 3D coordinates of all neurons once, instead of per pair of pre- and post-synaptic neurons
+	neuronLocations.assign(glbNetworkConfig.numN, Point3D(0.0, 0.0, 0.0));
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		for (int gNId = groupConfigMDMap[gGrpId].gStartN; gNId <= groupConfigMDMap[gGrpId].gEndN; gNId++)
+			neuronLocations[gNId] = getNeuronLocation3D(gGrpId, gNId - groupConfigMDMap[gGrpId].gStartN);
+	}
+
+	// 1. split the connections into blocks of pre-synaptic neurons, in the order of the connections. This parse covers
+	// the local connections first and the external connections second. A user-defined connection is a single block,
+	// which calls back the user and is therefore generated here, by a single thread, and only once
+	connectionBlocks.clear();
+	for (int pass = 0; pass < 2; pass++) {
+		bool isExternal = (pass == 1);
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			std::list<ConnectConfig>& connectList = isExternal ? externalConnectLists[netId] : localConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++) {
+				int blockSize = (connIt->type == CONN_USER_DEFINED) ? groupConfigMap[connIt->grpSrc].numN : CONN_BLOCK_SIZE;
+				int blockId = 0;
+				for (int gStartN = groupConfigMDMap[connIt->grpSrc].gStartN; gStartN <= groupConfigMDMap[connIt->grpSrc].gEndN;
+					gStartN += blockSize, blockId++)
+				{
+					ConnectionBlock block;
+					block.netId = netId;
+					block.connIt = connIt;
+					block.isExternal = isExternal;
+					block.externalNetId = isExternal ? groupConfigMDMap[connIt->grpDest].netId : -1;
+					block.gStartN = gStartN;
+					block.gEndN = std::min(gStartN + blockSize - 1, groupConfigMDMap[connIt->grpSrc].gEndN);
+					block.rng = CounterRNG(randSeed_, connIt->connId, blockId);
+					block.isExcitatorySrc = isExcitatoryGroup(connIt->grpSrc);
+					block.gSrcStartN = groupConfigMDMap[connIt->grpSrc].gStartN;
+					block.gDestStartN = groupConfigMDMap[connIt->grpDest].gStartN;
+					block.numNDest = groupConfigMap[connIt->grpDest].numN;
+					block.isCounting = (connIt->type != CONN_USER_DEFINED);
+					block.numSynapses = 0;
+					block.numWritten = 0;
+					block.synapses = NULL;
+					block.externalSynapses = NULL;
+					connectionBlocks.push_back(block);
+
+					if (connIt->type == CONN_USER_DEFINED) {
+						connectUserDefined(connectionBlocks.back());
+						connectionBlocks.back().numSynapses = connectionBlocks.back().userSynapses.size();
+					}
+				}
 			}
 		}
 	}
 
-	// this parse generates external connections
-	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
-		for (std::list<ConnectConfig>::iterator connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++) {
-			switch(connIt->type) {
-				case CONN_RANDOM:
-					connectRandom(netId, connIt, true);
-					break;
-				case CONN_FULL:
-					connectFull(netId, connIt, true);
-					break;
-				case CONN_FULL_NO_DIRECT:
-					connectFull(netId, connIt, true);
-					break;
-				case CONN_ONE_TO_ONE:
-					connectOneToOne(netId, connIt, true);
-					break;
-				case CONN_GAUSSIAN:
-					connectGaussian(netId, connIt, true);
-					break;
-				case CONN_USER_DEFINED:
-					connectUserDefined(netId, connIt, true);
-					break;
-				default:
-					KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
-					exitSimulation(-1);
-			}
+	// 2. count the synapses of the blocks in parallel. Each block draws from its own random stream, so that the
+	// synapses do not depend on the number of threads (one per thread of the CPU runtimes). The threads only read the
+	// group configs with find, because operator[] of std::map is not safe to call concurrently
+	int numCPUThreads = 0;
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty())
+			numCPUThreads += numCPUThreadsPerRuntime_;
+	}
+	numCPUThreads = std::min(numCPUThreads, (int)connectionBlocks.size());
+	CpuWorkerPool* pool = (numCPUThreads > 1) ? new CpuWorkerPool(numCPUThreads) : NULL;
+	std::vector<ThreadStruct> args(connectionBlocks.size());
+	for (int i = 0; i < (int)connectionBlocks.size(); i++) {
+		args[i].snn_pointer = this;
+		args[i].startIdx = i;
+	}
+	runConnectBlocks(pool, args);
+
+	// 3. allocate the connection lists, which are flat arrays, once with their final size and assign each block its
+	// slice, in the order of the connections. The synapses of an external connection are part of the connection lists
+	// of both networks
+	size_t listSize[MAX_NET_PER_SNN];
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		listSize[netId] = connectionLists[netId].size();
+	std::vector<size_t> offsets(connectionBlocks.size()), externalOffsets(connectionBlocks.size());
+	for (int i = 0; i < (int)connectionBlocks.size(); i++) {
+		ConnectionBlock& block = connectionBlocks[i];
+		offsets[i] = listSize[block.netId];
+		listSize[block.netId] += block.numSynapses;
+		if (block.externalNetId >= 0) {
+			externalOffsets[i] = listSize[block.externalNetId];
+			listSize[block.externalNetId] += block.numSynapses;
 		}
 	}
-}
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		connectionLists[netId].resize(listSize[netId]);
 
-//! set one specific connection from neuron id 'src' to neuron id 'dest'
-inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, int externalNetId) {
-	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
-	ConnectionInfo connInfo;
-	connInfo.grpSrc = _grpSrc;
-	connInfo.grpDest = _grpDest;
-	connInfo.nSrc = _nSrc;
-	connInfo.nDest = _nDest;
-	connInfo.srcGLoffset = 0;
-	connInfo.connId = _connId;
-	connInfo.preSynId = -1;
-	connInfo.initWt = 0.0f;
-	connInfo.maxWt = 0.0f;
-	connInfo.delay = 0;
+	for (int i = 0; i < (int)connectionBlocks.size(); i++) {
+		ConnectionBlock& block = connectionBlocks[i];
+		block.connIt->numberOfConnections += block.numSynapses;
+		if (block.numSynapses == 0)
+			continue;
 
-	// generate the delay vaule
-	connInfo.delay = connectConfigMap[_connId].minDelay + rand() % (connectConfigMap[_connId].maxDelay - connectConfigMap[_connId].minDelay + 1);
-	assert((connInfo.delay >= connectConfigMap[_connId].minDelay) && (connInfo.delay <= connectConfigMap[_connId].maxDelay));
-	// generate the max weight and initial weight
-	//float initWt = generateWeight(connectConfigMap[it->connId].connProp, connectConfigMap[it->connId].initWt, connectConfigMap[it->connId].maxWt, it->nSrc, it->grpSrc);
-	float initWt = connectConfigMap[_connId].initWt;
-	float maxWt = connectConfigMap[_connId].maxWt;
-	// adjust sign of weight based on pre-group (negative if pre is inhibitory)
-	// this access is fine, isExcitatoryGroup() use global grpId
-	connInfo.maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0 * fabs(maxWt);
-	connInfo.initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0 * fabs(initWt);
-
-	connectionLists[netId].push_back(connInfo);
-
-	// If the connection is external, copy the connection info to the external network
-	if (externalNetId >= 0)
-		connectionLists[externalNetId].push_back(connInfo);
-}
-
-//! set one specific connection from neuron id 'src' to neuron id 'dest'
-inline void SNN::connectNeurons(int netId, int _grpSrc, int _grpDest, int _nSrc, int _nDest, short int _connId, float initWt, float maxWt, uint8_t delay, int externalNetId) {
-	//assert(destN <= CONN_SYN_NEURON_MASK); // total number of neurons is less than 1 million within a GPU
-	ConnectionInfo connInfo;
-	connInfo.grpSrc = _grpSrc;
-	connInfo.grpDest = _grpDest;
-	connInfo.nSrc = _nSrc;
-	connInfo.nDest = _nDest;
-	connInfo.srcGLoffset = 0;
-	connInfo.connId = _connId;
-	connInfo.preSynId = -1;
-	// adjust the sign of the weight based on inh/exc connection
-	connInfo.initWt = isExcitatoryGroup(_grpSrc) ? fabs(initWt) : -1.0*fabs(initWt);
-	connInfo.maxWt = isExcitatoryGroup(_grpSrc) ? fabs(maxWt) : -1.0*fabs(maxWt);
-	connInfo.delay = delay;
+		block.synapses = &connectionLists[block.netId][offsets[i]];
+		if (block.externalNetId >= 0)
+			block.externalSynapses = &connectionLists[block.externalNetId][externalOffsets[i]];
+
+		if (block.connIt->type == CONN_USER_DEFINED) {
+			std::copy(block.userSynapses.begin(), block.userSynapses.end(), block.synapses);
+			if (block.externalSynapses != NULL)
+				std::copy(block.userSynapses.begin(), block.userSynapses.end(), block.externalSynapses);
+			std::vector<ConnectionInfo>().swap(block.userSynapses);
+		} else {
+			// the second pass draws the same random numbers again
+			block.isCounting = false;
+			block.rng.counter = 0;
+		}
+	}
 
-	connectionLists[netId].push_back(connInfo);
+	// 4. generate the synapses of the blocks in parallel, directly into their slices
+	runConnectBlocks(pool, args);
+	if (pool != NULL)
+		delete pool;
 
-	// If the connection is external, copy the connection info to the external network
-	if (externalNetId >= 0)
-		connectionLists[externalNetId].push_back(connInfo);
+	for (int pass = 0; pass < 2; pass++) {
+		bool isExternal = (pass == 1);
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			std::list<ConnectConfig>& connectList = isExternal ? externalConnectLists[netId] : localConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++)
+				addGroupSynapses(netId, connIt, isExternal);
+		}
+	}
+	connectionBlocks.clear();
+	std::vector<Point3D>().swap(neuronLocations);
 }
 
-// make 'C' full connections from grpSrc to grpDest
-void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
+// runs connectBlock on all blocks, on the worker threads of the pool if there is one
+void SNN::runConnectBlocks(CpuWorkerPool* pool, std::vector<ThreadStruct>& args) {
+	if (pool != NULL) {
+		pool->run(&SNN::helperConnectBlock, &args[0], connectionBlocks.size());
+	} else {
+		for (int i = 0; i < (int)connectionBlocks.size(); i++)
+			connectBlock(i);
+	}
+}
+
+// counts (first pass) or generates (second pass) the synapses of a block of pre-synaptic neurons of a connection
+void SNN::connectBlock(int blockId) {
+	ConnectionBlock& block = connectionBlocks[blockId];
+	if (!block.isCounting && block.numSynapses == 0)
+		return;
+
+	switch(block.connIt->type) {
+		case CONN_RANDOM:
+			connectRandom(block);
+			break;
+		case CONN_FULL:
+		case CONN_FULL_NO_DIRECT:
+			connectFull(block);
+			break;
+		case CONN_ONE_TO_ONE:
+			connectOneToOne(block);
+			break;
+		case CONN_GAUSSIAN:
+			connectGaussian(block);
+			break;
+		case CONN_USER_DEFINED:
+			// generated by connectNetwork
+			return;
+		default:
+			KERNEL_ERROR("Invalid connection type( should be 'random', 'full', 'full-no-direct', or 'one-to-one')");
+			exitSimulation(-1);
+	}
+	assert(block.isCounting || block.numWritten == block.numSynapses);
+}
+
+	// Static multithreading subroutine method - helper for the above method
+	void* SNN::helperConnectBlock(void* arguments) {
+		ThreadStruct* args = (ThreadStruct*) arguments;
+		((SNN *)args->snn_pointer) -> connectBlock(args->startIdx);
+		return NULL;
+	}
+
+// updates numPostSynapses and numPreSynapses of the groups of a connection, after its synapses have been generated
+void SNN::addGroupSynapses(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
 	int grpSrc = connIt->grpSrc;
 	int grpDest = connIt->grpDest;
-	bool noDirect = (connIt->type == CONN_FULL_NO_DIRECT);
 	int externalNetId = -1;
 
 	if (isExternal) {
@@ -3478,25 +3678,6 @@ void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool
 		assert(netId != externalNetId);
 	}
 
-	int gPreStart = groupConfigMDMap[grpSrc].gStartN;
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++)  {
-		Point3D locPre = getNeuronLocation3D(grpSrc, gPreN - gPreStart); // 3D coordinates of i
-		int gPostStart = groupConfigMDMap[grpDest].gStartN;
-		for(int gPostN = groupConfigMDMap[grpDest].gStartN; gPostN <= groupConfigMDMap[grpDest].gEndN; gPostN++) { // j: the temp neuron id
-			// if flag is set, don't connect direct connections
-			if(noDirect && gPreN == gPostN)
-				continue;
-
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D locPost = getNeuronLocation3D(grpDest, gPostN - gPostStart); // 3D coordinates of j
-			if (!isPoint3DinRF(connIt->connRadius, locPre, locPost))
-				continue;
-
-			connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-			connIt->numberOfConnections++;
-		}
-	}
-
 	std::list<GroupConfigMD>::iterator grpIt;
 	GroupConfigMD targetGrp;
 
@@ -3510,7 +3691,7 @@ void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool
 	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
 	assert(grpIt != groupPartitionLists[netId].end());
 	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
+
 	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
 	if (isExternal) {
 		targetGrp.gGrpId = grpSrc; // the other fields does not matter
@@ -3525,32 +3706,91 @@ void SNN::connectFull(int netId, std::list<ConnectConfig>::iterator connIt, bool
 	}
 }
 
-void SNN::connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	Grid3D grid_i = getGroupGrid3D(grpSrc);
-	Grid3D grid_j = getGroupGrid3D(grpDest);
-	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
-	int externalNetId = -1;
+//! adds a synapse from neuron id 'src' to neuron id 'dest' to a block, with the weights of the connection and a random delay
+inline void SNN::connectNeurons(ConnectionBlock& block, int _nSrc, int _nDest) {
+	// generate the delay vaule
+	uint8_t delay = block.connIt->minDelay + block.rng.nextInt(block.connIt->maxDelay - block.connIt->minDelay + 1);
+	assert((delay >= block.connIt->minDelay) && (delay <= block.connIt->maxDelay));
 
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
+	connectNeurons(block, _nSrc, _nDest, block.connIt->initWt, block.connIt->maxWt, delay);
+}
+
+//! adds a synapse from neuron id 'src' to neuron id 'dest' to a block
+inline void SNN::connectNeurons(ConnectionBlock& block, int _nSrc, int _nDest, float initWt, float maxWt, uint8_t delay) {
+	// the first pass over a block only counts its synapses
+	if (block.isCounting) {
+		block.numSynapses++;
+		return;
 	}
 
-	for(int i = groupConfigMDMap[grpSrc].gStartN; i <= groupConfigMDMap[grpSrc].gEndN; i++)  {
-		Point3D loc_i = getNeuronLocation3D(i)*scalePre; // i: adjusted 3D coordinates
+	ConnectionInfo connInfo;
+	connInfo.grpSrc = block.connIt->grpSrc;
+	connInfo.grpDest = block.connIt->grpDest;
+	connInfo.nSrc = _nSrc;
+	connInfo.nDest = _nDest;
+	connInfo.srcGLoffset = 0;
+	connInfo.connId = block.connIt->connId;
+	connInfo.preSynId = -1;
+	// adjust the sign of the weight based on inh/exc connection
+	connInfo.initWt = block.isExcitatorySrc ? fabs(initWt) : -1.0*fabs(initWt);
+	connInfo.maxWt = block.isExcitatorySrc ? fabs(maxWt) : -1.0*fabs(maxWt);
+	connInfo.delay = delay;
+
+	// a user-defined connection is generated before the connection lists are allocated
+	if (block.synapses == NULL) {
+		block.userSynapses.push_back(connInfo);
+		return;
+	}
 
-		for(int j = groupConfigMDMap[grpDest].gStartN; j <= groupConfigMDMap[grpDest].gEndN; j++) { // j: the temp neuron id
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D loc_j = getNeuronLocation3D(j); // 3D coordinates of j
+	assert(block.numWritten < block.numSynapses);
+	block.synapses[block.numWritten] = connInfo;
+	if (block.externalSynapses != NULL)
+		block.externalSynapses[block.numWritten] = connInfo;
+	block.numWritten++;
+}
 
-			// make sure point is in RF
-			double rfDist = getRFDist3D(connIt->connRadius,loc_i,loc_j);
-			if (rfDist < 0.0 || rfDist > 1.0)
+// make 'C' full connections from grpSrc to grpDest
+void SNN::connectFull(ConnectionBlock& block) {
+	int grpDest = block.connIt->grpDest;
+	bool noDirect = (block.connIt->type == CONN_FULL_NO_DIRECT);
+
+	int gPostStart = block.gDestStartN;
+	std::vector<int> relPostNIds;
+	for(int gPreN = block.gStartN; gPreN <= block.gEndN; gPreN++)  {
+		Point3D locPre = neuronLocations[gPreN]; // 3D coordinates of i
+		findNeuronsInRF3D(grpDest, block.connIt->connRadius, locPre, relPostNIds); // post-neurons whose RF contains i
+		for (int k = 0; k < (int)relPostNIds.size(); k++) {
+			int gPostN = gPostStart + relPostNIds[k]; // j: the temp neuron id
+			// if flag is set, don't connect direct connections
+			if(noDirect && gPreN == gPostN)
 				continue;
 
+			connectNeurons(block, gPreN, gPostN);
+		}
+	}
+}
+
+void SNN::connectGaussian(ConnectionBlock& block) {
+	// in case pre and post have different Grid3D sizes: scale pre to the grid size of post
+	int grpSrc = block.connIt->grpSrc;
+	int grpDest = block.connIt->grpDest;
+	const Grid3D& grid_i = groupConfigMap.find(grpSrc)->second.grid;
+	const Grid3D& grid_j = groupConfigMap.find(grpDest)->second.grid;
+	Point3D scalePre = Point3D(grid_j.numX, grid_j.numY, grid_j.numZ) / Point3D(grid_i.numX, grid_i.numY, grid_i.numZ);
+
+	// only visit the post-synaptic neurons in the receptive field, in the order of a scan over all pairs
+	std::vector<int> relPostNIds;
+	for(int i = block.gStartN; i <= block.gEndN; i++)  {
+		Point3D loc_i = neuronLocations[i]*scalePre; // i: adjusted 3D coordinates
+
+		findNeuronsInRF3D(grpDest, block.connIt->connRadius, loc_i, relPostNIds);
+		for (int k = 0; k < (int)relPostNIds.size(); k++) {
+			int j = block.gDestStartN + relPostNIds[k]; // j: the temp neuron id
+			Point3D loc_j = neuronLocations[j]; // 3D coordinates of j
+
+			// the point is in the RF
+			double rfDist = getRFDist3D(block.connIt->connRadius,loc_i,loc_j);
+
 			// if rfDist is valid, it returns a number between 0 and 1
 			// we want these numbers to fit to Gaussian weigths, so that rfDist=0 corresponds to max Gaussian weight
 			// and rfDist=1 corresponds to 0.1 times max Gaussian weight
@@ -3560,165 +3800,82 @@ void SNN::connectGaussian(int netId, std::list<ConnectConfig>::iterator connIt,
 			if (gauss < 0.1)
 				continue;
 
-			if (drand48() < connIt->connProbability) {
-				float initWt = gauss * connIt->initWt; // scale weight according to gauss distance
-				float maxWt = connIt->maxWt;
-				uint8_t delay = connIt->minDelay + rand() % (connIt->maxDelay - connIt->minDelay + 1);
-				assert((delay >= connIt->minDelay) && (delay <= connIt->maxDelay));
+			if (block.rng.nextDouble() < block.connIt->connProbability) {
+				float initWt = gauss * block.connIt->initWt; // scale weight according to gauss distance
+				float maxWt = block.connIt->maxWt;
+				uint8_t delay = block.connIt->minDelay + block.rng.nextInt(block.connIt->maxDelay - block.connIt->minDelay + 1);
+				assert((delay >= block.connIt->minDelay) && (delay <= block.connIt->maxDelay));
 
-				connectNeurons(netId, grpSrc, grpDest, i, j, connIt->connId, initWt, maxWt, delay, externalNetId);
-				connIt->numberOfConnections++;
+				connectNeurons(block, i, j, initWt, maxWt, delay);
 			}
 		}
 	}
-
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
-
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
-
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
-
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
-	}
 }
 
-void SNN::connectOneToOne(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
-
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
-	}
-
-	assert( groupConfigMap[grpDest].numN == groupConfigMap[grpSrc].numN);
+void SNN::connectOneToOne(ConnectionBlock& block) {
+	assert(block.numNDest == groupConfigMap.find(block.connIt->grpSrc)->second.numN);
 
 	// NOTE: RadiusRF does not make a difference here: ignore
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN, gPostN = groupConfigMDMap[grpDest].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++, gPostN++)  {
-		connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-		connIt->numberOfConnections++;
-	}
-
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
-
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
-
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
-
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
+	for(int gPreN = block.gStartN; gPreN <= block.gEndN; gPreN++)  {
+		connectNeurons(block, gPreN, block.gDestStartN + gPreN - block.gSrcStartN);
 	}
 }
 
 // make 'C' random connections from grpSrc to grpDest
-void SNN::connectRandom(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
-	int grpSrc = connIt->grpSrc;
-	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
-
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
-	}
-
-	int gPreStart = groupConfigMDMap[grpSrc].gStartN;
-	for(int gPreN = groupConfigMDMap[grpSrc].gStartN; gPreN <= groupConfigMDMap[grpSrc].gEndN; gPreN++) {
-		Point3D locPre = getNeuronLocation3D(grpSrc, gPreN - gPreStart); // 3D coordinates of i
-		int gPostStart = groupConfigMDMap[grpDest].gStartN;
-		for(int gPostN = groupConfigMDMap[grpDest].gStartN; gPostN <= groupConfigMDMap[grpDest].gEndN; gPostN++) {
-			// check whether pre-neuron location is in RF of post-neuron
-			Point3D locPost = getNeuronLocation3D(grpDest, gPostN - gPostStart); // 3D coordinates of j
-			if (!isPoint3DinRF(connIt->connRadius, locPre, locPost))
-				continue;
+void SNN::connectRandom(ConnectionBlock& block) {
+	int grpDest = block.connIt->grpDest;
+	float connProbability = block.connIt->connProbability;
+
+	int gPostStart = block.gDestStartN;
+	RadiusRF radius = block.connIt->connRadius;
+	if (radius.radX < 0 && radius.radY < 0 && radius.radZ < 0) {
+		// every pair is a candidate: instead of drawing a random number per pair, draw the gaps between the created
+		// synapses from a geometric distribution (skip sampling), so that the cost is proportional to the number of
+		// synapses. The pairs of the block are numbered pre-major, as in the loops below.
+		long long numPost = block.numNDest;
+		long long numPairs = (block.gEndN - block.gStartN + 1) * numPost;
+		double logNoConn = log(1.0 - connProbability);
+		long long pairId = -1;
+		while (connProbability > 0.0f) {
+			if (connProbability >= 1.0f) {
+				pairId++;
+			} else {
+				double skip = floor(log(1.0 - block.rng.nextDouble()) / logNoConn);
+				if (skip >= numPairs - pairId)
+					break;
+				pairId += (long long)skip + 1;
+			}
+			if (pairId >= numPairs)
+				break;
 
-			if (drand48() < connIt->connProbability) {
-				connectNeurons(netId, grpSrc, grpDest, gPreN, gPostN, connIt->connId, externalNetId);
-				connIt->numberOfConnections++;
+			connectNeurons(block, block.gStartN + (int)(pairId / numPost), gPostStart + (int)(pairId % numPost));
+		}
+	} else {
+		// only visit the post-synaptic neurons in the receptive field
+		std::vector<int> relPostNIds;
+		for(int gPreN = block.gStartN; gPreN <= block.gEndN; gPreN++) {
+			Point3D locPre = neuronLocations[gPreN]; // 3D coordinates of i
+			findNeuronsInRF3D(grpDest, radius, locPre, relPostNIds);
+			for (int k = 0; k < (int)relPostNIds.size(); k++) {
+				if (block.rng.nextDouble() < connProbability)
+					connectNeurons(block, gPreN, gPostStart + relPostNIds[k]);
 			}
 		}
 	}
-
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
-
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
-
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-	
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
-
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
-	}
 }
 
 // FIXME: rewrite user-define call-back function
 // user-defined functions called here...
 // This is where we define our user-defined call-back function.  -- KDC
-void SNN::connectUserDefined(int netId, std::list<ConnectConfig>::iterator connIt, bool isExternal) {
+void SNN::connectUserDefined(ConnectionBlock& block) {
+	std::list<ConnectConfig>::iterator connIt = block.connIt;
 	int grpSrc = connIt->grpSrc;
 	int grpDest = connIt->grpDest;
-	int externalNetId = -1;
-
-	if (isExternal) {
-		externalNetId = groupConfigMDMap[grpDest].netId;
-		assert(netId != externalNetId);
-	}
 
 	connIt->maxDelay = 0;
 	int preStartN = groupConfigMDMap[grpSrc].gStartN;
 	int postStartN = groupConfigMDMap[grpDest].gStartN;
-	for (int pre_nid = groupConfigMDMap[grpSrc].gStartN; pre_nid <= groupConfigMDMap[grpSrc].gEndN; pre_nid++) {
+	for (int pre_nid = block.gStartN; pre_nid <= block.gEndN; pre_nid++) {
 		//Point3D loc_pre = getNeuronLocation3D(pre_nid); // 3D coordinates of i
 		for (int post_nid = groupConfigMDMap[grpDest].gStartN; post_nid <= groupConfigMDMap[grpDest].gEndN; post_nid++) {
 			float weight, maxWt, delay;
@@ -3739,38 +3896,10 @@ void SNN::connectUserDefined(int netId, std::list<ConnectConfig>::iterator connI
 				if (delay > connIt->maxDelay)
 					connIt->maxDelay = delay;
 
-				connectNeurons(netId, grpSrc, grpDest, pre_nid, post_nid, connIt->connId, weight, maxWt, delay, externalNetId);
-				connIt->numberOfConnections++;
+				connectNeurons(block, pre_nid, post_nid, weight, maxWt, delay);
 			}
 		}
 	}
-
-	std::list<GroupConfigMD>::iterator grpIt;
-	GroupConfigMD targetGrp;
-
-	// update numPostSynapses and numPreSynapses of groups in the local network
-	targetGrp.gGrpId = grpSrc; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPostSynapses += connIt->numberOfConnections;
-
-	targetGrp.gGrpId = grpDest; // the other fields does not matter
-	grpIt = std::find(groupPartitionLists[netId].begin(), groupPartitionLists[netId].end(), targetGrp);
-	assert(grpIt != groupPartitionLists[netId].end());
-	grpIt->numPreSynapses += connIt->numberOfConnections;
-
-	// also update numPostSynapses and numPreSynapses of groups in the external network if the connection is external
-	if (isExternal) {
-		targetGrp.gGrpId = grpSrc; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPostSynapses += connIt->numberOfConnections;
-
-		targetGrp.gGrpId = grpDest; // the other fields does not matter
-		grpIt = std::find(groupPartitionLists[externalNetId].begin(), groupPartitionLists[externalNetId].end(), targetGrp);
-		assert(grpIt != groupPartitionLists[externalNetId].end());
-		grpIt->numPreSynapses += connIt->numberOfConnections;
-	}
 }
 
 //// make 'C' full connections from grpSrc to grpDest
@@ -3952,48 +4081,27 @@ void SNN::deleteRuntimeData() {
 	CUDA_CHECK_ERRORS(cudaThreadSynchronize());
 #endif
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-		cpu_set_t cpus;	
-		ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-		int threadCount = 0;
-	#endif
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
 
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {
 			if (netId < CPU_RUNTIME_BASE) // GPU runtime
 				deleteRuntimeData_GPU(netId);
 			else{ // CPU runtime
-				#if defined(WIN32) || defined(WIN64)
-					deleteRuntimeData_CPU(netId);
-				#else // Linux or MAC
-					pthread_attr_t attr;
-					pthread_attr_init(&attr);
-					CPU_ZERO(&cpus);
-					CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-					pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-					argsThreadRoutine[threadCount].snn_pointer = this;
-					argsThreadRoutine[threadCount].netId = netId;
-					argsThreadRoutine[threadCount].lGrpId = 0;
-					argsThreadRoutine[threadCount].startIdx = 0;
-					argsThreadRoutine[threadCount].endIdx = 0;
-					argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-					pthread_create(&threads[threadCount], &attr, &SNN::helperDeleteRuntimeData_CPU, (void*)&argsThreadRoutine[threadCount]);
-					pthread_attr_destroy(&attr);
-					threadCount++;
-				#endif
+				argsThreadRoutine[threadCount].snn_pointer = this;
+				argsThreadRoutine[threadCount].netId = netId;
+				argsThreadRoutine[threadCount].lGrpId = 0;
+				argsThreadRoutine[threadCount].startIdx = 0;
+				argsThreadRoutine[threadCount].endIdx = 0;
+				argsThreadRoutine[threadCount].GtoLOffset = 0;
+				threadCount++;
 			}
 		}
 	}
 
-	#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-		// join all the threads
-		for (int i=0; i<threadCount; i++){
-			pthread_join(threads[i], NULL);
-		}
-	#endif
+	// run the CPU runtimes on the worker pool and wait for them to finish
+	runCPUTasks(&SNN::helperDeleteRuntimeData_CPU, argsThreadRoutine, threadCount);
 
 #ifndef __NO_CUDA__
 	CUDA_DELETE_TIMER(timer);
@@ -4014,7 +4122,18 @@ void SNN::deleteObjects() {
 	// delete manager runtime data
 	deleteManagerRuntimeData();
 
-	deleteRuntimeData();
+	deleteRuntimeData();
+
+	if (networkCacheFID_ != NULL) {
+		fclose(networkCacheFID_);
+		networkCacheFID_ = NULL;
+	}
+
+	// join the CPU worker threads
+	if (cpuWorkerPool != NULL) {
+		delete cpuWorkerPool;
+		cpuWorkerPool = NULL;
+	}
 
 	// fclose file streams, unless in custom mode
 	if (loggerMode_ != CUSTOM) {
@@ -4050,7 +4169,7 @@ void SNN::findMaxNumSynapsesGroups(int* _maxNumPostSynGrp, int* _maxNumPreSynGrp
 void SNN::findMaxNumSynapsesNeurons(int _netId, int& _maxNumPostSynN, int& _maxNumPreSynN) {
 	int *tempNpre, *tempNpost;
 	int nSrc, nDest, numNeurons;
-	std::map<int, int> globalToLocalOffset;
+	std::vector<int> globalToLocalOffset(numGroups, 0);
 
 	numNeurons = networkConfigs[_netId].numNAssigned;
 	tempNpre = new int[numNeurons];
@@ -4064,7 +4183,7 @@ void SNN::findMaxNumSynapsesNeurons(int _netId, int& _maxNumPostSynN, int& _maxN
 	}
 
 	// calculate number of pre- and post- connections of each neuron
-	for (std::list<ConnectionInfo>::iterator connIt = connectionLists[_netId].begin(); connIt != connectionLists[_netId].end(); connIt++) {
+	for (std::vector<ConnectionInfo>::iterator connIt = connectionLists[_netId].begin(); connIt != connectionLists[_netId].end(); connIt++) {
 		nSrc = connIt->nSrc + globalToLocalOffset[connIt->grpSrc];
 		nDest = connIt->nDest + globalToLocalOffset[connIt->grpDest];
 		assert(nSrc < numNeurons); assert(nDest < numNeurons);
@@ -4360,7 +4479,7 @@ void SNN::fetchSpikeTables(int netId) {
 	if (netId < CPU_RUNTIME_BASE)
 		copySpikeTables(netId, cudaMemcpyDeviceToHost);
 	else
-		copySpikeTables(netId);
+		copySpikeTables(netId, true);
 }
 
 void SNN::fetchExtFiringTable(int netId) {
@@ -4431,10 +4550,33 @@ void SNN::routeSpikes() {
 	int firingTableIdxD2, firingTableIdxD1;
 	int GtoLOffset;
 
+	// CPU runtimes that only receive spikes from other CPU runtimes collect them in parallel, directly from the
+	// external firing tables of the source runtimes
+	ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+	int threadCount = 0;
+
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty() && cpuDirectSpikeExchange[netId]) {
+			argsThreadRoutine[threadCount].snn_pointer = this;
+			argsThreadRoutine[threadCount].netId = netId;
+			argsThreadRoutine[threadCount].lGrpId = 0;
+			argsThreadRoutine[threadCount].startIdx = 0;
+			argsThreadRoutine[threadCount].endIdx = 0;
+			argsThreadRoutine[threadCount].GtoLOffset = 0;
+			threadCount++;
+		}
+	}
+
+	runCPUTasks(&SNN::helperReceiveExtSpikes_CPU, argsThreadRoutine, threadCount);
+
+	// all other routes involve a GPU runtime and are staged through managerRuntimeData
 	for (std::list<RoutingTableEntry>::iterator rteItr = spikeRoutingTable.begin(); rteItr != spikeRoutingTable.end(); rteItr++) {
 		int srcNetId = rteItr->srcNetId;
 		int destNetId = rteItr->destNetId;
 
+		if (cpuDirectSpikeExchange[destNetId])
+			continue;
+
 		fetchExtFiringTable(srcNetId);
 
 		fetchTimeTable(destNetId);
@@ -4442,12 +4584,21 @@ void SNN::routeSpikes() {
 		firingTableIdxD1 = managerRuntimeData.timeTableD1[simTimeMs + glbNetworkConfig.maxDelay + 1];
 		//KERNEL_DEBUG("GPU1 D1:%d/D2:%d", firingTableIdxD1, firingTableIdxD2);
 
-		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			pthread_t threads[(2 * networkConfigs[srcNetId].numGroups) + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
-			ThreadStruct argsThreadRoutine[(2 * networkConfigs[srcNetId].numGroups) + 1]; // same as above, +1 array size
-			int threadCount = 0;
-		#endif
+		// make room for all spikes of the source runtime in the growable firing tables of a CPU runtime
+		if (destNetId >= CPU_RUNTIME_BASE) {
+			unsigned int numSpikesRxD2 = 0, numSpikesRxD1 = 0;
+			for (int lGrpId = 0; lGrpId < networkConfigs[srcNetId].numGroups; lGrpId++) {
+				if (groupConfigs[srcNetId][lGrpId].hasExternalConnect) {
+					numSpikesRxD2 += managerRuntimeData.extFiringTableEndIdxD2[lGrpId];
+					numSpikesRxD1 += managerRuntimeData.extFiringTableEndIdxD1[lGrpId];
+				}
+			}
+			growFiringTables_CPU(destNetId, firingTableIdxD1 + numSpikesRxD1, firingTableIdxD2 + numSpikesRxD2);
+		}
+
+		ThreadStruct argsThreadRoutineD2[MAX_GRP_PER_SNN]; // one task per source group
+		ThreadStruct argsThreadRoutineD1[MAX_GRP_PER_SNN];
+		int threadCountD2 = 0, threadCountD1 = 0;
 
 		for (int lGrpId = 0; lGrpId < networkConfigs[srcNetId].numGroups; lGrpId++) {
 			if (groupConfigs[srcNetId][lGrpId].hasExternalConnect && managerRuntimeData.extFiringTableEndIdxD2[lGrpId] > 0) {
@@ -4472,28 +4623,13 @@ void SNN::routeSpikes() {
 							GtoLOffset); // [StartIdx, EndIdx)
 					}
 					else{// CPU runtime
-							#if defined(WIN32) || defined(WIN64)
-								convertExtSpikesD2_CPU(destNetId, firingTableIdxD2,
-									firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId],
-									GtoLOffset); // [StartIdx, EndIdx)
-							#else // Linux or MAC
-								pthread_attr_t attr;
-								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-								argsThreadRoutine[threadCount].snn_pointer = this;
-								argsThreadRoutine[threadCount].netId = destNetId;
-								argsThreadRoutine[threadCount].lGrpId = 0;
-								argsThreadRoutine[threadCount].startIdx = firingTableIdxD2;
-								argsThreadRoutine[threadCount].endIdx = firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId];
-								argsThreadRoutine[threadCount].GtoLOffset = GtoLOffset;
-
-								pthread_create(&threads[threadCount], &attr, &SNN::helperConvertExtSpikesD2_CPU, (void*)&argsThreadRoutine[threadCount]);
-								pthread_attr_destroy(&attr);
-								threadCount++;
-							#endif
+						argsThreadRoutineD2[threadCountD2].snn_pointer = this;
+						argsThreadRoutineD2[threadCountD2].netId = destNetId;
+						argsThreadRoutineD2[threadCountD2].lGrpId = 0;
+						argsThreadRoutineD2[threadCountD2].startIdx = firingTableIdxD2;
+						argsThreadRoutineD2[threadCountD2].endIdx = firingTableIdxD2 + managerRuntimeData.extFiringTableEndIdxD2[lGrpId]; // [StartIdx, EndIdx)
+						argsThreadRoutineD2[threadCountD2].GtoLOffset = GtoLOffset;
+						threadCountD2++;
 					}
 
 					firingTableIdxD2 += managerRuntimeData.extFiringTableEndIdxD2[lGrpId];
@@ -4521,28 +4657,13 @@ void SNN::routeSpikes() {
 							GtoLOffset); // [StartIdx, EndIdx)
 					}
 					else{// CPU runtime
-						#if defined(WIN32) || defined(WIN64)
-								convertExtSpikesD1_CPU(destNetId, firingTableIdxD1,
-									firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId],
-									GtoLOffset); // [StartIdx, EndIdx)
-							#else // Linux or MAC
-								pthread_attr_t attr;
-								pthread_attr_init(&attr);
-								CPU_ZERO(&cpus);
-								CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-								pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-								argsThreadRoutine[threadCount].snn_pointer = this;
-								argsThreadRoutine[threadCount].netId = destNetId;
-								argsThreadRoutine[threadCount].lGrpId = 0;
-								argsThreadRoutine[threadCount].startIdx = firingTableIdxD1;
-								argsThreadRoutine[threadCount].endIdx = firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId];
-								argsThreadRoutine[threadCount].GtoLOffset = GtoLOffset;
-
-								pthread_create(&threads[threadCount], &attr, &SNN::helperConvertExtSpikesD1_CPU, (void*)&argsThreadRoutine[threadCount]);
-								pthread_attr_destroy(&attr);
-								threadCount++;
-							#endif
+						argsThreadRoutineD1[threadCountD1].snn_pointer = this;
+						argsThreadRoutineD1[threadCountD1].netId = destNetId;
+						argsThreadRoutineD1[threadCountD1].lGrpId = 0;
+						argsThreadRoutineD1[threadCountD1].startIdx = firingTableIdxD1;
+						argsThreadRoutineD1[threadCountD1].endIdx = firingTableIdxD1 + managerRuntimeData.extFiringTableEndIdxD1[lGrpId]; // [StartIdx, EndIdx)
+						argsThreadRoutineD1[threadCountD1].GtoLOffset = GtoLOffset;
+						threadCountD1++;
 					}
 					firingTableIdxD1 += managerRuntimeData.extFiringTableEndIdxD1[lGrpId];
 				}
@@ -4550,12 +4671,9 @@ void SNN::routeSpikes() {
 			//KERNEL_DEBUG("GPU1 New D1:%d/D2:%d", firingTableIdxD1, firingTableIdxD2);
 		}
 
-		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
-		#endif
+		// convert the received spikes on the worker pool and wait for them to finish
+		runCPUTasks(&SNN::helperConvertExtSpikesD2_CPU, argsThreadRoutineD2, threadCountD2);
+		runCPUTasks(&SNN::helperConvertExtSpikesD1_CPU, argsThreadRoutineD1, threadCountD1);
 
 		managerRuntimeData.timeTableD2[simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD2;
 		managerRuntimeData.timeTableD1[simTimeMs + glbNetworkConfig.maxDelay + 1] = firingTableIdxD1;
@@ -4799,17 +4917,213 @@ double SNN::getRFDist3D(const RadiusRF& radius, const Point3D& pre, const Point3
 	return rfDist;
 }
 
+// returns the range [first, last] of the grid indices along one dimension whose coordinates (dist * idx + offset) may
+// lie within radius of coord. A negative radius does not restrict the dimension. The range has a margin of one grid
+// point, so that rounding never drops a neuron: the caller checks every neuron of the range with isPoint3DinRF.
+static void getRFIndexRange(double coord, float radius, float dist, float offset, int num, int& first, int& last) {
+	first = 0;
+	last = num - 1;
+	if (radius < 0)
+		return;
+
+	double lo = (coord - radius - offset) / dist;
+	double hi = (coord + radius - offset) / dist;
+	if (lo > hi)
+		std::swap(lo, hi);
+	first = (int)std::max(floor(lo) - 1.0, 0.0);
+	last = (int)std::min(ceil(hi) + 1.0, num - 1.0);
+}
+
+// Enumerates only the bounding box of the receptive field in the grid of the group, so that the cost of finite receptive
+// fields is proportional to their size rather than to the size of the group. The neurons are returned in the order
+// of their ids, i.e., in the same order as a scan over all neurons of the group. The coordinates of the neurons are taken
+// from neuronLocations, which connectNetwork fills before the synapses are generated.
+void SNN::findNeuronsInRF3D(int gGrpId, const RadiusRF& radius, const Point3D& pre, std::vector<int>& relNIds) {
+	const Grid3D& grid = groupConfigMap.find(gGrpId)->second.grid;
+	const Point3D* locations = &neuronLocations[groupConfigMDMap.find(gGrpId)->second.gStartN];
+	assert((int)neuronLocations.size() == glbNetworkConfig.numN);
+	int firstX, lastX, firstY, lastY, firstZ, lastZ;
+	getRFIndexRange(pre.x, radius.radX, grid.distX, grid.offsetX, grid.numX, firstX, lastX);
+	getRFIndexRange(pre.y, radius.radY, grid.distY, grid.offsetY, grid.numY, firstY, lastY);
+	getRFIndexRange(pre.z, radius.radZ, grid.distZ, grid.offsetZ, grid.numZ, firstZ, lastZ);
+
+	relNIds.clear();
+	for (int z = firstZ; z <= lastZ; z++) {
+		for (int y = firstY; y <= lastY; y++) {
+			for (int x = firstX; x <= lastX; x++) {
+				int relNId = x + grid.numX * (y + grid.numY * z);
+				if (isPoint3DinRF(radius, pre, locations[relNId]))
+					relNIds.push_back(relNId);
+			}
+		}
+	}
+}
+
+// Greedy graph partitioning of the groups with preferredNetId ANY onto the CPU runtimes
+// CPU_RUNTIME_BASE..CPU_RUNTIME_BASE+numPartitions-1.
+// The cost of a group is estimated from its size (neuron update) and its expected number of incoming synapses (spike
+// delivery), the spike traffic of a connection between two groups from the size of the source group, since every spike
+// of a source neuron has to be routed to each other runtime that hosts a post-synaptic group. Groups are placed in the
+// order of decreasing cost; each group goes to the runtime it exchanges the most spikes with, as long as that runtime
+// stays below (1 + slack) times the average load. Otherwise, it goes to the least loaded runtime. Groups that are
+// connected by compartmental connections are always placed together. Groups with a user-specified preferredNetId keep
+// their runtime, but count towards its load.
+std::vector<int> SNN::partitionGroupsCPU(int numPartitions) {
+	assert(numPartitions > 1 && CPU_RUNTIME_BASE + numPartitions <= MAX_NET_PER_SNN);
+
+	// relative costs per ms: a neuron update vs. the delivery of a spike over one synapse (assuming ~10 Hz firing)
+	const double costRegularNeuron = 1.0;
+	const double costPoissonNeuron = 0.1;
+	const double costSynapse = 0.01;
+	const double slack = 0.1; // allowed load imbalance
+
+	std::vector<int> netIds(numGroups, ANY);
+	std::vector<double> grpCost(numGroups, 0.0);
+	std::vector<std::vector<double> > traffic(numGroups, std::vector<double>(numGroups, 0.0));
+
+	// estimate the cost of each group
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		int numN = groupConfigMap[gGrpId].numN;
+		grpCost[gGrpId] = numN * ((groupConfigMap[gGrpId].type & POISSON_NEURON) ? costPoissonNeuron : costRegularNeuron);
+	}
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		int grpSrc = connIt->second.grpSrc;
+		int grpDest = connIt->second.grpDest;
+		double numPre = groupConfigMap[grpSrc].numN;
+		double numPost = groupConfigMap[grpDest].numN;
+		double numSyn;
+		switch (connIt->second.type) {
+		case CONN_ONE_TO_ONE:
+			numSyn = numPre;
+			break;
+		case CONN_FULL:
+			numSyn = numPre * numPost;
+			break;
+		case CONN_FULL_NO_DIRECT:
+			numSyn = numPre * (grpSrc == grpDest ? numPost - 1 : numPost);
+			break;
+		default: // CONN_RANDOM, CONN_GAUSSIAN, CONN_USER_DEFINED: connection probability is an upper bound
+			numSyn = numPre * numPost * connIt->second.connProbability;
+			break;
+		}
+		grpCost[grpDest] += numSyn * costSynapse; // spikes are delivered by the runtime of the post-synaptic group
+
+		if (grpSrc != grpDest) {
+			traffic[grpSrc][grpDest] += numPre;
+			traffic[grpDest][grpSrc] += numPre;
+		}
+	}
+
+	// groups with a user-specified CPU runtime count towards its load
+	std::vector<double> load(MAX_NET_PER_SNN, 0.0);
+	double totalCost = 0.0;
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		int netId = groupConfigMap[gGrpId].preferredNetId;
+		if (netId != ANY)
+			load[netId] += grpCost[gGrpId];
+		if (netId == ANY || (netId >= CPU_RUNTIME_BASE && netId < CPU_RUNTIME_BASE + numPartitions))
+			totalCost += grpCost[gGrpId];
+	}
+	double maxLoad = (1.0 + slack) * totalCost / numPartitions;
+
+	// place the groups in the order of decreasing cost (ties are broken by group id)
+	std::vector<std::pair<double, int> > order;
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		if (groupConfigMap[gGrpId].preferredNetId == ANY)
+			order.push_back(std::make_pair(-grpCost[gGrpId], gGrpId));
+	}
+	std::sort(order.begin(), order.end());
+
+	for (int i = 0; i < (int)order.size(); i++) {
+		int gGrpId = order[i].second;
+		int bestNetId = ANY;
+
+		// compartmentally connected groups have to be in the same runtime
+		for (std::map<int, compConnectConfig>::iterator connIt = compConnectConfigMap.begin(); connIt != compConnectConfigMap.end() && bestNetId == ANY; connIt++) {
+			int otherGrpId = (connIt->second.grpSrc == gGrpId) ? connIt->second.grpDest : (connIt->second.grpDest == gGrpId ? connIt->second.grpSrc : ANY);
+			if (otherGrpId != ANY)
+				bestNetId = (groupConfigMap[otherGrpId].preferredNetId != ANY) ? groupConfigMap[otherGrpId].preferredNetId : netIds[otherGrpId];
+		}
+
+		// otherwise, prefer the runtime with the most spike traffic to the group that still has room for it
+		if (bestNetId == ANY) {
+			double bestTraffic = -1.0;
+			for (int netId = CPU_RUNTIME_BASE; netId < CPU_RUNTIME_BASE + numPartitions; netId++) {
+				if (load[netId] > 0.0 && load[netId] + grpCost[gGrpId] > maxLoad)
+					continue;
+
+				double netTraffic = 0.0;
+				for (int otherGrpId = 0; otherGrpId < numGroups; otherGrpId++) {
+					int otherNetId = (groupConfigMap[otherGrpId].preferredNetId != ANY) ? groupConfigMap[otherGrpId].preferredNetId : netIds[otherGrpId];
+					if (otherNetId == netId)
+						netTraffic += traffic[gGrpId][otherGrpId];
+				}
+
+				if (netTraffic > bestTraffic || (netTraffic == bestTraffic && load[netId] < load[bestNetId])) {
+					bestTraffic = netTraffic;
+					bestNetId = netId;
+				}
+			}
+		}
+
+		// no runtime has room left: use the least loaded one
+		if (bestNetId == ANY) {
+			bestNetId = CPU_RUNTIME_BASE;
+			for (int netId = CPU_RUNTIME_BASE + 1; netId < CPU_RUNTIME_BASE + numPartitions; netId++) {
+				if (load[netId] < load[bestNetId])
+					bestNetId = netId;
+			}
+		}
+
+		netIds[gGrpId] = bestNetId;
+		load[bestNetId] += grpCost[gGrpId];
+	}
+
+	// report the partition
+	double cutTraffic = 0.0;
+	for (int gGrpSrc = 0; gGrpSrc < numGroups; gGrpSrc++) {
+		for (int gGrpDest = gGrpSrc + 1; gGrpDest < numGroups; gGrpDest++) {
+			int srcNetId = (groupConfigMap[gGrpSrc].preferredNetId != ANY) ? groupConfigMap[gGrpSrc].preferredNetId : netIds[gGrpSrc];
+			int destNetId = (groupConfigMap[gGrpDest].preferredNetId != ANY) ? groupConfigMap[gGrpDest].preferredNetId : netIds[gGrpDest];
+			if (srcNetId != destNetId)
+				cutTraffic += traffic[gGrpSrc][gGrpDest];
+		}
+	}
+	KERNEL_INFO("Automatic partitioning of %d group(s) onto %d CPU runtime(s), estimated load (groups):", (int)order.size(), numPartitions);
+	for (int netId = CPU_RUNTIME_BASE; netId < CPU_RUNTIME_BASE + numPartitions; netId++) {
+		std::string grpNames;
+		for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+			if (netIds[gGrpId] == netId)
+				grpNames += (grpNames.empty() ? "" : ", ") + groupConfigMap[gGrpId].grpName;
+		}
+		KERNEL_INFO("  CPU runtime %d: %.1f (%s)", netId - CPU_RUNTIME_BASE, load[netId], grpNames.c_str());
+	}
+	KERNEL_INFO("  Spike traffic between runtimes: %.0f neuron(s)", cutTraffic);
+
+	return netIds;
+}
+
 void SNN::partitionSNN() {
 	int numAssignedNeurons[MAX_NET_PER_SNN] = {0};
 
 	// get number of available GPU card(s) in the present machine
 	numAvailableGPUs = configGPUDevice();
 
+	// distribute the groups that can run anywhere among multiple CPU runtimes (if requested)
+	std::vector<int> autoNetIds(numGroups, ANY);
+	if (numCPUAutoPartitions_ > 1 && (preferredSimMode_ == CPU_MODE || preferredSimMode_ == HYBRID_MODE))
+		autoNetIds = partitionGroupsCPU(numCPUAutoPartitions_);
+
 	for (std::map<int, GroupConfigMD>::iterator grpIt = groupConfigMDMap.begin(); grpIt != groupConfigMDMap.end(); grpIt++) {
 		// assign a group to the GPU specified by users
 		int gGrpId = grpIt->second.gGrpId;
 		int netId = groupConfigMap[gGrpId].preferredNetId;
-		if (netId != ANY) {
+		if (netId == ANY && autoNetIds[gGrpId] != ANY) { // assigned by partitionGroupsCPU()
+			netId = autoNetIds[gGrpId];
+			grpIt->second.netId = netId;
+			numAssignedNeurons[netId] += groupConfigMap[gGrpId].numN;
+			groupPartitionLists[netId].push_back(grpIt->second); // Copy by value, create a copy
+		} else if (netId != ANY) {
 			assert(netId > ANY && netId < MAX_NET_PER_SNN);
 			grpIt->second.netId = netId;
 			numAssignedNeurons[netId] += groupConfigMap[gGrpId].numN;
@@ -4906,6 +5220,15 @@ void SNN::partitionSNN() {
 
 	spikeRoutingTable.unique();
 
+	// a CPU runtime that only receives spikes from other CPU runtimes reads their external firing tables directly
+	// (see receiveExtSpikes_CPU), all other routes are staged through managerRuntimeData (see routeSpikes)
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++)
+		cpuDirectSpikeExchange[netId] = (netId >= CPU_RUNTIME_BASE);
+	for (std::list<RoutingTableEntry>::iterator rteItr = spikeRoutingTable.begin(); rteItr != spikeRoutingTable.end(); rteItr++) {
+		if (rteItr->srcNetId < CPU_RUNTIME_BASE)
+			cpuDirectSpikeExchange[rteItr->destNetId] = false;
+	}
+
 	// assign local neuron ids and, local group ids for each local network in the order
 	// MPORTANT : NEURON ORGANIZATION/ARRANGEMENT MAP
 	// <--- Excitatory --> | <-------- Inhibitory REGION ----------> | <-- Excitatory --> | <-- External -->
@@ -4944,7 +5267,16 @@ void SNN::partitionSNN() {
 	// generation connections among groups according to group and connect configs
 	// update ConnectConfig::numberOfConnections
 	// update GroupConfig::numPostSynapses, GroupConfig::numPreSynapses
-	connectNetwork();
+	// a loaded simulation takes the synapses from file instead, as does a network found in the network cache
+	if (loadSimFID == NULL && !networkCacheDir_.empty())
+		openNetworkCache();
+
+	if (loadSimFID == NULL) {
+		connectNetwork();
+	} else {
+		KERNEL_INFO("Loading the synapses from file");
+		loadSimulation_internal();
+	}
 
 	collectGlobalNetworkConfigP();
 
@@ -4973,232 +5305,577 @@ void SNN::partitionSNN() {
 	snnState = PARTITIONED_SNN;
 }
 
-int SNN::loadSimulation_internal(bool onlyPlastic) {
-	//// TSC: so that we can restore the file position later...
-	//// MB: not sure why though...
-	//long file_position = ftell(loadSimFID);
-	//
-	//int tmpInt;
-	//float tmpFloat;
+// reads the configuration of the network from the file of loadSimulation, which replaces connectNetwork
+// the synapse arrays and runtime states of the local networks, which follow in the file, are read by generateRuntimeSNN
+void SNN::loadSimulation_internal() {
+	int tmpInt;
+	float tmpFloat;
+	bool readErr = false; // keep track of reading errors
 
-	//bool readErr = false; // keep track of reading errors
-	//size_t result;
+	// ------- read header ----------------
 
+	fseek(loadSimFID, 0, SEEK_SET);
 
-	//// ------- read header ----------------
+	// read file signature
+	readErr |= !readBlock(loadSimFID, &tmpInt, 1);
+	if (readErr || tmpInt != SIM_FILE_SIGNATURE) {
+		KERNEL_ERROR("loadSimulation: Unknown file signature. This does not seem to be a "
+			"simulation file created with CARLsim::saveSimulation.");
+		exitSimulation(-1);
+	}
 
-	//fseek(loadSimFID, 0, SEEK_SET);
+	// read file version number
+	readErr |= !readBlock(loadSimFID, &tmpFloat, 1);
+	if (tmpFloat != SIM_FILE_VERSION) {
+		KERNEL_ERROR("loadSimulation: Unsupported version number (%f)", tmpFloat);
+		exitSimulation(-1);
+	}
 
-	//// read file signature
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != 294338571) {
-	//	KERNEL_ERROR("loadSimulation: Unknown file signature. This does not seem to be a "
-	//		"simulation file created with CARLsim::saveSimulation.");
-	//	exitSimulation(-1);
-	//}
+	// read simulation time and execution time
+	readErr |= !readBlock(loadSimFID, &tmpFloat, 1);
+	readErr |= !readBlock(loadSimFID, &tmpFloat, 1);
 
-	//// read file version number
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpFloat > 0.2f) {
-	//	KERNEL_ERROR("loadSimulation: Unsupported version number (%f)",tmpFloat);
-	//	exitSimulation(-1);
-	//}
+	// read number of neurons, pre-synapses, post-synapses, and groups
+	int networkInfo[4];
+	readErr |= !readBlock(loadSimFID, networkInfo, 4);
+	if (networkInfo[0] != glbNetworkConfig.numN) {
+		KERNEL_ERROR("loadSimulation: Number of neurons in file (%d) and simulation (%d) don't match.",
+			networkInfo[0], glbNetworkConfig.numN);
+		exitSimulation(-1);
+	}
+	if (networkInfo[3] != numGroups) {
+		KERNEL_ERROR("loadSimulation: Number of groups in file (%d) and simulation (%d) don't match.",
+			networkInfo[3], numGroups);
+		exitSimulation(-1);
+	}
 
-	//// read simulation time
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-
-	//// read execution time
-	//result = fread(&tmpFloat, sizeof(float), 1, loadSimFID);
-	//readErr |= (result!=1);
-
-	//// read number of neurons
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != numN) {
-	//	KERNEL_ERROR("loadSimulation: Number of neurons in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numN);
-	//	exitSimulation(-1);
-	//}
+	// throw reading error instead of proceeding
+	if (readErr) {
+		KERNEL_ERROR("loadSimulation: Error while reading file header");
+		exitSimulation(-1);
+	}
 
-	//// read number of pre-synapses
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (numPreSynNet != tmpInt) {
-	//	KERNEL_ERROR("loadSimulation: numPreSynNet in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numPreSynNet);
-	//	exitSimulation(-1);
-	//}
+	// ------- read group information ----------------
 
-	//// read number of post-synapses
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (numPostSynNet != tmpInt) {
-	//	KERNEL_ERROR("loadSimulation: numPostSynNet in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numPostSynNet);
-	//	exitSimulation(-1);
-	//}
+	char name[100];
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		int groupInfo[5];
+		readErr |= !readBlock(loadSimFID, groupInfo, 5);
+		readErr |= !readBlock(loadSimFID, name, sizeof(name));
+		name[sizeof(name) - 1] = '\0';
+
+		if (groupInfo[0] != groupConfigMDMap[gGrpId].gStartN || groupInfo[1] != groupConfigMDMap[gGrpId].gEndN) {
+			KERNEL_ERROR("loadSimulation: StartN, EndN in file (%d, %d) and simulation (%d, %d) for group %d don't match.",
+				groupInfo[0], groupInfo[1], groupConfigMDMap[gGrpId].gStartN, groupConfigMDMap[gGrpId].gEndN, gGrpId);
+			exitSimulation(-1);
+		}
+		if (strcmp(name, groupConfigMap[gGrpId].grpName.c_str()) != 0) {
+			KERNEL_ERROR("loadSimulation: Group names in file (%s) and simulation (%s) don't match.", name,
+				groupConfigMap[gGrpId].grpName.c_str());
+			exitSimulation(-1);
+		}
+	}
 
-	//// read number of groups
-	//result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//readErr |= (result!=1);
-	//if (tmpInt != numGroups) {
-	//	KERNEL_ERROR("loadSimulation: Number of groups in file (%d) and simulation (%d) don't match.",
-	//		tmpInt, numGroups);
-	//	exitSimulation(-1);
-	//}
+	// read the exact simulation time, which is restored along with the runtime state
+	int simTimeInfo[3];
+	readErr |= !readBlock(loadSimFID, simTimeInfo, 3);
 
-	//// throw reading error instead of proceeding
-	//if (readErr) {
-	//	fprintf(stderr,"loadSimulation: Error while reading file header");
-	//	exitSimulation(-1);
-	//}
+	if (readErr) {
+		KERNEL_ERROR("loadSimulation: Error while reading group info");
+		exitSimulation(-1);
+	}
 
+	// ------- read connection information ----------------
 
-	//// ------- read group information ----------------
+	int synapseInfo[2];
+	readErr |= !readBlock(loadSimFID, synapseInfo, 2);
+	if (!readErr && synapseInfo[0] == 0) {
+		KERNEL_ERROR("loadSimulation: The file does not contain the synapses, it has to be created with "
+			"CARLsim::saveSimulation(fileName, true).");
+		exitSimulation(-1);
+	}
+	loadSimWithState_ = (synapseInfo[1] != 0);
 
-	//for (int g=0; g<numGroups; g++) {
-	//	// read StartN
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-	//	if (tmpInt != groupConfigs[0][g].StartN) {
-	//		KERNEL_ERROR("loadSimulation: StartN in file (%d) and grpInfo (%d) for group %d don't match.",
-	//			tmpInt, groupConfigs[0][g].StartN, g);
-	//		exitSimulation(-1);
-	//	}
+	readErr |= !readBlock(loadSimFID, &tmpInt, 1);
+	if (tmpInt != (int)connectConfigMap.size()) {
+		KERNEL_ERROR("loadSimulation: Number of connections in file (%d) and simulation (%d) don't match.",
+			tmpInt, (int)connectConfigMap.size());
+		exitSimulation(-1);
+	}
 
-	//	// read EndN
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-	//	if (tmpInt != groupConfigs[0][g].EndN) {
-	//		KERNEL_ERROR("loadSimulation: EndN in file (%d) and grpInfo (%d) for group %d don't match.",
-	//			tmpInt, groupConfigs[0][g].EndN, g);
-	//		exitSimulation(-1);
-	//	}
+	std::map<int, ConnectConfig> loadedConnections;
+	for (int i = 0; i < tmpInt; i++) {
+		int connInfo[5];
+		ConnectConfig connConfig;
+		readErr |= !readBlock(loadSimFID, connInfo, 5);
+		readErr |= !readBlock(loadSimFID, &connConfig.maxWt, 1);
+		if (readErr || connectConfigMap.find(connInfo[0]) == connectConfigMap.end()
+			|| connectConfigMap[connInfo[0]].grpSrc != connInfo[1] || connectConfigMap[connInfo[0]].grpDest != connInfo[2])
+		{
+			KERNEL_ERROR("loadSimulation: Connection %d in file does not match the connections of the simulation.", connInfo[0]);
+			exitSimulation(-1);
+		}
+		connConfig.numberOfConnections = connInfo[3];
+		connConfig.maxDelay = connInfo[4];
+		loadedConnections[connInfo[0]] = connConfig;
+	}
 
-	//	// read SizeX
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read SizeY
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read SizeZ
-	//	result = fread(&tmpInt, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	// read group name
-	//	char name[100];
-	//	result = fread(name, sizeof(char), 100, loadSimFID);
-	//	readErr |= (result!=100);
-	//	if (strcmp(name,groupInfo[g].Name.c_str()) != 0) {
-	//		KERNEL_ERROR("loadSimulation: Group names in file (%s) and grpInfo (%s) don't match.", name,
-	//			groupInfo[g].Name.c_str());
-	//		exitSimulation(-1);
-	//	}
-	//}
+	// update the connections as connectNetwork does
+	for (int pass = 0; pass < 2; pass++) {
+		bool isExternal = (pass == 1);
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			std::list<ConnectConfig>& connectList = isExternal ? externalConnectLists[netId] : localConnectLists[netId];
+			for (std::list<ConnectConfig>::iterator connIt = connectList.begin(); connIt != connectList.end(); connIt++) {
+				connIt->numberOfConnections = loadedConnections[connIt->connId].numberOfConnections;
+				connIt->maxDelay = loadedConnections[connIt->connId].maxDelay;
+				connIt->maxWt = loadedConnections[connIt->connId].maxWt;
+				addGroupSynapses(netId, connIt, isExternal);
+			}
+		}
+	}
 
-	//if (readErr) {
-	//	KERNEL_ERROR("loadSimulation: Error while reading group info");
-	//	exitSimulation(-1);
-	//}
+	// ------- read the size of each local network ----------------
 
+	int numNetworks = 0;
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty())
+			numNetworks++;
+	}
+	readErr |= !readBlock(loadSimFID, &tmpInt, 1);
+	if (readErr || tmpInt != numNetworks) {
+		KERNEL_ERROR("loadSimulation: Number of local networks in file (%d) and simulation (%d) don't match.",
+			tmpInt, numNetworks);
+		exitSimulation(-1);
+	}
 
-	//// ------- read synapse information ----------------
-
-	//for (int i = 0; i < numN; i++) {
-	//	int nrSynapses = 0;
-
-	//	// read number of synapses
-	//	result = fread(&nrSynapses, sizeof(int), 1, loadSimFID);
-	//	readErr |= (result!=1);
-
-	//	for (int j=0; j<nrSynapses; j++) {
-	//		int nIDpre;
-	//		int nIDpost;
-	//		float weight, maxWeight;
-	//		uint8_t delay;
-	//		uint8_t plastic;
-	//		short int connId;
-
-	//		// read nIDpre
-	//		result = fread(&nIDpre, sizeof(int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (nIDpre != i) {
-	//			KERNEL_ERROR("loadSimulation: nIDpre in file (%u) and simulation (%u) don't match.", nIDpre, i);
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read nIDpost
-	//		result = fread(&nIDpost, sizeof(int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (nIDpost >= numN) {
-	//			KERNEL_ERROR("loadSimulation: nIDpre in file (%u) is larger than in simulation (%u).", nIDpost, numN);
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read weight
-	//		result = fread(&weight, sizeof(float), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		short int gIDpre = managerRuntimeData.grpIds[nIDpre];
-	//		if (IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (weight>0)
-	//				|| !IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (weight<0)) {
-	//			KERNEL_ERROR("loadSimulation: Sign of weight value (%s) does not match neuron type (%s)",
-	//				((weight>=0.0f)?"plus":"minus"), 
-	//				(IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type)?"inhibitory":"excitatory"));
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read max weight
-	//		result = fread(&maxWeight, sizeof(float), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (maxWeight>=0)
-	//				|| !IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type) && (maxWeight<=0)) {
-	//			KERNEL_ERROR("loadSimulation: Sign of maxWeight value (%s) does not match neuron type (%s)",
-	//				((maxWeight>=0.0f)?"plus":"minus"), 
-	//				(IS_INHIBITORY_TYPE(groupConfigs[0][gIDpre].Type)?"inhibitory":"excitatory"));
-	//			exitSimulation(-1);
-	//		}
-
-	//		// read delay
-	//		result = fread(&delay, sizeof(uint8_t), 1, loadSimFID);
-	//		readErr |= (result!=1);
-	//		if (delay > MAX_SYN_DELAY) {
-	//			KERNEL_ERROR("loadSimulation: delay in file (%d) is larger than MAX_SYN_DELAY (%d)",
-	//				(int)delay, (int)MAX_SYN_DELAY);
-	//			exitSimulation(-1);
-	//		}
-
-	//		assert(!isnan(weight));
-	//		// read plastic/fixed
-	//		result = fread(&plastic, sizeof(uint8_t), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		// read connection ID
-	//		result = fread(&connId, sizeof(short int), 1, loadSimFID);
-	//		readErr |= (result!=1);
-
-	//		if ((plastic && onlyPlastic) || (!plastic && !onlyPlastic)) {
-	//			int gIDpost = managerRuntimeData.grpIds[nIDpost];
-	//			int connProp = SET_FIXED_PLASTIC(plastic?SYN_PLASTIC:SYN_FIXED);
-
-	//			//setConnection(gIDpre, gIDpost, nIDpre, nIDpost, weight, maxWeight, delay, connProp, connId);
-	//			groupInfo[gIDpre].sumPostConn++;
-	//			groupInfo[gIDpost].sumPreConn++;
-
-	//			if (delay > groupConfigs[0][gIDpre].MaxDelay)
-	//				groupConfigs[0][gIDpre].MaxDelay = delay;
-	//		}
-	//	}
-	//}
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		if (groupPartitionLists[netId].empty())
+			continue;
 
-	//fseek(loadSimFID,file_position,SEEK_SET);
+		int numNAssigned = 0, numPreSyn = 0;
+		for (std::list<GroupConfigMD>::iterator grpIt = groupPartitionLists[netId].begin(); grpIt != groupPartitionLists[netId].end(); grpIt++) {
+			numNAssigned += groupConfigMap[grpIt->gGrpId].numN;
+			numPreSyn += grpIt->numPreSynapses;
+		}
 
-	return 0;
+		int netInfo[5];
+		readErr |= !readBlock(loadSimFID, netInfo, 5);
+		if (readErr || netInfo[0] != netId || netInfo[1] != numNAssigned || netInfo[2] != numPreSyn) {
+			KERNEL_ERROR("loadSimulation: The partitioning of the network in file (local network %d with %d neurons) and "
+				"simulation (local network %d with %d neurons) don't match.", netInfo[0], netInfo[1], netId, numNAssigned);
+			exitSimulation(-1);
+		}
+
+		// generateRuntimeNetworkConfigs cannot find them without the connection lists
+		networkConfigs[netId].maxNumPostSynN = netInfo[3];
+		networkConfigs[netId].maxNumPreSynN = netInfo[4];
+	}
+
+	// a simulation with runtime state continues at the time at which it was saved
+	if (loadSimWithState_) {
+		simTimeSec = simTimeInfo[0];
+		simTimeMs = simTimeInfo[1];
+		simTime = simTimeSec * 1000 + simTimeMs;
+		simTimeRunStart = simTime;
+		simTimeRunStop = simTime;
+		simTimeLastRunSummary = simTime;
+		simTimeLastUpdSpkMon_ = simTime;
+		wtANDwtChangeUpdateIntervalCnt_ = (simTimeInfo[2] < wtANDwtChangeUpdateInterval_) ? simTimeInfo[2] : 0;
+
+		for (int monitorId = 0; monitorId < numSpikeMonitor; monitorId++)
+			spikeMonCoreList[monitorId]->setLastUpdated(simTime);
+		for (int monitorId = 0; monitorId < numGroupMonitor; monitorId++)
+			groupMonCoreList[monitorId]->setLastUpdated(simTime);
+	}
+}
+
+// reads the synapse arrays of a local network written by saveSynapseArrays into the manager runtime data, which
+// replaces generateConnectionRuntime
+bool SNN::loadSynapseArrays(FILE* fid, int netId) {
+	int numNAssigned = networkConfigs[netId].numNAssigned;
+	int numPreSyn = networkConfigs[netId].numPreSynNet;
+	int numPostSyn = networkConfigs[netId].numPostSynNet;
+	int delayStride = glbNetworkConfig.maxDelay + 1;
+
+	int netInfo[4];
+	if (!readBlock(fid, netInfo, 4))
+		return false;
+	if (netInfo[0] != netId || netInfo[1] != numNAssigned || netInfo[2] != numPreSyn || netInfo[3] != numPostSyn)
+		return false;
+
+	// generate mulSynFast, mulSynSlow in connection-centric array
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		mulSynFast[connIt->second.connId] = connIt->second.mulSynFast;
+		mulSynSlow[connIt->second.connId] = connIt->second.mulSynSlow;
+	}
+
+	memset(managerRuntimeData.Npre, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.Npre_plastic, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.Npost, 0, sizeof(short) * numNAssigned);
+	memset(managerRuntimeData.cumulativePre, 0, sizeof(int) * numNAssigned);
+	memset(managerRuntimeData.cumulativePost, 0, sizeof(int) * numNAssigned);
+	memset(managerRuntimeData.postDelayInfo, 0, sizeof(DelayInfo) * (numNAssigned * delayStride));
+	if (numPreSyn == 0)
+		return true;
+
+	bool readErr = false;
+	readErr |= !readBlock(fid, managerRuntimeData.Npre, numNAssigned);
+	readErr |= !readBlock(fid, managerRuntimeData.Npre_plastic, numNAssigned);
+	readErr |= !readBlock(fid, managerRuntimeData.Npost, numNAssigned);
+	readErr |= !readBlock(fid, managerRuntimeData.cumulativePre, numNAssigned);
+	readErr |= !readBlock(fid, managerRuntimeData.cumulativePost, numNAssigned);
+	readErr |= !readBlock(fid, managerRuntimeData.postDelayInfo, numNAssigned * delayStride);
+	readErr |= !readBlock(fid, managerRuntimeData.preSynapticIds, numPreSyn);
+	readErr |= !readBlock(fid, managerRuntimeData.postSynapticIds, numPostSyn);
+	readErr |= !readBlock(fid, managerRuntimeData.connIdsPreIdx, numPreSyn);
+	readErr |= !readBlock(fid, managerRuntimeData.wt, numPreSyn);
+	readErr |= !readBlock(fid, managerRuntimeData.maxSynWt, numPreSyn);
+	if (readErr)
+		return false;
+
+	// the runtimes index the synapse arrays by the numbers of synapses of each neuron, which have to add up
+	unsigned int numPre = 0, numPost = 0;
+	for (int lNId = 0; lNId < numNAssigned; lNId++) {
+		if (managerRuntimeData.cumulativePre[lNId] != numPre || managerRuntimeData.cumulativePost[lNId] != numPost
+			|| managerRuntimeData.Npre_plastic[lNId] > managerRuntimeData.Npre[lNId])
+			return false;
+		numPre += managerRuntimeData.Npre[lNId];
+		numPost += managerRuntimeData.Npost[lNId];
+
+		if (managerRuntimeData.Npre_plastic[lNId] > 0) {
+			sim_with_fixedwts = false; // if network has any plastic synapses at all, this will be set to true
+
+			// homeostasis
+			int gGrpId = groupConfigs[netId][managerRuntimeData.grpIds[lNId]].gGrpId;
+			if (groupConfigMap[gGrpId].homeoConfig.WithHomeostasis && groupConfigMDMap[gGrpId].homeoId == -1)
+				groupConfigMDMap[gGrpId].homeoId = lNId; // this neuron info will be printed
+		}
+	}
+	if (numPre != (unsigned int)numPreSyn || numPost != (unsigned int)numPostSyn)
+		return false;
+
+	for (int pos = 0; pos < numPreSyn; pos++) {
+		if (GET_CONN_NEURON_ID(managerRuntimeData.preSynapticIds[pos]) >= numNAssigned
+			|| connectConfigMap.find(managerRuntimeData.connIdsPreIdx[pos]) == connectConfigMap.end())
+			return false;
+	}
+	for (int pos = 0; pos < numPostSyn; pos++) {
+		if (GET_CONN_NEURON_ID(managerRuntimeData.postSynapticIds[pos]) >= numNAssigned)
+			return false;
+	}
+
+	return true;
+}
+
+// reads the runtime state of a CPU runtime written by saveRuntimeState into the manager runtime data, called by
+// generateRuntimeSNN after the neurons and synapses of the network are initialized
+bool SNN::loadRuntimeState(FILE* fid, int netId) {
+	int numNReg = networkConfigs[netId].numNReg;
+	int numN = networkConfigs[netId].numN;
+	int numNAssigned = networkConfigs[netId].numNAssigned;
+	int numGroups = networkConfigs[netId].numGroups;
+	int numPreSyn = networkConfigs[netId].numPreSynNet;
+	int flags = getRuntimeStateFlags();
+
+	int stateInfo[5];
+	if (!readBlock(fid, stateInfo, 5) || stateInfo[0] != netId || stateInfo[1] != numNReg || stateInfo[2] != numN
+		|| stateInfo[3] != numNAssigned)
+		return false;
+	if (stateInfo[4] != flags) {
+		KERNEL_ERROR("loadSimulation: The features of the simulation in file and simulation (conductances, "
+			"homeostasis, STP) don't match.");
+		exitSimulation(-1);
+	}
+
+	bool readErr = false;
+	readErr |= !readBlock(fid, managerRuntimeData.voltage, numNReg);
+	readErr |= !readBlock(fid, managerRuntimeData.recovery, numNReg);
+	readErr |= !readBlock(fid, managerRuntimeData.current, numNReg);
+	if (flags & STATE_CONDUCTANCES) {
+		readErr |= !readBlock(fid, managerRuntimeData.gAMPA, numNReg);
+		if (flags & STATE_NMDA_RISE) {
+			readErr |= !readBlock(fid, managerRuntimeData.gNMDA_r, numNReg);
+			readErr |= !readBlock(fid, managerRuntimeData.gNMDA_d, numNReg);
+		} else {
+			readErr |= !readBlock(fid, managerRuntimeData.gNMDA, numNReg);
+		}
+		readErr |= !readBlock(fid, managerRuntimeData.gGABAa, numNReg);
+		if (flags & STATE_GABAB_RISE) {
+			readErr |= !readBlock(fid, managerRuntimeData.gGABAb_r, numNReg);
+			readErr |= !readBlock(fid, managerRuntimeData.gGABAb_d, numNReg);
+		} else {
+			readErr |= !readBlock(fid, managerRuntimeData.gGABAb, numNReg);
+		}
+	}
+	if (flags & STATE_HOMEOSTASIS) {
+		readErr |= !readBlock(fid, managerRuntimeData.avgFiring, numNReg);
+		readErr |= !readBlock(fid, managerRuntimeData.baseFiring, numNReg);
+	}
+	if (flags & STATE_STP) {
+		readErr |= !readBlock(fid, managerRuntimeData.stpu, numN * (networkConfigs[netId].maxDelay + 1));
+		readErr |= !readBlock(fid, managerRuntimeData.stpx, numN * (networkConfigs[netId].maxDelay + 1));
+	}
+	readErr |= !readBlock(fid, managerRuntimeData.lastSpikeTime, numNAssigned);
+	readErr |= !readBlock(fid, managerRuntimeData.grpDA, numGroups);
+	readErr |= !readBlock(fid, managerRuntimeData.grp5HT, numGroups);
+	readErr |= !readBlock(fid, managerRuntimeData.grpACh, numGroups);
+	readErr |= !readBlock(fid, managerRuntimeData.grpNE, numGroups);
+	readErr |= !readBlock(fid, managerRuntimeData.wtChange, numPreSyn);
+	readErr |= !readBlock(fid, managerRuntimeData.synSpikeTime, numPreSyn);
+	memcpy(managerRuntimeData.nextVoltage, managerRuntimeData.voltage, sizeof(float) * numNReg);
+
+	return !readErr;
+}
+
+// reads the spikes in transit of a CPU runtime written by saveSpikeTables, called by generateRuntimeSNN after the
+// runtime is allocated
+bool SNN::loadSpikeTables(FILE* fid, int netId) {
+	RuntimeData* rt = &runtimeData[netId];
+	int numNReg = networkConfigs[netId].numNReg;
+	int timeTableLength = 1000 + glbNetworkConfig.maxDelay + 1;
+
+	int tableInfo[4];
+	unsigned int spikeCounts[12];
+	if (!readBlock(fid, tableInfo, 4) || tableInfo[0] != netId || tableInfo[3] < 0 || tableInfo[3] > numNReg
+		|| !readBlock(fid, spikeCounts, 12))
+		return false;
+
+	// event-driven STDP has to be enabled in both simulations
+	if (tableInfo[2] != ((rt->postSpikeHistory != NULL) ? numNReg : 0))
+		return false;
+
+	rt->spikeCountSec = spikeCounts[0];
+	rt->spikeCountD1Sec = spikeCounts[1];
+	rt->spikeCountD2Sec = spikeCounts[2];
+	rt->spikeCountExtRxD1Sec = spikeCounts[3];
+	rt->spikeCountExtRxD2Sec = spikeCounts[4];
+	rt->spikeCount = spikeCounts[5];
+	rt->spikeCountD1 = spikeCounts[6];
+	rt->spikeCountD2 = spikeCounts[7];
+	rt->nPoissonSpikes = spikeCounts[8];
+	rt->spikeCountLastSecLeftD2 = spikeCounts[9];
+	rt->spikeCountExtRxD2 = spikeCounts[10];
+	rt->spikeCountExtRxD1 = spikeCounts[11];
+
+	// the spikes are read into the manager tables, which may have to grow, and then copied to the runtime
+	unsigned int numSpikesD1 = rt->spikeCountD1Sec;
+	unsigned int numSpikesD2 = rt->spikeCountD2Sec + rt->spikeCountLastSecLeftD2;
+	if (numSpikesD1 > managerRTDSize.maxMaxSpikeD1) {
+		delete [] managerRuntimeData.firingTableD1;
+		managerRTDSize.maxMaxSpikeD1 = numSpikesD1;
+		managerRuntimeData.firingTableD1 = new int[managerRTDSize.maxMaxSpikeD1];
+	}
+	if (numSpikesD2 > managerRTDSize.maxMaxSpikeD2) {
+		delete [] managerRuntimeData.firingTableD2;
+		managerRTDSize.maxMaxSpikeD2 = numSpikesD2;
+		managerRuntimeData.firingTableD2 = new int[managerRTDSize.maxMaxSpikeD2];
+	}
+
+	bool readErr = false;
+	readErr |= !readBlock(fid, managerRuntimeData.timeTableD1, timeTableLength);
+	readErr |= !readBlock(fid, managerRuntimeData.timeTableD2, timeTableLength);
+	readErr |= !readBlock(fid, managerRuntimeData.firingTableD1, numSpikesD1);
+	readErr |= !readBlock(fid, managerRuntimeData.firingTableD2, numSpikesD2);
+	if (readErr)
+		return false;
+
+	for (unsigned int i = 0; i < numSpikesD1; i++) {
+		if (managerRuntimeData.firingTableD1[i] < 0 || managerRuntimeData.firingTableD1[i] >= networkConfigs[netId].numNAssigned)
+			return false;
+	}
+	for (unsigned int i = 0; i < numSpikesD2; i++) {
+		if (managerRuntimeData.firingTableD2[i] < 0 || managerRuntimeData.firingTableD2[i] >= networkConfigs[netId].numNAssigned)
+			return false;
+	}
+	copySpikeTables(netId, false);
+
+	std::vector<int> firedNIds(tableInfo[3]);
+	if (!firedNIds.empty() && !readBlock(fid, &firedNIds[0], firedNIds.size()))
+		return false;
+	for (int i = 0; i < (int)firedNIds.size(); i++) {
+		if (firedNIds[i] < 0 || firedNIds[i] >= numNReg)
+			return false;
+	}
+	copySpikeBits(netId, firedNIds, true);
+
+	// the spike delivery engine chosen for the current second
+	if (cpuSpikeDeliveryMode_ == SPIKE_DELIVERY_AUTO)
+		cpuPullDelivery[netId] = (tableInfo[1] != 0);
+
+	if (tableInfo[2] > 0) {
+		std::vector<int> history(numNReg * STDP_POST_HISTORY_LENGTH);
+		std::vector<unsigned short> historyLength(numNReg);
+		readErr |= !readBlock(fid, &history[0], history.size());
+		readErr |= !readBlock(fid, &historyLength[0], historyLength.size());
+		if (!readErr)
+			copyPostSpikeHistory(netId, &history[0], &historyLength[0], true);
+	}
+
+	return !readErr;
+}
+
+// FNV-1a hash of n bytes, continuing the hash h
+static void hashBytes(unsigned long long& h, const void* data, size_t n) {
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < n; i++) {
+		h ^= bytes[i];
+		h *= 1099511628211ULL;
+	}
+}
+
+template <typename T>
+static void hashValue(unsigned long long& h, const T& value) {
+	hashBytes(h, &value, sizeof(T));
+}
+
+static void hashString(unsigned long long& h, const std::string& str) {
+	hashValue(h, str.size());
+	hashBytes(h, str.data(), str.size());
+}
+
+// hashes everything connectNetwork generates the synapses from: the groups and their partitioning, the connections,
+// and the random seed. The synapses of user-defined connections are identified by the identity of their
+// ConnectionGenerator, returns false if a generator does not declare one.
+bool SNN::hashNetworkConfig(unsigned long long& hash) {
+	hash = 14695981039346656037ULL;
+
+	float version = SIM_FILE_VERSION;
+	hashValue(hash, version);
+	hashValue(hash, randSeed_);
+
+	hashValue(hash, numGroups);
+	for (int gGrpId = 0; gGrpId < numGroups; gGrpId++) {
+		GroupConfig& groupConfig = groupConfigMap[gGrpId];
+		hashString(hash, groupConfig.grpName);
+		hashValue(hash, groupConfig.type);
+		hashValue(hash, groupConfig.numN);
+		hashValue(hash, groupConfig.grid.numX);
+		hashValue(hash, groupConfig.grid.numY);
+		hashValue(hash, groupConfig.grid.numZ);
+		hashValue(hash, groupConfig.grid.distX);
+		hashValue(hash, groupConfig.grid.distY);
+		hashValue(hash, groupConfig.grid.distZ);
+		hashValue(hash, groupConfig.grid.offsetX);
+		hashValue(hash, groupConfig.grid.offsetY);
+		hashValue(hash, groupConfig.grid.offsetZ);
+		hashValue(hash, groupConfigMDMap[gGrpId].netId);
+	}
+
+	hashValue(hash, connectConfigMap.size());
+	for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+		ConnectConfig& connConfig = connIt->second;
+		hashValue(hash, connConfig.connId);
+		hashValue(hash, connConfig.grpSrc);
+		hashValue(hash, connConfig.grpDest);
+		hashValue(hash, connConfig.type);
+		hashValue(hash, connConfig.minDelay);
+		hashValue(hash, connConfig.maxDelay);
+		hashValue(hash, connConfig.minWt);
+		hashValue(hash, connConfig.initWt);
+		hashValue(hash, connConfig.maxWt);
+		hashValue(hash, connConfig.connRadius.radX);
+		hashValue(hash, connConfig.connRadius.radY);
+		hashValue(hash, connConfig.connRadius.radZ);
+		hashValue(hash, connConfig.connProp);
+		hashValue(hash, connConfig.connProbability);
+
+		if (connConfig.type == CONN_USER_DEFINED) {
+			std::string identity = connConfig.conn->getIdentity();
+			if (identity.empty())
+				return false;
+			hashString(hash, identity);
+		}
+	}
+
+	return true;
+}
+
+// looks up the cache file of the network, which is named after the hash of its configuration (see hashNetworkConfig).
+// A cache file has the format of saveSimulation, without neuron state, and is loaded the same way.
+void SNN::openNetworkCache() {
+	unsigned long long hash;
+	if (!hashNetworkConfig(hash)) {
+		KERNEL_WARN("The network is not cached, because a ConnectionGenerator does not declare an identity "
+			"(see ConnectionGenerator::getIdentity).");
+		return;
+	}
+
+	char fileName[32];
+	snprintf(fileName, sizeof(fileName), "carlsim_%016llx.dat", hash);
+	networkCacheFile_ = networkCacheDir_ + "/" + fileName;
+
+	networkCacheFID_ = fopen(networkCacheFile_.c_str(), "rb");
+	if (networkCacheFID_ != NULL) {
+		KERNEL_INFO("Found the network in the network cache (%s)", networkCacheFile_.c_str());
+		loadSimFID = networkCacheFID_;
+	} else {
+		KERNEL_INFO("Did not find the network in the network cache, the synapses will be stored in %s",
+			networkCacheFile_.c_str());
+	}
+}
+
+// closes the cache file the synapses were loaded from, or writes the synapses of a network that was not found in the
+// network cache. The synapse image of each CPU runtime whose synapses were not mapped from the cache is (re)written,
+// so that the next simulation of the network maps it (see mapSynapseImage_CPU).
+void SNN::updateNetworkCache() {
+	bool isFound = (networkCacheFID_ != NULL);
+	if (isFound) {
+		fclose(networkCacheFID_);
+		networkCacheFID_ = NULL;
+		loadSimFID = NULL;
+	}
+
+	if (networkCacheFile_.empty())
+		return;
+
+	if (!isFound)
+		saveNetworkCacheFile(networkCacheFile_, ALL);
+
+#if !defined(WIN32) && !defined(WIN64)
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty() && cpuSynapseImage[netId] == NULL)
+			saveNetworkCacheFile(getSynapseImageFileName(netId), netId);
+	}
+#endif
+}
+
+// writes a file of the network cache: the synapses of the network (netId is ALL, see saveSimulation) or the synapse
+// image of a CPU runtime. The file is written under a temporary name (unique per process) and then renamed, so that
+// concurrent simulations of the same network never read a partially written file.
+void SNN::saveNetworkCacheFile(const std::string& fileName, int netId) {
+#if defined(WIN32) || defined(WIN64)
+	int pid = _getpid();
+#else
+	int pid = getpid();
+#endif
+	std::stringstream tmpFileName;
+	tmpFileName << fileName << "." << pid << ".tmp";
+
+	FILE* fid = fopen(tmpFileName.str().c_str(), "wb");
+	if (fid == NULL) {
+		KERNEL_WARN("Could not write the network cache file %s", tmpFileName.str().c_str());
+		return;
+	}
+
+	bool writeErr = false;
+	if (netId == ALL)
+		saveSimulation(fid, true, false);
+	else
+		writeErr = !saveSynapseImage_CPU(netId, fid);
+	writeErr |= (fclose(fid) != 0);
+
+	if (writeErr || rename(tmpFileName.str().c_str(), fileName.c_str()) != 0) {
+		// another simulation may have stored the network in the meantime
+		KERNEL_WARN("Could not write the network cache file %s", fileName.c_str());
+		remove(tmpFileName.str().c_str());
+	}
+}
+
+// the synapse image of a CPU runtime is stored next to the cache file of the network
+std::string SNN::getSynapseImageFileName(int netId) {
+	std::stringstream fileName;
+	fileName << networkCacheFile_ << ".cpu" << netId - CPU_RUNTIME_BASE;
+	return fileName.str();
 }
 
 void SNN::generateRuntimeSNN() {
@@ -5212,6 +5889,44 @@ void SNN::generateRuntimeSNN() {
 	// generate local network configs and accquire maximum size of rumtime data
 	generateRuntimeNetworkConfigs();
 
+	// the compact synapse storage of the CPU runtimes only keeps what fixed synapses need
+	if (cpuCompactSynapses_) {
+		bool withPlasticSynapses = false;
+		for (std::map<int, ConnectConfig>::iterator connIt = connectConfigMap.begin(); connIt != connectConfigMap.end(); connIt++) {
+			if (GET_FIXED_PLASTIC(connIt->second.connProp) == SYN_PLASTIC)
+				withPlasticSynapses = true;
+		}
+		if (withPlasticSynapses || sim_with_stdp) {
+			KERNEL_WARN("The compact synapse storage requires a network without plastic synapses and STDP, using the "
+				"default storage instead.");
+			cpuCompactSynapses_ = false;
+		}
+	}
+	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+		networkConfigs[netId].withPackedSynapseIds = false;
+		networkConfigs[netId].packedNeuronIdBits = 0;
+		networkConfigs[netId].synWeightFormat = SYN_WEIGHT_FLOAT;
+		if (!cpuCompactSynapses_ || netId < CPU_RUNTIME_BASE || groupPartitionLists[netId].empty())
+			continue;
+
+		// a packed post-synaptic id needs enough bits for the largest neuron id and the largest synapse id
+		int neuronIdBits = 0, synIdBits = 0;
+		while ((1u << neuronIdBits) < (unsigned int)networkConfigs[netId].numNAssigned)
+			neuronIdBits++;
+		while ((1u << synIdBits) < (unsigned int)networkConfigs[netId].maxNumPreSynN)
+			synIdBits++;
+		if (neuronIdBits + synIdBits <= 32) {
+			networkConfigs[netId].withPackedSynapseIds = true;
+			networkConfigs[netId].packedNeuronIdBits = neuronIdBits;
+		} else {
+			KERNEL_WARN("CPU %d Runtime: the synapse ids do not fit into 32 bits, using the default synapse ids instead.",
+				netId - CPU_RUNTIME_BASE);
+		}
+		networkConfigs[netId].synWeightFormat = cpuSynWeightFormat_;
+		KERNEL_INFO("CPU %d Runtime: compact synapse storage with %s weights", netId - CPU_RUNTIME_BASE,
+			synWeightFormat_string[cpuSynWeightFormat_]);
+	}
+
 	// 2. allocate space of runtime data used by the manager
 	// - allocate firingTableD1, firingTableD2, timeTableD1, timeTableD2
 	// - reset firingTableD1, firingTableD2, timeTableD1, timeTableD2
@@ -5223,9 +5938,24 @@ void SNN::generateRuntimeSNN() {
 	// - reset all above
 	allocateManagerRuntimeData();
 
-	// 3. initialize manager runtime data according to partitions (i.e., local networks)
-	// 4a. allocate appropriate memory space (e.g., main memory (CPU) or device memory (GPU)).
-	// 4b. load (copy) them to appropriate memory space for execution
+	// 3. spawn and pin the persistent worker threads before the runtimes are allocated, so that each CPU runtime can be
+	// allocated on the worker that executes it (see allocateSNN)
+	// a single CPU runtime can instead be executed inline on the calling thread
+	int numCPURuntimes = 0;
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty())
+			numCPURuntimes++;
+	}
+	if (cpuWorkerPool != NULL)
+		delete cpuWorkerPool;
+	int numCPUThreads = numCPURuntimes * numCPUThreadsPerRuntime_;
+	cpuWorkerPool = new CpuWorkerPool((numCPUThreads == 1 && cpuRunInline_) ? 0 : numCPUThreads);
+	KERNEL_DEBUG("CPU worker pool: %d runtime(s) x %d thread(s), %d worker thread(s)", numCPURuntimes,
+		numCPUThreadsPerRuntime_, cpuWorkerPool->getNumWorkers());
+
+	// 4. initialize manager runtime data according to partitions (i.e., local networks)
+	// 5a. allocate appropriate memory space (e.g., main memory (CPU) or device memory (GPU)).
+	// 5b. load (copy) them to appropriate memory space for execution
 	for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 		if (!groupPartitionLists[netId].empty()) {	
 			KERNEL_INFO("");
@@ -5270,7 +6000,12 @@ void SNN::generateRuntimeSNN() {
 			// - init mulSynFast, mulSynSlow
 			// - init Npre, Npre_plastic, Npost, cumulativePre, cumulativePost, preSynapticIds, postSynapticIds, postDelayInfo
 			// - init wt, maxSynWt
-			generateConnectionRuntime(netId);
+			if (loadSimFID == NULL) {
+				generateConnectionRuntime(netId);
+			} else if (!loadSynapseArrays(loadSimFID, netId)) {
+				KERNEL_ERROR("loadSimulation: Error while reading the synapses of local network %d", netId);
+				exitSimulation(-1);
+			}
 
 			generateCompConnectionRuntime(netId);
 
@@ -5283,7 +6018,29 @@ void SNN::generateRuntimeSNN() {
 			// - init synSpikeTime
 			resetSynapse(netId, false);
 
+			// - load the neuron, synapse, and group state of a loaded simulation
+			if (loadSimWithState_ && netId >= CPU_RUNTIME_BASE && !loadRuntimeState(loadSimFID, netId)) {
+				KERNEL_ERROR("loadSimulation: Error while reading the runtime state of local network %d", netId);
+				exitSimulation(-1);
+			}
+
 			allocateSNN(netId);
+
+			// - load the spikes in transit of a loaded simulation
+			if (loadSimWithState_ && netId >= CPU_RUNTIME_BASE && !loadSpikeTables(loadSimFID, netId)) {
+				KERNEL_ERROR("loadSimulation: Error while reading the spike tables of local network %d", netId);
+				exitSimulation(-1);
+			}
+
+			if (netId >= CPU_RUNTIME_BASE) {
+				if (cpuRuntimeNumaNode[netId] >= 0) {
+					KERNEL_INFO("CPU %d Runtime allocated by worker thread %d on NUMA node %d", netId - CPU_RUNTIME_BASE,
+						getCPURuntimeWorkerId(netId), cpuRuntimeNumaNode[netId]);
+				} else {
+					KERNEL_INFO("CPU %d Runtime allocated by worker thread %d (NUMA node unknown)", netId - CPU_RUNTIME_BASE,
+						getCPURuntimeWorkerId(netId));
+				}
+			}
 		}
 	}
 
@@ -5296,8 +6053,64 @@ void SNN::generateRuntimeSNN() {
 			numCores++;
 	}
 
-	// 5. declare the spiking neural network is excutable
+	// the fused neuron update requires that each neuron only depends on its own state
+	if (cpuFusedNeuronUpdate_ && sim_with_compartments) {
+		KERNEL_WARN("The fused neuron update does not support compartments, using the phase-by-phase update instead.");
+		cpuFusedNeuronUpdate_ = false;
+	}
+
+	// the vectorized neuron update uses the widest instruction set of the processor, or the scalar kernel
+	if (cpuVectorizedNeuronUpdate_ && numCores > 0) {
+		cpuSimdInstructionSet_ = detectSimdInstructionSet();
+		KERNEL_INFO("CPU runtimes integrate the neurons with %s kernels", getSimdInstructionSetName(cpuSimdInstructionSet_));
+	}
+
+	// the CPU runtimes use kernels specialized for the features of each group
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (runtimeData[netId].allocated)
+			selectCPUKernels(netId);
+	}
+
+	assert(numCores == numCPURuntimes);
+
+	// the lookahead of the CPU runtimes is the minimum delay of all connections between two runtimes: a spike fired at
+	// time t cannot affect another runtime before t + lookahead, so the runtimes only need to synchronize once per window
+	cpuLookaheadMs_ = 0;
+	if (cpuLookahead_) {
+		bool hasSpikeGen = false;
+		for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+			if (!groupPartitionLists[netId].empty() && networkConfigs[netId].numNSpikeGen > 0)
+				hasSpikeGen = true;
+		}
+
+		int lookaheadMs = 1000; // no connections between runtimes: synchronize once per second
+		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
+			for (std::list<ConnectConfig>::iterator connIt = externalConnectLists[netId].begin(); connIt != externalConnectLists[netId].end(); connIt++)
+				lookaheadMs = std::min(lookaheadMs, (int)connectConfigMap[connIt->connId].minDelay);
+		}
+
+		if (numGPUs > 0) {
+			KERNEL_WARN("Lookahead synchronization requires all groups to run on CPU runtimes, using lockstep synchronization instead.");
+		} else if (hasSpikeGen) {
+			KERNEL_WARN("Lookahead synchronization does not support user-defined spike generators, using lockstep synchronization instead.");
+		} else if (lookaheadMs < 2) {
+			KERNEL_WARN("Lookahead synchronization requires a minimum delay of at least 2 ms between CPU runtimes, using lockstep synchronization instead.");
+		} else {
+			cpuLookaheadMs_ = lookaheadMs;
+			KERNEL_INFO("CPU runtimes synchronize every %d ms (lookahead)", cpuLookaheadMs_);
+			if (numCPUThreadsPerRuntime_ > 1) {
+				KERNEL_WARN("Lookahead synchronization runs each CPU runtime on a single thread, ignoring %d threads per runtime.",
+					numCPUThreadsPerRuntime_);
+			}
+		}
+	}
+
+	// 6. declare the spiking neural network is excutable
 	snnState = EXECUTABLE_SNN;
+
+	// 7. store the synapses of a network that was not found in the network cache
+	if (!networkCacheDir_.empty())
+		updateNetworkCache();
 }
 
 void SNN::resetConductances(int netId) {
@@ -5616,48 +6429,27 @@ void SNN::resetSpikeCnt(int gGrpId) {
 	assert(gGrpId >= ALL);
 
 	if (gGrpId == ALL) {
-		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			pthread_t threads[numCores + 1]; // 1 additional array size if numCores == 0, it may work though bad practice
-			cpu_set_t cpus;	
-			ThreadStruct argsThreadRoutine[numCores + 1]; // same as above, +1 array size
-			int threadCount = 0;
-		#endif
+		ThreadStruct argsThreadRoutine[MAX_NET_PER_SNN]; // one task per CPU runtime
+		int threadCount = 0;
 		
 		for (int netId = 0; netId < MAX_NET_PER_SNN; netId++) {
 			if (!groupPartitionLists[netId].empty()) {
 				if (netId < CPU_RUNTIME_BASE) // GPU runtime
 					resetSpikeCnt_GPU(netId, ALL);
 				else{ // CPU runtime
-					#if defined(WIN32) || defined(WIN64)
-						resetSpikeCnt_CPU(netId, ALL);
-					#else // Linux or MAC
-						pthread_attr_t attr;
-						pthread_attr_init(&attr);
-						CPU_ZERO(&cpus);
-						CPU_SET(threadCount%NUM_CPU_CORES, &cpus);
-						pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus);
-
-						argsThreadRoutine[threadCount].snn_pointer = this;
-						argsThreadRoutine[threadCount].netId = netId;
-						argsThreadRoutine[threadCount].lGrpId = ALL;
-						argsThreadRoutine[threadCount].startIdx = 0;
-						argsThreadRoutine[threadCount].endIdx = 0;
-						argsThreadRoutine[threadCount].GtoLOffset = 0;
-
-						pthread_create(&threads[threadCount], &attr, &SNN::helperResetSpikeCnt_CPU, (void*)&argsThreadRoutine[threadCount]);
-						pthread_attr_destroy(&attr);
-						threadCount++;
-					#endif
+					argsThreadRoutine[threadCount].snn_pointer = this;
+					argsThreadRoutine[threadCount].netId = netId;
+					argsThreadRoutine[threadCount].lGrpId = ALL;
+					argsThreadRoutine[threadCount].startIdx = 0;
+					argsThreadRoutine[threadCount].endIdx = 0;
+					argsThreadRoutine[threadCount].GtoLOffset = 0;
+					threadCount++;
 				}
 			}
 		}
 
-		#if !defined(WIN32) && !defined(WIN64) // Linux or MAC
-			// join all the threads
-			for (int i=0; i<threadCount; i++){
-				pthread_join(threads[i], NULL);
-			}
-		#endif
+		// run the CPU runtimes on the worker pool and wait for them to finish
+		runCPUTasks(&SNN::helperResetSpikeCnt_CPU, argsThreadRoutine, threadCount);
 	} 
 	else {
 		int netId = groupConfigMDMap[gGrpId].netId;
@@ -6184,6 +6976,15 @@ void SNN::printSimSummary() {
 	KERNEL_INFO("Overall Spike Count:\t2+ms delay = %d", managerRuntimeData.spikeCountD2);
 	KERNEL_INFO("\t\t\t1ms delay = %d", managerRuntimeData.spikeCountD1);
 	KERNEL_INFO("\t\t\tTotal = %d", managerRuntimeData.spikeCount);
+	for (int netId = CPU_RUNTIME_BASE; netId < MAX_NET_PER_SNN; netId++) {
+		if (!groupPartitionLists[netId].empty()) {
+			KERNEL_INFO("Firing Tables (CPU %d):\t1ms delay = %u of %u entries used, 2+ms delay = %u of %u entries used",
+				netId - CPU_RUNTIME_BASE, std::max(firingTableHighWaterD1[netId], runtimeData[netId].spikeCountD1Sec),
+				networkConfigs[netId].maxSpikesD1,
+				std::max(firingTableHighWaterD2[netId], runtimeData[netId].spikeCountD2Sec + runtimeData[netId].spikeCountLastSecLeftD2),
+				networkConfigs[netId].maxSpikesD2);
+		}
+	}
 	KERNEL_INFO("*********************************************************************************\n");
 }
 
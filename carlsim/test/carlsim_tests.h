@@ -98,4 +98,62 @@
 void readAndReturnSpikeFile(const std::string fileName, int*& AERArray, long &arraySize);
 void readAndPrintSpikeFile(const std::string fileName);
 
+/// **************************************************************************************************************** ///
+/// Exc/Inh Test Network
+/// **************************************************************************************************************** ///
+
+class CARLsim;
+class ConnectionMonitor;
+
+//! the spikes, weights, and conductances of a run of an ExcInhNetwork
+struct ExcInhRun {
+	std::vector<std::vector<int> > spikesExc, spikesInh;
+	std::vector<std::vector<float> > wtExcExc;
+	std::vector<float> gAMPA, gNMDA, gGABAb; //!< of the exc group at the end of the run, empty with CUBA
+};
+
+/*!
+ * \brief the network of the tests that compare the runs of a simulation option on and off
+ *
+ * The network consists of an exc and an inh group of Izhikevich neurons (RS, and the 9-param model), an input group
+ * that drives the exc group one-to-one with Poisson spikes, and random exc->exc, exc->inh, and inh->exc connections.
+ * A test derives from this class, sets the fields below to change the network, and implements configure() to set the
+ * option of a mode. run() builds the network, simulates it in two calls to runNetwork, and deletes it again; the hooks
+ * find the groups, the exc->exc connection, and its ConnectionMonitor in the protected members.
+ */
+class ExcInhNetwork {
+public:
+	ExcInhNetwork(const std::string& name);
+	virtual ~ExcInhNetwork() {}
+
+	//! builds and runs the network of the given mode on a CPU runtime
+	ExcInhRun run(int mode);
+
+	int numExc, numInh;     //!< number of exc and inh neurons (the input group has numExc neurons)
+	bool coba;              //!< COBA weights and conductances with NMDA and GABAb rise times, CUBA otherwise
+	bool plasticExcExc;     //!< whether the exc->exc connection is plastic (its STDP is set by configure())
+	float inputRate;        //!< Poisson rate of the input group (Hz)
+	int runTimeMs;          //!< total simulation time (ms)
+
+protected:
+	//! sets the options of the given mode before the network is set up
+	virtual void configure(CARLsim* sim, int mode) = 0;
+
+	//! called after the network is set up, before it runs
+	virtual void afterSetup(CARLsim* sim, int mode) {}
+
+	//! called after the network has run, before it is deleted
+	virtual void afterRun(CARLsim* sim, int mode) {}
+
+	int gExc_, gInh_, gIn_, cExcExc_;
+	ConnectionMonitor* cmExcExc_; //!< only valid after the network is set up
+
+private:
+	std::string name_;
+};
+
+//! expects two runs of an ExcInhNetwork to have the same spikes, and the same weights and conductances (bit-exact or
+//! within the float precision)
+void expectSameRun(const ExcInhRun& a, const ExcInhRun& b, bool bitExact);
+
 #endif // _CARLSIM_TEST_H_
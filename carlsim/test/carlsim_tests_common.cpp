@@ -45,8 +45,11 @@
 * CARLsim available from http://socsci.uci.edu/~jkrichma/CARLsim/
 * Ver 12/31/2016
 */
+#include "gtest/gtest.h"
 #include "carlsim_tests.h"
 
+#include <carlsim.h>
+
 #include <stdio.h>			// fopen, fseek, fclose, etc.
 #include <cassert>			// assert
 #include <string.h>			// std::string
@@ -113,4 +116,104 @@ void readAndPrintSpikeFile(const std::string fileName){
 
 	for (int i=0; i<arraySize; i+=2)
 		printf("time = %d, nid = %d\n",arrayAER[i],arrayAER[i+1]);
-}
\ No newline at end of file
+}
+/// ****************************************************************************
+/// Exc/Inh test network
+/// ****************************************************************************
+ExcInhNetwork::ExcInhNetwork(const std::string& name) : numExc(800), numInh(200), coba(true), plasticExcExc(false),
+	inputRate(5.0f), runTimeMs(1000), gExc_(-1), gInh_(-1), gIn_(-1), cExcExc_(-1), cmExcExc_(NULL), name_(name) {}
+
+ExcInhRun ExcInhNetwork::run(int mode) {
+	ExcInhRun result;
+	float pConn = 100.0f / 1000; // connection probability
+	CARLsim* sim = new CARLsim(name_, CPU_MODE, SILENT, 0, 42);
+
+	gExc_ = sim->createGroup("exc", numExc, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gExc_, 0.02f, 0.2f, -65.0f, 8.0f); // RS, 4-param
+	gInh_ = sim->createGroup("inh", numInh, INHIBITORY_NEURON);
+	sim->setNeuronParameters(gInh_, 100.0f, 0.7f, -60.0f, -40.0f, 0.03f, -2.0f, 35.0f, -50.0f, 100.0f); // 9-param
+	gIn_ = sim->createSpikeGeneratorGroup("input", numExc, EXCITATORY_NEURON);
+
+	float wtExcExc = coba ? 0.05f : 1.0f;
+	RangeWeight wtExcExcRange = plasticExcExc ? RangeWeight(0.0f, wtExcExc, 2 * wtExcExc) : RangeWeight(wtExcExc);
+	sim->connect(gIn_, gExc_, "one-to-one", RangeWeight(coba ? 1.0f : 20.0f), 1.0f, RangeDelay(1), RadiusRF(-1),
+		SYN_FIXED);
+	cExcExc_ = sim->connect(gExc_, gExc_, "random", wtExcExcRange, pConn, RangeDelay(1, 20), RadiusRF(-1),
+		plasticExcExc ? SYN_PLASTIC : SYN_FIXED);
+	sim->connect(gExc_, gInh_, "random", RangeWeight(coba ? 0.05f : 150.0f), pConn, RangeDelay(1, 20), RadiusRF(-1),
+		SYN_FIXED);
+	sim->connect(gInh_, gExc_, "random", RangeWeight(coba ? 0.1f : 2.0f), pConn * 1.25f, RangeDelay(1), RadiusRF(-1),
+		SYN_FIXED);
+
+	if (coba)
+		sim->setConductances(true, 5, 20, 150, 6, 100, 150); // with NMDA and GABAb rise times
+	else
+		sim->setConductances(false);
+	configure(sim, mode);
+
+	sim->setupNetwork();
+
+	SpikeMonitor* smExc = sim->setSpikeMonitor(gExc_, "NULL");
+	SpikeMonitor* smInh = sim->setSpikeMonitor(gInh_, "NULL");
+	cmExcExc_ = sim->setConnectionMonitor(gExc_, gExc_, "NULL");
+
+	PoissonRate in(numExc);
+	in.setRates(inputRate);
+	sim->setSpikeRate(gIn_, &in);
+	afterSetup(sim, mode);
+
+	// stopping and resuming must not make a difference
+	smExc->startRecording();
+	smInh->startRecording();
+	int runTimeMs1 = runTimeMs / 2, runTimeMs2 = runTimeMs - runTimeMs1;
+	sim->runNetwork(runTimeMs1 / 1000, runTimeMs1 % 1000, false);
+	sim->runNetwork(runTimeMs2 / 1000, runTimeMs2 % 1000, false);
+	smExc->stopRecording();
+	smInh->stopRecording();
+
+	EXPECT_GT(smExc->getPopNumSpikes(), 0);
+	EXPECT_GT(smInh->getPopNumSpikes(), 0);
+	result.spikesExc = smExc->getSpikeVector2D();
+	result.spikesInh = smInh->getSpikeVector2D();
+	result.wtExcExc = cmExcExc_->takeSnapshot();
+	if (coba) {
+		result.gAMPA = sim->getConductanceAMPA(gExc_);
+		result.gNMDA = sim->getConductanceNMDA(gExc_);
+		result.gGABAb = sim->getConductanceGABAb(gExc_);
+	}
+	afterRun(sim, mode);
+
+	delete sim;
+	return result;
+}
+
+// compares two vectors of spike times, weights, or conductances
+template<typename T>
+static void expectSameVector2D(const std::vector<std::vector<T> >& a, const std::vector<std::vector<T> >& b,
+	bool bitExact)
+{
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); i++) {
+		ASSERT_EQ(a[i].size(), b[i].size());
+		for (size_t j = 0; j < a[i].size(); j++) {
+			if (a[i][j] != a[i][j]) {
+				EXPECT_NE(b[i][j], b[i][j]); // NaN: no synapse
+			} else if (bitExact) {
+				EXPECT_EQ(a[i][j], b[i][j]);
+			} else {
+				EXPECT_FLOAT_EQ(a[i][j], b[i][j]);
+			}
+		}
+	}
+}
+
+void expectSameRun(const ExcInhRun& a, const ExcInhRun& b, bool bitExact) {
+	expectSameVector2D(a.spikesExc, b.spikesExc, true);
+	expectSameVector2D(a.spikesInh, b.spikesInh, true);
+	expectSameVector2D(a.wtExcExc, b.wtExcExc, bitExact);
+
+	std::vector<std::vector<float> > gA, gB;
+	gA.push_back(a.gAMPA); gA.push_back(a.gNMDA); gA.push_back(a.gGABAb);
+	gB.push_back(b.gAMPA); gB.push_back(b.gNMDA); gB.push_back(b.gGABAb);
+	expectSameVector2D(gA, gB, bitExact);
+}
@@ -142,6 +142,66 @@ TEST(COBA, synRiseTime) {
 	}
 }
 
+/*!
+ * \brief This test ensures that the lazy conductance decay only sets vanishing conductances to zero
+ *
+ * A neuron receives one excitatory and one inhibitory spike per second. The conductances are compared to those of
+ * the default decay while they are large, must be zero once they have decayed below the snap threshold (whereas the
+ * default decay keeps them positive), and must follow the default decay again after the next input spike.
+ */
+TEST(COBA, lazyConductanceDecay) {
+	const float snapThreshold = 1e-2f;
+	std::vector<float> gNMDA[2], gGABAb[2];
+
+	for (int lazy = 0; lazy <= 1; lazy++) {
+		CARLsim* sim = new CARLsim("COBA.lazyConductanceDecay", CPU_MODE, SILENT, 0, 42);
+		int g1 = sim->createGroup("excit", 1, EXCITATORY_NEURON);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		int g0 = sim->createSpikeGeneratorGroup("inputExc", 1, EXCITATORY_NEURON);
+		int g2 = sim->createSpikeGeneratorGroup("inputInh", 1, INHIBITORY_NEURON);
+		sim->connect(g0, g1, "one-to-one", RangeWeight(0.5f), 1.0f, RangeDelay(1), RadiusRF(-1.0), SYN_FIXED, 0.5f, 0.5f);
+		sim->connect(g2, g1, "one-to-one", RangeWeight(0.5f), 1.0f, RangeDelay(1), RadiusRF(-1.0), SYN_FIXED, 0.5f, 0.5f);
+		sim->setConductances(true, 5, 20, 150, 6, 100, 150);
+		sim->setCPULazyConductanceDecay(lazy == 1, snapThreshold);
+
+		PeriodicSpikeGenerator spkGenExc(1.0f, true), spkGenInh(1.0f, true);
+		sim->setSpikeGenerator(g0, &spkGenExc);
+		sim->setSpikeGenerator(g2, &spkGenInh);
+		sim->setupNetwork();
+
+		// conductances are large: same as the default decay
+		sim->runNetwork(0, 50);
+		gNMDA[lazy] = sim->getConductanceNMDA(g1);
+		gGABAb[lazy] = sim->getConductanceGABAb(g1);
+
+		// conductances have vanished: zero with the lazy decay only
+		sim->runNetwork(0, 900);
+		if (lazy) {
+			EXPECT_EQ(sim->getConductanceAMPA(g1)[0], 0.0f);
+			EXPECT_EQ(sim->getConductanceNMDA(g1)[0], 0.0f);
+			EXPECT_EQ(sim->getConductanceGABAa(g1)[0], 0.0f);
+			EXPECT_EQ(sim->getConductanceGABAb(g1)[0], 0.0f);
+		} else {
+			EXPECT_GT(sim->getConductanceNMDA(g1)[0], 0.0f);
+			EXPECT_GT(sim->getConductanceGABAb(g1)[0], 0.0f);
+		}
+
+		// the next input spike (t = 1000 ms) resumes the decay
+		sim->runNetwork(0, 100);
+		gNMDA[lazy].push_back(sim->getConductanceNMDA(g1)[0]);
+		gGABAb[lazy].push_back(sim->getConductanceGABAb(g1)[0]);
+
+		delete sim;
+	}
+
+	EXPECT_FLOAT_EQ(gNMDA[1][0], gNMDA[0][0]);
+	EXPECT_FLOAT_EQ(gGABAb[1][0], gGABAb[0][0]);
+	EXPECT_GT(gNMDA[1][1], 0.0f);
+	EXPECT_GT(gGABAb[1][1], 0.0f);
+	EXPECT_NEAR(gNMDA[1][1], gNMDA[0][1], snapThreshold);
+	EXPECT_NEAR(gGABAb[1][1], gGABAb[0][1], snapThreshold);
+}
+
 #ifndef __NO_CUDA__
 /*!
  * \brief This test ensures that CPUmode and GPUmode produce the exact same conductance values over some time period
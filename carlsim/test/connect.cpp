@@ -52,6 +52,8 @@
 #include <vector>
 #include <math.h> // sqrt
 
+#include <periodic_spikegen.h>
+
 /// **************************************************************************************************************** ///
 /// Connect FUNCTIONALITY
 /// **************************************************************************************************************** ///
@@ -198,6 +200,201 @@ TEST(Connect, connectRandom) {
 	delete sim;
 }
 
+// unrestricted random connections are drawn with skip sampling, which must create the expected number of synapses
+TEST(Connect, connectRandomSkipSampling) {
+	CARLsim* sim = new CARLsim("Connect.connectRandomSkipSampling",CPU_MODE,SILENT,1,42);
+	int g0=sim->createGroup("excit0", 2000, EXCITATORY_NEURON);
+	int g1=sim->createGroup("excit1", 20, EXCITATORY_NEURON);
+	sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	double prob = 0.01;
+	int c0=sim->connect(g0,g0,"random",RangeWeight(0.1), prob, RangeDelay(1));
+	int c1=sim->connect(g1,g1,"random",RangeWeight(0.1), 1.0, RangeDelay(1));
+
+	sim->setupNetwork();
+
+	int numPairs = 2000 * 2000;
+	int errorMargin = 7.5*sqrt(prob*(1-prob)*numPairs)+0.5;
+	EXPECT_NEAR(sim->getNumSynapticConnections(c0), prob * numPairs, errorMargin);
+	EXPECT_EQ(sim->getNumSynapticConnections(c1), 20 * 20);
+
+	// the synapses are spread over all pre- and post-synaptic neurons
+	ConnectionMonitor* CM0 = sim->setConnectionMonitor(g0,g0,"NULL");
+	std::vector< std::vector<float> > wt0 = CM0->takeSnapshot();
+	int numPre[2] = {0, 0}, numPost[2] = {0, 0};
+	for (int i=0; i<wt0.size(); i++) {
+		for (int j=0; j<wt0[i].size(); j++) {
+			if (!isnan(wt0[i][j])) {
+				numPre[i >= 1000]++;
+				numPost[j >= 1000]++;
+			}
+		}
+	}
+	EXPECT_NEAR(numPre[0], numPre[1], 2 * errorMargin);
+	EXPECT_NEAR(numPost[0], numPost[1], 2 * errorMargin);
+
+	delete sim;
+}
+
+// every connection draws from its own random streams, so that the synapses depend neither on the number of threads
+// that generate them nor on the global random number generators
+TEST(Connect, connectThreadIndependent) {
+	std::vector< std::vector<float> > wt[2][3];
+	uint8_t* delays[2][3];
+	for (int run = 0; run < 2; run++) {
+		srand(run); // must not matter
+		CARLsim* sim = new CARLsim("Connect.connectThreadIndependent",CPU_MODE,SILENT,0,42);
+		Grid3D grid(30,20,2);
+		int g0=sim->createGroup("excit0", grid, EXCITATORY_NEURON);
+		int g1=sim->createGroup("excit1", grid, EXCITATORY_NEURON);
+		int g2=sim->createGroup("inhib2", grid, INHIBITORY_NEURON);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g2, 0.1f, 0.2f, -65.0f, 2.0f);
+
+		sim->connect(g0,g1,"random",RangeWeight(0.1), 0.05, RangeDelay(1,20));
+		sim->connect(g1,g2,"gaussian",RangeWeight(0.2), 0.5, RangeDelay(1,10), RadiusRF(3,3,1));
+		sim->connect(g2,g0,"full",RangeWeight(0.3), 1.0, RangeDelay(1,5), RadiusRF(2,2,0));
+		sim->setCPUThreadsPerRuntime(run == 0 ? 1 : 4);
+
+		sim->setupNetwork();
+
+		int grpIds[4] = {g0, g1, g2, g0};
+		for (int c = 0; c < 3; c++) {
+			ConnectionMonitor* CM = sim->setConnectionMonitor(grpIds[c],grpIds[c+1],"NULL");
+			wt[run][c] = CM->takeSnapshot();
+			int numPre, numPost;
+			delays[run][c] = sim->getDelays(grpIds[c], grpIds[c+1], numPre, numPost);
+		}
+
+		delete sim;
+	}
+
+	for (int c = 0; c < 3; c++) {
+		ASSERT_EQ(wt[0][c].size(), wt[1][c].size());
+		int nSyn = 0;
+		for (int i = 0; i < wt[0][c].size(); i++) {
+			for (int j = 0; j < wt[0][c][i].size(); j++) {
+				if (isnan(wt[0][c][i][j])) {
+					EXPECT_TRUE(isnan(wt[1][c][i][j]));
+				} else {
+					EXPECT_FLOAT_EQ(wt[0][c][i][j], wt[1][c][i][j]);
+					nSyn++;
+				}
+				EXPECT_EQ(delays[0][c][i * wt[0][c][i].size() + j], delays[1][c][i * wt[0][c][i].size() + j]);
+			}
+		}
+		EXPECT_GT(nSyn, 0);
+		delete[] delays[0][c];
+		delete[] delays[1][c];
+	}
+}
+
+
+//! connects neuron i to neuron j if i+j is a multiple of three
+class EveryThirdPairConnGen : public ConnectionGenerator {
+public:
+	void connect(CARLsim* net, int srcGrp, int i, int destGrp, int j, float& weight, float& maxWt, float& delay,
+		bool& connected) {
+		connected = ((i + j) % 3 == 0);
+		weight = 0.1f;
+		maxWt = 0.1f;
+		delay = 1 + (i % 7);
+	}
+};
+
+// connectNetwork counts the synapses of each block, allocates the connection lists once, and then generates each block
+// into its slice. The synapses must not depend on the partitioning (external connections are written into the lists
+// of two networks) or on the number of threads, and user-defined connections in between generated ones must keep their
+// place: the spikes of networks that only differ in the number of threads are identical
+TEST(Connect, connectTwoPassBuild) {
+	const int numConns = 5;
+	std::vector< std::vector<float> > wt[4][numConns];
+	uint8_t* delays[4][numConns];
+	std::vector< std::vector<int> > spikes[4];
+	int numSyn[4][numConns];
+
+	for (int run = 0; run < 4; run++) {
+		bool twoPartitions = (run >= 2);
+		CARLsim* sim = new CARLsim("Connect.connectTwoPassBuild", CPU_MODE, SILENT, 0, 42);
+		PeriodicSpikeGenerator spkGen(50.0f);
+		EveryThirdPairConnGen connGen;
+
+		int gIn = sim->createSpikeGeneratorGroup("input", 50, EXCITATORY_NEURON, 0, CPU_CORES);
+		int g0 = sim->createGroup("excit0", Grid3D(20, 10, 1), EXCITATORY_NEURON, 0, CPU_CORES);
+		int g1 = sim->createGroup("excit1", Grid3D(20, 10, 1), EXCITATORY_NEURON, twoPartitions ? 1 : 0, CPU_CORES);
+		int g2 = sim->createGroup("inhib2", Grid3D(10, 10, 1), INHIBITORY_NEURON, twoPartitions ? 1 : 0, CPU_CORES);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f);
+		sim->setNeuronParameters(g2, 0.1f, 0.2f, -65.0f, 2.0f);
+		sim->setSpikeGenerator(gIn, &spkGen);
+
+		sim->connect(gIn, g0, "random", RangeWeight(0.3f), 0.2f, RangeDelay(1, 5));
+		sim->connect(g0, g1, "random", RangeWeight(0.05f), 0.1f, RangeDelay(1, 20));
+		sim->connect(g0, g2, &connGen, SYN_FIXED);
+		sim->connect(g1, g0, "one-to-one", RangeWeight(0.02f), 1.0f, RangeDelay(3));
+		sim->connect(g1, g2, "gaussian", RangeWeight(0.1f), 0.5f, RangeDelay(1, 10), RadiusRF(3, 3, 0));
+		sim->connect(g2, g0, "full", RangeWeight(0.05f), 1.0f, RangeDelay(1, 4));
+		sim->setConductances(false);
+		sim->setCPUThreadsPerRuntime(run % 2 == 0 ? 1 : 4);
+
+		sim->setupNetwork();
+
+		int grpIds[numConns][2] = {{g0, g1}, {g0, g2}, {g1, g0}, {g1, g2}, {g2, g0}};
+		for (int c = 0; c < numConns; c++) {
+			ConnectionMonitor* CM = sim->setConnectionMonitor(grpIds[c][0], grpIds[c][1], "NULL");
+			wt[run][c] = CM->takeSnapshot();
+			numSyn[run][c] = CM->getNumSynapses();
+			int numPre, numPost;
+			delays[run][c] = sim->getDelays(grpIds[c][0], grpIds[c][1], numPre, numPost);
+		}
+
+		SpikeMonitor* SM = sim->setSpikeMonitor(g0, "NULL");
+		SM->startRecording();
+		sim->runNetwork(0, 500, false);
+		SM->stopRecording();
+		spikes[run] = SM->getSpikeVector2D();
+
+		delete sim;
+	}
+
+	// the sizes of the connections that do not depend on random numbers
+	for (int run = 0; run < 4; run++) {
+		int numEveryThird = 0;
+		for (int i = 0; i < 200; i++)
+			for (int j = 0; j < 100; j++)
+				numEveryThird += ((i + j) % 3 == 0);
+		EXPECT_EQ(numSyn[run][1], numEveryThird);
+		EXPECT_EQ(numSyn[run][2], 200);
+		EXPECT_EQ(numSyn[run][4], 100 * 200);
+	}
+
+	for (int run = 1; run < 4; run++) {
+		for (int c = 0; c < numConns; c++) {
+			EXPECT_EQ(numSyn[0][c], numSyn[run][c]);
+			ASSERT_EQ(wt[0][c].size(), wt[run][c].size());
+			for (int i = 0; i < wt[0][c].size(); i++) {
+				for (int j = 0; j < wt[0][c][i].size(); j++) {
+					if (isnan(wt[0][c][i][j])) {
+						EXPECT_TRUE(isnan(wt[run][c][i][j]));
+					} else {
+						EXPECT_FLOAT_EQ(wt[0][c][i][j], wt[run][c][i][j]);
+					}
+					EXPECT_EQ(delays[0][c][i * wt[0][c][i].size() + j], delays[run][c][i * wt[0][c][i].size() + j]);
+				}
+			}
+		}
+	}
+
+	// the same synapses in the same order of the synapse arrays
+	EXPECT_EQ(spikes[0], spikes[1]);
+	EXPECT_EQ(spikes[2], spikes[3]);
+
+	for (int run = 0; run < 4; run++)
+		for (int c = 0; c < numConns; c++)
+			delete[] delays[run][c];
+}
 
 TEST(Connect, connectGaussian) {
 	CARLsim* sim = NULL;
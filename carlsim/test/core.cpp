@@ -52,6 +52,7 @@
 #include <vector>
 
 #include <periodic_spikegen.h>
+#include <izhikevich_simd.h> // vectorized neuron update kernels
 
 
 /// **************************************************************************************************************** ///
@@ -562,6 +563,361 @@ TEST(Core, startStopTestingPhase) {
 	}
 }
 
+// The fused neuron update (CPU only) must produce bit-exact results compared to the phase-by-phase update, including
+// the conductances read between two calls to runNetwork
+TEST(Core, fusedNeuronUpdateBitExact) {
+	class FusedNetwork : public ExcInhNetwork {
+	public:
+		FusedNetwork(int method) : ExcInhNetwork("Core.fusedNeuronUpdateBitExact"), method_(method) {
+			plasticExcExc = true;
+		}
+	protected:
+		void configure(CARLsim* sim, int fused) {
+			sim->setESTDP(gExc_, true, STANDARD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+			sim->setHomeostasis(gExc_, true, 1.0f, 10.0f);
+			sim->setHomeoBaseFiringRate(gExc_, 10.0f, 0.0f);
+			if (method_ == 0)
+				sim->setIntegrationMethod(FORWARD_EULER, 2);
+			else
+				sim->setIntegrationMethod(RUNGE_KUTTA4, 10);
+			sim->setCPUFusedNeuronUpdate(fused == 1);
+		}
+	private:
+		int method_;
+	};
+
+	for (int method = 0; method < 2; method++) {
+		FusedNetwork net(method);
+		expectSameRun(net.run(0), net.run(1), true);
+	}
+}
+
+// The vectorized neuron update (CPU only) must produce bit-exact results compared to the scalar update, with and
+// without the fused neuron update. Group sizes are not multiples of the vector width, so that the remainder is covered.
+TEST(Core, vectorizedNeuronUpdateBitExact) {
+	class VectorizedNetwork : public ExcInhNetwork {
+	public:
+		VectorizedNetwork(int method, bool withCoba) : ExcInhNetwork("Core.vectorizedNeuronUpdateBitExact"),
+			method_(method)
+		{
+			numExc = 803;
+			numInh = 203;
+			coba = withCoba;
+			runTimeMs = 300;
+		}
+	protected:
+		// 0: scalar, 1: vectorized, 2: vectorized and fused
+		void configure(CARLsim* sim, int mode) {
+			if (method_ == 0)
+				sim->setIntegrationMethod(FORWARD_EULER, 2);
+			else
+				sim->setIntegrationMethod(RUNGE_KUTTA4, 10);
+			sim->setCPUVectorizedNeuronUpdate(mode > 0);
+			sim->setCPUFusedNeuronUpdate(mode == 2);
+		}
+	private:
+		int method_;
+	};
+
+	for (int method = 0; method < 2; method++) {
+		for (int coba = 0; coba < 2; coba++) {
+			VectorizedNetwork net(method, coba == 1);
+			ExcInhRun scalar = net.run(0);
+			for (int mode = 1; mode < 3; mode++)
+				expectSameRun(scalar, net.run(mode), true);
+		}
+	}
+}
+
+// All SIMD kernels supported by the processor must compute bit-exact the same state as the scalar kernel
+TEST(Core, izhikevichKernelsBitExact) {
+	const int numN = 37; // not a multiple of the vector width
+	SimdInstructionSet isaSupported = detectSimdInstructionSet();
+
+	srand(42);
+	std::vector<float> v(numN), u(numN), I(numN), a(numN), b(numN), c(numN), d(numN), C(numN), k(numN), vr(numN),
+		vt(numN), vpeak(numN), g(numN * 8);
+	for (int i = 0; i < numN; i++) {
+		v[i] = -80.0f + 120.0f * rand() / RAND_MAX; // some neurons are above threshold
+		u[i] = -20.0f + 20.0f * rand() / RAND_MAX;
+		I[i] = 10.0f * rand() / RAND_MAX;
+		a[i] = 0.02f; b[i] = 0.2f; c[i] = -65.0f; d[i] = 8.0f;
+		C[i] = 100.0f; k[i] = 0.7f; vr[i] = -60.0f; vt[i] = -40.0f; vpeak[i] = 35.0f;
+	}
+	for (int i = 0; i < numN * 8; i++)
+		g[i] = 0.5f * rand() / RAND_MAX;
+
+	for (int config = 0; config < 16; config++) {
+		std::vector<float> vOut[3], uOut[3], IOut[3];
+		std::vector<bool> spikes[3];
+
+		for (int isa = SIMD_SCALAR; isa <= isaSupported; isa++) {
+			vOut[isa] = v;
+			uOut[isa] = u;
+			IOut[isa] = I;
+			unsigned int curSpikeBits[numN / 32 + 2] = {0};
+
+			IzhikevichRange range;
+			range.numN = numN;
+			range.numSteps = 2;
+			range.voltage = &v[0];
+			range.nextVoltage = &vOut[isa][0];
+			range.recovery = &uOut[isa][0];
+			range.curSpikeBits = curSpikeBits;
+			range.curSpikeBitOffset = 5; // the vectors of a range straddle the words of the bitset
+			range.current = &IOut[isa][0];
+			range.extCurrent = &I[0];
+			range.Izh_a = &a[0]; range.Izh_b = &b[0]; range.Izh_c = &c[0]; range.Izh_d = &d[0];
+			range.Izh_C = &C[0]; range.Izh_k = &k[0]; range.Izh_vr = &vr[0]; range.Izh_vt = &vt[0];
+			range.Izh_vpeak = &vpeak[0];
+			range.gAMPA = &g[0]; range.gNMDA = &g[numN]; range.gNMDA_r = &g[2 * numN]; range.gNMDA_d = &g[3 * numN];
+			range.gGABAa = &g[4 * numN]; range.gGABAb = &g[5 * numN]; range.gGABAb_r = &g[6 * numN];
+			range.gGABAb_d = &g[7 * numN];
+			range.withParamModel_9 = (config & 1) != 0;
+			range.integrationMethod = (config & 2) ? RUNGE_KUTTA4 : FORWARD_EULER;
+			range.withConductances = (config & 4) != 0;
+			range.withNMDARise = range.withGABAbRise = (config & 8) != 0;
+			range.timeStep = 0.5f;
+
+			integrateIzhikevich(range, (SimdInstructionSet)isa);
+			for (int i = 0; i < numN; i++)
+				spikes[isa].push_back((curSpikeBits[(i + 5) / 32] >> ((i + 5) % 32)) & 1u);
+			EXPECT_EQ(curSpikeBits[0] & 0x1fu, 0u);
+		}
+
+		for (int isa = SIMD_SCALAR + 1; isa <= isaSupported; isa++) {
+			for (int i = 0; i < numN; i++) {
+				EXPECT_EQ(vOut[SIMD_SCALAR][i], vOut[isa][i]);
+				EXPECT_EQ(uOut[SIMD_SCALAR][i], uOut[isa][i]);
+				EXPECT_EQ(IOut[SIMD_SCALAR][i], IOut[isa][i]);
+				EXPECT_EQ(spikes[SIMD_SCALAR][i], spikes[isa][i]);
+			}
+		}
+	}
+}
+
+// The compact synapse storage (CPU only) must give the same results as the default storage with float weights, and
+// weights within the rounding error of the weight format with half and int8 weights
+TEST(Core, compactSynapseStorage) {
+	// 0: default, 1: compact float, 2: compact half, 3: compact int8
+	class CompactNetwork : public ExcInhNetwork {
+	public:
+		CompactNetwork() : ExcInhNetwork("Core.compactSynapseStorage") {
+			runTimeMs = 500;
+			for (int mode = 0; mode < 4; mode++)
+				delays[mode] = NULL;
+		}
+		~CompactNetwork() {
+			for (int mode = 0; mode < 4; mode++)
+				delete[] delays[mode];
+		}
+
+		std::vector<std::vector<float> > wtRaised[4], wtScaled[4];
+		uint8_t* delays[4];
+
+	protected:
+		void configure(CARLsim* sim, int mode) {
+			if (mode > 0)
+				sim->setCPUCompactSynapses(true, (SynWeightFormat)(mode - 1));
+		}
+
+		// changed weights are stored in the weight format, too, also beyond the initial maximum weight (a snapshot is
+		// only taken once the simulation time advanced)
+		void afterRun(CARLsim* sim, int mode) {
+			sim->scaleWeights(cExcExc_, 2.0f, true);
+			sim->runNetwork(0, 1, false);
+			wtRaised[mode] = cmExcExc_->takeSnapshot();
+			sim->scaleWeights(cExcExc_, 0.25f, false);
+			sim->runNetwork(0, 1, false);
+			wtScaled[mode] = cmExcExc_->takeSnapshot();
+
+			int numPre, numPost;
+			delete[] delays[mode];
+			delays[mode] = sim->getDelays(gExc_, gInh_, numPre, numPost);
+			EXPECT_EQ(numPre * numPost, numExc * numInh);
+		}
+	};
+
+	CompactNetwork net;
+	ExcInhRun runs[4];
+	for (int mode = 0; mode < 4; mode++)
+		runs[mode] = net.run(mode);
+
+	// with float weights, the simulation is the same
+	expectSameRun(runs[0], runs[1], true);
+
+	float maxWt = 0.05f; // the exc->exc weight
+	for (int mode = 1; mode < 4; mode++) {
+		// the maximum rounding error of a weight w
+		float relErr = (mode == 2) ? 1.0f / 2048 : 0.0f;
+		float absErr = (mode == 3) ? maxWt / 254 + 1e-6f : 0.0f;
+
+		std::vector<std::vector<float> >& wt0 = runs[0].wtExcExc;
+		std::vector<std::vector<float> >& wt = runs[mode].wtExcExc;
+		ASSERT_EQ(wt0.size(), wt.size());
+		for (int i = 0; i < wt0.size(); i++) {
+			ASSERT_EQ(wt0[i].size(), wt[i].size());
+			for (int j = 0; j < wt0[i].size(); j++) {
+				if (isnan(wt0[i][j])) {
+					EXPECT_TRUE(isnan(wt[i][j]));
+					continue;
+				}
+				EXPECT_NEAR(wt0[i][j], wt[i][j], fabs(wt0[i][j]) * relErr + absErr);
+				EXPECT_NEAR(net.wtRaised[0][i][j], net.wtRaised[mode][i][j], 2 * (fabs(wt0[i][j]) * relErr + absErr));
+				EXPECT_NEAR(net.wtScaled[0][i][j], net.wtScaled[mode][i][j], 3 * (fabs(wt0[i][j]) * relErr + absErr));
+			}
+		}
+
+		ASSERT_TRUE(net.delays[0] != NULL && net.delays[mode] != NULL);
+		for (int i = 0; i < net.numExc * net.numInh; i++)
+			EXPECT_EQ(net.delays[0][i], net.delays[mode][i]);
+	}
+}
+
+// The neuron reordering (CPU only) changes the storage order of the neurons of 2D and 3D groups, but neither the
+// public neuron ids nor the connectivity, and the spikes only up to rounding
+TEST(Core, neuronReordering) {
+	int randSeed = 42;
+
+	std::vector<std::vector<int> > spikes[2];
+	std::vector<std::vector<float> > wt[2];
+	std::vector<float> gAMPA[2];
+	for (int reorder = 0; reorder <= 1; reorder++) {
+		CARLsim* sim = new CARLsim("Core.neuronReordering", CPU_MODE, SILENT, 0, randSeed);
+
+		int gExc = sim->createGroup("exc", Grid3D(24, 20), EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+		int gInh = sim->createGroup("inh", Grid3D(12, 10, 2), INHIBITORY_NEURON);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+		int gIn = sim->createSpikeGeneratorGroup("input", Grid3D(24, 20), EXCITATORY_NEURON);
+
+		sim->connect(gIn, gExc, "one-to-one", RangeWeight(1.0f), 1.0f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gExc, "gaussian", RangeWeight(0.05f), 0.5f, RangeDelay(1, 10), RadiusRF(3, 3, 0),
+			SYN_FIXED);
+		sim->connect(gExc, gInh, "gaussian", RangeWeight(0.05f), 0.5f, RangeDelay(1, 5), RadiusRF(4, 4, 2),
+			SYN_FIXED);
+		int cInhExc = sim->connect(gInh, gExc, "gaussian", RangeWeight(0.1f), 0.5f, RangeDelay(1), RadiusRF(4, 4, 2),
+			SYN_FIXED);
+
+		sim->setConductances(true);
+		sim->setCPUNeuronReordering(reorder == 1);
+
+		sim->setupNetwork();
+
+		SpikeMonitor* SM = sim->setSpikeMonitor(gExc, "NULL");
+		ConnectionMonitor* CM = sim->setConnectionMonitor(gInh, gExc, "NULL");
+
+		PoissonRate in(24 * 20);
+		in.setRates(5.0f);
+		sim->setSpikeRate(gIn, &in);
+
+		// an external current that depends on the neuron id
+		std::vector<float> current(24 * 20, 0.0f);
+		for (int neurId = 0; neurId < 24 * 5; neurId++)
+			current[neurId] = 10.0f;
+		sim->setExternalCurrent(gExc, current);
+
+		SM->startRecording();
+		sim->runNetwork(0, 500, false);
+		SM->stopRecording();
+
+		EXPECT_GT(SM->getPopNumSpikes(), 0);
+		spikes[reorder] = SM->getSpikeVector2D();
+		wt[reorder] = CM->takeSnapshot();
+		gAMPA[reorder] = sim->getConductanceAMPA(gExc);
+
+		// the synapses are still found by the ids of their neurons
+		sim->setWeight(cInhExc, 0, 0, 0.02f, true);
+		std::vector<std::vector<float> > wtSet = CM->takeSnapshot();
+		if (!isnan(wt[reorder][0][0])) {
+			EXPECT_FLOAT_EQ(wtSet[0][0], -0.02f);
+		}
+
+		delete sim;
+	}
+
+	ASSERT_EQ(wt[0].size(), wt[1].size());
+	for (int i = 0; i < wt[0].size(); i++) {
+		ASSERT_EQ(wt[0][i].size(), wt[1][i].size());
+		for (int j = 0; j < wt[0][i].size(); j++) {
+			if (isnan(wt[0][i][j]))
+				EXPECT_TRUE(isnan(wt[1][i][j]));
+			else
+				EXPECT_FLOAT_EQ(wt[0][i][j], wt[1][i][j]);
+		}
+	}
+
+	// the neurons with the external current fire the most
+	int numSpkCurrent = 0, numSpkNoCurrent = 0;
+	ASSERT_EQ(spikes[0].size(), spikes[1].size());
+	for (int nId = 0; nId < spikes[0].size(); nId++) {
+		EXPECT_NEAR(spikes[0][nId].size(), spikes[1][nId].size(), 1);
+		if (nId < 24 * 5)
+			numSpkCurrent += spikes[1][nId].size();
+		else if (nId < 24 * 10)
+			numSpkNoCurrent += spikes[1][nId].size();
+	}
+	EXPECT_GT(numSpkCurrent, 2 * numSpkNoCurrent);
+
+	ASSERT_EQ(gAMPA[0].size(), gAMPA[1].size());
+	for (int nId = 0; nId < gAMPA[0].size(); nId++)
+		EXPECT_NEAR(gAMPA[0][nId], gAMPA[1][nId], 1e-3f);
+}
+
+//! pull-based and automatically selected spike delivery produce the same spikes as push-based spike delivery. The
+//! weights are powers of two and the currents are not decayed (CUBA), so that the order of the synapses does not matter
+TEST(Core, spikeDeliveryModes) {
+	int randSeed = 42;
+	SpikeDeliveryMode modes[4] = {SPIKE_DELIVERY_PUSH, SPIKE_DELIVERY_PULL, SPIKE_DELIVERY_AUTO, SPIKE_DELIVERY_PULL};
+
+	std::vector<std::vector<int> > spikes[4];
+	for (int i = 0; i < 4; i++) {
+		CARLsim* sim = new CARLsim("Core.spikeDeliveryModes", CPU_MODE, SILENT, 0, randSeed);
+
+		int gExc = sim->createGroup("exc", 400, EXCITATORY_NEURON);
+		sim->setNeuronParameters(gExc, 0.1f, 0.2f, -65.0f, 2.0f);
+		int gInh = sim->createGroup("inh", 100, INHIBITORY_NEURON);
+		sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+		int gIn = sim->createSpikeGeneratorGroup("input", 400, EXCITATORY_NEURON);
+
+		sim->connect(gIn, gExc, "one-to-one", RangeWeight(32.0f), 1.0f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gExc, "random", RangeWeight(1.0f), 0.1f, RangeDelay(1, 20), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gExc, gInh, "random", RangeWeight(1.0f), 0.1f, RangeDelay(1, 5), RadiusRF(-1), SYN_FIXED);
+		sim->connect(gInh, gExc, "random", RangeWeight(2.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+
+		sim->setConductances(false);
+		sim->setCPUSpikeDelivery(modes[i]);
+		if (i == 3) {
+			sim->setCPUThreadsPerRuntime(2);
+			sim->setCPUParallelSpikeDelivery(true);
+		}
+
+		sim->setupNetwork();
+
+		SpikeMonitor* SM = sim->setSpikeMonitor(gExc, "NULL");
+
+		PoissonRate in(400);
+		in.setRates(80.0f);
+		sim->setSpikeRate(gIn, &in);
+
+		// the fast spiking neurons are dense enough for the automatic selection to pull after the first second
+		SM->startRecording();
+		sim->runNetwork(2, 500, false);
+		SM->stopRecording();
+
+		EXPECT_GT(SM->getPopNumSpikes(), 0);
+		spikes[i] = SM->getSpikeVector2D();
+
+		delete sim;
+	}
+
+	for (int i = 1; i < 4; i++) {
+		ASSERT_EQ(spikes[0].size(), spikes[i].size());
+		for (int nId = 0; nId < spikes[0].size(); nId++)
+			EXPECT_EQ(spikes[0][nId], spikes[i][nId]);
+	}
+}
+
 TEST(Core, saveLoadSimulation) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
@@ -637,6 +993,196 @@ TEST(Core, saveLoadSimulation) {
 	}
 }
 
+// a loaded simulation has to continue the saved simulation bit by bit, also when the random seed of the loading
+// simulation differs. The networks have STDP, STP, homeostasis, conductances, and spikes in transit at the time they
+// are saved.
+TEST(Core, saveLoadSimulationBitExact) {
+	// STP is limited to networks with delays of 1 ms and a single partition, the other network has spikes in transit
+	// for up to 20 ms and spans two partitions
+	for (int withSTP = 0; withSTP <= 1; withSTP++) {
+		std::vector<std::vector<float> > weights[2];
+		std::vector<std::vector<int> > spikes[2];
+
+		// 0: runs 2200 ms without interruption, 1: runs 1500 ms and saves the simulation, 2: loads it and runs 700 ms
+		for (int mode = 0; mode <= 2; mode++) {
+			CARLsim* sim = new CARLsim("Core.saveLoadSimulationBitExact", CPU_MODE, SILENT, 0, (mode == 2) ? 43 : 42);
+			FILE* simFid = NULL;
+
+			int gExc = sim->createGroup("exc", 80, EXCITATORY_NEURON, 0, CPU_CORES);
+			int gInh = sim->createGroup("inh", 20, INHIBITORY_NEURON, withSTP ? 0 : 1, CPU_CORES);
+			sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+			sim->setNeuronParameters(gInh, 0.1f, 0.2f, -65.0f, 2.0f);
+
+			sim->connect(gExc, gExc, "random", RangeWeight(0.0f, 0.05f, 0.1f), 0.1f,
+				withSTP ? RangeDelay(1) : RangeDelay(1, 20), RadiusRF(-1), SYN_PLASTIC);
+			sim->connect(gExc, gInh, "random", RangeWeight(0.02f), 0.2f, withSTP ? RangeDelay(1) : RangeDelay(1, 5));
+			sim->connect(gInh, gExc, "random", RangeWeight(0.1f), 0.2f, RangeDelay(1));
+			sim->setConductances(true);
+			sim->setSTDP(gExc, true, STANDARD, 0.001f, 20.0f, 0.0012f, 20.0f);
+			sim->setHomeostasis(gExc, true, 1.0f, 10.0f);
+			sim->setHomeoBaseFiringRate(gExc, 10.0f, 2.0f);
+			if (withSTP) {
+				sim->setSTP(gExc, true);
+				sim->setSTP(gInh, true);
+			}
+
+			if (mode == 2) {
+				simFid = fopen("results/sim_bitexact.dat", "rb");
+				sim->loadSimulation(simFid);
+			}
+
+			sim->setupNetwork();
+
+			// the external current is not part of the saved state
+			std::vector<float> current(80);
+			for (int i = 0; i < current.size(); i++)
+				current[i] = 5.0f + 0.05f * i;
+			sim->setExternalCurrent(gExc, current);
+
+			ConnectionMonitor* cm = sim->setConnectionMonitor(gExc, gExc, "NULL");
+			SpikeMonitor* sm = sim->setSpikeMonitor(gExc, "NULL");
+
+			if (mode <= 1)
+				sim->runNetwork(1, 500, false);
+
+			if (mode == 1) {
+				sim->saveSimulation("results/sim_bitexact.dat", true);
+			} else {
+				sm->startRecording();
+				sim->runNetwork(0, 700, false);
+				sm->stopRecording();
+				EXPECT_EQ(sim->getSimTime(), 2200);
+
+				weights[mode / 2] = cm->takeSnapshot();
+				spikes[mode / 2] = sm->getSpikeVector2D();
+			}
+
+			if (simFid != NULL) fclose(simFid);
+			delete sim;
+		}
+		remove("results/sim_bitexact.dat");
+
+		// spike times are absolute, so the loaded simulation has to fire at the same times
+		int numSpikes = 0;
+		for (int i = 0; i < spikes[0].size(); i++)
+			numSpikes += spikes[0][i].size();
+		EXPECT_GT(numSpikes, 0);
+		EXPECT_EQ(spikes[0], spikes[1]);
+
+		ASSERT_EQ(weights[0].size(), weights[1].size());
+		for (int i = 0; i < weights[0].size(); i++) {
+			for (int j = 0; j < weights[0][i].size(); j++) {
+				// NaN marks the absence of a synapse
+				if (weights[0][i][j] != weights[0][i][j]) {
+					EXPECT_NE(weights[1][i][j], weights[1][i][j]);
+				} else {
+					EXPECT_EQ(weights[0][i][j], weights[1][i][j]);
+				}
+			}
+		}
+	}
+}
+
+//! connects every other pair of neurons and counts how often it was called
+class CountingConnGen : public ConnectionGenerator {
+public:
+	CountingConnGen(const std::string& identity) : identity_(identity), numCalls_(0) {}
+
+	void connect(CARLsim* net, int srcGrp, int i, int destGrp, int j, float& weight, float& maxWt, float& delay,
+		bool& connected) {
+		numCalls_++;
+		connected = ((i + j) % 2 == 0);
+		weight = 0.01f * (i % 5);
+		maxWt = 0.05f;
+		delay = 1 + (j % 4);
+	}
+
+	std::string getIdentity() { return identity_; }
+	int getNumCalls() { return numCalls_; }
+
+private:
+	std::string identity_;
+	int numCalls_;
+};
+
+// removes the files of the network cache from results/
+static void removeNetworkCacheFiles() {
+#if defined(WIN32) || defined(WIN64)
+	int ret = system("del results\\carlsim_*");
+#else
+	int ret = system("rm -f results/carlsim_*");
+#endif
+}
+
+// a network found in the network cache is loaded instead of generated: its ConnectionGenerator is not called, the
+// synapses of its CPU runtime are mapped from the cache, and it simulates the same as the network that was stored.
+// Without plastic synapses the weights are mapped as well, setWeight then works on a copy.
+TEST(Core, networkCache) {
+	removeNetworkCacheFiles();
+
+	for (int hasPlasticSynapses = 0; hasPlasticSynapses <= 1; hasPlasticSynapses++) {
+		std::vector<std::vector<float> > weights[3];
+		int numCalls[3], numSpikes[3];
+		for (int run = 0; run < 3; run++) {
+			CARLsim* sim = new CARLsim("Core.networkCache", CPU_MODE, SILENT, 0, run < 2 ? 42 : 43);
+			CountingConnGen connGen("Core.networkCache");
+
+			int gIn = sim->createSpikeGeneratorGroup("input", 20, EXCITATORY_NEURON);
+			int gExc = sim->createGroup("exc", 50, EXCITATORY_NEURON);
+			sim->setNeuronParameters(gExc, 0.02f, 0.2f, -65.0f, 8.0f);
+			int cIn = sim->connect(gIn, gExc, &connGen, SYN_FIXED);
+			if (hasPlasticSynapses) {
+				sim->connect(gExc, gExc, "random", RangeWeight(0.0f, 0.02f, 0.05f), 0.2f, RangeDelay(1, 10),
+					RadiusRF(-1), SYN_PLASTIC);
+				sim->setSTDP(gExc, true, STANDARD, 0.001f, 20.0f, 0.0012f, 20.0f);
+			} else {
+				sim->connect(gExc, gExc, "random", RangeWeight(0.02f), 0.2f, RangeDelay(1, 10));
+			}
+			sim->setConductances(true);
+			sim->setNetworkCache("results");
+			sim->setupNetwork();
+
+			numCalls[run] = connGen.getNumCalls();
+			weights[run] = sim->setConnectionMonitor(gExc, gExc, "NULL")->takeSnapshot();
+			ConnectionMonitor* cmIn = sim->setConnectionMonitor(gIn, gExc, "NULL");
+			SpikeMonitor* sm = sim->setSpikeMonitor(gExc, "NULL");
+			PoissonRate in(20);
+			in.setRates(30.0f);
+			sim->setSpikeRate(gIn, &in);
+
+			sm->startRecording();
+			sim->runNetwork(0, 500, false);
+			sm->stopRecording();
+			numSpikes[run] = sm->getPopNumSpikes();
+
+			// neurons 0 and 0 are connected (see CountingConnGen)
+			sim->setWeight(cIn, 0, 0, 0.03f);
+			EXPECT_FLOAT_EQ(cmIn->takeSnapshot()[0][0], 0.03f);
+			delete sim;
+		}
+
+		// the first simulation stores the network, the second one loads it, the third one differs in the random seed
+		EXPECT_GT(numCalls[0], 0);
+		EXPECT_EQ(numCalls[1], 0);
+		EXPECT_GT(numCalls[2], 0);
+		EXPECT_GT(numSpikes[0], 0);
+		EXPECT_EQ(numSpikes[0], numSpikes[1]);
+
+		ASSERT_EQ(weights[0].size(), weights[1].size());
+		for (int i = 0; i < weights[0].size(); i++) {
+			for (int j = 0; j < weights[0][i].size(); j++) {
+				if (weights[0][i][j] != weights[0][i][j]) {
+					EXPECT_NE(weights[1][i][j], weights[1][i][j]); // NaN: no synapse
+				} else {
+					EXPECT_EQ(weights[0][i][j], weights[1][i][j]);
+				}
+			}
+		}
+	}
+
+	removeNetworkCacheFiles();
+}
+
 TEST(Core, synapseIdOverflow) {
 	::testing::FLAGS_gtest_death_test_style = "threadsafe";
 
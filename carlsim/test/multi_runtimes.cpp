@@ -50,6 +50,8 @@
 #include "gtest/gtest.h"
 #include "carlsim_tests.h"
 #include <carlsim.h>
+#include <cstdio>	// tmpfile, fgets
+#include <sstream>	// std::stringstream
 
 /*
 	class FixedRandomConnGen - Subclass of the connectionGenerator class to define custom connections between two groups
@@ -101,6 +103,28 @@ private:
 	bool* connecteds;
 };
 
+// returns the CPU runtime that setCPUAutoPartition placed a group on according to the partition summary in the info
+// log fpInf, or -1 if the summary does not list the group
+static int getAutoPartitionRuntime(FILE* fpInf, const std::string& grpName) {
+	char line[1024];
+	rewind(fpInf);
+	while (fgets(line, sizeof(line), fpInf) != NULL) {
+		int runtime;
+		float load;
+		char grpNames[1024];
+		if (sscanf(line, "  CPU runtime %d: %f (%1023[^)])", &runtime, &load, grpNames) != 3)
+			continue;
+
+		std::stringstream names(grpNames);
+		std::string name;
+		while (std::getline(names, name, ',')) {
+			if (name.substr(name.find_first_not_of(' ')) == grpName)
+				return runtime;
+		}
+	}
+	return -1;
+}
+
 TEST(MultiRuntimes, spikesSingleVsMulti) {
 	// create a network on GPU
 	int gExc, gExc2, gInput;
@@ -255,3 +279,208 @@ TEST(MultiRuntimes, shuffleGroups) {
 		}
 	}
 }
+
+// a single CPU runtime must produce the same spikes whether it runs inline or on a pinned worker thread
+TEST(MultiRuntimes, spikesInlineVsWorkerPool) {
+	class InlineNetwork : public ExcInhNetwork {
+	public:
+		InlineNetwork() : ExcInhNetwork("MultiRuntimes.spikesInlineVsWorkerPool") {}
+	protected:
+		void configure(CARLsim* sim, int runInline) { sim->setCPURunInline(runInline == 1); }
+	};
+
+	InlineNetwork net;
+	expectSameRun(net.run(0), net.run(1), true);
+}
+
+// splitting the neurons of a CPU runtime among threads must not change the spikes
+TEST(MultiRuntimes, spikesSingleVsMultiThreadPerRuntime) {
+	class MultiThreadNetwork : public ExcInhNetwork {
+	public:
+		MultiThreadNetwork() : ExcInhNetwork("MultiRuntimes.spikesSingleVsMultiThreadPerRuntime") {}
+	protected:
+		// 3 threads do not divide the neurons evenly
+		void configure(CARLsim* sim, int mode) { sim->setCPUThreadsPerRuntime(mode == 0 ? 1 : 3); }
+	};
+
+	MultiThreadNetwork net;
+	expectSameRun(net.run(0), net.run(1), true);
+}
+
+// delivering the spikes of a CPU runtime by post-synaptic neuron range must not change spikes or (plastic) weights
+TEST(MultiRuntimes, spikesSerialVsParallelSpikeDelivery) {
+	class ParallelDeliveryNetwork : public ExcInhNetwork {
+	public:
+		ParallelDeliveryNetwork() : ExcInhNetwork("MultiRuntimes.spikesSerialVsParallelSpikeDelivery"), inDA_(100) {
+			plasticExcExc = true;
+			runTimeMs = 2000;
+			inDA_.setRates(10.0f);
+		}
+	protected:
+		void configure(CARLsim* sim, int mode) {
+			gDA_ = sim->createSpikeGeneratorGroup("dopamine", 100, DOPAMINERGIC_NEURON);
+			sim->connect(gDA_, gExc_, "random", RangeWeight(0.0f), 0.1f, RangeDelay(1), RadiusRF(-1), SYN_FIXED);
+			sim->setESTDP(gExc_, true, DA_MOD, ExpCurve(2e-4f, 20.0f, -6.6e-5f, 60.0f));
+			sim->setCPUThreadsPerRuntime(mode == 0 ? 1 : 4);
+			sim->setCPUParallelSpikeDelivery(mode == 1);
+		}
+		void afterSetup(CARLsim* sim, int mode) { sim->setSpikeRate(gDA_, &inDA_); }
+	private:
+		int gDA_;
+		PoissonRate inDA_;
+	};
+
+	ParallelDeliveryNetwork net;
+	expectSameRun(net.run(0), net.run(1), false);
+}
+
+TEST(MultiRuntimes, spikesSingleVsAutoPartition) {
+	std::vector<std::vector<int> > spikes[2][3];
+	FixedRandomConnGen frConnGen(10, 10, RangeWeight(10.0f), RangeDelay(1, 20));
+	int randSeed = 42;
+
+	// distributing the groups among CPU runtimes must not change the spikes
+	// (the network is driven by an external current, because Poisson input is drawn per runtime)
+	for (int mode = 0; mode < 2; mode++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.spikesSingleVsAutoPartition", CPU_MODE, CUSTOM, 0, randSeed);
+		FILE* fpInf = tmpfile();
+		sim->setLogsFpCustom(fpInf);
+
+		const char* names[3] = {"exc0", "exc1", "exc2"};
+		int g[3];
+		for (int i = 0; i < 3; i++) {
+			g[i] = sim->createGroup(names[i], 10, EXCITATORY_NEURON);
+			sim->setNeuronParameters(g[i], 0.02f, 0.2f, -65.0f, 8.0f); // RS
+		}
+		sim->connect(g[0], g[1], &frConnGen, SYN_FIXED);
+		sim->connect(g[1], g[2], &frConnGen, SYN_FIXED);
+
+		sim->setConductances(false);
+		sim->setCPUAutoPartition(mode == 0 ? 1 : 2);
+
+		sim->setupNetwork();
+
+		// the groups cost the same and a runtime only has room for one of them, so the spikes cross the runtimes
+		if (mode == 1) {
+			int netId[3];
+			for (int i = 0; i < 3; i++) {
+				netId[i] = getAutoPartitionRuntime(fpInf, names[i]);
+				EXPECT_TRUE(netId[i] == 0 || netId[i] == 1);
+			}
+			EXPECT_NE(netId[0], netId[1]);
+			EXPECT_NE(netId[1], netId[2]);
+		}
+
+		SpikeMonitor* sm[3];
+		for (int i = 0; i < 3; i++) {
+			sm[i] = sim->setSpikeMonitor(g[i], "NULL");
+			sm[i]->startRecording();
+		}
+		sim->setExternalCurrent(g[0], 7.0f);
+
+		sim->runNetwork(1, 0, false);
+
+		for (int i = 0; i < 3; i++) {
+			sm[i]->stopRecording();
+			EXPECT_GT(sm[i]->getPopNumSpikes(), 0);
+			spikes[mode][i] = sm[i]->getSpikeVector2D();
+		}
+
+		delete sim;
+		fclose(fpInf);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		ASSERT_EQ(spikes[0][i].size(), spikes[1][i].size());
+		for (int nId = 0; nId < spikes[0][i].size(); nId++) {
+			ASSERT_EQ(spikes[0][i][nId].size(), spikes[1][i][nId].size()); // the same number of spikes
+			for (int s = 0; s < spikes[0][i][nId].size(); s++)
+				EXPECT_EQ(spikes[0][i][nId][s], spikes[1][i][nId][s]); // the same spike timing
+		}
+	}
+}
+
+// The spike traffic between the groups decides the placement of groups that fit into either runtime: each small group
+// goes to the runtime of the large group it receives spikes from, whereas balancing the load alone would place small1
+// (placed first) on runtime 0 and small0 on the then less loaded runtime 1
+TEST(MultiRuntimes, autoPartitionByTraffic) {
+	CARLsim* sim = new CARLsim("MultiRuntimes.autoPartitionByTraffic", CPU_MODE, CUSTOM, 0, 42);
+	FILE* fpInf = tmpfile();
+	sim->setLogsFpCustom(fpInf);
+
+	const char* names[4] = {"large0", "large1", "small0", "small1"};
+	int numN[4] = {100, 100, 10, 20};
+	int g[4];
+	for (int i = 0; i < 4; i++) {
+		g[i] = sim->createGroup(names[i], numN[i], EXCITATORY_NEURON);
+		sim->setNeuronParameters(g[i], 0.02f, 0.2f, -65.0f, 8.0f); // RS
+	}
+	sim->connect(g[0], g[2], "random", RangeWeight(1.0f), 0.1f, RangeDelay(1, 5));
+	sim->connect(g[1], g[3], "random", RangeWeight(1.0f), 0.1f, RangeDelay(1, 5));
+	sim->setConductances(false);
+	sim->setCPUAutoPartition(2);
+
+	sim->setupNetwork();
+
+	// the large groups do not fit into the same runtime, each small group follows its pre-synaptic group
+	EXPECT_EQ(getAutoPartitionRuntime(fpInf, "large0"), 0);
+	EXPECT_EQ(getAutoPartitionRuntime(fpInf, "large1"), 1);
+	EXPECT_EQ(getAutoPartitionRuntime(fpInf, "small0"), 0);
+	EXPECT_EQ(getAutoPartitionRuntime(fpInf, "small1"), 1);
+
+	delete sim;
+	fclose(fpInf);
+}
+
+TEST(MultiRuntimes, spikesLockstepVsLookahead) {
+	std::vector<std::vector<int> > spikes[2][2];
+	int randSeed = 42;
+
+	// synchronizing the CPU runtimes once per lookahead window must not change the spikes
+	// (the network is driven by an external current, because Poisson input is drawn per runtime)
+	for (int mode = 0; mode < 2; mode++) {
+		CARLsim* sim = new CARLsim("MultiRuntimes.spikesLockstepVsLookahead", CPU_MODE, SILENT, 0, randSeed);
+
+		int g0 = sim->createGroup("exc0", 20, EXCITATORY_NEURON, 0, CPU_CORES);
+		int g1 = sim->createGroup("exc1", 20, EXCITATORY_NEURON, 1, CPU_CORES);
+		sim->setNeuronParameters(g0, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+		sim->setNeuronParameters(g1, 0.02f, 0.2f, -65.0f, 8.0f); // RS
+
+		sim->connect(g0, g0, "random", RangeWeight(1.0f), 0.1f, RangeDelay(1, 5));
+		sim->connect(g0, g1, "random", RangeWeight(8.0f), 0.2f, RangeDelay(4, 10));
+		sim->connect(g1, g0, "random", RangeWeight(3.0f), 0.1f, RangeDelay(5, 20));
+
+		sim->setConductances(false);
+		sim->setCPULookahead(mode == 1);
+
+		sim->setupNetwork();
+
+		SpikeMonitor* sm[2];
+		sm[0] = sim->setSpikeMonitor(g0, "NULL");
+		sm[1] = sim->setSpikeMonitor(g1, "NULL");
+		sm[0]->startRecording();
+		sm[1]->startRecording();
+		sim->setExternalCurrent(g0, 7.0f);
+
+		// windows must also be cut at the end of a run and at second boundaries
+		sim->runNetwork(0, 333, false);
+		sim->runNetwork(1, 0, false);
+
+		for (int i = 0; i < 2; i++) {
+			sm[i]->stopRecording();
+			EXPECT_GT(sm[i]->getPopNumSpikes(), 0);
+			spikes[mode][i] = sm[i]->getSpikeVector2D();
+		}
+
+		delete sim;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		ASSERT_EQ(spikes[0][i].size(), spikes[1][i].size());
+		for (int nId = 0; nId < spikes[0][i].size(); nId++) {
+			ASSERT_EQ(spikes[0][i][nId].size(), spikes[1][i][nId].size()); // the same number of spikes
+			for (int s = 0; s < spikes[0][i][nId].size(); s++)
+				EXPECT_EQ(spikes[0][i][nId][s], spikes[1][i][nId][s]); // the same spike timing
+		}
+	}
+}
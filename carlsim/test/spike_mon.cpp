@@ -401,6 +401,48 @@ TEST(SpikeMon, spikeTimes) {
 	}
 }
 
+/*
+ * This test makes sure that no spikes are dropped when the firing tables of a CPU runtime fill up. Two spike generator
+ * groups fire at NEURON_MAX_FIRING_RATE, the rate that the worst-case estimate of the firing tables is based on, one
+ * with a 1 ms delay (firingTableD1) and one with a longer delay (firingTableD2). The firing tables start much smaller
+ * and must grow during the run, so that every generated spike is recorded.
+ */
+TEST(SpikeMon, firingTablesGrowAtMaxFiringRate) {
+	const int GRP_SIZE = 50;
+	const int isi = 1000 / NEURON_MAX_FIRING_RATE;
+	const int runMs = 2500;
+
+	CARLsim* sim = new CARLsim("SpikeMon.firingTablesGrowAtMaxFiringRate", CPU_MODE, SILENT, 0, 42);
+	int gD1 = sim->createSpikeGeneratorGroup("inputD1", GRP_SIZE, EXCITATORY_NEURON);
+	int gD2 = sim->createSpikeGeneratorGroup("inputD2", GRP_SIZE, EXCITATORY_NEURON);
+	int gOut = sim->createGroup("output", GRP_SIZE, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+	sim->connect(gD1, gOut, "one-to-one", RangeWeight(0.5f), 1.0f, RangeDelay(1));
+	sim->connect(gD2, gOut, "one-to-one", RangeWeight(0.5f), 1.0f, RangeDelay(5));
+	sim->setConductances(false);
+
+	PeriodicSpikeGenerator spkGen(NEURON_MAX_FIRING_RATE, false); // first spike at t = isi
+	sim->setSpikeGenerator(gD1, &spkGen);
+	sim->setSpikeGenerator(gD2, &spkGen);
+
+	sim->setupNetwork();
+
+	SpikeMonitor* spkMonD1 = sim->setSpikeMonitor(gD1, "NULL");
+	SpikeMonitor* spkMonD2 = sim->setSpikeMonitor(gD2, "NULL");
+	spkMonD1->startRecording();
+	spkMonD2->startRecording();
+	sim->runNetwork(runMs / 1000, runMs % 1000);
+	spkMonD1->stopRecording();
+	spkMonD2->stopRecording();
+
+	for (int i = 0; i < GRP_SIZE; i++) {
+		EXPECT_EQ(spkMonD1->getNeuronNumSpikes(i), (runMs - 1) / isi);
+		EXPECT_EQ(spkMonD2->getNeuronNumSpikes(i), (runMs - 1) / isi);
+	}
+
+	delete sim;
+}
+
 /*
  * This test checks for the correctness of the getGroupFiringRate method.
  * A PeriodicSpikeGenerator is used to periodically generate input spikes, so that the input spike times are known.
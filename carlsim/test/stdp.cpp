@@ -1139,3 +1139,162 @@ TEST(STDP, ISTDPExpCurve_Adv) {
 		}
 	}
 }
+
+/*!
+ * \brief testing fixed and plastic synapses onto the same STDP group
+ * CPU runtimes keep the STDP state only for plastic synapses. This test makes sure that fixed synapses are not
+ * affected by STDP, that plastic synapses are, and that a weight range extended by biasWeights reaches the runtime.
+ */
+TEST(STDP, fixedAndPlasticSynapsesOnSTDPGroup) {
+	const int numIn = 100, numOut = 20;
+	float initWt = 5.0f;
+	float maxWt = 10.0f;
+
+	CARLsim* sim = new CARLsim("STDP.fixedAndPlasticSynapsesOnSTDPGroup", CPU_MODE, SILENT, 1, 42);
+	int gFixed = sim->createSpikeGeneratorGroup("input-fixed", numIn, EXCITATORY_NEURON);
+	int gPlastic = sim->createSpikeGeneratorGroup("input-plastic", numIn, EXCITATORY_NEURON);
+	int gOut = sim->createGroup("output", numOut, EXCITATORY_NEURON);
+	sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+
+	// the fixed connection is created first, but plastic synapses come first in the pre-synaptic list of a neuron
+	sim->connect(gFixed, gOut, "random", RangeWeight(initWt), 0.2f, RangeDelay(1, 10), RadiusRF(-1), SYN_FIXED);
+	int cPlastic = sim->connect(gPlastic, gOut, "random", RangeWeight(0.0f, initWt, maxWt), 0.2f, RangeDelay(1, 10),
+		RadiusRF(-1), SYN_PLASTIC);
+	sim->setConductances(false);
+	sim->setESTDP(gOut, true, STANDARD, ExpCurve(0.1f, 20.0f, -0.12f, 20.0f));
+
+	sim->setupNetwork();
+
+	PoissonRate in(numIn);
+	in.setRates(20.0f);
+	sim->setSpikeRate(gFixed, &in);
+	sim->setSpikeRate(gPlastic, &in);
+
+	ConnectionMonitor* cmFixed = sim->setConnectionMonitor(gFixed, gOut, "NULL");
+	ConnectionMonitor* cmPlastic = sim->setConnectionMonitor(gPlastic, gOut, "NULL");
+	cmFixed->setUpdateTimeIntervalSec(-1);
+	cmPlastic->setUpdateTimeIntervalSec(-1);
+
+	sim->runNetwork(2, 0, false);
+
+	std::vector<std::vector<float> > wtFixed = cmFixed->takeSnapshot();
+	std::vector<std::vector<float> > wtPlastic = cmPlastic->takeSnapshot();
+	int numChanged = 0;
+	for (int i = 0; i < numIn; i++) {
+		for (int j = 0; j < numOut; j++) {
+			if (!isnan(wtFixed[i][j])) {
+				EXPECT_FLOAT_EQ(wtFixed[i][j], initWt);
+			}
+			if (!isnan(wtPlastic[i][j])) {
+				EXPECT_GE(wtPlastic[i][j], 0.0f);
+				EXPECT_LE(wtPlastic[i][j], maxWt);
+				if (fabs(wtPlastic[i][j] - initWt) > 1e-6f)
+					numChanged++;
+			}
+		}
+	}
+	EXPECT_GT(numChanged, 0);
+
+	// extend the weight range: if the runtime still used the old maximum, all weights would be clamped back to it
+	sim->biasWeights(cPlastic, maxWt, true);
+	sim->runNetwork(1, 0, false);
+
+	wtPlastic = cmPlastic->takeSnapshot();
+	int numAboveOldMax = 0;
+	for (int i = 0; i < numIn; i++) {
+		for (int j = 0; j < numOut; j++) {
+			if (!isnan(wtPlastic[i][j]) && wtPlastic[i][j] > maxWt + 1e-3f)
+				numAboveOldMax++;
+		}
+	}
+	EXPECT_GT(numAboveOldMax, 0);
+
+	delete sim;
+}
+
+// irregular but reproducible input spikes with a mean rate of 20 Hz (the PoissonRate stream differs between
+// two CARLsim instances in the same process)
+class IrregularSpikeGenerator : public SpikeGenerator {
+public:
+	int nextSpikeTime(CARLsim* sim, int grpId, int nid, int currentTime, int lastScheduledSpikeTime, int endOfTimeSlice) {
+		unsigned int hash = (unsigned int)(nid + 1) * 2654435761u ^ (unsigned int)(lastScheduledSpikeTime + 1) * 40503u;
+		return lastScheduledSpikeTime + 20 + (int)((hash >> 8) % 61);
+	}
+};
+
+/*!
+ * \brief testing event-driven STDP on CPU runtimes
+ * With setCPUEventDrivenSTDP, the LTP of a synapse is applied when it is next used instead of at every post-synaptic
+ * spike. The pairing of spikes is the same, so the weights are expected to be the same as without it (up to rounding)
+ * for all E-STDP and I-STDP curves. The post-synaptic neurons fire often enough to fill their spike history.
+ */
+TEST(STDP, eventDrivenSTDP) {
+	const int numIn = 50, numOut = 10;
+
+	for (int curve = 0; curve < 2; curve++) {
+		std::vector<std::vector<float> > wtExc[2], wtInh[2];
+		for (int eventDriven = 0; eventDriven < 2; eventDriven++) {
+			CARLsim* sim = new CARLsim("STDP.eventDrivenSTDP", CPU_MODE, SILENT, 1, 42);
+			int gExc = sim->createSpikeGeneratorGroup("input-exc", numIn, EXCITATORY_NEURON);
+			int gInh = sim->createSpikeGeneratorGroup("input-inh", numIn, INHIBITORY_NEURON);
+			int gOut = sim->createGroup("output", numOut, EXCITATORY_NEURON);
+			sim->setNeuronParameters(gOut, 0.02f, 0.2f, -65.0f, 8.0f);
+
+			sim->connect(gExc, gOut, "random", RangeWeight(0.0f, 15.0f, 30.0f), 0.5f, RangeDelay(3), RadiusRF(-1),
+				SYN_PLASTIC);
+			sim->connect(gInh, gOut, "random", RangeWeight(0.0f, 1.0f, 2.0f), 0.5f, RangeDelay(1), RadiusRF(-1),
+				SYN_PLASTIC);
+			sim->setConductances(false);
+			if (curve == 0) {
+				sim->setESTDP(gOut, true, STANDARD, ExpCurve(0.1f, 20.0f, -0.12f, 20.0f));
+				sim->setISTDP(gOut, true, STANDARD, ExpCurve(0.05f, 20.0f, -0.05f, 20.0f));
+			} else {
+				sim->setESTDP(gOut, true, STANDARD, TimingBasedCurve(0.1f, 20.0f, -0.12f, 20.0f, 10.0f));
+				sim->setISTDP(gOut, true, STANDARD, PulseCurve(0.02f, -0.01f, 10.0f, 20.0f));
+			}
+			sim->setCPUEventDrivenSTDP(eventDriven == 1);
+
+			IrregularSpikeGenerator spikeGen;
+			sim->setSpikeGenerator(gExc, &spikeGen);
+			sim->setSpikeGenerator(gInh, &spikeGen);
+
+			sim->setupNetwork();
+
+			ConnectionMonitor* cmExc = sim->setConnectionMonitor(gExc, gOut, "NULL");
+			ConnectionMonitor* cmInh = sim->setConnectionMonitor(gInh, gOut, "NULL");
+			cmExc->setUpdateTimeIntervalSec(-1);
+			cmInh->setUpdateTimeIntervalSec(-1);
+			SpikeMonitor* smOut = sim->setSpikeMonitor(gOut, "NULL");
+
+			smOut->startRecording();
+			sim->runNetwork(3, 0, false);
+			smOut->stopRecording();
+
+			// more than STDP_POST_HISTORY_LENGTH spikes per second and neuron
+			EXPECT_GT(smOut->getPopMeanFiringRate(), 16.0f);
+
+			wtExc[eventDriven] = cmExc->takeSnapshot();
+			wtInh[eventDriven] = cmInh->takeSnapshot();
+			delete sim;
+		}
+
+		int numChanged = 0;
+		for (int i = 0; i < numIn; i++) {
+			for (int j = 0; j < numOut; j++) {
+				if (isnan(wtExc[0][i][j])) {
+					EXPECT_TRUE(isnan(wtExc[1][i][j]));
+				} else {
+					EXPECT_NEAR(wtExc[0][i][j], wtExc[1][i][j], 1e-4f);
+					if (fabs(wtExc[0][i][j] - 15.0f) > 1e-3f)
+						numChanged++;
+				}
+				if (isnan(wtInh[0][i][j])) {
+					EXPECT_TRUE(isnan(wtInh[1][i][j]));
+				} else {
+					EXPECT_NEAR(wtInh[0][i][j], wtInh[1][i][j], 1e-4f);
+				}
+			}
+		}
+		EXPECT_GT(numChanged, 0);
+	}
+}
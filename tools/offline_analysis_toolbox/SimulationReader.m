@@ -187,6 +187,14 @@ classdef SimulationReader < handle
             
             %% READ SYNAPSES
             % reading synapse info is optional
+            % from version 0.4 on, the header and groups keep the layout
+            % above, but the synapses are stored as the flat arrays of
+            % CARLsim::loadSimulation, which are not read here
+            if loadSynapseInfo && version >= 0.4 - 1e-6
+                error(['Synapse info of file version ' num2str(version) ...
+                    ' cannot be read. Use ConnectionMonitor or ' ...
+                    'ConnectionReader instead.'])
+            end
             if loadSynapseInfo
                 weightData = cell(sim.nNeurons,1);
                 nrSynTot = 0;